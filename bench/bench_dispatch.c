@@ -0,0 +1,127 @@
+/**
+ * @file bench_dispatch.c
+ * @brief Benchmark del costo por línea de decidir qué comando interno (si alguno) la atiende.
+ *
+ * Compara la clasificación anterior (comandos JSON, tabla del monitor y luego strdup + strtok + una cadena de
+ * strcmp) con la búsqueda en la tabla de hash perfecto de lookup_builtin(), sobre una mezcla de líneas externas e
+ * internas.
+ *
+ * Uso: `bench_dispatch [iteraciones]` (por defecto 2000000 líneas por estrategia).
+ */
+
+#include "JSON_handler.h"
+#include "builtins.h"
+#include "command_processor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_ITERATIONS 2000000
+
+/**
+ * @brief Líneas a clasificar, en rotación: la mayoría son comandos externos, como en los scripts habituales.
+ */
+static const char* const sample_lines[] = {
+    "ls -la /var/log",
+    "grep -c error /var/log/syslog",
+    "echo procesando lote",
+    "sort -k5 -n datos.txt",
+    "cd /tmp",
+    "find . -name '*.json'",
+    "config print",
+    "status_monitor",
+};
+
+#define NUM_SAMPLES (sizeof(sample_lines) / sizeof(sample_lines[0]))
+
+/**
+ * @brief Devuelve el tiempo monotónico actual en segundos.
+ */
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Clasificación anterior al registro de comandos internos, reproducida para comparar.
+ */
+static command_type legacy_classify(const char* command)
+{
+    if (is_JSON_command(command))
+        return CMD_CONFIG;
+    if (is_monitor_command(command))
+        return CMD_MONITOR;
+
+    char* cmd = strdup(command);
+    if (cmd == NULL)
+        return CMD_EXTERNAL;
+    char* base = strtok(cmd, " ");
+    command_type type = CMD_EXTERNAL;
+    if (base == NULL)
+        type = CMD_EXTERNAL;
+    else if (strcmp(base, "quit") == 0)
+        type = CMD_QUIT;
+    else if (strcmp(base, "cd") == 0)
+        type = CMD_CD;
+    else if (strcmp(base, "clr") == 0)
+        type = CMD_CLR;
+    else if (strcmp(base, "echo") == 0)
+        type = CMD_ECHO;
+    else if (strcmp(base, "scan") == 0)
+        type = CMD_SCAN;
+    else if (strcmp(base, "hash") == 0)
+        type = CMD_HASH;
+    else if (strcmp(base, "jobs") == 0)
+        type = CMD_JOBS;
+    else if (strcmp(base, "fg") == 0)
+        type = CMD_FG;
+    else if (strcmp(base, "bg") == 0)
+        type = CMD_BG;
+    else if (strcmp(base, "wait") == 0)
+        type = CMD_WAIT;
+    free(cmd);
+    return type;
+}
+
+/**
+ * @brief Mide una estrategia y reporta nanosegundos por línea.
+ *
+ * @return Nanosegundos por línea.
+ */
+static double measure(const char* label, command_type (*classify)(const char*), int iterations)
+{
+    volatile unsigned long checksum = 0; // Evita que el compilador descarte las llamadas
+    double start = now_seconds();
+    for (int i = 0; i < iterations; i++)
+        checksum += (unsigned long)classify(sample_lines[(size_t)i % NUM_SAMPLES]);
+    double elapsed = now_seconds() - start;
+
+    double ns_per_line = elapsed * 1e9 / iterations;
+    printf("%-26s %9d líneas en %7.3f s -> %7.1f ns/línea\n", label, iterations, elapsed, ns_per_line);
+    return ns_per_line;
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0)
+        iterations = DEFAULT_ITERATIONS;
+
+    // Ambas estrategias deben coincidir antes de compararlas
+    for (size_t i = 0; i < NUM_SAMPLES; i++)
+    {
+        if (legacy_classify(sample_lines[i]) != lookup_builtin(sample_lines[i]))
+        {
+            fprintf(stderr, "bench_dispatch: clasificación distinta para '%s'\n", sample_lines[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    double before = measure("strcmp + strdup/strtok", legacy_classify, iterations);
+    double after = measure("hash perfecto", lookup_builtin, iterations);
+    printf("Mejora: %.2fx\n", before / after);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,206 @@
+/**
+ * @file bench_metric_matcher.c
+ * @brief Benchmark del filtro de métricas del wrapper con muchas métricas configuradas.
+ *
+ * Arma una configuración de nombres exactos y algunos patrones glob, y una exposición en la que aparecen esos
+ * nombres y otros que los contienen (`<nombre>_bucket`, `<nombre>_count`). Mide:
+ * - el filtro compilado (metric_matcher) sobre el nombre que entrega el analizador;
+ * - como referencia, el filtro anterior: buscar cada nombre configurado con strstr en cada línea.
+ *
+ * La referencia acepta también las líneas que solo contienen un nombre configurado, así que cuenta más coincidencias,
+ * y no entiende los patrones glob.
+ *
+ * Uso: `bench_metric_matcher [nombres configurados] [líneas] [repeticiones]` (por defecto 5000, 50000 y 5).
+ */
+
+#include "exposition_parser.h"
+#include "metric_matcher.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_NAMES 5000
+#define DEFAULT_LINES 50000
+#define DEFAULT_ROUNDS 5
+#define NAME_SIZE 48   // Bytes por nombre configurado
+#define GLOB_EVERY 100 // Uno de cada GLOB_EVERY nombres configurados es un patrón
+
+/**
+ * @brief Devuelve el tiempo monotónico actual en segundos.
+ */
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Arma la lista de nombres configurados: `app_metric_<i>` y, cada GLOB_EVERY, un patrón glob.
+ */
+static char** build_patterns(int count)
+{
+    char** patterns = malloc((size_t)count * sizeof(char*));
+    char* storage = malloc((size_t)count * NAME_SIZE);
+    if (patterns == NULL || storage == NULL)
+        return NULL;
+    for (int i = 0; i < count; i++)
+    {
+        patterns[i] = storage + (size_t)i * NAME_SIZE;
+        switch (i % GLOB_EVERY == GLOB_EVERY - 1 ? i / GLOB_EVERY % 3 : 3)
+        {
+        case 0:
+            snprintf(patterns[i], NAME_SIZE, "team_%d_*", i);
+            break;
+        case 1:
+            snprintf(patterns[i], NAME_SIZE, "*_job_%d", i);
+            break;
+        case 2:
+            snprintf(patterns[i], NAME_SIZE, "svc_%d_*_seconds", i);
+            break;
+        default:
+            snprintf(patterns[i], NAME_SIZE, "app_metric_%d", i);
+            break;
+        }
+    }
+    return patterns;
+}
+
+/**
+ * @brief Genera una exposición de `lines` líneas con nombres configurados, derivados de ellos y ajenos.
+ */
+static char* build_exposition(int names, int lines, size_t* length)
+{
+    size_t capacity = (size_t)lines * 96 + 1;
+    char* text = malloc(capacity);
+    if (text == NULL)
+        return NULL;
+    static const char* const kinds[] = {"app_metric_%d", "app_metric_%d_bucket", "app_metric_%d_count",
+                                        "node_other_%d", "team_%d_requests", "svc_%d_wait_seconds"};
+    size_t used = 0;
+    for (int i = 0; i < lines; i++)
+    {
+        char name[NAME_SIZE];
+        int id = i * 7919 % names;
+        snprintf(name, sizeof(name), kinds[i % 6], i % 6 >= 4 ? id / GLOB_EVERY * GLOB_EVERY + GLOB_EVERY - 1 : id);
+        used += (size_t)snprintf(text + used, capacity - used, "%s{instance=\"localhost:8000\",job=\"monitor\"} %d\n",
+                                 name, i);
+    }
+    *length = used;
+    return text;
+}
+
+/**
+ * @brief Filtro del analizador con el metric_matcher.
+ */
+static bool matcher_filter(const char* name, size_t name_length, void* data)
+{
+    return metric_matcher_match(data, name, name_length);
+}
+
+/**
+ * @brief Descarta las muestras: el analizador ya cuenta las aceptadas.
+ */
+static void discard_sample(const exposition_sample* sample, void* data)
+{
+    (void)sample;
+    (void)data;
+}
+
+/**
+ * @brief Referencia: cada línea se copia terminada en '\0' y se busca cada nombre configurado con strstr.
+ *
+ * @return Líneas aceptadas.
+ */
+static size_t strstr_filter(const char* text, size_t length, char* const* patterns, int count)
+{
+    size_t accepted = 0;
+    char line[512];
+    const char* end = text + length;
+    for (const char* start = text; start < end;)
+    {
+        const char* newline = memchr(start, '\n', (size_t)(end - start));
+        size_t line_length = (size_t)(newline - start);
+        memcpy(line, start, line_length);
+        line[line_length] = '\0';
+        for (int i = 0; i < count; i++)
+        {
+            if (strstr(line, patterns[i]) != NULL)
+            {
+                accepted++;
+                break;
+            }
+        }
+        start = newline + 1;
+    }
+    return accepted;
+}
+
+/**
+ * @brief Imprime una medición en líneas por segundo.
+ */
+static void report(const char* label, int rounds, int lines, size_t accepted, double elapsed)
+{
+    printf("%-30s %8.3f ms por exposición -> %10.0f líneas/s, %6zu líneas aceptadas\n", label, elapsed / rounds * 1e3,
+           (double)rounds * lines / elapsed, accepted);
+}
+
+int main(int argc, char* argv[])
+{
+    int names = argc > 1 ? atoi(argv[1]) : DEFAULT_NAMES;
+    int lines = argc > 2 ? atoi(argv[2]) : DEFAULT_LINES;
+    int rounds = argc > 3 ? atoi(argv[3]) : DEFAULT_ROUNDS;
+    if (names < GLOB_EVERY || lines <= 0 || rounds <= 0)
+    {
+        fprintf(stderr, "Uso: %s [nombres configurados (>= %d)] [líneas] [repeticiones]\n", argv[0], GLOB_EVERY);
+        return EXIT_FAILURE;
+    }
+
+    size_t length;
+    char** patterns = build_patterns(names);
+    char* text = build_exposition(names, lines, &length);
+    if (patterns == NULL || text == NULL)
+    {
+        perror("bench_metric_matcher");
+        return EXIT_FAILURE;
+    }
+    printf("%d nombres configurados (%d patrones), %d líneas, %.1f KiB por exposición\n\n", names, names / GLOB_EVERY,
+           lines, length / 1024.0);
+
+    // Compilación, una vez por versión de la configuración
+    metric_matcher matcher;
+    double start = now_seconds();
+    if (metric_matcher_compile(&matcher, (const char* const*)patterns, (size_t)names) == -1)
+    {
+        fprintf(stderr, "Sin memoria para compilar el filtro\n");
+        return EXIT_FAILURE;
+    }
+    printf("%-30s %8.3f ms\n", "compilar el filtro", (now_seconds() - start) * 1e3);
+
+    // Analizador + filtro compilado sobre el nombre
+    size_t accepted = 0;
+    exposition_parser parser;
+    exposition_parser_init(&parser, matcher_filter, discard_sample, &matcher);
+    start = now_seconds();
+    for (int i = 0; i < rounds; i++)
+    {
+        exposition_parser_reset(&parser);
+        exposition_parser_feed(&parser, text, length);
+        exposition_parser_finish(&parser);
+        accepted = parser.samples;
+    }
+    report("analizador + metric_matcher", rounds, lines, accepted, now_seconds() - start);
+    exposition_parser_free(&parser);
+
+    // Referencia: strstr de cada nombre en cada línea (una sola repetición: es varios órdenes más lenta)
+    start = now_seconds();
+    size_t reference = strstr_filter(text, length, patterns, names);
+    report("referencia: strstr por nombre", 1, lines, reference, now_seconds() - start);
+
+    metric_matcher_free(&matcher);
+    free(patterns[0]);
+    free(patterns);
+    free(text);
+    return EXIT_SUCCESS;
+}
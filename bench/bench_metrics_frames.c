@@ -0,0 +1,286 @@
+/**
+ * @file bench_metrics_frames.c
+ * @brief Benchmark del transporte de métricas del wrapper a la shell con tramas de muchas series.
+ *
+ * Publica tramas en una memoria compartida propia (no la del wrapper) y mide:
+ * - la publicación, analizando cada línea del formato de exposición como hace el wrapper;
+ * - la lectura de la trama más reciente, como `expose metrics`;
+ * - lecturas desde otro proceso mientras se publica, verificando que ninguna copia quede mezclada.
+ *
+ * Como referencia mide el transporte anterior: texto por una tubería terminado en `<END_OF_METRICS>`, leído de a
+ * 1024 bytes y buscando el marcador en todo lo acumulado después de cada lectura (sin el límite de 4 KB que tenía,
+ * que no dejaba pasar estas tramas).
+ *
+ * Uso: `bench_metrics_frames [series por trama] [tramas]` (por defecto 10000 series y 200 tramas).
+ */
+
+#include "metrics_shm.h"
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_SERIES 10000
+#define DEFAULT_FRAMES 200
+#define BENCH_SHM_NAME "/shell_metrics_bench"
+#define END_OF_METRICS "<END_OF_METRICS>\n"
+#define CHUNK_SIZE 1024 // Lecturas de la referencia, como el buffer del lector anterior
+
+/**
+ * @brief Devuelve el tiempo monotónico actual en segundos.
+ */
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Genera una exposición de `series` líneas con etiquetas, como la que devuelve el monitor.
+ */
+static char* build_exposition(int series, size_t* length)
+{
+    size_t capacity = (size_t)series * 96 + 1;
+    char* text = malloc(capacity);
+    if (text == NULL)
+        return NULL;
+    size_t used = 0;
+    for (int i = 0; i < series; i++)
+        used += (size_t)snprintf(text + used, capacity - used,
+                                 "node_metric_%d{instance=\"localhost:8000\",job=\"monitor\",cpu=\"%d\"} %d.5\n",
+                                 i % 500, i / 500, i);
+    *length = used;
+    return text;
+}
+
+/**
+ * @brief Publica una trama a partir del texto, línea por línea.
+ *
+ * @return Cantidad de muestras publicadas, o -1 en caso de error.
+ */
+static int publish_text(metrics_shm* shm, const char* text, size_t length)
+{
+    int added = 0;
+    metrics_shm_begin(shm);
+    const char* end = text + length;
+    for (const char* line = text; line < end;)
+    {
+        const char* newline = memchr(line, '\n', (size_t)(end - line));
+        if (newline == NULL)
+            newline = end;
+        int result = metrics_shm_add_line(shm, line, (size_t)(newline - line));
+        if (result == -1)
+            return -1;
+        added += result;
+        line = newline + 1;
+    }
+    return metrics_shm_commit(shm) == 0 ? added : -1;
+}
+
+/**
+ * @brief Lee tramas sin parar hasta recibir SIGTERM y verifica que cada copia sea una trama completa.
+ *
+ * La muestra i de cada trama vale i + 0.5, así que una copia mezclada de dos tramas se detecta.
+ */
+static void reader_child(int series, int result_fd)
+{
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGTERM);
+    sigprocmask(SIG_BLOCK, &set, NULL);
+
+    metrics_shm shm;
+    if (metrics_shm_open(&shm, BENCH_SHM_NAME) == -1)
+        _exit(1);
+    metrics_snapshot snapshot = {0};
+    long reads[2] = {0, 0}; // Lecturas y copias inconsistentes
+    sigset_t pending;
+    while (sigpending(&pending) == 0 && !sigismember(&pending, SIGTERM))
+    {
+        if (metrics_shm_read(&shm, &snapshot) == -1)
+            continue;
+        reads[0]++;
+        if (snapshot.num_samples != (uint32_t)series || snapshot.samples[0].value != 0.5 ||
+            snapshot.samples[series - 1].value != series - 1 + 0.5)
+            reads[1]++;
+    }
+    ssize_t written = write(result_fd, reads, sizeof(reads));
+    (void)written;
+    _exit(0);
+}
+
+/**
+ * @struct pipe_writer
+ * @brief Datos del hilo que escribe la referencia en la tubería.
+ */
+typedef struct
+{
+    int fd;           /**< Extremo de escritura. */
+    const char* text; /**< Exposición. */
+    size_t length;    /**< Longitud de la exposición. */
+    int frames;       /**< Tramas a escribir. */
+} pipe_writer;
+
+/**
+ * @brief Hilo escritor de la referencia: manda cada trama como texto seguido del marcador.
+ */
+static void* write_text_frames(void* data)
+{
+    pipe_writer* writer = data;
+    for (int i = 0; i < writer->frames; i++)
+    {
+        for (size_t sent = 0; sent < writer->length;)
+        {
+            ssize_t n = write(writer->fd, writer->text + sent, writer->length - sent);
+            if (n <= 0)
+                return NULL;
+            sent += (size_t)n;
+        }
+        if (write(writer->fd, END_OF_METRICS, strlen(END_OF_METRICS)) <= 0)
+            return NULL;
+    }
+    close(writer->fd);
+    return NULL;
+}
+
+/**
+ * @brief Mide la referencia: lecturas de 1024 bytes, strncat y strstr sobre todo lo acumulado.
+ *
+ * @return Segundos empleados, o -1 en caso de error.
+ */
+static double measure_text_pipe(const char* text, size_t length, int frames)
+{
+    int fds[2];
+    if (pipe(fds) == -1)
+        return -1;
+    pipe_writer writer = {fds[1], text, length, frames};
+    pthread_t thread;
+    double start = now_seconds();
+    if (pthread_create(&thread, NULL, write_text_frames, &writer) != 0)
+        return -1;
+
+    size_t capacity = length + 2 * CHUNK_SIZE + sizeof(END_OF_METRICS);
+    char* accumulated = malloc(capacity);
+    if (accumulated == NULL)
+        return -1;
+    char buffer[CHUNK_SIZE];
+    size_t used = 0;
+    int received = 0;
+    accumulated[0] = '\0';
+    ssize_t n;
+    while ((n = read(fds[0], buffer, sizeof(buffer) - 1)) > 0)
+    {
+        buffer[n] = '\0';
+        strncat(accumulated, buffer, capacity - used - 1);
+        used += (size_t)n;
+        char* marker = strstr(accumulated, "<END_OF_METRICS>");
+        if (marker != NULL)
+        {
+            received++;
+            char* rest = marker + strlen(END_OF_METRICS);
+            used -= (size_t)(rest - accumulated);
+            memmove(accumulated, rest, used + 1);
+        }
+    }
+    double elapsed = now_seconds() - start;
+    pthread_join(thread, NULL);
+    close(fds[0]);
+    free(accumulated);
+    return received == frames ? elapsed : -1;
+}
+
+/**
+ * @brief Imprime una medición en tramas, series y MiB por segundo.
+ */
+static void report(const char* label, int frames, int series, double bytes_per_frame, double elapsed)
+{
+    printf("%-34s %5d tramas en %7.3f s -> %9.1f tramas/s, %6.2f M series/s, %8.1f MiB/s\n", label, frames, elapsed,
+           frames / elapsed, (double)frames * series / elapsed / 1e6, frames * bytes_per_frame / elapsed / 1048576.0);
+}
+
+int main(int argc, char* argv[])
+{
+    int series = argc > 1 ? atoi(argv[1]) : DEFAULT_SERIES;
+    int frames = argc > 2 ? atoi(argv[2]) : DEFAULT_FRAMES;
+    if (series <= 0 || frames <= 0)
+    {
+        fprintf(stderr, "Uso: %s [series por trama] [tramas]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t length;
+    char* text = build_exposition(series, &length);
+    metrics_shm writer;
+    if (text == NULL || metrics_shm_create(&writer, BENCH_SHM_NAME) == -1)
+    {
+        perror("bench_metrics_frames");
+        return EXIT_FAILURE;
+    }
+    printf("%d series por trama, %.1f KiB de texto por trama\n", series, length / 1024.0);
+
+    // Publicación: análisis de cada línea, armado de la trama y copia a la memoria compartida
+    double start = now_seconds();
+    for (int i = 0; i < frames; i++)
+    {
+        if (publish_text(&writer, text, length) != series)
+        {
+            fprintf(stderr, "La publicación no agregó todas las series\n");
+            return EXIT_FAILURE;
+        }
+    }
+    double elapsed = now_seconds() - start;
+
+    metrics_shm reader;
+    metrics_snapshot snapshot = {0};
+    if (metrics_shm_open(&reader, BENCH_SHM_NAME) == -1 || metrics_shm_read(&reader, &snapshot) == -1)
+    {
+        perror("bench_metrics_frames: lectura");
+        return EXIT_FAILURE;
+    }
+    double frame_bytes = (double)((const metrics_frame*)snapshot.buffer)->bytes;
+    printf("%.1f KiB por trama binaria\n\n", frame_bytes / 1024.0);
+    report("publicar (análisis de texto)", frames, series, frame_bytes, elapsed);
+
+    // Lectura de la trama más reciente en un buffer que ya tiene capacidad
+    start = now_seconds();
+    for (int i = 0; i < frames; i++)
+        metrics_shm_read(&reader, &snapshot);
+    report("leer (copia de una trama)", frames, series, frame_bytes, now_seconds() - start);
+
+    // Publicación con un lector concurrente en otro proceso
+    int result_pipe[2];
+    if (pipe(result_pipe) == -1)
+        return EXIT_FAILURE;
+    pid_t child = fork();
+    if (child == 0)
+        reader_child(series, result_pipe[1]);
+    start = now_seconds();
+    for (int i = 0; i < frames; i++)
+        publish_text(&writer, text, length);
+    elapsed = now_seconds() - start;
+    kill(child, SIGTERM);
+    long reads[2] = {0, 0};
+    ssize_t received = read(result_pipe[0], reads, sizeof(reads));
+    waitpid(child, NULL, 0);
+    report("publicar con un lector concurrente", frames, series, frame_bytes, elapsed);
+    if (received == (ssize_t)sizeof(reads))
+        printf("%-34s %5ld lecturas, %ld copias inconsistentes\n", "  lector concurrente", reads[0], reads[1]);
+
+    // Referencia: el transporte anterior por tubería
+    double text_elapsed = measure_text_pipe(text, length, frames);
+    if (text_elapsed > 0)
+        report("referencia: texto + strstr", frames, series, (double)length, text_elapsed);
+
+    metrics_snapshot_free(&snapshot);
+    metrics_shm_close(&reader);
+    metrics_shm_close(&writer);
+    shm_unlink(BENCH_SHM_NAME);
+    free(text);
+    return reads[1] == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
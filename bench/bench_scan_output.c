@@ -0,0 +1,193 @@
+/**
+ * @file bench_scan_output.c
+ * @brief Benchmark de la salida de `scan`: copiar con fgets/printf frente a write_config_file().
+ *
+ * Genera un directorio con archivos ".json" grandes, los busca con scan_config_files() y vuelca su contenido a una
+ * tubería de la que lee un hilo aparte, como cuando la salida de `scan` se redirige a otro proceso. Se comparan la
+ * copia línea por línea con bloques de 1024 bytes (la implementación anterior) y write_config_file(), que usa
+ * sendfile().
+ *
+ * Uso: `bench_scan_output [archivos] [MiB por archivo] [repeticiones]` (por defecto 16 archivos de 8 MiB y 3
+ * repeticiones). Los archivos se escriben en un directorio temporal que se borra al terminar.
+ */
+
+#include "config_scan.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_FILES 16
+#define DEFAULT_MIB 8
+#define DEFAULT_REPETITIONS 3
+#define LINE_LENGTH 100 // Longitud de cada línea de los archivos generados
+
+/**
+ * @brief Devuelve el tiempo monotónico actual en segundos.
+ */
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Escribe un archivo de `size` bytes con líneas de LINE_LENGTH caracteres.
+ *
+ * @return 0 si el archivo se escribió, -1 en caso de error o si una línea no cabe en LINE_LENGTH caracteres.
+ */
+static int write_sample_file(const char* path, size_t size)
+{
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+        return -1;
+    char line[LINE_LENGTH + 1];
+    for (size_t written = 0; written < size; written += LINE_LENGTH)
+    {
+        int length = snprintf(line, sizeof(line), "{\"clave\": %zu, \"valor\": \"%0*zu\"}", written, LINE_LENGTH - 40,
+                              written);
+        if (length < 0 || length >= LINE_LENGTH) // Sin sitio para el salto de línea: el archivo sería irregular
+        {
+            fclose(file);
+            return -1;
+        }
+        memset(line + strlen(line), ' ', sizeof(line) - strlen(line));
+        line[LINE_LENGTH - 1] = '\n';
+        fwrite(line, 1, LINE_LENGTH, file);
+    }
+    return fclose(file);
+}
+
+/**
+ * @brief Hilo lector: consume la tubería hasta el fin de archivo y cuenta los bytes.
+ */
+static void* drain_pipe(void* arg)
+{
+    int fd = *(int*)arg;
+    static char buffer[1 << 16];
+    size_t total = 0;
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+        total += (size_t)n;
+    return (void*)total;
+}
+
+/**
+ * @brief Implementación anterior de `scan`: fgets con un búfer de 1024 bytes y printf por línea.
+ */
+static void legacy_copy(const char* path, FILE* out)
+{
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+        return;
+    char line[1024];
+    fprintf(out, "\033[1;31mArchivo de configuracion encontrado: %s\ncontenido de %s:\033[38;5;87m\n", path, path);
+    while (fgets(line, sizeof(line), file) != NULL)
+        fprintf(out, "%s", line);
+    fprintf(out, "\n");
+    fclose(file);
+}
+
+/**
+ * @brief Vuelca todos los archivos de `result` a una tubería y devuelve los segundos que tardó.
+ *
+ * @param bytes Cantidad de bytes que recibió el lector.
+ */
+static double run_copy(const scan_result* result, bool legacy, size_t* bytes)
+{
+    int fds[2];
+    if (pipe(fds) == -1)
+        return -1;
+    pthread_t reader;
+    pthread_create(&reader, NULL, drain_pipe, &fds[0]);
+
+    double start = now_seconds();
+    if (legacy)
+    {
+        FILE* out = fdopen(fds[1], "w");
+        for (size_t i = 0; i < result->count; i++)
+            legacy_copy(result->paths[i], out);
+        fclose(out);
+    }
+    else
+    {
+        for (size_t i = 0; i < result->count; i++)
+            write_config_file(result->paths[i], fds[1]);
+        close(fds[1]);
+    }
+    void* total;
+    pthread_join(reader, &total);
+    double elapsed = now_seconds() - start;
+
+    close(fds[0]);
+    *bytes = (size_t)total;
+    return elapsed;
+}
+
+int main(int argc, char* argv[])
+{
+    int num_files = argc > 1 ? atoi(argv[1]) : DEFAULT_FILES;
+    int mib = argc > 2 ? atoi(argv[2]) : DEFAULT_MIB;
+    int repetitions = argc > 3 ? atoi(argv[3]) : DEFAULT_REPETITIONS;
+    if (num_files <= 0)
+        num_files = DEFAULT_FILES;
+    if (mib <= 0)
+        mib = DEFAULT_MIB;
+    if (repetitions <= 0)
+        repetitions = DEFAULT_REPETITIONS;
+
+    char dir[] = "/tmp/bench_scan_output.XXXXXX";
+    if (mkdtemp(dir) == NULL)
+    {
+        perror("bench_scan_output");
+        return EXIT_FAILURE;
+    }
+
+    char path[sizeof(dir) + 32];
+    for (int i = 0; i < num_files; i++)
+    {
+        snprintf(path, sizeof(path), "%s/archivo%03d.json", dir, i);
+        if (write_sample_file(path, (size_t)mib << 20) == -1)
+        {
+            fprintf(stderr, "bench_scan_output: no se pudo escribir %s\n", path);
+            return EXIT_FAILURE;
+        }
+    }
+
+    scan_result result;
+    if (scan_config_files(dir, 0, &result) == -1)
+    {
+        fprintf(stderr, "bench_scan_output: no se pudo explorar %s\n", dir);
+        return EXIT_FAILURE;
+    }
+
+    double best_legacy = 0, best_sendfile = 0;
+    size_t legacy_bytes = 0, sendfile_bytes = 0;
+    for (int i = 0; i < repetitions; i++)
+    {
+        double legacy = run_copy(&result, true, &legacy_bytes);
+        double zero_copy = run_copy(&result, false, &sendfile_bytes);
+        if (i == 0 || legacy < best_legacy)
+            best_legacy = legacy;
+        if (i == 0 || zero_copy < best_sendfile)
+            best_sendfile = zero_copy;
+    }
+    scan_result_free(&result);
+
+    if (legacy_bytes != sendfile_bytes)
+        fprintf(stderr, "bench_scan_output: la salida difiere (%zu frente a %zu bytes)\n", legacy_bytes,
+                sendfile_bytes);
+
+    double mb = (double)sendfile_bytes / (1 << 20);
+    printf("%d archivos de %d MiB hacia una tubería (mejor de %d repeticiones)\n", num_files, mib, repetitions);
+    printf("%-18s %9.3f ms %9.1f MB/s\n", "fgets + printf", best_legacy * 1e3, mb / best_legacy);
+    printf("%-18s %9.3f ms %9.1f MB/s\n", "write_config_file", best_sendfile * 1e3, mb / best_sendfile);
+    printf("Mejora: %.2fx\n", best_legacy / best_sendfile);
+
+    char command[sizeof(dir) + 16];
+    snprintf(command, sizeof(command), "rm -rf %s", dir);
+    return system(command) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
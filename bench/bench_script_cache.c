@@ -0,0 +1,154 @@
+/**
+ * @file bench_script_cache.c
+ * @brief Benchmark de la caché de scripts: preparar cada línea de un script frente a cargar su caché.
+ *
+ * Genera un script de prueba, lo prepara línea por línea (clasificación y análisis, lo que hace la shell sin caché),
+ * construye su caché y mide cuánto tarda cargarla. No se ejecuta ningún comando.
+ *
+ * Uso: `bench_script_cache [líneas] [repeticiones]` (por defecto 50000 líneas y 5 repeticiones).
+ * La caché se escribe en un directorio temporal que se usa como `$XDG_CACHE_HOME`.
+ */
+
+#include "command_processor.h"
+#include "line_reader.h"
+#include "script_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_LINES 50000
+#define DEFAULT_REPETITIONS 5
+
+/**
+ * @brief Líneas con las que se arma el script, en rotación: comandos internos, tuberías y redirecciones.
+ */
+static const char* const sample_lines[] = {
+    "echo procesando lote",
+    "ls -la /var/log | grep -v old | sort -k5 -n | tail -n 20",
+    "cat /etc/hostname > /tmp/bench_host.txt 2> /tmp/bench_err.txt",
+    "cd /tmp",
+    "grep -c \"error grave\" /var/log/syslog >> /tmp/bench_count.txt",
+    "find . -name '*.json' -newer /tmp/bench_host.txt",
+    "jobs",
+    "sleep 0 & wc -l /etc/passwd; true",
+};
+
+/**
+ * @brief Devuelve el tiempo monotónico actual en segundos.
+ */
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Escribe un script de `num_lines` líneas.
+ *
+ * @return 0 si el script se escribió, -1 en caso de error.
+ */
+static int write_script(const char* path, int num_lines)
+{
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+        return -1;
+    int num_samples = (int)(sizeof(sample_lines) / sizeof(sample_lines[0]));
+    for (int i = 0; i < num_lines; i++)
+        fprintf(file, "%s\n", sample_lines[i % num_samples]);
+    return fclose(file);
+}
+
+/**
+ * @brief Camino sin caché: lee el script y prepara cada línea. Si se indica, además construye la caché.
+ */
+static double prepare_script(const char* path, bool build_cache)
+{
+    double start = now_seconds();
+    line_reader reader;
+    if (line_reader_open(&reader, path) == -1)
+        return -1;
+
+    script_cache_builder builder;
+    if (build_cache && script_cache_builder_init(&builder, path) == -1)
+        build_cache = false;
+
+    char* line;
+    while ((line = line_reader_next(&reader, NULL)) != NULL)
+    {
+        prepared_command prepared;
+        prepare_command(line, &prepared);
+        if (build_cache)
+            script_cache_record(&builder, line, &prepared);
+        free_prepared_command(&prepared);
+    }
+    line_reader_close(&reader);
+
+    if (build_cache)
+    {
+        script_cache_commit(&builder);
+        script_cache_builder_free(&builder);
+    }
+    return now_seconds() - start;
+}
+
+/**
+ * @brief Camino con caché: proyecta el archivo de caché y reconstruye las líneas.
+ */
+static double load_script(const char* path)
+{
+    double start = now_seconds();
+    script_cache cache;
+    if (script_cache_load(&cache, path) == -1)
+        return -1;
+    script_cache_close(&cache);
+    return now_seconds() - start;
+}
+
+int main(int argc, char* argv[])
+{
+    int num_lines = argc > 1 ? atoi(argv[1]) : DEFAULT_LINES;
+    int repetitions = argc > 2 ? atoi(argv[2]) : DEFAULT_REPETITIONS;
+    if (num_lines <= 0)
+        num_lines = DEFAULT_LINES;
+    if (repetitions <= 0)
+        repetitions = DEFAULT_REPETITIONS;
+
+    char dir[] = "/tmp/bench_script_cache.XXXXXX";
+    if (mkdtemp(dir) == NULL)
+    {
+        perror("bench_script_cache");
+        return EXIT_FAILURE;
+    }
+    setenv("XDG_CACHE_HOME", dir, 1);
+
+    char script[sizeof(dir) + 16];
+    snprintf(script, sizeof(script), "%s/script.sh", dir);
+    if (write_script(script, num_lines) == -1 || prepare_script(script, true) < 0 || load_script(script) < 0)
+    {
+        fprintf(stderr, "bench_script_cache: no se pudo construir la caché en %s\n", dir);
+        return EXIT_FAILURE;
+    }
+
+    double best_parse = 0, best_load = 0;
+    for (int i = 0; i < repetitions; i++)
+    {
+        double parse = prepare_script(script, false);
+        double load = load_script(script);
+        if (i == 0 || parse < best_parse)
+            best_parse = parse;
+        if (i == 0 || load < best_load)
+            best_load = load;
+    }
+
+    printf("Script de %d líneas (mejor de %d repeticiones)\n", num_lines, repetitions);
+    printf("%-22s %9.3f ms\n", "clasificar + analizar", best_parse * 1e3);
+    printf("%-22s %9.3f ms\n", "cargar caché", best_load * 1e3);
+    printf("Mejora: %.2fx\n", best_parse / best_load);
+
+    char command[sizeof(dir) + 16];
+    snprintf(command, sizeof(command), "rm -rf %s", dir);
+    return system(command) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file bench_spawn.c
+ * @brief Benchmark de comandos por segundo: fork + `/bin/sh -c` frente a posix_spawn directo.
+ *
+ * Ejecuta repetidamente un comando externo (o una tubería) con cada estrategia y reporta cuántos comandos por
+ * segundo completa cada una.
+ *
+ * Uso: `bench_spawn [iteraciones] [comando]` (por defecto 2000 iteraciones de `true`).
+ * Ejemplo con tubería: `bench_spawn 1000 "seq 10 | sort -r | head -n 1 | wc -l"`.
+ */
+
+#include "executor.h"
+#include "parser.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_ITERATIONS 2000
+
+/**
+ * @brief Devuelve el tiempo monotónico actual en segundos.
+ */
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Camino anterior: fork y luego `execl("/bin/sh", "sh", "-c", command)`.
+ */
+static void run_fork_sh(const char* command)
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        execl("/bin/sh", "sh", "-c", command, NULL);
+        _exit(EXIT_FAILURE);
+    }
+    waitpid(pid, NULL, 0);
+}
+
+/**
+ * @brief Camino nuevo: análisis de la línea y posix_spawn de cada etapa resuelta.
+ */
+static void run_spawn(const char* command)
+{
+    command_list list;
+    if (parse_command_line(command, &list) != PARSE_OK)
+        return;
+
+    for (int i = 0; i < list.num_pipelines; i++)
+    {
+        const pipeline* pl = &list.pipelines[i];
+        pid_t pids[pl->num_commands];
+        pid_t pgid;
+        int inline_status;
+        int launched = launch_pipeline(pl, NULL, pids, &pgid, &inline_status, -1);
+        for (int j = 0; j < launched; j++)
+            waitpid(pids[j], NULL, 0);
+    }
+    free_command_list(&list);
+}
+
+/**
+ * @brief Mide una estrategia y reporta comandos por segundo.
+ *
+ * @return Comandos por segundo alcanzados.
+ */
+static double measure(FILE* report, const char* label, void (*run)(const char*), const char* command,
+                      int iterations)
+{
+    double start = now_seconds();
+    for (int i = 0; i < iterations; i++)
+        run(command);
+    double elapsed = now_seconds() - start;
+
+    double rate = iterations / elapsed;
+    fprintf(report, "%-22s %8d comandos en %7.3f s -> %9.1f comandos/s\n", label, iterations, elapsed, rate);
+    return rate;
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    const char* command = argc > 2 ? argv[2] : "true";
+    if (iterations <= 0)
+        iterations = DEFAULT_ITERATIONS;
+
+    // La salida de los comandos medidos se descarta; el reporte va a una copia del stdout original
+    FILE* report = fdopen(dup(STDOUT_FILENO), "w");
+    int devnull = open("/dev/null", O_WRONLY);
+    if (report == NULL || devnull == -1)
+    {
+        perror("bench_spawn");
+        return EXIT_FAILURE;
+    }
+    dup2(devnull, STDOUT_FILENO);
+    close(devnull);
+
+    fprintf(report, "Comando: '%s'\n", command);
+    double before = measure(report, "fork + /bin/sh -c", run_fork_sh, command, iterations);
+    double after = measure(report, "posix_spawn directo", run_spawn, command, iterations);
+    fprintf(report, "Mejora: %.2fx\n", after / before);
+    fclose(report);
+    return EXIT_SUCCESS;
+}
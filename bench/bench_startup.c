@@ -0,0 +1,127 @@
+/**
+ * @file bench_startup.c
+ * @brief Benchmark del tiempo de arranque de la shell: ejecuta `shell /dev/null` muchas veces.
+ *
+ * Cada ejecución arranca la shell en modo batch con un script vacío, así que mide solo la inicialización y la
+ * salida. Como referencia mide también `/bin/sh -c clear`, lo que costaba el `system("clear")` que la shell hacía
+ * al iniciar.
+ *
+ * Uso: `bench_startup [ruta de la shell] [iteraciones]` (por defecto `./shell` y 1000 iteraciones).
+ */
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_SHELL "./shell"
+#define DEFAULT_ITERATIONS 1000
+
+extern char** environ;
+
+/**
+ * @brief Devuelve el tiempo monotónico actual en segundos.
+ */
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Compara dos tiempos para qsort().
+ */
+static int compare_doubles(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Ejecuta un programa con la salida descartada y espera a que termine.
+ *
+ * @return 0 si terminó con código 0, -1 si no se pudo lanzar o falló.
+ */
+static int run_once(char* const argv[], int null_fd)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, null_fd, STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, null_fd, STDERR_FILENO);
+
+    pid_t pid;
+    int error = posix_spawn(&pid, argv[0], &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (error != 0)
+        return -1;
+
+    int status;
+    if (waitpid(pid, &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return -1;
+    return 0;
+}
+
+/**
+ * @brief Mide `iterations` ejecuciones de un programa e informa la media, la mediana y el p99.
+ *
+ * @return 0 si todas las ejecuciones terminaron bien, -1 si alguna falló.
+ */
+static int measure(const char* label, char* const argv[], int iterations, int null_fd)
+{
+    double* times = malloc((size_t)iterations * sizeof(double));
+    if (times == NULL)
+        return -1;
+
+    double total = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        double start = now_seconds();
+        if (run_once(argv, null_fd) == -1)
+        {
+            fprintf(stderr, "%s: falló la ejecución %d\n", label, i + 1);
+            free(times);
+            return -1;
+        }
+        times[i] = now_seconds() - start;
+        total += times[i];
+    }
+    qsort(times, (size_t)iterations, sizeof(double), compare_doubles);
+
+    printf("%-28s %6d arranques en %7.3f s -> media %7.3f ms, mediana %7.3f ms, p99 %7.3f ms\n", label, iterations,
+           total, total / iterations * 1e3, times[iterations / 2] * 1e3, times[iterations * 99 / 100] * 1e3);
+    free(times);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    char* shell = argc > 1 ? argv[1] : DEFAULT_SHELL;
+    int iterations = argc > 2 ? atoi(argv[2]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0)
+    {
+        fprintf(stderr, "Uso: %s [ruta de la shell] [iteraciones]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    setenv("TERM", "xterm", 0); // `clear` falla sin una terminal conocida
+    int null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (null_fd == -1)
+    {
+        perror("/dev/null");
+        return EXIT_FAILURE;
+    }
+
+    char* shell_argv[] = {shell, "/dev/null", NULL};
+    char* clear_argv[] = {"/bin/sh", "-c", "clear", NULL};
+    int status = measure("shell /dev/null", shell_argv, iterations, null_fd);
+    measure("system(\"clear\") (referencia)", clear_argv, iterations, null_fd);
+
+    close(null_fd);
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
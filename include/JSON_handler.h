@@ -16,6 +16,7 @@ typedef struct
     int intervalo_muestreo; /**< Intervalo de muestreo en segundos */
     char** metricas;        /**< Lista de métricas a monitorear */
     int num_metricas;       /**< Número de métricas en la lista */
+    int timeout_ms;         /**< Tiempo máximo de cada consulta del wrapper en ms, o 0 si el JSON no lo define */
 } Config;
 
 /**
@@ -107,6 +108,14 @@ void config_help();
  */
 void print_config(const Config* config);
 
+/**
+ * @brief Indica si una línea es un comando de configuración (`config ...`) reconocido.
+ *
+ * @param command Línea a analizar, sin el salto de línea final.
+ * @return true si JSON_command() ejecutaría la línea.
+ */
+bool is_JSON_command(const char* command);
+
 /**
  * @brief Ejecuta un comando para modificar la configuración.
  *
@@ -0,0 +1,38 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "line_reader.h" ///< Lector de líneas del archivo batch.
+#include <stdbool.h>     ///< Header para el tipo bool.
+
+#define BATCH_BARRIER "wait" // Línea que separa grupos de comandos dependientes en modo paralelo
+
+/**
+ * @brief Ejecuta un archivo batch con hasta `max_jobs` líneas en paralelo.
+ *
+ * Cada línea es un comando independiente que se ejecuta en un proceso hijo con execute_command(), con stdin en
+ * /dev/null y su salida (stdout y stderr) almacenada en un archivo temporal. Las salidas se copian a `output_fd` en
+ * el orden del archivo, a medida que terminan las líneas anteriores. Una línea `wait` actúa como barrera: las líneas
+ * posteriores no empiezan hasta que terminan todas las anteriores. Las líneas vacías y los comentarios se omiten.
+ *
+ * @param script Lector abierto sobre el archivo batch.
+ * @param max_jobs Cantidad máxima de líneas en ejecución simultánea (mayor que cero).
+ * @param output_fd Descriptor donde se escribe la salida de las líneas.
+ * @return 0 si todas las líneas terminaron correctamente, o el código de salida de la primera línea que falló.
+ */
+int batch_run_parallel(line_reader* script, int max_jobs, int output_fd);
+
+/**
+ * @brief Ejecuta un archivo batch línea por línea en la propia shell, usando la caché del script si está al día.
+ *
+ * Con la caché (ver script_cache.h), las líneas se ejecutan sin volver a separarlas en palabras ni a compararlas con
+ * los comandos internos. Sin ella, cada línea se prepara, se agrega a la caché y se ejecuta; la caché se guarda al
+ * terminar, o antes de ejecutar un `quit`, que termina el proceso. Las líneas con variables o errores de sintaxis se
+ * vuelven a analizar en cada ejecución.
+ *
+ * @param script Lector abierto sobre el archivo batch; se cierra antes de volver.
+ * @param path Ruta del archivo, que identifica su caché.
+ * @param use_cache false para no leer ni escribir la caché.
+ */
+void batch_run_file(line_reader* script, const char* path, bool use_cache);
+
+#endif // BATCH_H
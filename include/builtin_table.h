@@ -0,0 +1,36 @@
+/* Archivo generado por scripts/gen_builtin_table.py: no editar a mano. */
+#ifndef BUILTIN_TABLE_H
+#define BUILTIN_TABLE_H
+
+#include "JSON_handler.h"      ///< is_JSON_command(), validador de `config`.
+#include "builtins.h"          ///< Tipo builtin.
+#include "command_processor.h" ///< is_monitor_command(), validador de los comandos del monitor.
+
+#define BUILTIN_HASH_SEED 0x00000003u // Semilla sin colisiones para las palabras de la tabla
+#define BUILTIN_HASH_BITS 6           // La tabla tiene 2^BUILTIN_HASH_BITS posiciones
+#define BUILTIN_TABLE_SIZE (1u << BUILTIN_HASH_BITS)
+
+/**
+ * @brief Comandos internos, cada uno en la posición que le asigna builtin_hash().
+ */
+static const builtin builtin_table[BUILTIN_TABLE_SIZE] = {
+    [1] = {"wait", 4, CMD_WAIT, NULL},
+    [4] = {"metrics", 7, CMD_MONITOR, is_monitor_command},
+    [8] = {"quit", 4, CMD_QUIT, NULL},
+    [9] = {"status_monitor", 14, CMD_MONITOR, is_monitor_command},
+    [11] = {"hash", 4, CMD_HASH, NULL},
+    [14] = {"fg", 2, CMD_FG, NULL},
+    [16] = {"config", 6, CMD_CONFIG, is_JSON_command},
+    [17] = {"start_monitor", 13, CMD_MONITOR, is_monitor_command},
+    [18] = {"bg", 2, CMD_BG, NULL},
+    [27] = {"cd", 2, CMD_CD, NULL},
+    [28] = {"bench", 5, CMD_BENCH, NULL},
+    [31] = {"stats", 5, CMD_STATS, NULL},
+    [36] = {"jobs", 4, CMD_JOBS, NULL},
+    [38] = {"clr", 3, CMD_CLR, NULL},
+    [41] = {"stop_monitor", 12, CMD_MONITOR, is_monitor_command},
+    [43] = {"scan", 4, CMD_SCAN, NULL},
+    [58] = {"expose", 6, CMD_MONITOR, is_monitor_command},
+    [61] = {"echo", 4, CMD_ECHO, NULL}};
+
+#endif // BUILTIN_TABLE_H
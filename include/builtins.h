@@ -0,0 +1,59 @@
+#ifndef BUILTINS_H
+#define BUILTINS_H
+
+#include "command_processor.h" ///< Tipo command_type.
+#include <stdbool.h>           ///< Header para el tipo bool.
+#include <stddef.h>            ///< Header para el tipo size_t.
+#include <stdint.h>            ///< Header para el tipo uint64_t.
+
+/**
+ * @brief Valida los argumentos de un comando interno a partir de la línea completa.
+ *
+ * @return true si la línea es una invocación válida del comando; si no, la línea se trata como comando externo.
+ */
+typedef bool (*builtin_args_parser)(const char* line);
+
+/**
+ * @struct builtin
+ * @brief Comando interno del registro, identificado por la primera palabra de la línea.
+ */
+typedef struct
+{
+    const char* name;               /**< Primera palabra de la línea. */
+    unsigned char length;           /**< Longitud de `name`. */
+    command_type type;              /**< Tipo que se asigna a la línea. */
+    builtin_args_parser parse_args; /**< Validador de la línea, o NULL si se acepta cualquier argumento. */
+} builtin;
+
+/**
+ * @brief Busca un comando interno por su nombre en la tabla de hash perfecto.
+ *
+ * @param name Nombre a buscar (no necesita terminar en '\0').
+ * @param length Longitud del nombre.
+ * @return El comando interno, o NULL si no existe.
+ */
+const builtin* find_builtin(const char* name, size_t length);
+
+/**
+ * @brief Clasifica una línea según su primera palabra.
+ *
+ * La primera palabra termina en los mismos caracteres que en el parser (ver parser_is_word_end()). Una línea que no
+ * empieza con un comando interno cuesta un hash de su primera palabra y, como mucho, una comparación; no se reserva
+ * memoria.
+ *
+ * @param line Línea sin el salto de línea final.
+ * @return Tipo del comando interno, o CMD_EXTERNAL.
+ */
+command_type lookup_builtin(const char* line);
+
+/**
+ * @brief Resume la tabla de comandos internos y la numeración de command_type en un hash.
+ *
+ * Cambia si se agrega, quita o mueve un comando interno, si cambia su tipo, si gana o pierde un validador o si
+ * cambia CMD_LAST. La caché de scripts lo guarda para descartar los análisis hechos con otra tabla.
+ *
+ * @return Hash FNV-1a de 64 bits de la tabla.
+ */
+uint64_t builtin_table_identity(void);
+
+#endif // BUILTINS_H
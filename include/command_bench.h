@@ -0,0 +1,73 @@
+#ifndef COMMAND_BENCH_H
+#define COMMAND_BENCH_H
+
+#include <stdbool.h>      ///< Header para el tipo bool.
+#include <stddef.h>       ///< Header para el tipo size_t.
+#include <stdio.h>        ///< Header para el tipo FILE.
+#include <sys/resource.h> ///< Header para la estructura rusage.
+
+#define BENCH_DEFAULT_RUNS 10  // Ejecuciones medidas si no se indica -n
+#define BENCH_DEFAULT_WARMUP 1 // Ejecuciones de calentamiento si no se indica -w
+
+/**
+ * @struct bench_options
+ * @brief Opciones del comando interno `bench`.
+ */
+typedef struct
+{
+    int runs;            /**< Ejecuciones medidas (-n). */
+    int warmup;          /**< Ejecuciones previas que no se miden (-w). */
+    bool json;           /**< Informar en JSON (--json). */
+    bool show_output;    /**< Dejar ver la salida del comando; por defecto va a /dev/null (--show-output). */
+    const char* command; /**< Comando a medir: el resto de la línea después de las opciones o de `--`. */
+} bench_options;
+
+/**
+ * @brief Ejecuta una vez el comando medido y espera a que termine.
+ *
+ * @param command Comando a ejecutar.
+ * @param data Puntero entregado a bench_command().
+ * @param usage Donde se guardan los recursos que consumieron los procesos del comando.
+ * @return Código de salida del comando.
+ */
+typedef int (*bench_run_function)(const char* command, void* data, struct rusage* usage);
+
+/**
+ * @brief Interpreta los argumentos de `bench [-n ejecuciones] [-w calentamiento] [--json] [--show-output] -- cmd`.
+ *
+ * El comando empieza después de `--` o en la primera palabra que no es una opción, y se toma tal cual, con sus
+ * tuberías y redirecciones. Las opciones se separan en palabras con el parser, así que sus variables se expanden
+ * (`-n $RUNS`). Los errores se informan en stderr.
+ *
+ * @param args Argumentos (la línea sin la palabra `bench`), o NULL.
+ * @param options Opciones a completar; `command` apunta dentro de `args`.
+ * @return 0 si los argumentos son válidos, -1 si no.
+ */
+int bench_parse_options(const char* args, bench_options* options);
+
+/**
+ * @brief Percentil por rango más cercano de un arreglo ordenado.
+ *
+ * @param sorted Valores ordenados de menor a mayor.
+ * @param count Cantidad de valores (mayor que cero).
+ * @param percentile Percentil entre 0 y 100.
+ * @return El menor valor que deja por debajo o igual al `percentile` % de las muestras.
+ */
+double bench_percentile(const double* sorted, size_t count, double percentile);
+
+/**
+ * @brief Mide un comando: lo ejecuta `warmup` veces sin medir y `runs` veces midiendo, e informa las estadísticas.
+ *
+ * De cada ejecución se toma el tiempo real con el reloj monotónico y, de wait4(), los tiempos de usuario y sistema,
+ * el RSS máximo y los cambios de contexto. El informe muestra mínimo, mediana, p95, p99, máximo, media y desvío del
+ * tiempo real, y la media de los recursos. Si el comando termina por SIGINT o se detiene, la medición se interrumpe.
+ *
+ * @param options Opciones de la medición.
+ * @param run Función que ejecuta el comando una vez.
+ * @param data Puntero que se entrega a `run`.
+ * @param out Flujo donde se escribe el informe.
+ * @return 0 si todas las ejecuciones terminaron con 0; si no, el código de la última que falló.
+ */
+int bench_command(const bench_options* options, bench_run_function run, void* data, FILE* out);
+
+#endif // COMMAND_BENCH_H
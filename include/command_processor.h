@@ -1,6 +1,7 @@
 #ifndef COMMANDS_H
 #define COMMANDS_H
 
+#include "parser.h"    ///< Árbol sintáctico de las líneas de comandos.
 #include <signal.h>    ///< Header para el manejo de señales.
 #include <stdio.h>     ///< Header para operaciones de entrada/salida estándar.
 #include <stdlib.h>    ///< Header para funciones de memoria dinámica, control de procesos y conversión.
@@ -11,6 +12,65 @@
 
 #define COMMAND_BUFFER_SIZE 1024 // Tamaño del buffer para leer comandos
 #define FILE_PERMISSIONS 0666
+#define COMMAND_NOT_FOUND_STATUS 127 // Código de salida cuando no se pudo lanzar el comando
+#define SYNTAX_ERROR_STATUS 2        // Código de salida ante un error de sintaxis
+
+/**
+ * @enum command_type
+ * @brief Enumeración de los tipos de comandos principales soportados.
+ *
+ * Define los tipos de comandos reconocidos por la función `execute_command`.
+ * Los valores se guardan en la caché de scripts: los nuevos tipos se agregan al final y actualizan CMD_LAST.
+ */
+typedef enum
+{
+    CMD_QUIT,     /**< Comando para salir del programa. */
+    CMD_CD,       /**< Comando para cambiar el directorio actual. */
+    CMD_CLR,      /**< Comando para limpiar la pantalla. */
+    CMD_ECHO,     /**< Comando para imprimir texto o valores. */
+    CMD_EXTERNAL, /**< Comando externo no reconocido internamente. */
+    CMD_SCAN,     /**< Comando para buscar configuraciones recursivamente. */
+    CMD_HASH,     /**< Comando para consultar o modificar la tabla de rutas. */
+    CMD_JOBS,     /**< Comando para listar los trabajos activos. */
+    CMD_FG,       /**< Comando para traer un trabajo al primer plano. */
+    CMD_BG,       /**< Comando para continuar un trabajo detenido en segundo plano. */
+    CMD_WAIT,     /**< Comando para esperar a los trabajos en segundo plano. */
+    CMD_CONFIG,   /**< Comando de configuración (`config ...`), ver JSON_handler.h. */
+    CMD_MONITOR,  /**< Comando del monitor de métricas (`start_monitor`, `expose metrics`, etc.). */
+    CMD_BENCH,    /**< Comando para medir el tiempo y los recursos de otro comando. */
+    CMD_STATS     /**< Comando para consultar las estadísticas internas de la shell. */
+} command_type;
+
+#define CMD_LAST CMD_STATS // Último tipo de comando, para validar los valores leídos de la caché
+
+/**
+ * @struct prepared_command
+ * @brief Línea ya clasificada y, si es un comando externo, ya analizada.
+ */
+typedef struct
+{
+    command_type type;   /**< Tipo de comando resuelto. */
+    parse_status status; /**< Resultado del análisis (solo si is_pipeline_command() lo indica para el tipo). */
+    command_list list;   /**< Tuberías a lanzar (ídem, con PARSE_OK). */
+} prepared_command;
+
+/**
+ * @brief Indica si las líneas de un tipo se analizan como tuberías.
+ *
+ * Además de los comandos externos, `echo`, `jobs`, `hash` y `stats` pueden formar parte de tuberías y
+ * redirecciones.
+ *
+ * @param type Tipo de comando.
+ * @return true si prepare_command() analiza las líneas de ese tipo.
+ */
+bool is_pipeline_command(command_type type);
+
+/**
+ * @brief Configura la atención de las señales de la shell.
+ *
+ * Debe llamarse una vez al iniciar, después de inicializar el bucle de eventos si se usa.
+ */
+void setup_signal_handlers(void);
 
 /**
  * @brief Ejecuta un comando dado.
@@ -21,6 +81,44 @@
  */
 void execute_command(char* command);
 
+/**
+ * @brief Clasifica una línea y, si es un comando externo, la analiza.
+ *
+ * Elimina el salto de línea final de `command`. Los errores de sintaxis se informan en este paso.
+ *
+ * @param command Línea a preparar.
+ * @param prepared Donde se guarda el resultado; debe liberarse con free_prepared_command().
+ */
+void prepare_command(char* command, prepared_command* prepared);
+
+/**
+ * @brief Ejecuta una línea ya preparada, sin volver a clasificarla ni analizarla.
+ *
+ * Los comandos internos que no forman tuberías separan `command` en palabras con el parser al ejecutarse, así que
+ * sus variables se expanden como en cualquier otro comando; `bench` recibe el resto de la línea y puede modificarla.
+ *
+ * @param command Texto de la línea, sin el salto de línea final.
+ * @param prepared Resultado de prepare_command() o de la caché de scripts; no se modifica.
+ */
+void execute_prepared_command(char* command, const prepared_command* prepared);
+
+/**
+ * @brief Libera el análisis guardado en un comando preparado.
+ *
+ * @param prepared Comando preparado con prepare_command().
+ */
+void free_prepared_command(prepared_command* prepared);
+
+/**
+ * @brief Devuelve el código de salida del último comando ejecutado con execute_command().
+ *
+ * Para las tuberías en primer plano es el de su última etapa (128 + señal si terminó por una señal); los trabajos
+ * lanzados en segundo plano cuentan como exitosos.
+ *
+ * @return Código de salida, 0 si el comando terminó correctamente.
+ */
+int get_last_exit_status(void);
+
 /**
  * @brief Ejecuta un comando externo al proceso principal.
  *
@@ -30,4 +128,12 @@ void execute_command(char* command);
  */
 void external_command(char* command);
 
+/**
+ * @brief Indica si la línea completa es un comando del monitor de métricas (`start_monitor`, `expose metrics`, etc.).
+ *
+ * @param command Línea sin el salto de línea final.
+ * @return true si la línea es un comando del monitor.
+ */
+bool is_monitor_command(const char* command);
+
 #endif // COMMANDS_H
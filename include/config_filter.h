@@ -0,0 +1,31 @@
+#ifndef CONFIG_FILTER_H
+#define CONFIG_FILTER_H
+
+#include "config_scan.h" ///< Tipo scan_result con los archivos a filtrar.
+
+/**
+ * @brief Criterio con el que filter_config_files() decide qué archivos conservar.
+ */
+typedef enum
+{
+    FILTER_GREP,    /**< Archivos cuyo contenido incluye el texto buscado. */
+    FILTER_INVALID  /**< Archivos ".json" que cJSON no puede analizar. */
+} filter_kind;
+
+/**
+ * @brief Filtra en el lugar los archivos de un resultado de `scan` según su contenido.
+ *
+ * Cada archivo se proyecta en memoria con mmap() y se examina sin copiarlo: con FILTER_GREP se busca `pattern` como
+ * texto literal con memmem(), y con FILTER_INVALID se analiza con cJSON (los ".config" se descartan). Los archivos
+ * se reparten entre varios hilos que toman el siguiente pendiente de un contador compartido. El orden de las rutas
+ * que quedan se mantiene.
+ *
+ * @param result Resultado a filtrar; las rutas descartadas se liberan.
+ * @param kind Criterio del filtro.
+ * @param pattern Texto a buscar con FILTER_GREP (no vacío); se ignora con FILTER_INVALID.
+ * @param num_threads Cantidad de hilos, o 0 para usar uno por núcleo (hasta SCAN_MAX_THREADS).
+ * @return 0 si se filtró, -1 si no hubo memoria (en ese caso `result` queda sin cambios).
+ */
+int filter_config_files(scan_result* result, filter_kind kind, const char* pattern, int num_threads);
+
+#endif // CONFIG_FILTER_H
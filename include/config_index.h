@@ -0,0 +1,54 @@
+#ifndef CONFIG_INDEX_H
+#define CONFIG_INDEX_H
+
+#include "config_scan.h" ///< Tipo scan_result con el que se devuelven los archivos.
+
+/**
+ * @brief Registra un directorio como raíz indexada y construye su índice.
+ *
+ * Las raíces registradas se guardan en el directorio de caché de la shell (ver cache_directory()), junto con un
+ * archivo de índice por raíz con los directorios del árbol, su fecha de modificación y sus archivos ".config" y
+ * ".json".
+ *
+ * @param root Directorio a indexar.
+ * @return 0 si el índice se construyó y guardó, -1 en caso de error.
+ */
+int config_index_register(const char* root);
+
+/**
+ * @brief Quita una raíz del registro y borra su índice.
+ *
+ * @param path Raíz registrada o un directorio dentro de ella.
+ * @return 0 si se quitó, -1 si la ruta no está dentro de ninguna raíz registrada.
+ */
+int config_index_unregister(const char* path);
+
+/**
+ * @brief Vuelve a recorrer por completo la raíz registrada que contiene `path` y reemplaza su índice.
+ *
+ * @param path Raíz registrada o un directorio dentro de ella.
+ * @return 0 si el índice se reconstruyó, -1 si la ruta no está indexada o hubo un error.
+ */
+int config_index_rebuild(const char* path);
+
+/**
+ * @brief Responde `scan` desde el índice si `path` está dentro de una raíz registrada.
+ *
+ * Antes de responder se actualizan los directorios que cambiaron: los que marcó el vigilante de inotify o, si el
+ * vigilante no está activo (índice recién cargado, límite de vigilancias agotado o eventos perdidos), los que
+ * tienen una fecha de modificación distinta de la guardada. Solo esos directorios se vuelven a leer, y solo sus
+ * subdirectorios nuevos se recorren.
+ *
+ * @param path Directorio desde el que se busca (absoluto).
+ * @param result Archivos encontrados bajo `path`, ordenados; debe liberarse con scan_result_free() si la función
+ *        devolvió 0.
+ * @return 0 si se respondió desde el índice, -1 si `path` no está indexado o el índice no pudo usarse.
+ */
+int config_index_scan(const char* path, scan_result* result);
+
+/**
+ * @brief Muestra el tamaño y la antigüedad del índice de cada raíz registrada.
+ */
+void config_index_print_stats(void);
+
+#endif // CONFIG_INDEX_H
@@ -0,0 +1,87 @@
+#ifndef CONFIG_SCAN_H
+#define CONFIG_SCAN_H
+
+#include <stdbool.h>  ///< Header para el tipo bool.
+#include <stddef.h>   ///< Header para el tipo size_t.
+#include <sys/stat.h> ///< Header para la estructura stat.
+
+#define SCAN_MAX_THREADS 16 // Cantidad máxima de hilos que recorren el árbol
+
+/**
+ * @struct scan_result
+ * @brief Archivos de configuración encontrados por scan_config_files().
+ */
+typedef struct
+{
+    char** paths; /**< Rutas de los archivos, ordenadas alfabéticamente. */
+    size_t count; /**< Cantidad de rutas. */
+} scan_result;
+
+/**
+ * @brief Función que recibe cada directorio leído por scan_tree().
+ *
+ * Se invoca desde los hilos del recorrido, posiblemente varios a la vez.
+ *
+ * @param rel_path Ruta del directorio relativa a la raíz ("." para la raíz).
+ * @param st Estado del directorio.
+ * @param data Puntero entregado a scan_tree().
+ */
+typedef void (*scan_dir_callback)(const char* rel_path, const struct stat* st, void* data);
+
+/**
+ * @brief Busca archivos ".config" y ".json" en un árbol de directorios sin cambiar el directorio de trabajo.
+ *
+ * El árbol se recorre en paralelo: cada hilo abre los directorios con openat() relativo a la raíz y usa el tipo que
+ * devuelve readdir() para no consultar el estado de cada entrada; solo los enlaces simbólicos y los tipos
+ * desconocidos se resuelven con fstatat(). Los directorios pendientes se reparten entre colas por hilo, y un hilo sin
+ * trabajo roba directorios de las colas de los demás. Cada directorio se visita una sola vez según su par
+ * (dispositivo, inodo), por lo que los enlaces simbólicos que forman ciclos no se recorren dos veces.
+ *
+ * @param root Directorio raíz del recorrido.
+ * @param num_threads Cantidad de hilos, o 0 para usar uno por núcleo (hasta SCAN_MAX_THREADS).
+ * @param result Estructura a completar; debe liberarse con scan_result_free() si la función tuvo éxito.
+ * @return 0 si el recorrido terminó, -1 si no se pudo abrir la raíz o no hubo memoria.
+ */
+int scan_config_files(const char* root, int num_threads, scan_result* result);
+
+/**
+ * @brief Igual que scan_config_files(), pero además informa cada directorio leído.
+ *
+ * @param root Directorio raíz del recorrido.
+ * @param num_threads Cantidad de hilos, o 0 para usar uno por núcleo.
+ * @param on_directory Función a invocar por cada directorio, o NULL.
+ * @param data Puntero que se entrega a `on_directory`.
+ * @param result Estructura a completar; debe liberarse con scan_result_free() si la función tuvo éxito.
+ * @return 0 si el recorrido terminó, -1 si no se pudo abrir la raíz o no hubo memoria.
+ */
+int scan_tree(const char* root, int num_threads, scan_dir_callback on_directory, void* data, scan_result* result);
+
+/**
+ * @brief Verifica si un nombre de archivo tiene extensión ".config" o ".json", los archivos que busca `scan`.
+ *
+ * @param name Nombre del archivo (sin directorio).
+ * @return true si es un archivo de configuración.
+ */
+bool is_config_file_name(const char* name);
+
+/**
+ * @brief Escribe el encabezado y el contenido de un archivo de configuración encontrado por `scan`.
+ *
+ * El encabezado (en color) se escribe con una sola llamada a write(). El contenido se copia dentro del kernel con
+ * sendfile() hacia archivos y tuberías; si la salida es una terminal, o sendfile() no la admite, se copia con
+ * read/write en bloques de 256 KiB. No usa stdio: quien llama debe vaciar stdout antes si escribió en él.
+ *
+ * @param path Ruta del archivo.
+ * @param output_fd Descriptor de salida.
+ * @return 0 si se escribió todo, -1 en caso de error (si no pudo abrirse el archivo, se informa en stderr).
+ */
+int write_config_file(const char* path, int output_fd);
+
+/**
+ * @brief Libera las rutas de un resultado.
+ *
+ * @param result Resultado a liberar.
+ */
+void scan_result_free(scan_result* result);
+
+#endif // CONFIG_SCAN_H
@@ -0,0 +1,83 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdbool.h> ///< Header para el tipo bool.
+
+/**
+ * @brief Función que se invoca cuando un descriptor registrado tiene datos para leer.
+ *
+ * @param fd Descriptor listo para lectura.
+ * @param data Puntero entregado al registrar el descriptor.
+ */
+typedef void (*event_callback)(int fd, void* data);
+
+/**
+ * @brief Función que se invoca, fuera de contexto de señal, cuando llega una señal registrada.
+ *
+ * @param sig Número de la señal recibida.
+ */
+typedef void (*signal_callback)(int sig);
+
+/**
+ * @brief Inicializa el bucle de eventos de la shell.
+ *
+ * Crea la instancia de epoll y el signalfd por el que se reciben las señales registradas con
+ * event_loop_handle_signal(). A partir de este punto esas señales quedan bloqueadas y se atienden de forma síncrona
+ * dentro de event_loop_dispatch().
+ *
+ * @return 0 si el bucle se inicializó, -1 en caso de error.
+ */
+int event_loop_init(void);
+
+/**
+ * @brief Indica si el bucle de eventos está inicializado.
+ *
+ * @return true si se llamó con éxito a event_loop_init().
+ */
+bool event_loop_active(void);
+
+/**
+ * @brief Atiende una señal a través del bucle en lugar de con un manejador asíncrono.
+ *
+ * @param sig Señal a atender.
+ * @param callback Función a invocar cada vez que llega la señal.
+ * @return 0 si la señal quedó registrada, -1 en caso de error.
+ */
+int event_loop_handle_signal(int sig, signal_callback callback);
+
+/**
+ * @brief Registra un descriptor para que el bucle invoque una función cuando tenga datos para leer.
+ *
+ * @param fd Descriptor a vigilar.
+ * @param callback Función a invocar.
+ * @param data Puntero que se entrega a la función.
+ * @return 0 si el descriptor quedó registrado, -1 en caso de error.
+ */
+int event_loop_add_fd(int fd, event_callback callback, void* data);
+
+/**
+ * @brief Deja de vigilar un descriptor.
+ *
+ * @param fd Descriptor registrado con event_loop_add_fd().
+ */
+void event_loop_remove_fd(int fd);
+
+/**
+ * @brief Espera eventos y los atiende: señales primero y luego descriptores listos.
+ *
+ * @param timeout_ms Tiempo máximo de espera en milisegundos, o -1 para esperar indefinidamente.
+ * @return Cantidad de eventos atendidos, o -1 en caso de error.
+ */
+int event_loop_dispatch(int timeout_ms);
+
+/**
+ * @brief Atiende eventos hasta que un descriptor tenga datos para leer.
+ *
+ * Se usa para esperar la entrada del usuario sin dejar de atender señales ni otros descriptores. Los descriptores
+ * que epoll no admite (por ejemplo, archivos regulares) se consideran siempre listos.
+ *
+ * @param fd Descriptor a esperar.
+ */
+void event_loop_wait_readable(int fd);
+
+#endif // EVENT_LOOP_H
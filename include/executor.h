@@ -0,0 +1,117 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include "parser.h"    ///< Header para el árbol sintáctico de los comandos.
+#include <stddef.h>    ///< Header para el tipo size_t.
+#include <sys/types.h> ///< Header para el tipo pid_t.
+
+#define PATH_BUFFER_SIZE 4096 // Tamaño del buffer para rutas resueltas
+
+/**
+ * @brief Resuelve la ruta absoluta de un ejecutable.
+ *
+ * Si el nombre contiene '/', se usa tal cual. En caso contrario se recorre cada directorio de $PATH hasta encontrar
+ * un archivo ejecutable.
+ *
+ * @param name Nombre del comando.
+ * @param buffer Buffer donde se escribe la ruta resuelta.
+ * @param size Tamaño del buffer.
+ * @return Puntero a buffer con la ruta, o NULL si no se encontró el ejecutable.
+ */
+char* resolve_command_path(const char* name, char* buffer, size_t size);
+
+/**
+ * @brief Crea una tubería cuyos extremos se cierran automáticamente al ejecutar otro programa.
+ *
+ * Los hijos solo conservan la copia del extremo que se les asigna como stdin/stdout.
+ *
+ * @param pipefd Arreglo donde se guardan los extremos de lectura y escritura.
+ * @return 0 si la tubería se creó correctamente, -1 en caso de error.
+ */
+int cloexec_pipe(int pipefd[2]);
+
+/**
+ * @brief Lanza un programa directamente con posix_spawn, sin pasar por /bin/sh.
+ *
+ * La ruta del ejecutable se obtiene de la tabla de rutas (ver path_cache.h), por lo que $PATH solo se recorre la
+ * primera vez que se usa cada comando.
+ *
+ * @param argv Vector de argumentos terminado en NULL; argv[0] es el nombre del comando.
+ * @param input_fd Descriptor a usar como stdin del hijo, o -1 para heredar el actual.
+ * @param output_fd Descriptor a usar como stdout del hijo, o -1 para heredar el actual.
+ * @param error_fd Descriptor a usar como stderr del hijo, o -1 para heredar el actual.
+ * @param pgid Grupo de procesos al que se une el hijo: 0 para crear uno nuevo, -1 para heredar el de la shell.
+ * @return PID del proceso creado, o -1 si ocurre un error.
+ */
+pid_t spawn_command(char* const argv[], int input_fd, int output_fd, int error_fd, pid_t pgid);
+
+/**
+ * @brief Lanza un comando a través de `/bin/sh -c`.
+ *
+ * Es el camino de respaldo para las construcciones que no interpreta la shell.
+ *
+ * @param command Comando a ejecutar.
+ * @param input_fd Descriptor a usar como stdin del hijo, o -1 para heredar el actual.
+ * @param output_fd Descriptor a usar como stdout del hijo, o -1 para heredar el actual.
+ * @param pgid Grupo de procesos al que se une el hijo: 0 para crear uno nuevo, -1 para heredar el de la shell.
+ * @return PID del proceso creado, o -1 si ocurre un error.
+ */
+pid_t spawn_shell(const char* command, int input_fd, int output_fd, pid_t pgid);
+
+/**
+ * @brief Comando interno que puede ejecutarse como etapa de una tubería.
+ *
+ * @param argv Vector de argumentos terminado en NULL; argv[0] es el nombre del comando.
+ * @param output_fd Descriptor donde el comando escribe su salida.
+ * @return Código de salida del comando.
+ */
+typedef int (*builtin_function)(char* const argv[], int output_fd);
+
+/**
+ * @brief Busca el comando interno que atiende a un nombre.
+ *
+ * @return La función del comando interno, o NULL si el nombre corresponde a un programa externo.
+ */
+typedef builtin_function (*builtin_lookup)(const char* name);
+
+/**
+ * @brief Ejecuta un comando interno en un proceso hijo, como si fuera un programa más de la tubería.
+ *
+ * @param function Comando interno a ejecutar.
+ * @param argv Vector de argumentos terminado en NULL.
+ * @param input_fd Descriptor a usar como stdin del hijo, o -1 para heredar el actual.
+ * @param output_fd Descriptor a usar como stdout del hijo, o -1 para heredar el actual.
+ * @param error_fd Descriptor a usar como stderr del hijo, o -1 para heredar el actual.
+ * @param pgid Grupo de procesos al que se une el hijo: 0 para crear uno nuevo, -1 para heredar el de la shell.
+ * @return PID del proceso creado, o -1 si ocurre un error.
+ */
+pid_t spawn_builtin(builtin_function function, char* const argv[], int input_fd, int output_fd, int error_fd,
+                    pid_t pgid);
+
+/**
+ * @brief Lanza todas las etapas de una tubería conectadas entre sí.
+ *
+ * Crea una tubería entre cada par de etapas consecutivas, abre las redirecciones de cada comando y lanza cada etapa
+ * directamente, sin shells intermedias. Las redirecciones explícitas tienen prioridad sobre las tuberías. Una etapa
+ * cuya redirección no puede abrirse no se lanza, pero el resto de la tubería sí. Todas las etapas comparten un
+ * grupo de procesos propio, para que la shell pueda detenerlas, continuarlas o cederles la terminal juntas.
+ *
+ * En una tubería en primer plano, un comando interno en la primera o en la última etapa se ejecuta dentro de la
+ * shell, escribiendo directamente en el descriptor de su etapa: la primera etapa escribe después de lanzar las
+ * demás, para que alguien lea la tubería. Los comandos internos en etapas intermedias o en tuberías en segundo plano
+ * deben correr a la vez que el resto y se ejecutan en un proceso hijo.
+ *
+ * @param pl Tubería a lanzar.
+ * @param lookup Función que identifica los comandos internos, o NULL si todas las etapas son programas externos.
+ * @param pids Arreglo con capacidad para pl->num_commands PIDs, donde se guardan los procesos creados.
+ * @param pgid Donde se guarda el grupo de procesos de la tubería (el PID de su primera etapa).
+ * @param inline_status Donde se guarda el código de salida de la última etapa si se ejecutó dentro de la shell, o
+ * -1 si no.
+ * @param terminal_fd Terminal que se cede al grupo de la tubería apenas se lanza su primera etapa, antes que las
+ * demás, o -1 para no cederla. Quien espera el trabajo debe recuperarla.
+ * @return Cantidad de procesos creados.
+ */
+int launch_pipeline(const pipeline* pl, builtin_lookup lookup, pid_t* pids, pid_t* pgid, int* inline_status,
+                    int terminal_fd);
+
+#endif // EXECUTOR_H
@@ -0,0 +1,104 @@
+#ifndef EXPOSITION_PARSER_H
+#define EXPOSITION_PARSER_H
+
+#include <stdbool.h> ///< Header para el tipo bool.
+#include <stddef.h>  ///< Header para el tipo size_t.
+#include <stdint.h>  ///< Header para el tipo int64_t.
+
+/**
+ * @struct exposition_sample
+ * @brief Muestra de una línea del formato de exposición de Prometheus.
+ *
+ * Los textos apuntan a la línea analizada (no están terminados en '\0') y solo valen durante la llamada que la
+ * entrega.
+ */
+typedef struct
+{
+    const char* name;     /**< Nombre de la métrica. */
+    size_t name_length;   /**< Longitud del nombre. */
+    const char* labels;   /**< Etiquetas sin llaves (`clave="valor",...`), o NULL si la línea no tiene. */
+    size_t labels_length; /**< Longitud de las etiquetas. */
+    double value;         /**< Valor de la muestra. */
+    int64_t timestamp_ms; /**< Marca de tiempo de la línea, o 0 si no tiene. */
+} exposition_sample;
+
+/**
+ * @brief Función que recibe cada muestra analizada.
+ */
+typedef void (*exposition_callback)(const exposition_sample* sample, void* data);
+
+/**
+ * @brief Función que decide, con solo el nombre de la métrica, si vale la pena analizar el resto de la línea.
+ */
+typedef bool (*exposition_filter)(const char* name, size_t name_length, void* data);
+
+/**
+ * @struct exposition_parser
+ * @brief Analizador incremental: recibe los bytes en trozos de cualquier tamaño y entrega cada muestra al completarse
+ * su línea.
+ *
+ * Las líneas completas de un trozo se analizan en el lugar; solo el final de una línea cortada entre dos trozos se
+ * copia a `pending`, que crece según la línea más larga y conserva su capacidad. La memoria no depende del tamaño de
+ * la exposición.
+ */
+typedef struct
+{
+    exposition_filter filter;     /**< Filtro por nombre, o NULL para entregar todas las muestras. */
+    exposition_callback callback; /**< Destino de las muestras. */
+    void* data;                   /**< Dato que se pasa a `filter` y a `callback`. */
+    char* pending;                /**< Comienzo de una línea que todavía no terminó de llegar. */
+    size_t pending_size;          /**< Bytes guardados en `pending`. */
+    size_t pending_capacity;      /**< Capacidad de `pending`. */
+    size_t samples;               /**< Muestras entregadas desde exposition_parser_reset(). */
+    size_t filtered;              /**< Muestras que descartó el filtro desde exposition_parser_reset(). */
+} exposition_parser;
+
+/**
+ * @brief Analiza una línea del formato de exposición.
+ *
+ * Acepta `nombre[{etiquetas}] valor [marca de tiempo]`; los comentarios (`#`) y las líneas vacías no tienen muestra.
+ *
+ * @param line Línea, sin el salto de línea final (no necesariamente terminada en '\0').
+ * @param length Longitud de la línea.
+ * @param sample Donde se guarda la muestra.
+ * @return 1 si la línea tenía una muestra, 0 si era un comentario, estaba vacía o mal formada.
+ */
+int exposition_parse_line(const char* line, size_t length, exposition_sample* sample);
+
+/**
+ * @brief Inicializa un analizador.
+ *
+ * @param parser Analizador a inicializar.
+ * @param filter Filtro por nombre, o NULL. Las líneas que rechaza no se terminan de analizar.
+ * @param callback Función que recibe cada muestra.
+ * @param data Dato que se pasa a `filter` y a `callback`.
+ */
+void exposition_parser_init(exposition_parser* parser, exposition_filter filter, exposition_callback callback,
+                            void* data);
+
+/**
+ * @brief Descarta la línea pendiente y los contadores, conservando la memoria, para empezar otra exposición.
+ */
+void exposition_parser_reset(exposition_parser* parser);
+
+/**
+ * @brief Analiza un trozo de la exposición y entrega las muestras de las líneas que se completaron.
+ *
+ * @param parser Analizador inicializado.
+ * @param bytes Trozo recibido.
+ * @param length Longitud del trozo.
+ * @return 0 si se analizó, -1 si no hubo memoria para guardar una línea cortada.
+ */
+int exposition_parser_feed(exposition_parser* parser, const char* bytes, size_t length);
+
+/**
+ * @brief Analiza la última línea si la exposición no terminaba en '\n'.
+ */
+void exposition_parser_finish(exposition_parser* parser);
+
+/**
+ * @brief Libera la memoria del analizador.
+ */
+void exposition_parser_free(exposition_parser* parser);
+
+#endif // EXPOSITION_PARSER_H
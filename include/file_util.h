@@ -0,0 +1,28 @@
+#ifndef FILE_UTIL_H
+#define FILE_UTIL_H
+
+#include <stdbool.h> ///< Header para el tipo bool.
+#include <stddef.h>  ///< Header para el tipo size_t.
+
+/**
+ * @brief Concatena dos componentes de ruta con una barra.
+ *
+ * "." como primer componente se omite, y la barra también si el primero ya termina en una (la raíz "/").
+ *
+ * @param dir Primer componente.
+ * @param name Segundo componente.
+ * @return Ruta nueva reservada con malloc, o NULL si no hay memoria.
+ */
+char* join_path(const char* dir, const char* name);
+
+/**
+ * @brief Escribe todo el contenido en un descriptor, reintentando las escrituras parciales y las interrumpidas.
+ *
+ * @param fd Descriptor de destino.
+ * @param data Datos a escribir.
+ * @param size Cantidad de bytes.
+ * @return true si se escribió todo, false en caso de error (con errno).
+ */
+bool write_all(int fd, const void* data, size_t size);
+
+#endif // FILE_UTIL_H
@@ -0,0 +1,65 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h> ///< Header para el tipo size_t.
+#include <stdint.h> ///< Header para los enteros de tamaño fijo.
+
+#define FNV1A32_OFFSET 2166136261u             // Valor inicial del hash FNV-1a de 32 bits
+#define FNV1A32_PRIME 16777619u                // Primo del hash FNV-1a de 32 bits
+#define FNV1A64_OFFSET 14695981039346656037ULL // Valor inicial del hash FNV-1a de 64 bits
+#define FNV1A64_PRIME 1099511628211ULL         // Primo del hash FNV-1a de 64 bits
+
+/**
+ * @brief Aplica un byte al hash FNV-1a de 32 bits, para calcularlo mientras se recorre un texto.
+ */
+static inline uint32_t fnv1a32_step(uint32_t hash, char c)
+{
+    return (hash ^ (unsigned char)c) * FNV1A32_PRIME;
+}
+
+/**
+ * @brief Continúa un hash FNV-1a de 32 bits con `length` bytes.
+ *
+ * @param hash Estado inicial: FNV1A32_OFFSET, o una variante para separar dominios (por ejemplo, con una semilla).
+ * @param data Bytes a aplicar (no necesitan terminar en '\0').
+ * @param length Cantidad de bytes.
+ */
+static inline uint32_t fnv1a32_from(uint32_t hash, const char* data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+        hash = fnv1a32_step(hash, data[i]);
+    return hash;
+}
+
+/**
+ * @brief Hash FNV-1a de 32 bits, para las tablas hash en memoria.
+ */
+static inline uint32_t fnv1a32(const char* data, size_t length)
+{
+    return fnv1a32_from(FNV1A32_OFFSET, data, length);
+}
+
+/**
+ * @brief Continúa un hash FNV-1a de 64 bits con `length` bytes.
+ *
+ * @param hash Estado inicial: FNV1A64_OFFSET, o el resultado de una llamada anterior para encadenar varios datos.
+ * @param data Bytes a aplicar (no necesitan terminar en '\0').
+ * @param length Cantidad de bytes.
+ */
+static inline uint64_t fnv1a64_from(uint64_t hash, const void* data, size_t length)
+{
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < length; i++)
+        hash = (hash ^ bytes[i]) * FNV1A64_PRIME;
+    return hash;
+}
+
+/**
+ * @brief Hash FNV-1a de 64 bits, para los nombres derivados de rutas que se guardan en disco.
+ */
+static inline uint64_t fnv1a64(const char* data, size_t length)
+{
+    return fnv1a64_from(FNV1A64_OFFSET, data, length);
+}
+
+#endif // HASH_H
@@ -7,29 +7,39 @@
 #include <unistd.h> ///< Header para llamadas al sistema POSIX.
 
 // Colores para el terminal. Ten en cuenta que pueden no funcionar en todos los terminales.
-#define RED "\033[1;91m"      ///< Color rojo para el texto en terminal.
-#define YELLOW "\033[1;93m"   ///< Color amarillo para el texto en terminal.
-#define GREEN "\033[1;32m"    ///< Color verde para el texto en terminal.
-#define BLUE "\033[1;34m"     ///< Color azul para el texto en terminal.
-#define RESET "\033[38;5;87m" ///< Resetea el color del texto al valor por defecto.
+#define RED "\033[1;91m"                    ///< Color rojo para el texto en terminal.
+#define YELLOW "\033[1;93m"                 ///< Color amarillo para el texto en terminal.
+#define GREEN "\033[1;32m"                  ///< Color verde para el texto en terminal.
+#define BLUE "\033[1;34m"                   ///< Color azul para el texto en terminal.
+#define RESET "\033[38;5;87m"               ///< Resetea el color del texto al valor por defecto.
+#define CLEAR_SCREEN "\033[H\033[2J\033[3J" ///< Limpia la pantalla y el historial, como `clear`.
 
 #define HOSTNAME_SIZE 32 // Tamaño máximo para hostname
-#define COMMAND_BUFFER_SIZE_2 64
 
 /**
  * @brief Inicializa el terminal para la aplicación.
  *
  * Configura el entorno del terminal con las características necesarias
- * para la ejecución del programa.
+ * para la ejecución del programa: limpia la pantalla y muestra el
+ * encabezado. Solo tiene sentido en una sesión interactiva en una terminal.
  */
 void init_terminal();
 
+/**
+ * @brief Vuelve a componer el prompt a partir de $USER, $HOME, $PWD y el hostname.
+ *
+ * El prompt se compone una sola vez y se reutiliza en cada línea; debe llamarse cada vez que la shell cambia alguno
+ * de esos valores (por ejemplo, después de `cd`).
+ */
+void refresh_prompt();
+
 /**
  * @brief Obtiene el comando ingresado por el usuario.
  *
  * Lee la entrada del usuario desde el terminal y devuelve el comando como una cadena de caracteres.
  *
- * @return Cadena de caracteres que contiene el comando ingresado por el usuario.
+ * @return Cadena de caracteres que contiene el comando ingresado por el usuario. Pertenece a un buffer interno que
+ * se reutiliza en la siguiente llamada, por lo que no debe liberarse.
  */
 char* get_command();
 
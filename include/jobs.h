@@ -0,0 +1,175 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdbool.h>      ///< Header para el tipo bool.
+#include <stdint.h>       ///< Header para el tipo uint64_t.
+#include <stdio.h>        ///< Header para el tipo FILE.
+#include <sys/resource.h> ///< Header para la estructura rusage.
+#include <sys/types.h>    ///< Header para el tipo pid_t.
+
+#define SIGNAL_EXIT_BASE 128 ///< Código de salida base para procesos terminados por señal (128 + señal).
+
+/**
+ * @enum job_state
+ * @brief Estados posibles de un trabajo.
+ */
+typedef enum
+{
+    JOB_RUNNING, ///< Al menos un proceso del trabajo sigue en ejecución.
+    JOB_STOPPED, ///< El trabajo fue detenido (por ejemplo, con Ctrl-Z).
+    JOB_DONE     ///< Todos los procesos del trabajo terminaron.
+} job_state;
+
+/**
+ * @struct job
+ * @brief Trabajo de la shell: una tubería lanzada en su propio grupo de procesos.
+ */
+typedef struct
+{
+    int id;              /**< Identificador del trabajo ([n]). */
+    pid_t pgid;          /**< Grupo de procesos del trabajo. */
+    pid_t* pids;         /**< Procesos del trabajo, en el orden de la tubería. */
+    int num_pids;        /**< Cantidad de procesos. */
+    int num_alive;       /**< Procesos que todavía no terminaron. */
+    job_state state;     /**< Estado actual del trabajo. */
+    int status;          /**< Estado de salida del último proceso de la tubería. */
+    bool background;     /**< true si el trabajo corre en segundo plano. */
+    char* command;       /**< Texto del comando, para mostrarlo en `jobs`. */
+    struct rusage usage; /**< Recursos consumidos por los procesos que ya terminaron, según wait4(). */
+    uint64_t started;    /**< Instante en que se registró el trabajo (ns, ver stats_now()). */
+    uint64_t finished;   /**< Instante en que terminó su último proceso (ns), o 0 si sigue activo. */
+} job;
+
+/**
+ * @brief Prepara la tabla de trabajos: atiende SIGCHLD y detecta si la shell controla la terminal.
+ *
+ * Si el bucle de eventos está activo, SIGCHLD se recibe a través de él; en otro caso se instala un manejador
+ * asíncrono. Debe llamarse después de inicializar el bucle. Las llamadas repetidas no tienen efecto.
+ */
+void jobs_init(void);
+
+/**
+ * @brief Devuelve la terminal que la shell puede ceder a un trabajo en primer plano.
+ *
+ * Prepara la tabla con jobs_init() si todavía no se preparó.
+ *
+ * @return STDIN_FILENO si la shell controla la terminal, o -1 si no.
+ */
+int jobs_terminal_fd(void);
+
+/**
+ * @brief Registra un trabajo recién lanzado.
+ *
+ * Si la tabla no se preparó con jobs_init(), se prepara en esta llamada.
+ *
+ * @param pids Procesos del trabajo.
+ * @param num_pids Cantidad de procesos (mayor que cero).
+ * @param pgid Grupo de procesos del trabajo.
+ * @param command Texto del comando; se copia.
+ * @param background true si el trabajo se lanzó en segundo plano.
+ * @return El trabajo registrado, o NULL si no hay memoria.
+ */
+job* jobs_add(const pid_t* pids, int num_pids, pid_t pgid, const char* command, bool background);
+
+/**
+ * @brief Convierte un estado de waitpid en código de salida al estilo de la shell.
+ *
+ * @param status Estado devuelto por waitpid() o wait4().
+ * @return El código de salida si el proceso terminó, SIGNAL_EXIT_BASE + señal si lo terminó una señal, o
+ *         EXIT_FAILURE para cualquier otro estado.
+ */
+int jobs_exit_code(int status);
+
+/**
+ * @brief Recolecta todos los hijos que cambiaron de estado y actualiza sus trabajos.
+ *
+ * Llama a wait4(-1, WNOHANG) hasta que no queden hijos por recolectar y suma los recursos de cada proceso terminado
+ * a su trabajo. Es segura para usarse desde el manejador de SIGCHLD.
+ */
+void jobs_reap(void);
+
+/**
+ * @brief Espera a que un trabajo termine o se detenga, cediéndole la terminal si corresponde.
+ *
+ * Los trabajos que terminan se eliminan de la tabla; los que se detienen pasan a segundo plano.
+ *
+ * @param j Trabajo a esperar.
+ * @param foreground true para ceder la terminal al trabajo mientras se espera.
+ * @return Código de salida del trabajo (128 + señal si terminó por una señal).
+ */
+int jobs_wait(job* j, bool foreground);
+
+/**
+ * @brief Igual que jobs_wait(), pero además devuelve los recursos que consumió el trabajo.
+ *
+ * @param j Trabajo a esperar.
+ * @param foreground true para ceder la terminal al trabajo mientras se espera.
+ * @param usage Donde se copian los recursos de los procesos terminados (tiempos de CPU y cambios de contexto
+ *        sumados, RSS máximo del mayor), o NULL.
+ * @return Código de salida del trabajo (128 + señal si terminó por una señal).
+ */
+int jobs_wait_usage(job* j, bool foreground, struct rusage* usage);
+
+/**
+ * @brief Suma los recursos de un proceso o trabajo a un total.
+ *
+ * Los tiempos de CPU, los fallos de página y los cambios de contexto se acumulan; el RSS máximo se queda con el mayor.
+ *
+ * @param total Total a actualizar.
+ * @param usage Recursos a sumar.
+ */
+void jobs_add_usage(struct rusage* total, const struct rusage* usage);
+
+/**
+ * @brief Espera a que terminen todos los trabajos en segundo plano en ejecución.
+ *
+ * Los trabajos detenidos no se esperan. Al terminar se informan los trabajos finalizados, como con jobs_notify().
+ *
+ * @return Código de salida del último trabajo de la tabla.
+ */
+int jobs_wait_all(void);
+
+/**
+ * @brief Continúa un trabajo detenido, en primer o segundo plano.
+ *
+ * @param j Trabajo a continuar.
+ * @param foreground true para traerlo al primer plano y esperarlo (`fg`), false para dejarlo en segundo plano (`bg`).
+ * @return Código de salida si se esperó el trabajo, 0 en otro caso.
+ */
+int jobs_continue(job* j, bool foreground);
+
+/**
+ * @brief Busca un trabajo por especificación.
+ *
+ * Acepta `%n` o `n` (identificador de trabajo), un PID de alguno de sus procesos, o NULL para el trabajo actual.
+ *
+ * @param spec Especificación del trabajo, o NULL.
+ * @return El trabajo, o NULL si no existe.
+ */
+job* jobs_find(const char* spec);
+
+/**
+ * @brief Imprime los trabajos activos con el formato `[n]+ Estado comando`.
+ *
+ * Los trabajos terminados se informan con el resumen de sus recursos y se eliminan. En formato largo (`jobs -l`)
+ * se agregan los PIDs de cada trabajo y los recursos de los procesos que ya terminaron.
+ *
+ * @param stream Flujo de salida.
+ * @param long_format true para el formato largo.
+ */
+void jobs_print(FILE* stream, bool long_format);
+
+/**
+ * @brief Informa los trabajos en segundo plano que terminaron, con el resumen de sus recursos, y los elimina de la
+ * tabla.
+ */
+void jobs_notify(void);
+
+/**
+ * @brief Devuelve el grupo de procesos del trabajo en primer plano.
+ *
+ * @return PGID del trabajo en primer plano, o -1 si no hay ninguno.
+ */
+pid_t jobs_foreground_pgid(void);
+
+#endif // JOBS_H
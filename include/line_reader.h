@@ -0,0 +1,88 @@
+#ifndef LINE_READER_H
+#define LINE_READER_H
+
+#include <stdbool.h>   ///< Header para el tipo bool.
+#include <stdio.h>     ///< Header para el tipo FILE.
+#include <sys/types.h> ///< Header para el tipo ssize_t.
+
+/**
+ * @struct line_buffer
+ * @brief Buffer reutilizable que crece según la línea más larga leída.
+ */
+typedef struct
+{
+    char* data;      /**< Contenido de la última línea leída. */
+    size_t capacity; /**< Capacidad reservada del buffer. */
+} line_buffer;
+
+/**
+ * @struct line_reader
+ * @brief Lector de líneas de un archivo batch.
+ *
+ * Los archivos regulares se proyectan en memoria y las líneas se devuelven en el lugar, sin copiarlas. El resto de
+ * las entradas (tuberías, terminales, flujos ya abiertos) se leen con un line_buffer.
+ */
+typedef struct
+{
+    char* map;          /**< Proyección privada del archivo, o NULL si se lee desde un flujo. */
+    size_t size;        /**< Tamaño del archivo proyectado. */
+    size_t offset;      /**< Posición de la próxima línea dentro de la proyección. */
+    char* tail;         /**< Copia de la última línea si no termina en '\n' y no queda lugar para el '\0'. */
+    FILE* stream;       /**< Flujo de respaldo, o NULL si se usa la proyección. */
+    bool owns_stream;   /**< El lector abrió el flujo y debe cerrarlo. */
+    line_buffer buffer; /**< Buffer para las líneas leídas desde el flujo. */
+} line_reader;
+
+/**
+ * @brief Lee una línea completa, de cualquier longitud, reutilizando el buffer entre llamadas.
+ *
+ * @param buffer Buffer a reutilizar; debe iniciarse en cero.
+ * @param stream Flujo de entrada.
+ * @return Longitud de la línea leída (incluido el '\n' final, si lo hay), o -1 al final del flujo o ante un error.
+ */
+ssize_t line_buffer_read(line_buffer* buffer, FILE* stream);
+
+/**
+ * @brief Libera la memoria del buffer.
+ *
+ * @param buffer Buffer a liberar; queda listo para reutilizarse.
+ */
+void line_buffer_free(line_buffer* buffer);
+
+/**
+ * @brief Abre un archivo batch, proyectándolo en memoria si es un archivo regular.
+ *
+ * @param reader Lector a inicializar.
+ * @param path Ruta del archivo.
+ * @return 0 si el archivo se abrió, -1 en caso de error (con errno establecido).
+ */
+int line_reader_open(line_reader* reader, const char* path);
+
+/**
+ * @brief Inicializa un lector sobre un flujo ya abierto, que no se cierra al cerrar el lector.
+ *
+ * @param reader Lector a inicializar.
+ * @param stream Flujo de entrada.
+ */
+void line_reader_from_stream(line_reader* reader, FILE* stream);
+
+/**
+ * @brief Devuelve la siguiente línea, sin el '\n' final.
+ *
+ * La línea está terminada en '\0' y puede modificarse. Con la proyección en memoria sigue siendo válida hasta que se
+ * cierra el lector; con un flujo, hasta la siguiente llamada.
+ *
+ * @param reader Lector abierto.
+ * @param length Donde se guarda la longitud de la línea, o NULL.
+ * @return La línea, o NULL al llegar al final.
+ */
+char* line_reader_next(line_reader* reader, size_t* length);
+
+/**
+ * @brief Libera la proyección o el buffer y cierra el archivo si el lector lo abrió.
+ *
+ * @param reader Lector a cerrar.
+ */
+void line_reader_close(line_reader* reader);
+
+#endif // LINE_READER_H
@@ -0,0 +1,80 @@
+#ifndef METRIC_MATCHER_H
+#define METRIC_MATCHER_H
+
+#include <stdbool.h> ///< Header para el tipo bool.
+#include <stddef.h>  ///< Header para el tipo size_t.
+#include <stdint.h>  ///< Header para los enteros de tamaño fijo.
+
+/**
+ * @struct matcher_entry
+ * @brief Nombre exacto del conjunto hash.
+ */
+typedef struct
+{
+    const char* name; /**< Nombre (dentro de `strings`), o NULL si la posición está libre. */
+    uint32_t length;  /**< Longitud del nombre. */
+    uint32_t hash;    /**< Hash del nombre. */
+} matcher_entry;
+
+/**
+ * @struct matcher_node
+ * @brief Nodo de un trie de prefijos (o de sufijos, leídos al revés).
+ */
+typedef struct
+{
+    uint32_t child;   /**< Primer hijo, o 0 si no tiene. */
+    uint32_t sibling; /**< Siguiente hermano, o 0 si es el último. */
+    char symbol;      /**< Carácter que lleva a este nodo. */
+    bool terminal;    /**< Algún patrón termina en este nodo: todo lo que siga coincide. */
+} matcher_node;
+
+/**
+ * @struct metric_matcher
+ * @brief Filtro compilado de nombres de métricas.
+ *
+ * Los nombres sin comodines van a un conjunto hash; los patrones `prefijo*` y `*sufijo` se compilan en dos tries que
+ * se recorren una sola vez por nombre, sin importar cuántos patrones haya. Los demás patrones glob se evalúan con
+ * fnmatch().
+ */
+typedef struct
+{
+    matcher_entry* entries;  /**< Conjunto hash de nombres exactos. */
+    size_t entries_size;     /**< Posiciones de `entries` (potencia de dos). */
+    size_t exact_count;      /**< Nombres exactos. */
+    matcher_node* prefixes;  /**< Trie de prefijos; el nodo 0 es la raíz. */
+    size_t prefix_nodes;     /**< Nodos usados de `prefixes`. */
+    size_t prefix_count;     /**< Patrones `prefijo*`. */
+    matcher_node* suffixes;  /**< Trie de sufijos invertidos; el nodo 0 es la raíz. */
+    size_t suffix_nodes;     /**< Nodos usados de `suffixes`. */
+    size_t suffix_count;     /**< Patrones `*sufijo`. */
+    char** globs;            /**< Patrones con comodines en otras posiciones. */
+    size_t glob_count;       /**< Cantidad de `globs`. */
+    char* strings;           /**< Copia de los nombres exactos. */
+} metric_matcher;
+
+/**
+ * @brief Compila una lista de nombres y patrones glob.
+ *
+ * @param matcher Filtro a inicializar.
+ * @param patterns Nombres exactos (`cpu_usage`) o patrones (`memory_*`, `*_seconds`, `node_*_bytes`).
+ * @param count Cantidad de patrones.
+ * @return 0 si se compiló, -1 si no hay memoria.
+ */
+int metric_matcher_compile(metric_matcher* matcher, const char* const* patterns, size_t count);
+
+/**
+ * @brief Indica si el nombre de una métrica coincide con algún patrón.
+ *
+ * @param matcher Filtro compilado.
+ * @param name Nombre de la métrica (no necesariamente terminado en '\0').
+ * @param length Longitud del nombre.
+ * @return true si coincide.
+ */
+bool metric_matcher_match(const metric_matcher* matcher, const char* name, size_t length);
+
+/**
+ * @brief Libera la memoria del filtro.
+ */
+void metric_matcher_free(metric_matcher* matcher);
+
+#endif // METRIC_MATCHER_H
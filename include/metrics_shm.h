@@ -0,0 +1,208 @@
+#ifndef METRICS_SHM_H
+#define METRICS_SHM_H
+
+#include <stdatomic.h> ///< Header para los contadores atómicos del seqlock.
+#include <stdbool.h>   ///< Header para el tipo bool.
+#include <stddef.h>    ///< Header para el tipo size_t.
+#include <stdint.h>    ///< Header para los enteros de tamaño fijo.
+
+#define METRICS_SHM_NAME "/shell_metrics"    // Nombre de la memoria compartida (en /dev/shm)
+#define METRICS_SHM_MAGIC 0x4d455452u        // "METR": identifica una región de métricas
+#define METRICS_SHM_VERSION 2                // Versión del formato; los lectores rechazan las demás
+#define METRICS_SHM_SLOTS 4                  // Tramas del anillo
+#define METRICS_SHM_HEADER_SIZE 64           // Bytes reservados para metrics_region antes de la primera posición
+#define METRICS_SHM_INITIAL_SLOT (64 * 1024) // Bytes por posición al crear la región; crece según las tramas
+
+/**
+ * @struct metric_sample
+ * @brief Muestra binaria: los textos se guardan una sola vez en la tabla de cadenas de la trama.
+ */
+typedef struct
+{
+    uint32_t name_id;     /**< Desplazamiento del nombre de la métrica en la tabla de cadenas. */
+    uint32_t labels_id;   /**< Desplazamiento de las etiquetas (`clave="valor",...`, sin llaves), o del texto vacío. */
+    double value;         /**< Valor de la muestra. */
+    int64_t timestamp_ms; /**< Marca de tiempo (ms desde la época): la de la exposición o la de publicación. */
+} metric_sample;
+
+/**
+ * @struct metrics_frame
+ * @brief Encabezado de una trama: lo siguen `num_samples` muestras empaquetadas y `strings_size` bytes de cadenas.
+ *
+ * La trama ocupa exactamente `bytes` bytes contiguos, así que un lector la copia de una sola vez sin buscar
+ * marcadores.
+ */
+typedef struct
+{
+    uint64_t bytes;        /**< Longitud total de la trama, encabezado incluido. */
+    int64_t timestamp_ms;  /**< Momento de la publicación (ms desde la época). */
+    uint32_t num_samples;  /**< Muestras de la trama. */
+    uint32_t truncated;    /**< Distinto de 0 si el escritor se quedó sin memoria y descartó muestras. */
+    uint64_t strings_size; /**< Bytes de la tabla de cadenas; la posición 0 es el texto vacío. */
+} metrics_frame;
+
+/**
+ * @struct metrics_slot
+ * @brief Posición del anillo protegida por un seqlock; la sigue una trama.
+ *
+ * El escritor deja `sequence` impar mientras copia la trama y par al terminar; un lector que ve el mismo valor par
+ * antes y después de copiarla obtuvo una copia consistente.
+ */
+typedef struct
+{
+    _Atomic uint64_t sequence; /**< Contador del seqlock. */
+    uint64_t generation;       /**< Número de publicación de la trama. */
+} metrics_slot;
+
+/**
+ * @struct metrics_region
+ * @brief Encabezado de la memoria compartida; lo siguen METRICS_SHM_SLOTS posiciones de `slot_size` bytes.
+ *
+ * Cuando una trama no entra, el escritor agranda la región y redistribuye las posiciones con `layout` impar; los
+ * lectores vuelven a proyectarla si la ven más grande que su proyección.
+ */
+typedef struct
+{
+    uint32_t magic;          /**< METRICS_SHM_MAGIC. */
+    uint32_t version;        /**< METRICS_SHM_VERSION. */
+    _Atomic uint64_t latest; /**< Generación publicada más reciente, o 0 si todavía no hay ninguna. */
+    _Atomic uint64_t layout; /**< Seqlock del tamaño de las posiciones. */
+    uint64_t slot_size;      /**< Bytes por posición (múltiplo de 8); la generación g está en la posición g % SLOTS. */
+} metrics_region;
+
+/**
+ * @struct metrics_shm
+ * @brief Acceso de un proceso a la región de métricas.
+ *
+ * El escritor arma cada trama en memoria privada y solo la copia a la región al publicarla, así que el seqlock de
+ * la posición queda impar lo que dura un memcpy.
+ */
+typedef struct
+{
+    metrics_region* region;  /**< Región proyectada en memoria. */
+    size_t mapped_size;      /**< Bytes proyectados. */
+    int fd;                  /**< Descriptor de la memoria compartida, para agrandarla o volver a proyectarla. */
+    bool writer;             /**< true si el proceso publica (el wrapper). */
+    int64_t timestamp_ms;    /**< Momento en que empezó la trama en curso. */
+    bool truncated;          /**< La trama en curso perdió muestras por falta de memoria. */
+    metric_sample* samples;  /**< Muestras de la trama en curso. */
+    size_t num_samples;      /**< Muestras cargadas. */
+    size_t samples_capacity; /**< Capacidad de `samples`. */
+    char* strings;           /**< Tabla de cadenas de la trama en curso. */
+    size_t strings_size;     /**< Bytes usados de `strings`. */
+    size_t strings_capacity; /**< Capacidad de `strings`. */
+    uint32_t* interned;      /**< Tabla hash (desplazamientos) para no repetir cadenas en una trama. */
+    size_t interned_size;    /**< Posiciones de `interned` (potencia de dos). */
+    size_t interned_count;   /**< Cadenas guardadas en `interned`. */
+} metrics_shm;
+
+/**
+ * @struct metrics_snapshot
+ * @brief Copia privada de una trama; su buffer crece según hace falta y se reutiliza entre lecturas.
+ */
+typedef struct
+{
+    uint64_t generation;          /**< Generación copiada. */
+    int64_t timestamp_ms;         /**< Momento de la publicación. */
+    bool truncated;               /**< El escritor descartó muestras de esta trama. */
+    uint32_t num_samples;         /**< Muestras copiadas. */
+    const metric_sample* samples; /**< Muestras (dentro de `buffer`). */
+    const char* strings;          /**< Tabla de cadenas (dentro de `buffer`). */
+    size_t strings_size;          /**< Bytes de la tabla. */
+    void* buffer;                 /**< Copia de la trama completa. */
+    size_t capacity;              /**< Capacidad de `buffer`. */
+} metrics_snapshot;
+
+/**
+ * @brief Crea (o reutiliza) una región y la proyecta para publicar.
+ *
+ * @param shm Acceso a inicializar.
+ * @param name Nombre de la memoria compartida, normalmente METRICS_SHM_NAME.
+ * @return 0 si la región quedó lista, -1 en caso de error (con errno).
+ */
+int metrics_shm_create(metrics_shm* shm, const char* name);
+
+/**
+ * @brief Proyecta una región existente solo para lectura.
+ *
+ * @param shm Acceso a inicializar.
+ * @param name Nombre de la memoria compartida, normalmente METRICS_SHM_NAME.
+ * @return 0 si se abrió, -1 si no existe (el wrapper nunca publicó) o tiene otro formato.
+ */
+int metrics_shm_open(metrics_shm* shm, const char* name);
+
+/**
+ * @brief Libera la proyección de la región (la región sigue existiendo para los demás procesos).
+ */
+void metrics_shm_close(metrics_shm* shm);
+
+/**
+ * @brief Empieza una nueva trama.
+ *
+ * Los lectores siguen viendo la trama anterior hasta metrics_shm_commit().
+ */
+void metrics_shm_begin(metrics_shm* shm);
+
+/**
+ * @brief Agrega una muestra a la trama en curso.
+ *
+ * Los nombres y las etiquetas repetidos se guardan una sola vez.
+ *
+ * @param shm Acceso del escritor, después de metrics_shm_begin().
+ * @param name Nombre de la métrica (no necesariamente terminado en '\0').
+ * @param name_length Longitud del nombre.
+ * @param labels Etiquetas sin llaves, o NULL.
+ * @param labels_length Longitud de las etiquetas.
+ * @param value Valor.
+ * @param timestamp_ms Marca de tiempo, o 0 para usar la de publicación.
+ * @return 0 si se agregó, -1 si no hay memoria (la trama queda marcada como truncada).
+ */
+int metrics_shm_add(metrics_shm* shm, const char* name, size_t name_length, const char* labels,
+                    size_t labels_length, double value, int64_t timestamp_ms);
+
+/**
+ * @brief Analiza una línea del formato de exposición de Prometheus y agrega su muestra a la trama en curso.
+ *
+ * Acepta `nombre[{etiquetas}] valor [marca de tiempo]`; los comentarios (`#`) y las líneas vacías se ignoran.
+ *
+ * @param shm Acceso del escritor, después de metrics_shm_begin().
+ * @param line Línea, sin el salto de línea final (no necesariamente terminada en '\0').
+ * @param length Longitud de la línea.
+ * @return 1 si se agregó una muestra, 0 si la línea no tenía ninguna o estaba mal formada, -1 si no hay memoria.
+ */
+int metrics_shm_add_line(metrics_shm* shm, const char* line, size_t length);
+
+/**
+ * @brief Publica la trama en curso: desde ahora es la que leen los lectores.
+ *
+ * @return 0 si se publicó, -1 si no se pudo agrandar la región (la trama se descarta).
+ */
+int metrics_shm_commit(metrics_shm* shm);
+
+/**
+ * @brief Devuelve la generación publicada más reciente, sin copiar nada.
+ */
+uint64_t metrics_shm_latest(const metrics_shm* shm);
+
+/**
+ * @brief Copia la trama más reciente sin bloquear al escritor ni a otros lectores.
+ *
+ * Si el escritor la reemplaza durante la copia, se reintenta con la nueva.
+ *
+ * @param shm Acceso del lector; se vuelve a proyectar si la región creció.
+ * @param snapshot Copia a completar; debe empezar en cero y puede reutilizarse.
+ * @return 0 si se copió, -1 si todavía no se publicó ninguna o no hay memoria.
+ */
+int metrics_shm_read(metrics_shm* shm, metrics_snapshot* snapshot);
+
+/**
+ * @brief Devuelve una cadena de la copia a partir de su identificador.
+ */
+const char* metrics_snapshot_string(const metrics_snapshot* snapshot, uint32_t id);
+
+/**
+ * @brief Libera el buffer de una copia.
+ */
+void metrics_snapshot_free(metrics_snapshot* snapshot);
+
+#endif // METRICS_SHM_H
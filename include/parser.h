@@ -0,0 +1,146 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <stdbool.h> ///< Header para el tipo bool.
+#include <stddef.h>  ///< Header para el tipo size_t.
+
+/**
+ * @brief Indica si un carácter termina una palabra sin comillas.
+ *
+ * El parser y la búsqueda de comandos internos cortan la primera palabra con esta misma función.
+ *
+ * @param c Carácter a clasificar.
+ * @return true para el fin de la línea, espacios, saltos de línea y los operadores `|`, `<`, `>`, `&` y `;`.
+ */
+static inline bool parser_is_word_end(char c)
+{
+    switch (c)
+    {
+    case '\0':
+    case ' ':
+    case '\t':
+    case '\n':
+    case '|':
+    case '<':
+    case '>':
+    case '&':
+    case ';':
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Devuelve la longitud de la palabra sin comillas que empieza en `s` (ver parser_is_word_end()).
+ */
+static inline size_t parser_word_length(const char* s)
+{
+    size_t length = 0;
+    while (!parser_is_word_end(s[length]))
+        length++;
+    return length;
+}
+
+/**
+ * @enum redirection_type
+ * @brief Tipos de redirección soportados por el parser.
+ */
+typedef enum
+{
+    REDIR_IN,     ///< `< archivo`: stdin desde un archivo.
+    REDIR_OUT,    ///< `> archivo`: stdout hacia un archivo, truncándolo.
+    REDIR_APPEND, ///< `>> archivo`: stdout hacia un archivo, agregando al final.
+    REDIR_ERR     ///< `2> archivo`: stderr hacia un archivo, truncándolo.
+} redirection_type;
+
+/**
+ * @struct redirection
+ * @brief Redirección asociada a un comando simple.
+ */
+typedef struct
+{
+    redirection_type type; /**< Tipo de redirección. */
+    char* path;            /**< Archivo destino u origen. */
+} redirection;
+
+/**
+ * @struct simple_command
+ * @brief Comando simple: programa, argumentos y redirecciones.
+ */
+typedef struct
+{
+    char** argv;               /**< Vector de argumentos terminado en NULL. */
+    int argc;                  /**< Cantidad de argumentos. */
+    redirection* redirections; /**< Redirecciones en el orden en que aparecen. */
+    int num_redirections;      /**< Cantidad de redirecciones. */
+} simple_command;
+
+/**
+ * @struct pipeline
+ * @brief Secuencia de comandos simples conectados con `|`.
+ */
+typedef struct
+{
+    simple_command* commands; /**< Etapas de la tubería, de izquierda a derecha. */
+    int num_commands;         /**< Cantidad de etapas. */
+    bool background;          /**< true si la tubería termina en `&`. */
+} pipeline;
+
+/**
+ * @struct command_list
+ * @brief Lista de tuberías separadas por `;` o `&`.
+ */
+typedef struct
+{
+    pipeline* pipelines; /**< Tuberías en orden de ejecución. */
+    int num_pipelines;   /**< Cantidad de tuberías. */
+    bool expanded;       /**< Alguna palabra contiene variables: el resultado depende del entorno al analizar. */
+} command_list;
+
+/**
+ * @enum parse_status
+ * @brief Resultado del análisis de una línea de comandos.
+ */
+typedef enum
+{
+    PARSE_OK,          ///< La línea se analizó por completo.
+    PARSE_UNSUPPORTED, ///< La línea usa construcciones que se delegan en /bin/sh.
+    PARSE_SYNTAX_ERROR ///< La línea tiene un error de sintaxis (o no hubo memoria para analizarla).
+} parse_status;
+
+/**
+ * @brief Analiza una línea de comandos y construye su árbol sintáctico.
+ *
+ * Reconoce palabras con comillas simples y dobles, escapes con `\`, tuberías `|`, redirecciones `<`, `>`, `>>` y
+ * `2>`, y los separadores `&` y `;`. Las variables `$NOMBRE`, `${NOMBRE}`, `${NOMBRE:-valor}` y `${NOMBRE-valor}`
+ * se expanden en cualquier palabra con el entorno actual de la shell; fuera de comillas dobles su valor se separa en
+ * campos por los espacios. Las construcciones que no interpreta (parámetros especiales, sustitución de comandos,
+ * comodines, `~`, `&&`, `||`, subshells, etc.) se informan con PARSE_UNSUPPORTED para que el llamador recurra a
+ * /bin/sh. Si falta memoria, lo informa en stderr y devuelve PARSE_SYNTAX_ERROR, como con los errores de sintaxis.
+ *
+ * @param line Línea a analizar; no se modifica.
+ * @param list Estructura donde se guarda el resultado; debe liberarse con free_command_list() si se devuelve
+ * PARSE_OK.
+ * @return Estado del análisis.
+ */
+parse_status parse_command_line(const char* line, command_list* list);
+
+/**
+ * @brief Reconstruye el texto de una tubería, por ejemplo para mostrarla en la tabla de trabajos.
+ *
+ * Las comillas y escapes originales no se conservan.
+ *
+ * @param pl Tubería a mostrar.
+ * @return Cadena reservada con malloc que el llamador debe liberar, o NULL si no hay memoria.
+ */
+char* pipeline_to_string(const pipeline* pl);
+
+/**
+ * @brief Libera la memoria asociada a una lista de comandos.
+ *
+ * @param list Lista a liberar; queda vacía.
+ */
+void free_command_list(command_list* list);
+
+#endif // PARSER_H
@@ -0,0 +1,46 @@
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+#include <stdio.h> ///< Header para el tipo FILE.
+
+/**
+ * @brief Devuelve la ruta absoluta de un comando, resolviéndola en $PATH solo la primera vez.
+ *
+ * Los nombres que contienen '/' no se almacenan. Si $PATH cambió desde la última consulta, la tabla se vacía antes
+ * de buscar.
+ *
+ * @param name Nombre del comando.
+ * @return Ruta del ejecutable (válida hasta la próxima modificación de la tabla), o NULL si no se encontró.
+ */
+const char* path_cache_lookup(const char* name);
+
+/**
+ * @brief Resuelve un comando y lo agrega a la tabla aunque todavía no se haya usado.
+ *
+ * @param name Nombre del comando.
+ * @return 0 si el comando se encontró en $PATH, -1 en caso contrario.
+ */
+int path_cache_seed(const char* name);
+
+/**
+ * @brief Elimina un comando de la tabla.
+ *
+ * Se usa cuando el ejecutable almacenado ya no existe (por ejemplo, si exec falla con ENOENT).
+ *
+ * @param name Nombre del comando.
+ */
+void path_cache_forget(const char* name);
+
+/**
+ * @brief Vacía la tabla de rutas.
+ */
+void path_cache_clear(void);
+
+/**
+ * @brief Imprime el contenido de la tabla con la cantidad de usos de cada comando.
+ *
+ * @param stream Flujo de salida.
+ */
+void path_cache_print(FILE* stream);
+
+#endif // PATH_CACHE_H
@@ -0,0 +1,121 @@
+#ifndef SCRIPT_CACHE_H
+#define SCRIPT_CACHE_H
+
+#include "command_processor.h" ///< Tipo prepared_command que guarda la caché.
+#include <stddef.h>            ///< Header para el tipo size_t.
+#include <sys/stat.h>          ///< Header para la estructura stat.
+
+/**
+ * @struct cached_line
+ * @brief Línea de un script junto con su clasificación y su análisis.
+ */
+typedef struct
+{
+    char* text;                /**< Texto de la línea, modificable. */
+    prepared_command prepared; /**< Tipo de comando y tuberías ya separadas en argumentos. */
+    bool reparse;              /**< Debe volver a analizarse al ejecutarla (variables o errores de sintaxis). */
+} cached_line;
+
+/**
+ * @struct script_cache
+ * @brief Script cargado desde la caché.
+ *
+ * Las cadenas apuntan dentro de la proyección privada del archivo de caché; las estructuras se reservan en un arreglo
+ * por tipo. Nada de esto se libera con free_prepared_command().
+ */
+typedef struct
+{
+    cached_line* lines;        /**< Líneas del script en orden. */
+    int num_lines;             /**< Cantidad de líneas. */
+    char* map;                 /**< Proyección del archivo de caché. */
+    size_t map_size;           /**< Tamaño de la proyección. */
+    pipeline* pipelines;       /**< Tuberías de todas las líneas. */
+    simple_command* commands;  /**< Comandos simples de todas las tuberías. */
+    char** args;               /**< Vectores argv de todos los comandos, cada uno terminado en NULL. */
+    redirection* redirections; /**< Redirecciones de todos los comandos. */
+} script_cache;
+
+/**
+ * @struct script_cache_builder
+ * @brief Acumula las líneas preparadas de un script para guardarlas al terminar.
+ */
+typedef struct
+{
+    char* cache_path;              /**< Archivo de caché a escribir. */
+    char* script_path;             /**< Ruta absoluta del script. */
+    struct stat script_stat;       /**< Estado del script al empezar a leerlo. */
+    unsigned char* data;           /**< Registros serializados. */
+    size_t size;                   /**< Bytes usados de `data`. */
+    size_t capacity;               /**< Capacidad de `data`. */
+    unsigned int num_lines;        /**< Registros acumulados. */
+    unsigned int num_pipelines;    /**< Tuberías acumuladas. */
+    unsigned int num_commands;     /**< Comandos simples acumulados. */
+    unsigned int num_args;         /**< Argumentos acumulados. */
+    unsigned int num_redirections; /**< Redirecciones acumuladas. */
+    bool failed;                   /**< Falló una reserva de memoria; la caché no se guarda. */
+} script_cache_builder;
+
+/**
+ * @brief Devuelve el directorio donde la shell guarda sus cachés: `$XDG_CACHE_HOME/shell` o `~/.cache/shell`.
+ *
+ * @param create_dirs Crear los directorios que falten (con permisos 0700).
+ * @return Ruta reservada con malloc, o NULL si no hay directorio de caché disponible.
+ */
+char* cache_directory(bool create_dirs);
+
+/**
+ * @brief Carga la caché de un script si existe y corresponde a su ruta, tamaño y fecha de modificación actuales.
+ *
+ * La caché se guarda en `$XDG_CACHE_HOME/shell` (o `~/.cache/shell`), en un archivo por script.
+ *
+ * @param cache Estructura a inicializar; debe cerrarse con script_cache_close() si la carga tuvo éxito.
+ * @param script_path Ruta del script.
+ * @return 0 si se cargó la caché, -1 si no existe, está desactualizada o es inválida.
+ */
+int script_cache_load(script_cache* cache, const char* script_path);
+
+/**
+ * @brief Libera la proyección y los arreglos de una caché cargada.
+ *
+ * @param cache Caché a cerrar.
+ */
+void script_cache_close(script_cache* cache);
+
+/**
+ * @brief Prepara la construcción de la caché de un script regular.
+ *
+ * @param builder Constructor a inicializar; debe liberarse con script_cache_builder_free().
+ * @param script_path Ruta del script.
+ * @return 0 si se puede construir la caché, -1 si el script no es un archivo regular o no hay dónde guardarla.
+ */
+int script_cache_builder_init(script_cache_builder* builder, const char* script_path);
+
+/**
+ * @brief Agrega una línea preparada a la caché.
+ *
+ * Debe llamarse antes de ejecutar la línea, porque la ejecución puede modificar su texto.
+ *
+ * @param builder Constructor inicializado.
+ * @param text Texto de la línea.
+ * @param prepared Resultado de prepare_command() para la línea.
+ */
+void script_cache_record(script_cache_builder* builder, const char* text, const prepared_command* prepared);
+
+/**
+ * @brief Escribe la caché en un archivo temporal y lo renombra sobre el definitivo.
+ *
+ * No se guarda nada si el script cambió mientras se leía.
+ *
+ * @param builder Constructor con todas las líneas del script.
+ * @return 0 si la caché se guardó, -1 en caso contrario.
+ */
+int script_cache_commit(script_cache_builder* builder);
+
+/**
+ * @brief Libera la memoria del constructor.
+ *
+ * @param builder Constructor a liberar.
+ */
+void script_cache_builder_free(script_cache_builder* builder);
+
+#endif // SCRIPT_CACHE_H
@@ -0,0 +1,112 @@
+#ifndef SHELL_STATS_H
+#define SHELL_STATS_H
+
+#include <stdint.h> ///< Header para el tipo uint64_t.
+#include <stdio.h>  ///< Header para el tipo FILE.
+
+#define STATS_BUCKETS 28                             // Cubetas de los histogramas: 1 µs, 2 µs, 4 µs, ... 2^27 µs
+#define STATS_DEFAULT_SOCKET "/tmp/shell_stats.sock" // Socket de `stats --serve` si no se indica una ruta
+
+/**
+ * @brief Histogramas de latencia que mantiene la shell sobre sí misma.
+ */
+typedef enum
+{
+    STATS_DISPATCH,   /**< Desde que se leyó la línea hasta despacharla (clasificación y análisis). */
+    STATS_BUILTIN,    /**< Ejecución de un comando interno dentro de la shell. */
+    STATS_SPAWN,      /**< Desde que se crea un proceso hasta que ejecuta su programa (fork + exec). */
+    STATS_CHILD_WALL, /**< Tiempo real de cada trabajo, desde que se registra hasta que terminan sus procesos. */
+    STATS_HISTOGRAMS  /**< Cantidad de histogramas. */
+} stats_histogram;
+
+/**
+ * @brief Clase de comando que cuenta stats_count_command().
+ */
+typedef enum
+{
+    STATS_INTERNAL, /**< Comando interno. */
+    STATS_EXTERNAL  /**< Programa externo. */
+} stats_command_kind;
+
+/**
+ * @brief Devuelve el instante actual del reloj monotónico en nanosegundos.
+ *
+ * Usa solo clock_gettime(), así que puede llamarse desde un manejador de señales.
+ */
+uint64_t stats_now(void);
+
+/**
+ * @brief Registra una duración en un histograma.
+ *
+ * Debe llamarse desde el hilo principal de la shell, fuera de los manejadores de señales.
+ *
+ * @param histogram Histograma a actualizar.
+ * @param nanoseconds Duración medida.
+ */
+void stats_observe(stats_histogram histogram, uint64_t nanoseconds);
+
+/**
+ * @brief Registra en un histograma el tiempo transcurrido desde `start` (obtenido con stats_now()).
+ */
+void stats_observe_since(stats_histogram histogram, uint64_t start);
+
+/**
+ * @brief Suma una ejecución al contador de un comando.
+ *
+ * Los programas externos se cuentan por el nombre del ejecutable, sin su directorio. Si la tabla de contadores se
+ * llena, los comandos nuevos se cuentan juntos como "(otros)".
+ *
+ * @param kind Clase del comando.
+ * @param name Nombre del comando.
+ */
+void stats_count_command(stats_command_kind kind, const char* name);
+
+/**
+ * @brief Devuelve la cantidad de mediciones de un histograma.
+ */
+uint64_t stats_histogram_count(stats_histogram histogram);
+
+/**
+ * @brief Estima un cuantil de un histograma interpolando dentro de su cubeta, como histogram_quantile() de
+ * Prometheus.
+ *
+ * @param histogram Histograma a consultar.
+ * @param quantile Cuantil entre 0 y 1.
+ * @return La duración estimada en nanosegundos, o 0 si el histograma está vacío.
+ */
+uint64_t stats_histogram_quantile(stats_histogram histogram, double quantile);
+
+/**
+ * @brief Devuelve la cantidad de ejecuciones contadas para un comando.
+ */
+uint64_t stats_command_count(stats_command_kind kind, const char* name);
+
+/**
+ * @brief Vacía los histogramas y los contadores.
+ *
+ * Las series ya exportadas con stats_serve() no se reinician, porque en Prometheus los contadores solo crecen.
+ */
+void stats_reset(void);
+
+/**
+ * @brief Imprime los histogramas (cantidad, media, p50, p95, p99 y máximo) y los contadores de comandos.
+ *
+ * @param stream Flujo de salida.
+ */
+void stats_print(FILE* stream);
+
+/**
+ * @brief Exporta las estadísticas en formato Prometheus por un socket Unix.
+ *
+ * Desde la llamada, cada medición también se registra en métricas de prometheus-client-c, y un hilo atiende el
+ * socket `path` respondiendo a cada conexión con una respuesta HTTP que contiene la exposición de las métricas (por
+ * ejemplo, `curl --unix-socket /tmp/shell_stats.sock http://localhost/metrics`). Las mediciones anteriores a la
+ * llamada no se exportan. Solo puede haber un socket por shell.
+ *
+ * @param path Ruta del socket; si ya existe un socket con ese nombre, se reemplaza, pero cualquier otro archivo se
+ *             respeta y la llamada falla.
+ * @return 0 si el socket quedó escuchando, -1 en caso de error (informado en stderr).
+ */
+int stats_serve(const char* path);
+
+#endif // SHELL_STATS_H
@@ -1,78 +1,87 @@
 #ifndef METRICS_PROCESSOR_H
 #define METRICS_PROCESSOR_H
 
+#include "exposition_parser.h"
+#include "metric_matcher.h"
+#include "metrics_shm.h"
 #include <cjson/cJSON.h>
 #include <curl/curl.h>
-#include <fcntl.h> // Para open y O_TRUNC
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/stat.h>
-#include <sys/types.h> // Para mkfifo
-#include <unistd.h>    // Para access y sleep
+#include <unistd.h> // Para sleep
 
-#define PIPE_PATH "/tmp/metrics_pipe"
 #define CONFIG_PATH "config.json"
-#define DELIMITADOR "<END_OF_METRICS>\n"
+#define METRICS_URL "http://localhost:8000/metrics"
 #define DEFAULT_INTERVAL 10
+#define DEFAULT_TIMEOUT_MS 5000 // Tiempo máximo de cada consulta si el JSON no define "timeout_ms"
 
 /**
- * @struct memory_struct
- * @brief Estructura para almacenar la respuesta de libcurl.
- *
- * Esta estructura se utiliza para almacenar la memoria de la respuesta recibida
- * al realizar solicitudes HTTP mediante la biblioteca cURL.
+ * @struct metrics_client
+ * @brief Cliente HTTP del wrapper: un único handle de cURL y el analizador que consume la respuesta mientras llega.
  */
-struct memory_struct
+struct metrics_client
 {
-    char* memory; /**< Puntero a la memoria que almacena la respuesta. */
-    size_t size;  /**< Tamaño de la memoria almacenada. */
+    CURL* curl;               /**< Handle que conserva la conexión con el monitor entre consultas. */
+    exposition_parser parser; /**< Analizador incremental de la respuesta. */
+    metric_matcher matcher;   /**< Filtro compilado de la configuración vigente. */
+    metrics_shm* shm;         /**< Memoria compartida en la que se arma la trama en curso. */
 };
 
 /**
- * @brief Callback para escribir datos en un buffer.
+ * @brief Lee el archivo de configuración.
  *
- * Esta función se llama para manejar los datos recibidos de cURL y
- * almacenarlos en un buffer dinámico.
+ * Esta función carga y analiza el archivo de configuración JSON para
+ * obtener el intervalo de muestreo y el tiempo máximo de cada consulta.
  *
- * @return Tamaño real de los datos escritos.
+ * @return Puntero a un objeto cJSON que representa la configuración leída, o NULL en caso de error.
  */
-static size_t write_memory_callback(void* contents, size_t size, size_t nmemb, void* userp);
+cJSON* leer_configuracion(int* intervalo_muestreo, long* timeout_ms);
 
 /**
- * @brief Lee el archivo de configuración.
+ * @brief Compila el filtro de métricas de la configuración.
  *
- * Esta función carga y analiza el archivo de configuración JSON para
- * obtener el intervalo de muestreo.
+ * Esta función toma los nombres y patrones de la lista "metricas" y los
+ * compila en un metric_matcher, que se usa hasta que cambie el archivo.
  *
- * @return Puntero a un objeto cJSON que representa la configuración leída, o NULL en caso de error.
+ * @param matcher Filtro a inicializar.
+ * @param config Configuración leída con leer_configuracion().
+ * @return 0 si se compiló, -1 si no hay memoria.
  */
-cJSON* leer_configuracion(int* intervalo_muestreo);
+int compilar_filtro(metric_matcher* matcher, cJSON* config);
 
 /**
- * @brief Filtra métricas según el archivo de configuración.
+ * @brief Prepara el cliente HTTP que se reutiliza en todas las consultas.
  *
- * Esta función verifica si las métricas proporcionadas están incluidas en
- * el conjunto de métricas especificadas en la configuración.
+ * El mismo handle de cURL mantiene abierta la conexión con el monitor (keep-alive), así que las consultas
+ * siguientes no vuelven a conectarse.
  *
- * @return 1 si hay métricas filtradas, 0 de lo contrario.
+ * @return 0 si el cliente quedó listo, -1 en caso de error.
  */
-int metricas_filtradas(const char* metricas, cJSON* config);
+int iniciar_cliente(struct metrics_client* client);
 
 /**
- * @brief Función principal para obtener, filtrar y escribir métricas.
+ * @brief Libera el cliente HTTP y su analizador.
+ */
+void cerrar_cliente(struct metrics_client* client);
+
+/**
+ * @brief Función principal para obtener, filtrar y publicar métricas.
+ *
+ * Esta función realiza una solicitud HTTP para obtener métricas, las filtra según la configuración y publica las
+ * muestras como una nueva trama de la memoria compartida.
  *
- * Esta función realiza una solicitud HTTP para obtener métricas,
- * las filtra según la configuración y las escribe en una pipe nombrada.
+ * @param client Cliente creado con iniciar_cliente() y con un filtro compilado.
+ * @param timeout_ms Tiempo máximo de la consulta en milisegundos.
+ * @param shm Memoria compartida creada con metrics_shm_create().
  */
-void procesar_metricas();
+void procesar_metricas(struct metrics_client* client, long timeout_ms, metrics_shm* shm);
 
 /**
  * @brief Función principal del programa.
  *
- * Esta función crea una pipe nombrada si no existe y ejecuta el
- * procesamiento de métricas en un bucle continuo, usando el intervalo
- * de muestreo definido en el archivo de configuración.
+ * Esta función crea la memoria compartida de métricas y ejecuta el procesamiento de métricas en un bucle continuo,
+ * usando el intervalo de muestreo definido en el archivo de configuración.
  *
  * @return 0 si el programa se ejecuta con éxito.
  */
@@ -8,8 +8,10 @@
  * Las métricas se exponen vía HTTP utilizando Prometheus.
  */
 
+#include "job_metrics.h"
 #include "metrics.h"
 // #include "read_cpu_usage.h"
+#include <ctype.h>
 #include <errno.h>
 #include <prom.h>
 #include <promhttp.h>
@@ -17,6 +19,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <unistd.h> // Para sleep
 
 /**
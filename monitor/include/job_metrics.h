@@ -0,0 +1,80 @@
+/**
+ * @file job_metrics.h
+ * @brief Datagrama con el que la shell informa al monitor los recursos de cada trabajo terminado.
+ *
+ * La shell envía un datagrama por trabajo a un socket Unix del monitor, sin esperar respuesta: si el monitor no
+ * está en ejecución, el envío falla y se descarta. El monitor acumula los valores en series de Prometheus con la
+ * etiqueta `comando` (el nombre del primer programa del trabajo).
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Ruta del socket Unix (SOCK_DGRAM) en el que escucha el monitor, si no se indica otra.
+ */
+#define JOB_METRICS_SOCKET "/tmp/shell_job_metrics.sock"
+
+/**
+ * @brief Variable de entorno que reemplaza la ruta del socket, en la shell y en el monitor.
+ */
+#define JOB_METRICS_SOCKET_ENV "SHELL_JOB_METRICS_SOCKET"
+
+/**
+ * @brief Comandos distintos con series propias; los siguientes se acumulan en la etiqueta JOB_OTHERS.
+ */
+#define JOB_MAX_COMMANDS 128
+
+/**
+ * @brief Etiqueta con la que se acumulan los comandos que no entran en las JOB_MAX_COMMANDS series.
+ */
+#define JOB_OTHERS "(otros)"
+
+/**
+ * @brief Versión del formato del datagrama; el monitor descarta las demás.
+ */
+#define JOB_METRICS_VERSION 1
+
+/**
+ * @brief Longitud máxima del nombre del comando, incluido el '\0'.
+ */
+#define JOB_COMMAND_LENGTH 64
+
+/**
+ * @struct job_metrics_datagram
+ * @brief Recursos consumidos por un trabajo terminado, según wait4().
+ */
+typedef struct
+{
+    uint32_t version;                 /**< JOB_METRICS_VERSION. */
+    int32_t exit_status;              /**< Código de salida del trabajo (128 + señal si terminó por una señal). */
+    uint64_t user_usec;               /**< Tiempo de CPU en modo usuario (microsegundos). */
+    uint64_t system_usec;             /**< Tiempo de CPU en modo sistema (microsegundos). */
+    uint64_t max_rss_kib;             /**< RSS máximo del mayor proceso del trabajo (KiB). */
+    uint64_t input_blocks;            /**< Bloques leídos del sistema de archivos. */
+    uint64_t output_blocks;           /**< Bloques escritos en el sistema de archivos. */
+    uint64_t voluntary_switches;      /**< Cambios de contexto voluntarios. */
+    uint64_t involuntary_switches;    /**< Cambios de contexto involuntarios. */
+    char command[JOB_COMMAND_LENGTH]; /**< Nombre del primer programa del trabajo, terminado en '\0'. */
+} job_metrics_datagram;
+
+/**
+ * @brief Devuelve la ruta del socket: la de JOB_METRICS_SOCKET_ENV si está definida, o JOB_METRICS_SOCKET.
+ */
+static inline const char* job_metrics_socket_path(void)
+{
+    const char* path = getenv(JOB_METRICS_SOCKET_ENV);
+    return path != NULL && *path != '\0' ? path : JOB_METRICS_SOCKET;
+}
+
+/**
+ * @brief Función del hilo que recibe los datagramas de la shell y actualiza las métricas de los trabajos.
+ *
+ * Crea el socket de job_metrics_socket_path() (reemplazando uno viejo, pero nunca otro tipo de archivo) con permisos
+ * solo para su dueño, y atiende datagramas hasta que falle la recepción.
+ *
+ * @param arg Argumento no utilizado.
+ * @return NULL
+ */
+void* receive_job_metrics(void* arg);
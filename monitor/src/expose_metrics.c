@@ -81,6 +81,56 @@ static prom_gauge_t* memory_avalible_metric;
  */
 static prom_gauge_t* memory_usage_2_metric;
 
+/**
+ * @brief Etiqueta de las métricas de los trabajos de la shell: el nombre del programa.
+ */
+static const char* job_label_keys[] = {"comando"};
+
+/**
+ * @brief Métrica de Prometheus para la cantidad de trabajos terminados de la shell.
+ */
+static prom_counter_t* jobs_metric;
+
+/**
+ * @brief Métrica de Prometheus para los trabajos de la shell que terminaron con error.
+ */
+static prom_counter_t* job_failures_metric;
+
+/**
+ * @brief Métrica de Prometheus para el tiempo de CPU en modo usuario de los trabajos.
+ */
+static prom_counter_t* job_user_seconds_metric;
+
+/**
+ * @brief Métrica de Prometheus para el tiempo de CPU en modo sistema de los trabajos.
+ */
+static prom_counter_t* job_system_seconds_metric;
+
+/**
+ * @brief Métrica de Prometheus para el RSS máximo del último trabajo de cada comando.
+ */
+static prom_gauge_t* job_max_rss_metric;
+
+/**
+ * @brief Métrica de Prometheus para los bloques leídos por los trabajos.
+ */
+static prom_counter_t* job_input_blocks_metric;
+
+/**
+ * @brief Métrica de Prometheus para los bloques escritos por los trabajos.
+ */
+static prom_counter_t* job_output_blocks_metric;
+
+/**
+ * @brief Métrica de Prometheus para los cambios de contexto voluntarios de los trabajos.
+ */
+static prom_counter_t* job_voluntary_switches_metric;
+
+/**
+ * @brief Métrica de Prometheus para los cambios de contexto involuntarios de los trabajos.
+ */
+static prom_counter_t* job_involuntary_switches_metric;
+
 /**
  * @brief Actualiza la métrica de memoria disponible.
  */
@@ -343,6 +393,169 @@ void* expose_metrics(void* arg)
     MHD_stop_daemon(daemon);
 }
 
+/**
+ * @brief Crea y registra las métricas de los trabajos de la shell, etiquetadas por comando.
+ */
+static void init_job_metrics()
+{
+    jobs_metric = prom_counter_new("shell_jobs_total", "Trabajos terminados de la shell", 1, job_label_keys);
+    job_failures_metric =
+        prom_counter_new("shell_job_failures_total", "Trabajos de la shell que terminaron con error", 1, job_label_keys);
+    job_user_seconds_metric = prom_counter_new("shell_job_user_seconds_total",
+                                               "Tiempo de CPU en modo usuario de los trabajos", 1, job_label_keys);
+    job_system_seconds_metric = prom_counter_new("shell_job_system_seconds_total",
+                                                 "Tiempo de CPU en modo sistema de los trabajos", 1, job_label_keys);
+    job_max_rss_metric =
+        prom_gauge_new("shell_job_max_rss_kib", "RSS máximo del último trabajo de cada comando", 1, job_label_keys);
+    job_input_blocks_metric = prom_counter_new("shell_job_input_blocks_total",
+                                               "Bloques leídos del sistema de archivos por los trabajos", 1,
+                                               job_label_keys);
+    job_output_blocks_metric = prom_counter_new("shell_job_output_blocks_total",
+                                                "Bloques escritos en el sistema de archivos por los trabajos", 1,
+                                                job_label_keys);
+    job_voluntary_switches_metric = prom_counter_new(
+        "shell_job_voluntary_switches_total", "Cambios de contexto voluntarios de los trabajos", 1, job_label_keys);
+    job_involuntary_switches_metric = prom_counter_new(
+        "shell_job_involuntary_switches_total", "Cambios de contexto involuntarios de los trabajos", 1, job_label_keys);
+
+    if (prom_collector_registry_must_register_metric(jobs_metric) == NULL ||
+        prom_collector_registry_must_register_metric(job_failures_metric) == NULL ||
+        prom_collector_registry_must_register_metric(job_user_seconds_metric) == NULL ||
+        prom_collector_registry_must_register_metric(job_system_seconds_metric) == NULL ||
+        prom_collector_registry_must_register_metric(job_max_rss_metric) == NULL ||
+        prom_collector_registry_must_register_metric(job_input_blocks_metric) == NULL ||
+        prom_collector_registry_must_register_metric(job_output_blocks_metric) == NULL ||
+        prom_collector_registry_must_register_metric(job_voluntary_switches_metric) == NULL ||
+        prom_collector_registry_must_register_metric(job_involuntary_switches_metric) == NULL)
+    {
+        fprintf(stderr, "Error al registrar las métricas de los trabajos\n");
+    }
+}
+
+/**
+ * @brief Reemplaza por '_' los caracteres del nombre de un comando que no conviene usar como valor de etiqueta.
+ */
+static void sanitize_job_label(char* command)
+{
+    for (char* c = command; *c != '\0'; c++)
+    {
+        if (!isalnum((unsigned char)*c) && strchr("._+-", *c) == NULL)
+            *c = '_';
+    }
+}
+
+/**
+ * @brief Comandos que ya tienen series propias; solo los usa el hilo de receive_job_metrics().
+ */
+static char job_commands[JOB_MAX_COMMANDS][JOB_COMMAND_LENGTH];
+static size_t num_job_commands = 0;
+
+/**
+ * @brief Devuelve la etiqueta de un comando: su nombre si ya tiene series o todavía hay lugar, o JOB_OTHERS.
+ *
+ * Cualquier proceso del usuario puede enviar datagramas, así que la cantidad de series no depende de lo que llegue.
+ */
+static const char* job_label(const char* command)
+{
+    for (size_t i = 0; i < num_job_commands; i++)
+    {
+        if (strcmp(job_commands[i], command) == 0)
+            return job_commands[i];
+    }
+    if (num_job_commands == JOB_MAX_COMMANDS)
+        return JOB_OTHERS;
+    strcpy(job_commands[num_job_commands], command);
+    return job_commands[num_job_commands++];
+}
+
+/**
+ * @brief Suma a las series de su comando los recursos informados por un datagrama.
+ */
+static void update_job_metrics(const job_metrics_datagram* datagram)
+{
+    const char* labels[] = {job_label(datagram->command)};
+    pthread_mutex_lock(&lock);
+    prom_counter_inc(jobs_metric, labels);
+    if (datagram->exit_status != 0)
+        prom_counter_inc(job_failures_metric, labels);
+    prom_counter_add(job_user_seconds_metric, (double)datagram->user_usec / 1e6, labels);
+    prom_counter_add(job_system_seconds_metric, (double)datagram->system_usec / 1e6, labels);
+    prom_gauge_set(job_max_rss_metric, (double)datagram->max_rss_kib, labels);
+    prom_counter_add(job_input_blocks_metric, (double)datagram->input_blocks, labels);
+    prom_counter_add(job_output_blocks_metric, (double)datagram->output_blocks, labels);
+    prom_counter_add(job_voluntary_switches_metric, (double)datagram->voluntary_switches, labels);
+    prom_counter_add(job_involuntary_switches_metric, (double)datagram->involuntary_switches, labels);
+    pthread_mutex_unlock(&lock);
+}
+
+/**
+ * @brief Recibe los datagramas de la shell con los recursos de cada trabajo terminado.
+ */
+void* receive_job_metrics(void* arg)
+{
+    (void)arg;
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        perror("Error al crear el socket de trabajos");
+        return NULL;
+    }
+
+    const char* path = job_metrics_socket_path();
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "Ruta del socket de trabajos demasiado larga: %s\n", path);
+        close(fd);
+        return NULL;
+    }
+    strcpy(addr.sun_path, path);
+
+    // Solo se reemplaza el socket de una ejecución anterior del monitor, nunca otro tipo de archivo
+    struct stat st;
+    if (lstat(path, &st) == 0 && !S_ISSOCK(st.st_mode))
+    {
+        fprintf(stderr, "El socket de trabajos %s ya existe y no es un socket\n", path);
+        close(fd);
+        return NULL;
+    }
+    unlink(path);
+
+    // Solo el dueño puede enviar datagramas: el socket se crea con permisos 0600 (ningún otro hilo crea archivos)
+    mode_t old_umask = umask(S_IRWXG | S_IRWXO | S_IXUSR);
+    int status = bind(fd, (struct sockaddr*)&addr, sizeof(addr));
+    umask(old_umask);
+    if (status == -1)
+    {
+        perror("Error al crear el socket de trabajos");
+        close(fd);
+        return NULL;
+    }
+
+    job_metrics_datagram datagram;
+    while (1)
+    {
+        ssize_t n = recv(fd, &datagram, sizeof(datagram), 0);
+        if (n == -1 && errno == EINTR)
+            continue;
+        if (n == -1)
+        {
+            perror("Error al recibir las métricas de un trabajo");
+            break;
+        }
+        if ((size_t)n != sizeof(datagram) || datagram.version != JOB_METRICS_VERSION)
+            continue; // Datagrama de otra versión de la shell
+        datagram.command[JOB_COMMAND_LENGTH - 1] = '\0';
+        sanitize_job_label(datagram.command);
+        update_job_metrics(&datagram);
+    }
+
+    close(fd);
+    return NULL;
+}
+
 /**
  * @brief Inicializa las métricas del sistema y registra las métricas de
  * Prometheus.
@@ -486,6 +699,8 @@ void init_metrics()
         fprintf(stderr, "Error al registrar las métricas\n");
         // return EXIT_FAILURE;
     }
+
+    init_job_metrics();
 }
 
 /**
@@ -44,6 +44,13 @@ int main(int argc, char* argv[])
         return EXIT_FAILURE; /**< Retorna fallo si la creación del hilo falla. */
     }
 
+    // Creamos un hilo para recibir los recursos de los trabajos que termina la shell
+    pthread_t jobs_tid; /**< Identificador del hilo que recibe las métricas de los trabajos. */
+    if (pthread_create(&jobs_tid, NULL, receive_job_metrics, NULL) != 0)
+    {
+        fprintf(stderr, "Error al crear el hilo de métricas de trabajos\n");
+    }
+
     // Bucle principal para actualizar las métricas cada segundo
     while (true)
     {
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Genera include/builtin_table.h: la tabla de hash perfecto de los comandos internos.
+
+Cada comando interno se identifica por la primera palabra de la línea. El script busca una semilla para la que el
+hash FNV-1a de todas las palabras cae en posiciones distintas de la tabla, de modo que una búsqueda cuesta un hash y
+una sola comparación. Para agregar un comando interno, sumarlo a BUILTINS y volver a ejecutar:
+
+    python3 scripts/gen_builtin_table.py > include/builtin_table.h
+"""
+
+import sys
+
+# (primera palabra, tipo de comando, función que valida la línea completa o None si acepta cualquier argumento)
+BUILTINS = [
+    ("quit", "CMD_QUIT", None),
+    ("cd", "CMD_CD", None),
+    ("clr", "CMD_CLR", None),
+    ("echo", "CMD_ECHO", None),
+    ("scan", "CMD_SCAN", None),
+    ("hash", "CMD_HASH", None),
+    ("jobs", "CMD_JOBS", None),
+    ("fg", "CMD_FG", None),
+    ("bg", "CMD_BG", None),
+    ("wait", "CMD_WAIT", None),
+    ("config", "CMD_CONFIG", "is_JSON_command"),
+    ("start_monitor", "CMD_MONITOR", "is_monitor_command"),
+    ("stop_monitor", "CMD_MONITOR", "is_monitor_command"),
+    ("status_monitor", "CMD_MONITOR", "is_monitor_command"),
+    ("expose", "CMD_MONITOR", "is_monitor_command"),
+    ("metrics", "CMD_MONITOR", "is_monitor_command"),
+    ("bench", "CMD_BENCH", None),
+    ("stats", "CMD_STATS", None),
+]
+
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+MASK = 0xFFFFFFFF
+
+
+def builtin_hash(word, seed):
+    """Debe coincidir con fnv1a32_from() de include/hash.h, con el que src/builtins.c busca en la tabla."""
+    h = FNV_OFFSET ^ seed
+    for byte in word.encode():
+        h ^= byte
+        h = (h * FNV_PRIME) & MASK
+    return h
+
+
+def builtin_slot(word, seed, bits):
+    """Posición en una tabla de 2^bits entradas: los bits altos del hash, que dependen de todos los bytes."""
+    return builtin_hash(word, seed) >> (32 - bits)
+
+
+def find_seed(words, bits):
+    """Devuelve la primera semilla sin colisiones para una tabla de 2^bits posiciones, o None."""
+    for seed in range(1 << 20):
+        slots = {builtin_slot(word, seed, bits) for word in words}
+        if len(slots) == len(words):
+            return seed
+    return None
+
+
+def main():
+    words = [name for name, _, _ in BUILTINS]
+    bits = 1
+    while (1 << bits) < len(words):
+        bits += 1
+    seed = None
+    while seed is None:
+        bits += 1
+        seed = find_seed(words, bits)
+
+    entries = sorted((builtin_slot(name, seed, bits), name, ctype, parser) for name, ctype, parser in BUILTINS)
+    out = sys.stdout
+    out.write("/* Archivo generado por scripts/gen_builtin_table.py: no editar a mano. */\n")
+    out.write("#ifndef BUILTIN_TABLE_H\n#define BUILTIN_TABLE_H\n\n")
+    out.write('#include "JSON_handler.h"      ///< is_JSON_command(), validador de `config`.\n')
+    out.write('#include "builtins.h"          ///< Tipo builtin.\n')
+    out.write('#include "command_processor.h" ///< is_monitor_command(), validador de los comandos del monitor.\n\n')
+    out.write("#define BUILTIN_HASH_SEED 0x%08xu // Semilla sin colisiones para las palabras de la tabla\n" % seed)
+    out.write("#define BUILTIN_HASH_BITS %d           // La tabla tiene 2^BUILTIN_HASH_BITS posiciones\n" % bits)
+    out.write("#define BUILTIN_TABLE_SIZE (1u << BUILTIN_HASH_BITS)\n\n")
+    out.write("/**\n * @brief Comandos internos, cada uno en la posición que le asigna builtin_hash().\n */\n")
+    out.write("static const builtin builtin_table[BUILTIN_TABLE_SIZE] = {\n")
+    for i, (slot, name, ctype, parser) in enumerate(entries):
+        sep = "," if i + 1 < len(entries) else "};"
+        out.write('    [%d] = {"%s", %d, %s, %s}%s\n' % (slot, name, len(name), ctype, parser or "NULL", sep))
+    out.write("\n#endif // BUILTIN_TABLE_H\n")
+
+
+if __name__ == "__main__":
+    main()
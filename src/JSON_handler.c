@@ -62,14 +62,14 @@ json_command_type parse_json_command(const char* command)
  * el tamaño máximo de cada métrica definido por `MAX_METRICA_LEN`.
  *
  * Las métricas predefinidas incluyen:
- * - "cpu_usage"
- * - "memory_usage"
- * - "disk_usage"
+ * - "cpu_usage_percentage"
+ * - "memory_usage_percentage"
+ * - "disk_usage_percentage"
  * - "network_usage"
  * - "bandwidth_usage"
  * - "major_page_faults"
  * - "minor_page_faults"
- * - "change_context"
+ * - "change_contexts"
  * - "total_processes"
  * - "memory_total"
  * - "memory_available"
@@ -80,11 +80,11 @@ json_command_type parse_json_command(const char* command)
  */
 void list_generator()
 {
-    // Lista de métricas predefinidas
-    const char* METRICAS_PREDEFINIDAS[] = {"cpu_usage",         "memory_usage",     "disk_usage",
-                                           "network_usage",     "bandwidth_usage",  "major_page_faults",
-                                           "minor_page_faults", "change_context",   "total_processes",
-                                           "memory_total",      "memory_available", "memory_usage_2"};
+    // Lista de métricas predefinidas: los nombres que exporta el monitor, que el wrapper compara enteros
+    const char* METRICAS_PREDEFINIDAS[] = {"cpu_usage_percentage", "memory_usage_percentage", "disk_usage_percentage",
+                                           "network_usage",        "bandwidth_usage",         "major_page_faults",
+                                           "minor_page_faults",    "change_contexts",         "total_processes",
+                                           "memory_total",         "memory_available",        "memory_usage_2"};
 
     size_t num_predefinidas = sizeof(METRICAS_PREDEFINIDAS) / sizeof(METRICAS_PREDEFINIDAS[0]);
 
@@ -133,6 +133,8 @@ Config* read_config(const char* filename)
     // Crear la estructura de configuración
     Config* config = (Config*)malloc(sizeof(Config));
     config->intervalo_muestreo = cJSON_GetObjectItem(json, "intervalo_muestreo")->valueint;
+    cJSON* timeout = cJSON_GetObjectItem(json, "timeout_ms");
+    config->timeout_ms = cJSON_IsNumber(timeout) ? timeout->valueint : 0;
 
     // Obtener la lista de métricas
     cJSON* metricas_json = cJSON_GetObjectItem(json, "metricas");
@@ -188,6 +190,8 @@ void update_config(const char* filename, Config* config)
         cJSON_AddItemToArray(metricas_json, cJSON_CreateString(config->metricas[i]));
     }
     cJSON_AddItemToObject(json, "metricas", metricas_json);
+    if (config->timeout_ms > 0)
+        cJSON_AddNumberToObject(json, "timeout_ms", config->timeout_ms); // Lo usa el wrapper: no se pierde al guardar
 
     // Guardar el JSON en el archivo
     FILE* file = fopen(filename, "w");
@@ -323,6 +327,14 @@ void print_config(const Config* config)
     }
 }
 
+/**
+ * @brief Indica si la línea corresponde a alguno de los comandos de configuración.
+ */
+bool is_JSON_command(const char* command)
+{
+    return parse_json_command(command) != CMD_INVALID;
+}
+
 /**
  * @brief Procesa comandos de configuración para la aplicación JSON.
  *
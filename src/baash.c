@@ -1,7 +1,63 @@
+#include "batch.h"
 #include "command_processor.h"
+#include "event_loop.h"
 #include "input_interface.h"
+#include "jobs.h"
+#include "line_reader.h"
+#include "shell_stats.h"
+#include <limits.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Interpreta la opción `-j N` (o `-jN`) de ejecución paralela de archivos batch.
+ *
+ * @param arg_index Posición del primer argumento; se avanza más allá de la opción si está presente.
+ * @return Cantidad de líneas a ejecutar en paralelo, 0 si no se pidió el modo paralelo o -1 si el valor no es válido.
+ */
+static int parse_jobs_option(int argc, char const* argv[], int* arg_index)
+{
+    if (*arg_index >= argc || strncmp(argv[*arg_index], "-j", 2) != 0)
+        return 0;
+
+    const char* value = argv[*arg_index] + 2;
+    (*arg_index)++;
+    if (*value == '\0')
+    {
+        if (*arg_index >= argc)
+            return -1;
+        value = argv[(*arg_index)++];
+    }
+
+    char* end;
+    long max_jobs = strtol(value, &end, 10);
+    if (*end != '\0' || max_jobs <= 0 || max_jobs > INT_MAX)
+        return -1;
+    return (int)max_jobs;
+}
+
+/**
+ * @brief Interpreta las opciones que preceden al archivo batch: `-j N` y `--no-cache`, en cualquier orden.
+ *
+ * @return 0 si las opciones son válidas, -1 en caso contrario.
+ */
+static int parse_options(int argc, char const* argv[], int* arg_index, int* max_jobs, bool* use_cache)
+{
+    while (*arg_index < argc && argv[*arg_index][0] == '-')
+    {
+        if (strcmp(argv[*arg_index], "--no-cache") == 0)
+        {
+            *use_cache = false;
+            (*arg_index)++;
+        }
+        else if ((*max_jobs = parse_jobs_option(argc, argv, arg_index)) <= 0)
+            return -1;
+    }
+    return 0;
+}
 
 /**
  * @brief Programa principal para el procesamiento de comandos.
@@ -10,34 +66,62 @@
  * desde un archivo si se proporciona como argumento, y permite al usuario
  * introducir comandos en modo interactivo.
  *
+ * Con `-j N archivo`, las líneas del archivo se ejecutan en paralelo de a N
+ * (ver batch.h) y el código de salida refleja la primera línea que falló.
+ * En modo secuencial el análisis del archivo se guarda en una caché (ver
+ * script_cache.h), salvo que se indique `--no-cache`.
+ *
  * @return int Código de salida del programa (0 si es exitoso).
  */
 int main(int argc, char const* argv[])
 {
+    int arg_index = 1;
+    int max_jobs = 0;
+    bool use_cache = true;
+    if (parse_options(argc, argv, &arg_index, &max_jobs, &use_cache) == -1 || (max_jobs > 0 && arg_index >= argc))
+    {
+        fprintf(stderr, "Uso: %s [-j N] [--no-cache] [archivo]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    line_reader batchfile;
+    bool batch_mode = arg_index < argc;
 
-    int unused = system("clear"); ///< Limpia la pantalla de la terminal al inicio.
-    (void)unused;                 // O simplemente no usar "unused" en ninguna otra parte
+    /* Solo una sesión interactiva en una terminal limpia la pantalla y muestra el encabezado; el prompt se arma
+     * recién al pedir la primera línea. */
+    if (!batch_mode && isatty(STDOUT_FILENO))
+        init_terminal();
 
-    /* Initialize variables for command line prompt and print header. */
-    init_terminal();
+    if (batch_mode && line_reader_open(&batchfile, argv[arg_index]) == -1)
+    {
+        fprintf(stderr, "Error opening file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* En modo paralelo cada línea corre en su propio proceso, sin el bucle de eventos compartido. */
+    if (max_jobs > 0)
+    {
+        int status = batch_run_parallel(&batchfile, max_jobs, STDOUT_FILENO);
+        line_reader_close(&batchfile);
+        exit(status);
+    }
+
+    /* Las señales y la finalización de hijos se atienden desde el bucle de eventos. */
+    if (event_loop_init() == -1)
+        perror("Error al inicializar el bucle de eventos");
+    setup_signal_handlers();
+
+    /* Con SHELL_STATS_SOCKET, las estadísticas internas se exportan desde el inicio (ver `stats --serve`). */
+    const char* stats_socket = getenv("SHELL_STATS_SOCKET");
+    if (stats_socket != NULL && *stats_socket != '\0')
+        stats_serve(stats_socket);
 
     /**
      * Si se proporciona un archivo batch como argumento, ejecuta los comandos dentro de él.
      */
-    if (argc >= 2)
+    if (batch_mode)
     {
-        FILE* batchfile = fopen(argv[1], "r");
-        if (batchfile == NULL)
-        {
-            fprintf(stderr, "Error opening file\n");
-            exit(EXIT_FAILURE);
-        }
-
-        char* command = (char*)malloc(sizeof(char) * COMMAND_BUFFER_SIZE);
-        while (fgets(command, COMMAND_BUFFER_SIZE, batchfile) != NULL)
-            execute_command(command);
-        fclose(batchfile);
-        free(command);
+        batch_run_file(&batchfile, argv[arg_index], use_cache);
         exit(EXIT_SUCCESS);
     }
 
@@ -46,6 +130,7 @@ int main(int argc, char const* argv[])
      */
     while (1)
     {
+        jobs_notify();                 // Informa los trabajos en segundo plano que terminaron antes del prompt
         char* command = get_command(); // La funcion get_comand() termina el programa en caso de error
         execute_command(command);      // la funcion execute_command() termina el programa si recibe "quit"
         // por lo tanto si bien es un bucle infinito, sigue habiendo control del proceso ante circunstancias
@@ -0,0 +1,352 @@
+#include "batch.h"
+#include "command_processor.h"
+#include "jobs.h"
+#include "line_reader.h"
+#include "script_cache.h"
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define COPY_BUFFER_SIZE 8192 // Tamaño del bloque con el que se copia la salida de cada línea
+
+/**
+ * @struct batch_line
+ * @brief Línea del archivo batch y el estado de su ejecución.
+ */
+typedef struct
+{
+    char* command; /**< Texto de la línea, sin el salto de línea. */
+    FILE* output;  /**< Archivo temporal con la salida de la línea, o NULL si no se lanzó. */
+    pid_t pid;     /**< Proceso que ejecuta la línea. */
+    int status;    /**< Código de salida de la línea. */
+    bool done;     /**< La línea terminó (o no pudo lanzarse). */
+} batch_line;
+
+/**
+ * @brief Indica si una línea no contiene comandos (vacía o comentario).
+ */
+static bool is_blank(const char* line)
+{
+    while (isspace((unsigned char)*line))
+        line++;
+    return *line == '\0' || *line == '#';
+}
+
+/**
+ * @brief Indica si una línea es una barrera (`wait`, con espacios opcionales alrededor).
+ */
+static bool is_barrier(const char* line)
+{
+    while (isspace((unsigned char)*line))
+        line++;
+    size_t len = strlen(BATCH_BARRIER);
+    if (strncmp(line, BATCH_BARRIER, len) != 0)
+        return false;
+    for (line += len; *line != '\0'; line++)
+    {
+        if (!isspace((unsigned char)*line))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Lanza un proceso hijo que ejecuta la línea con su salida redirigida a un archivo temporal.
+ *
+ * El hijo espera a sus propios trabajos en segundo plano antes de terminar, para que toda su salida quede en el
+ * archivo antes de copiarlo.
+ */
+static void launch_line(batch_line* line)
+{
+    line->output = tmpfile();
+    if (line->output == NULL)
+    {
+        perror("batch: archivo temporal");
+        line->status = EXIT_FAILURE;
+        line->done = true;
+        return;
+    }
+    fcntl(fileno(line->output), F_SETFD, FD_CLOEXEC);
+
+    // Lo que quede en los buffers del padre no debe duplicarse en el hijo
+    fflush(stdout);
+    fflush(stderr);
+
+    line->pid = fork();
+    if (line->pid == -1)
+    {
+        perror("batch: fork");
+        line->status = EXIT_FAILURE;
+        line->done = true;
+        return;
+    }
+
+    if (line->pid == 0)
+    {
+        int devnull = open("/dev/null", O_RDONLY);
+        if (devnull != -1)
+        {
+            dup2(devnull, STDIN_FILENO);
+            close(devnull);
+        }
+        dup2(fileno(line->output), STDOUT_FILENO);
+        dup2(fileno(line->output), STDERR_FILENO);
+
+        execute_command(line->command);
+        int status = get_last_exit_status();
+        jobs_wait_all();
+        fflush(stdout);
+        // exit() reposicionaría el archivo batch si se lee como flujo, y su desplazamiento se comparte con el padre
+        _exit(status);
+    }
+}
+
+/**
+ * @brief Copia la salida almacenada de una línea al descriptor de salida y libera el archivo temporal.
+ */
+static void flush_output(batch_line* line, int output_fd)
+{
+    if (line->output == NULL)
+        return;
+
+    int fd = fileno(line->output);
+    char buffer[COPY_BUFFER_SIZE];
+    ssize_t bytes_read;
+    lseek(fd, 0, SEEK_SET);
+    while ((bytes_read = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        ssize_t written = 0;
+        while (written < bytes_read)
+        {
+            ssize_t n = write(output_fd, buffer + written, (size_t)(bytes_read - written));
+            if (n == -1 && errno == EINTR)
+                continue;
+            if (n == -1)
+                break;
+            written += n;
+        }
+    }
+    fclose(line->output);
+    line->output = NULL;
+}
+
+/**
+ * @brief Ejecuta un grupo de líneas independientes con un máximo de `max_jobs` procesos a la vez.
+ *
+ * La salida de cada línea se escribe en cuanto terminaron ella y todas las anteriores.
+ *
+ * @return 0 si todas las líneas terminaron correctamente, o el código de la primera que falló.
+ */
+static int run_group(batch_line* lines, int num_lines, int max_jobs, int output_fd)
+{
+    int next = 0;    // Próxima línea a lanzar
+    int printed = 0; // Próxima línea cuya salida se escribe
+    int running = 0; // Procesos en ejecución
+    int result = 0;
+
+    while (printed < num_lines)
+    {
+        while (running < max_jobs && next < num_lines)
+        {
+            launch_line(&lines[next]);
+            if (!lines[next].done)
+                running++;
+            next++;
+        }
+
+        while (printed < num_lines && lines[printed].done)
+        {
+            flush_output(&lines[printed], output_fd);
+            if (result == 0)
+                result = lines[printed].status;
+            printed++;
+        }
+        if (running == 0)
+            continue;
+
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("batch: waitpid");
+            break;
+        }
+
+        for (int i = printed; i < next; i++)
+        {
+            if (!lines[i].done && lines[i].pid == pid)
+            {
+                lines[i].status = jobs_exit_code(status);
+                lines[i].done = true;
+                running--;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @struct batch_group
+ * @brief Líneas leídas desde la última barrera, pendientes de ejecutar.
+ */
+typedef struct
+{
+    batch_line* lines; /**< Líneas del grupo. */
+    int num_lines;     /**< Cantidad de líneas del grupo. */
+    int capacity;      /**< Capacidad del arreglo de líneas. */
+} batch_group;
+
+/**
+ * @brief Agrega una línea al grupo.
+ *
+ * @return 0 si la línea se agregó, -1 si no hay memoria.
+ */
+static int add_line(batch_group* group, const char* text)
+{
+    if (group->num_lines == group->capacity)
+    {
+        int new_capacity = group->capacity ? group->capacity * 2 : 16;
+        batch_line* new_lines = realloc(group->lines, (size_t)new_capacity * sizeof(batch_line));
+        if (new_lines == NULL)
+            return -1;
+        group->lines = new_lines;
+        group->capacity = new_capacity;
+    }
+
+    batch_line* line = &group->lines[group->num_lines];
+    memset(line, 0, sizeof(*line));
+    line->command = strdup(text);
+    if (line->command == NULL)
+        return -1;
+    group->num_lines++;
+    return 0;
+}
+
+/**
+ * @brief Libera las líneas del grupo y lo deja vacío para reutilizarlo.
+ */
+static void clear_group(batch_group* group)
+{
+    for (int i = 0; i < group->num_lines; i++)
+    {
+        free(group->lines[i].command);
+        if (group->lines[i].output != NULL)
+            fclose(group->lines[i].output);
+    }
+    group->num_lines = 0;
+}
+
+/**
+ * @brief Ejecuta las líneas acumuladas del grupo, suma sus resultados al total y vacía el grupo.
+ */
+static void run_pending(batch_group* group, int max_jobs, int output_fd, int* result, int* failed, int* total)
+{
+    int status = run_group(group->lines, group->num_lines, max_jobs, output_fd);
+    if (*result == 0)
+        *result = status;
+    for (int i = 0; i < group->num_lines; i++)
+        *failed += group->lines[i].status != 0;
+    *total += group->num_lines;
+    clear_group(group);
+}
+
+/**
+ * @brief Lee el archivo por grupos separados por barreras y ejecuta cada grupo en paralelo.
+ *
+ * @return 0 si todas las líneas terminaron correctamente, o el código de la primera que falló.
+ */
+int batch_run_parallel(line_reader* script, int max_jobs, int output_fd)
+{
+    batch_group group = {NULL, 0, 0};
+    int result = 0;
+    int failed = 0;
+    int total = 0;
+
+    char* text;
+    while ((text = line_reader_next(script, NULL)) != NULL)
+    {
+        if (is_blank(text))
+            continue;
+
+        if (is_barrier(text))
+        {
+            run_pending(&group, max_jobs, output_fd, &result, &failed, &total);
+        }
+        else if (add_line(&group, text) == -1)
+        {
+            perror("batch");
+            break; // Se ejecuta lo ya leído y se termina
+        }
+    }
+    run_pending(&group, max_jobs, output_fd, &result, &failed, &total);
+
+    free(group.lines);
+
+    if (failed > 0)
+        fprintf(stderr, "batch: %d de %d líneas fallaron\n", failed, total);
+    return result;
+}
+
+/**
+ * @brief Guarda la caché construida y libera el constructor.
+ */
+static void finish_cache(script_cache_builder* builder)
+{
+    script_cache_commit(builder);
+    script_cache_builder_free(builder);
+}
+
+/**
+ * @brief Ejecuta las líneas desde la caché, o las prepara, las registra y las ejecuta de a una.
+ */
+void batch_run_file(line_reader* script, const char* path, bool use_cache)
+{
+    script_cache cache;
+    if (use_cache && script_cache_load(&cache, path) == 0)
+    {
+        line_reader_close(script);
+        for (int i = 0; i < cache.num_lines; i++)
+        {
+            cached_line* line = &cache.lines[i];
+            if (line->reparse)
+                execute_command(line->text);
+            else
+                execute_prepared_command(line->text, &line->prepared);
+        }
+        script_cache_close(&cache);
+        return;
+    }
+
+    script_cache_builder builder;
+    bool building = use_cache && script_cache_builder_init(&builder, path) == 0;
+    char* command;
+    while ((command = line_reader_next(script, NULL)) != NULL)
+    {
+        prepared_command prepared;
+        prepare_command(command, &prepared);
+        if (building)
+            script_cache_record(&builder, command, &prepared);
+        if (building && prepared.type == CMD_QUIT)
+        {
+            // `quit` termina el proceso: la caché se guarda antes, con las líneas leídas hasta acá
+            finish_cache(&builder);
+            building = false;
+        }
+        execute_prepared_command(command, &prepared);
+        free_prepared_command(&prepared);
+    }
+    line_reader_close(script);
+
+    if (building)
+        finish_cache(&builder);
+}
@@ -0,0 +1,66 @@
+#include "builtins.h"
+#include "builtin_table.h"
+#include "hash.h"
+#include "parser.h"
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Compara el nombre con la única entrada de la tabla en la que podría estar.
+ */
+static const builtin* probe(const char* name, size_t length, uint32_t hash)
+{
+    const builtin* entry = &builtin_table[hash >> (32 - BUILTIN_HASH_BITS)];
+    if (entry->name == NULL || entry->length != length || memcmp(entry->name, name, length) != 0)
+        return NULL;
+    return entry;
+}
+
+/**
+ * @brief Calcula el hash del nombre y lo busca en la tabla.
+ */
+const builtin* find_builtin(const char* name, size_t length)
+{
+    return probe(name, length, fnv1a32_from(FNV1A32_OFFSET ^ BUILTIN_HASH_SEED, name, length));
+}
+
+/**
+ * @brief Calcula el hash mientras recorre la primera palabra, sin copiarla.
+ */
+command_type lookup_builtin(const char* line)
+{
+    const char* word = line;
+    while (*word == ' ' || *word == '\t' || *word == '\n')
+        word++;
+
+    uint32_t hash = FNV1A32_OFFSET ^ BUILTIN_HASH_SEED;
+    size_t length = 0;
+    for (; !parser_is_word_end(word[length]); length++)
+        hash = fnv1a32_step(hash, word[length]); // Igual que builtin_hash() de scripts/gen_builtin_table.py
+    if (length == 0)
+        return CMD_EXTERNAL;
+
+    const builtin* entry = probe(word, length, hash);
+    if (entry == NULL || (entry->parse_args != NULL && !entry->parse_args(line)))
+        return CMD_EXTERNAL;
+    return entry->type;
+}
+
+/**
+ * @brief Aplica al hash la cantidad de tipos y, por cada posición ocupada, su índice, nombre, tipo y si valida.
+ */
+uint64_t builtin_table_identity(void)
+{
+    uint32_t last = CMD_LAST;
+    uint64_t hash = fnv1a64_from(FNV1A64_OFFSET, &last, sizeof(last));
+    for (uint32_t slot = 0; slot < BUILTIN_TABLE_SIZE; slot++)
+    {
+        const builtin* entry = &builtin_table[slot];
+        if (entry->name == NULL)
+            continue;
+        uint32_t fields[3] = {slot, (uint32_t)entry->type, entry->parse_args != NULL};
+        hash = fnv1a64_from(hash, fields, sizeof(fields));
+        hash = fnv1a64_from(hash, entry->name, entry->length);
+    }
+    return hash;
+}
@@ -0,0 +1,397 @@
+#include "command_bench.h"
+#include "jobs.h"
+#include "parser.h"
+#include <cjson/cJSON.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_BENCH_RUNS 100000 // Máximo de ejecuciones aceptado por -n y -w
+
+/**
+ * @struct bench_sample
+ * @brief Medición de una ejecución.
+ */
+typedef struct
+{
+    double wall;         /**< Tiempo real en segundos. */
+    struct rusage usage; /**< Recursos informados por wait4(). */
+} bench_sample;
+
+/**
+ * @struct bench_summary
+ * @brief Estadísticas de todas las ejecuciones medidas.
+ */
+typedef struct
+{
+    size_t count;       /**< Ejecuciones medidas. */
+    int failed;         /**< Ejecuciones con código de salida distinto de 0. */
+    double min;         /**< Tiempo real mínimo (ms). */
+    double median;      /**< Mediana del tiempo real (ms). */
+    double p95;         /**< Percentil 95 del tiempo real (ms). */
+    double p99;         /**< Percentil 99 del tiempo real (ms). */
+    double max;         /**< Tiempo real máximo (ms). */
+    double mean;        /**< Media del tiempo real (ms). */
+    double stddev;      /**< Desvío estándar muestral del tiempo real (ms). */
+    double user;        /**< Media del tiempo de usuario (ms). */
+    double system;      /**< Media del tiempo de sistema (ms). */
+    long max_rss;       /**< Mayor RSS máximo entre las ejecuciones (KiB). */
+    double voluntary;   /**< Media de cambios de contexto voluntarios. */
+    double involuntary; /**< Media de cambios de contexto involuntarios. */
+} bench_summary;
+
+/**
+ * @brief Devuelve el tiempo monotónico actual en segundos.
+ */
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Convierte un timeval en milisegundos.
+ */
+static double timeval_ms(const struct timeval* tv)
+{
+    return (double)tv->tv_sec * 1e3 + (double)tv->tv_usec / 1e3;
+}
+
+/**
+ * @brief Lee el valor numérico de -n o -w.
+ *
+ * @return El valor, o -1 si falta o no es un entero entre `min` y MAX_BENCH_RUNS.
+ */
+static int parse_count(const char* text, int min)
+{
+    char* end;
+    errno = 0;
+    long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || value < min || value > MAX_BENCH_RUNS)
+        return -1;
+    return (int)value;
+}
+
+/**
+ * @brief Busca dónde empieza el comando: después de `--` o en la primera palabra que no es una opción.
+ *
+ * Las opciones todavía no se validan; solo se saltea el valor de `-n` y de `-w`.
+ */
+static const char* find_command_start(const char* args)
+{
+    const char* p = args;
+    for (;;)
+    {
+        p += strspn(p, " ");
+        size_t length = strcspn(p, " ");
+        if (length == 0 || p[0] != '-')
+            return p; // Fin de la línea o primera palabra del comando
+        if (length == 2 && p[1] == '-')
+            return p + length + strspn(p + length, " ");
+        p += length;
+        if (length == 2 && (p[-1] == 'n' || p[-1] == 'w'))
+        {
+            p += strspn(p, " ");
+            p += strcspn(p, " ");
+        }
+    }
+}
+
+/**
+ * @brief Aplica las opciones ya separadas en palabras (y con sus variables expandidas).
+ *
+ * @return 0 si son válidas, -1 si no (el error se informa en stderr).
+ */
+static int apply_options(char* const argv[], bench_options* options)
+{
+    for (int i = 0; argv[i] != NULL; i++)
+    {
+        const char* word = argv[i];
+        if (strcmp(word, "-n") == 0 || strcmp(word, "-w") == 0)
+        {
+            int min = word[1] == 'n' ? 1 : 0;
+            int count = argv[i + 1] != NULL ? parse_count(argv[++i], min) : -1;
+            if (count == -1)
+            {
+                fprintf(stderr, "bench: %s requiere un número entre %d y %d\n", word, min, MAX_BENCH_RUNS);
+                return -1;
+            }
+            if (word[1] == 'n')
+                options->runs = count;
+            else
+                options->warmup = count;
+        }
+        else if (strcmp(word, "--json") == 0)
+        {
+            options->json = true;
+        }
+        else if (strcmp(word, "--show-output") == 0)
+        {
+            options->show_output = true;
+        }
+        else if (strcmp(word, "--") != 0)
+        {
+            fprintf(stderr, "bench: opción desconocida '%s'\n", word);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Interpreta los argumentos de `bench`.
+ */
+int bench_parse_options(const char* args, bench_options* options)
+{
+    options->runs = BENCH_DEFAULT_RUNS;
+    options->warmup = BENCH_DEFAULT_WARMUP;
+    options->json = false;
+    options->show_output = false;
+    options->command = NULL;
+
+    const char* p = args != NULL ? args : "";
+    const char* command = find_command_start(p);
+    if (*command == '\0')
+    {
+        fprintf(stderr, "uso: bench [-n ejecuciones] [-w calentamiento] [--json] [--show-output] -- comando\n");
+        return -1;
+    }
+
+    // Las opciones se separan y se expanden como cualquier otra línea (`-n $RUNS`); el comando se analiza al medirlo
+    char* text = strndup(p, (size_t)(command - p));
+    if (text == NULL)
+    {
+        perror("bench");
+        return -1;
+    }
+    command_list list;
+    parse_status status = parse_command_line(text, &list);
+    free(text);
+    if (status != PARSE_OK)
+    {
+        if (status == PARSE_UNSUPPORTED)
+            fprintf(stderr, "bench: opciones no válidas\n");
+        return -1;
+    }
+
+    int result = 0;
+    if (list.num_pipelines > 1 || (list.num_pipelines == 1 && (list.pipelines[0].num_commands != 1 ||
+                                                               list.pipelines[0].commands[0].num_redirections > 0)))
+    {
+        fprintf(stderr, "bench: opciones no válidas\n");
+        result = -1;
+    }
+    else if (list.num_pipelines == 1)
+    {
+        result = apply_options(list.pipelines[0].commands[0].argv, options);
+    }
+    free_command_list(&list);
+    if (result == 0)
+        options->command = command;
+    return result;
+}
+
+/**
+ * @brief Percentil por rango más cercano de un arreglo ordenado.
+ */
+double bench_percentile(const double* sorted, size_t count, double percentile)
+{
+    size_t rank = (size_t)ceil(percentile / 100.0 * (double)count);
+    if (rank == 0)
+        rank = 1;
+    if (rank > count)
+        rank = count;
+    return sorted[rank - 1];
+}
+
+/**
+ * @brief Compara dos tiempos para qsort().
+ */
+static int compare_doubles(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Calcula las estadísticas de las ejecuciones medidas.
+ *
+ * @return 0 si se calcularon, -1 si no hay memoria.
+ */
+static int summarize(const bench_sample* samples, size_t count, bench_summary* summary)
+{
+    double* walls = malloc(count * sizeof(double));
+    if (walls == NULL)
+        return -1;
+
+    memset(summary, 0, sizeof(*summary));
+    summary->count = count;
+    double sum = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        walls[i] = samples[i].wall * 1e3;
+        sum += walls[i];
+        summary->user += timeval_ms(&samples[i].usage.ru_utime);
+        summary->system += timeval_ms(&samples[i].usage.ru_stime);
+        summary->voluntary += (double)samples[i].usage.ru_nvcsw;
+        summary->involuntary += (double)samples[i].usage.ru_nivcsw;
+        if (samples[i].usage.ru_maxrss > summary->max_rss)
+            summary->max_rss = samples[i].usage.ru_maxrss;
+    }
+    qsort(walls, count, sizeof(double), compare_doubles);
+
+    summary->mean = sum / (double)count;
+    double squares = 0;
+    for (size_t i = 0; i < count; i++)
+        squares += (walls[i] - summary->mean) * (walls[i] - summary->mean);
+    summary->stddev = count > 1 ? sqrt(squares / (double)(count - 1)) : 0;
+    summary->min = walls[0];
+    summary->max = walls[count - 1];
+    summary->median = count % 2 ? walls[count / 2] : (walls[count / 2 - 1] + walls[count / 2]) / 2;
+    summary->p95 = bench_percentile(walls, count, 95);
+    summary->p99 = bench_percentile(walls, count, 99);
+    summary->user /= (double)count;
+    summary->system /= (double)count;
+    summary->voluntary /= (double)count;
+    summary->involuntary /= (double)count;
+    free(walls);
+    return 0;
+}
+
+/**
+ * @brief Escribe el informe en texto.
+ */
+static void print_summary(FILE* out, const bench_options* options, const bench_summary* s)
+{
+    fprintf(out, "Comando: %s\n", options->command);
+    fprintf(out, "Ejecuciones: %zu medidas, %d de calentamiento", s->count, options->warmup);
+    if (s->failed > 0)
+        fprintf(out, ", %d con error", s->failed);
+    fprintf(out, "\n");
+    fprintf(out, "Tiempo real:   %.3f ms ± %.3f ms (media ± desvío)\n", s->mean, s->stddev);
+    fprintf(out, "               mín %.3f ms, mediana %.3f ms, p95 %.3f ms, p99 %.3f ms, máx %.3f ms\n", s->min,
+            s->median, s->p95, s->p99, s->max);
+    fprintf(out, "CPU (media):   usuario %.3f ms, sistema %.3f ms\n", s->user, s->system);
+    fprintf(out, "RSS máximo:    %ld KiB\n", s->max_rss);
+    fprintf(out, "Cambios de contexto (media): %.1f voluntarios, %.1f involuntarios\n", s->voluntary, s->involuntary);
+}
+
+/**
+ * @brief Escribe el informe en JSON.
+ */
+static void print_summary_json(FILE* out, const bench_options* options, const bench_summary* s)
+{
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddItemToObject(json, "comando", cJSON_CreateString(options->command));
+    cJSON_AddNumberToObject(json, "ejecuciones", (double)s->count);
+    cJSON_AddNumberToObject(json, "calentamiento", options->warmup);
+    cJSON_AddNumberToObject(json, "fallidas", s->failed);
+
+    cJSON* wall = cJSON_CreateObject();
+    cJSON_AddNumberToObject(wall, "media", s->mean);
+    cJSON_AddNumberToObject(wall, "desvio", s->stddev);
+    cJSON_AddNumberToObject(wall, "min", s->min);
+    cJSON_AddNumberToObject(wall, "mediana", s->median);
+    cJSON_AddNumberToObject(wall, "p95", s->p95);
+    cJSON_AddNumberToObject(wall, "p99", s->p99);
+    cJSON_AddNumberToObject(wall, "max", s->max);
+    cJSON_AddItemToObject(json, "tiempo_real_ms", wall);
+
+    cJSON_AddNumberToObject(json, "usuario_ms", s->user);
+    cJSON_AddNumberToObject(json, "sistema_ms", s->system);
+    cJSON_AddNumberToObject(json, "rss_max_kib", (double)s->max_rss);
+    cJSON_AddNumberToObject(json, "cambios_contexto_voluntarios", s->voluntary);
+    cJSON_AddNumberToObject(json, "cambios_contexto_involuntarios", s->involuntary);
+
+    char* string = cJSON_Print(json);
+    if (string != NULL)
+        fprintf(out, "%s\n", string);
+    free(string);
+    cJSON_Delete(json);
+}
+
+/**
+ * @brief Indica si un código de salida corresponde a un comando interrumpido con Ctrl-C o detenido con Ctrl-Z.
+ */
+static bool interrupted(int status)
+{
+    return status == SIGNAL_EXIT_BASE + SIGINT || status == SIGNAL_EXIT_BASE + SIGTSTP;
+}
+
+/**
+ * @brief Mide un comando e informa las estadísticas de sus ejecuciones.
+ */
+int bench_command(const bench_options* options, bench_run_function run, void* data, FILE* out)
+{
+    bench_sample* samples = malloc((size_t)options->runs * sizeof(bench_sample));
+    if (samples == NULL)
+    {
+        perror("bench");
+        return EXIT_FAILURE;
+    }
+
+    // La salida del comando se descarta para no medir la terminal
+    int saved_stdout = -1;
+    fflush(out);
+    fflush(stdout);
+    if (!options->show_output)
+    {
+        int null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+        saved_stdout = null_fd != -1 ? fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 0) : -1;
+        if (saved_stdout != -1)
+            dup2(null_fd, STDOUT_FILENO);
+        if (null_fd != -1)
+            close(null_fd);
+    }
+
+    int status = 0;
+    int failed = 0;
+    size_t count = 0;
+    bool stop = false;
+    for (int i = 0; i < options->warmup && !stop; i++)
+    {
+        struct rusage usage;
+        stop = interrupted(run(options->command, data, &usage));
+    }
+    for (int i = 0; i < options->runs && !stop; i++)
+    {
+        double start = now_seconds();
+        int run_status = run(options->command, data, &samples[count].usage);
+        samples[count].wall = now_seconds() - start;
+        count++;
+        if (run_status != 0)
+        {
+            status = run_status;
+            failed++;
+        }
+        stop = interrupted(run_status);
+    }
+
+    if (saved_stdout != -1)
+    {
+        fflush(stdout);
+        dup2(saved_stdout, STDOUT_FILENO);
+        close(saved_stdout);
+    }
+
+    bench_summary summary;
+    if (stop)
+        fprintf(stderr, "bench: medición interrumpida después de %zu ejecuciones\n", count);
+    if (count > 0 && summarize(samples, count, &summary) == 0)
+    {
+        summary.failed = failed;
+        if (options->json)
+            print_summary_json(out, options, &summary);
+        else
+            print_summary(out, options, &summary);
+    }
+    free(samples);
+    return status;
+}
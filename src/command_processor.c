@@ -1,7 +1,20 @@
 #include "command_processor.h"
 #include "JSON_handler.h"
+#include "builtins.h"
+#include "command_bench.h"
+#include "config_filter.h"
+#include "config_index.h"
+#include "config_scan.h"
+#include "event_loop.h"
+#include "executor.h"
+#include "input_interface.h"
+#include "jobs.h"
 #include "metric_handler.h"
-#include <dirent.h>
+#include "metrics_shm.h"
+#include "parser.h"
+#include "path_cache.h"
+#include "shell_stats.h"
+#include <errno.h>
 #include <fcntl.h>
 #include <signal.h>
 #include <stdbool.h>
@@ -13,59 +26,14 @@
 #include <sys/wait.h>
 #include <unistd.h>
 
-#define BACKGROUND 4
 #define BUFFER_SIZE 1024
+#define BUILTIN_NAME_SIZE 32 // Tamaño del nombre de un comando interno en las estadísticas
+#define METRICS_POLL_MS 250  // Cada cuánto `expose metrics realtime` busca una trama nueva
 
-int flags[BACKGROUND] = {0};
-int job_bg[BACKGROUND] = {0};
-int pid_bg[BACKGROUND] = {0};
-int job_ID = 0;
-int background_flag = 0;
 volatile bool realtime = false;
-pid_t foreground_pid = -1;
+static int last_exit_status = 0; // Código de salida del último comando ejecutado
 Config* conf = NULL; // Inicializado a NULL
 
-/**
- * @enum command_type
- * @brief Enumeración de los tipos de comandos principales soportados.
- *
- * Define los tipos de comandos reconocidos por la función `execute_command`.
- */
-typedef enum
-{
-    CMD_QUIT,     /**< Comando para salir del programa. */
-    CMD_CD,       /**< Comando para cambiar el directorio actual. */
-    CMD_CLR,      /**< Comando para limpiar la pantalla. */
-    CMD_ECHO,     /**< Comando para imprimir texto o valores. */
-    CMD_EXTERNAL, /**< Comando externo no reconocido internamente. */
-    CMD_SCAN      /**< Comando para buscar configuraciones recursivamente. */
-} command_type;
-
-/**
- * @brief Mapea un comando base a su tipo correspondiente.
- *
- * Esta función analiza el comando base proporcionado como cadena y lo mapea
- * al tipo definido en la enumeración @ref command_type.
- *
- * @return El tipo de comando correspondiente de la enumeración @ref command_type.
- *         Si el comando no coincide con ninguno de los tipos predefinidos,
- *         devuelve CMD_EXTERNAL.
- */
-command_type parse_command(const char* cmd)
-{
-    if (strcmp(cmd, "quit") == 0)
-        return CMD_QUIT;
-    if (strcmp(cmd, "cd") == 0)
-        return CMD_CD;
-    if (strcmp(cmd, "clr") == 0)
-        return CMD_CLR;
-    if (strcmp(cmd, "echo") == 0)
-        return CMD_ECHO;
-    if (strcmp(cmd, "scan") == 0)
-        return CMD_SCAN;
-    return CMD_EXTERNAL; // Por defecto, cualquier otro comando se trata como externo
-}
-
 /**
  * @brief Obtiene la configuración desde un archivo JSON.
  *
@@ -90,32 +58,37 @@ Config* get_config()
 /**
  * @brief Determina si el comando debe ejecutarse en segundo plano.
  *
- * Si el comando contiene '&' al final, se establece el indicador de segundo plano.
+ * Si el comando termina en '&' (y no en "&&"), lo quita de la cadena.
  *
+ * @return true si el comando debe ejecutarse en segundo plano.
  */
-static void get_flag(char* command)
+static bool get_flag(char* command)
 {
-    if (strrchr(command, '&'))
+    size_t len = strlen(command);
+    while (len > 0 && (command[len - 1] == ' ' || command[len - 1] == '\t'))
+        len--;
+    if (len > 0 && command[len - 1] == '&' && (len < 2 || command[len - 2] != '&'))
     {
-        background_flag = 1;
-        command[strcspn(command, "&")] = '\0';
+        command[len - 1] = '\0';
+        return true;
     }
+    return false;
 }
 
 /**
  * @brief Manejador de la señal SIGINT (Ctrl-C).
  *
- * Si existe un proceso en primer plano, envía SIGINT a ese proceso. Si el modo en tiempo real está activo, lo
- * desactiva.
+ * Si existe un trabajo en primer plano, envía SIGINT a todo su grupo de procesos. Si el modo en tiempo real está
+ * activo, lo desactiva.
  *
  */
 void ctrl_c_Handler(int sig)
 {
     (void)sig;
-    if (foreground_pid > 0)
+    pid_t pgid = jobs_foreground_pgid();
+    if (pgid > 0)
     {
-        kill(foreground_pid, SIGINT); // Envía SIGINT solo al proceso en primer plano
-        foreground_pid = -1;          // Reinicia foreground_pid después de terminar el proceso
+        kill(-pgid, SIGINT); // Envía SIGINT solo a las etapas del trabajo en primer plano
     }
     else if (realtime)
     {
@@ -126,18 +99,17 @@ void ctrl_c_Handler(int sig)
 /**
  * @brief Manejador de la señal SIGTSTP (Ctrl-Z).
  *
- * Envía la señal SIGTSTP al proceso en primer plano.
+ * Envía la señal SIGTSTP al grupo de procesos del trabajo en primer plano.
  *
  */
 void ctrl_z_Handler(int sig)
 {
     (void)sig;
-
-    if (foreground_pid > 0)
+    pid_t pgid = jobs_foreground_pgid();
+    if (pgid > 0)
     {
-        // Enviar la señal al proceso en primer plano
-        kill(foreground_pid, SIGTSTP);
-        foreground_pid = -1;
+        // Al detenerse, la espera del trabajo lo pasa a segundo plano
+        kill(-pgid, SIGTSTP);
     }
 }
 
@@ -153,24 +125,6 @@ void sigquit_Handler(int sig)
     // ignora la señal
 }
 
-/**
- * @brief Manejador para la señal SIGCHLD.
- *
- * Verifica si alguno de los trabajos en segundo plano ha finalizado y actualiza sus indicadores.
- */
-static void CHLD_Handler()
-{
-    pid_t pid;
-    for (int i = 0; i < BACKGROUND; i++)
-    {
-        if ((pid = waitpid(-1, NULL, WNOHANG)) == pid_bg[i] && pid_bg[i] != 0)
-        {
-            flags[i] = 1;
-            break;
-        }
-    }
-}
-
 /**
  * @brief Obtiene el directorio de trabajo actual.
  *
@@ -201,232 +155,431 @@ char* get_cwd()
     return buffer;
 }
 /**
- * @brief Ejecuta un comando externo con soporte para redirección y tuberías.
+ * @brief Bloquea SIGCHLD para que ningún proceso se recolecte antes de quedar registrado en la tabla de trabajos.
+ */
+static void block_sigchld(sigset_t* old_mask)
+{
+    sigset_t block;
+    sigemptyset(&block);
+    sigaddset(&block, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &block, old_mask);
+}
+
+/**
+ * @brief Registra los procesos recién lanzados como un trabajo y lo espera si corre en primer plano.
  *
- * Esta función maneja la ejecución de comandos con redirección de entrada/salida, ejecución en segundo plano y
- * tuberías.
+ * Debe llamarse con SIGCHLD bloqueada desde antes de lanzar los procesos.
+ */
+static void run_job(const pid_t* pids, int num_pids, pid_t pgid, const char* text, bool background)
+{
+    if (num_pids == 0)
+    {
+        last_exit_status = COMMAND_NOT_FOUND_STATUS; // No se pudo lanzar ninguna etapa
+        return;
+    }
+
+    job* j = jobs_add(pids, num_pids, pgid, text, background);
+    if (j == NULL)
+    {
+        perror("Error al registrar el trabajo");
+        last_exit_status = EXIT_FAILURE;
+        return;
+    }
+
+    if (background)
+    {
+        printf("[%d] %d\n", j->id, pids[num_pids - 1]);
+        last_exit_status = 0;
+    }
+    else
+    {
+        last_exit_status = jobs_wait(j, true);
+    }
+}
+
+/**
+ * @brief Ejecuta mediante /bin/sh una línea con construcciones que el parser no interpreta.
+ */
+static void run_with_system_shell(char* command)
+{
+    bool background = get_flag(command);
+    stats_count_command(STATS_EXTERNAL, "sh");
+    sigset_t old_mask;
+    block_sigchld(&old_mask);
+    pid_t pid = spawn_shell(command, -1, -1, 0);
+    int terminal_fd = background ? -1 : jobs_terminal_fd();
+    if (pid > 0 && terminal_fd != -1)
+        tcsetpgrp(terminal_fd, pid); // La terminal se cede antes de que el comando pueda usarla
+    run_job(&pid, pid > 0 ? 1 : 0, pid, command, background);
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+}
+
+/**
+ * @brief Devuelve el flujo con el que un comando interno escribe en el descriptor de su etapa.
+ *
+ * Para stdout se usa el propio flujo de la shell, así la salida no se adelanta a lo que quede en su buffer.
  *
+ * @return El flujo, o NULL si no pudo abrirse.
  */
-void external_command(char* command)
+static FILE* open_stage_output(int output_fd)
+{
+    if (output_fd == STDOUT_FILENO)
+        return stdout;
+
+    int fd = fcntl(output_fd, F_DUPFD_CLOEXEC, 0);
+    FILE* stream = fd != -1 ? fdopen(fd, "w") : NULL;
+    if (stream == NULL)
+    {
+        perror("Error al abrir la salida");
+        if (fd != -1)
+            close(fd);
+    }
+    return stream;
+}
+
+/**
+ * @brief Vacía y cierra el flujo abierto con open_stage_output().
+ *
+ * @return 0 si toda la salida se escribió, EXIT_FAILURE si no (por ejemplo, si el lector de la tubería terminó).
+ */
+static int close_stage_output(FILE* stream)
+{
+    if (stream != stdout)
+        return fclose(stream) == 0 ? 0 : EXIT_FAILURE;
+
+    int status = fflush(stdout) == 0 && !ferror(stdout) ? 0 : EXIT_FAILURE;
+    clearerr(stdout); // Un error de escritura de este comando no afecta a los siguientes
+    return status;
+}
+
+/**
+ * @brief Comando interno `echo`: escribe sus argumentos separados por espacios; con `-n`, sin salto de línea final.
+ */
+static int echo_builtin(char* const argv[], int output_fd)
 {
+    int first = 1;
+    bool newline = true;
+    if (argv[first] != NULL && strcmp(argv[first], "-n") == 0)
+    {
+        newline = false;
+        first++;
+    }
 
-    get_flag(command);
+    FILE* out = open_stage_output(output_fd);
+    if (out == NULL)
+        return EXIT_FAILURE;
+    for (int i = first; argv[i] != NULL; i++)
+    {
+        if (i > first)
+            fputc(' ', out);
+        fputs(argv[i], out);
+    }
+    if (newline)
+        fputc('\n', out);
+    return close_stage_output(out);
+}
 
-    int pipe_flag = 0;
-    char* pipe_token = strchr(command, '|');
-    if (pipe_token != NULL)
+/**
+ * @brief Comando interno `jobs`: lista los trabajos activos; con `-l`, también sus PIDs y recursos consumidos.
+ */
+static int jobs_builtin(char* const argv[], int output_fd)
+{
+    bool long_format = argv[1] != NULL && strcmp(argv[1], "-l") == 0;
+    if (argv[1] != NULL && !long_format)
     {
-        pipe_flag = 1;
-        *pipe_token = '\0'; // Split command into two parts at the pipe symbol
+        fprintf(stderr, "jobs: opción desconocida '%s' (use -l)\n", argv[1]);
+        return EXIT_FAILURE;
     }
 
-    int input_fd = -1;
-    int output_fd = -1;
+    FILE* out = open_stage_output(output_fd);
+    if (out == NULL)
+        return EXIT_FAILURE;
+    jobs_print(out, long_format);
+    return close_stage_output(out);
+}
 
-    // Handle input redirection
-    char* input_token = strchr(command, '<');
-    if (input_token != NULL)
+/**
+ * @brief Comando interno `hash`: consulta o modifica la tabla de rutas de comandos.
+ *
+ * Sin argumentos lista la tabla; `hash -r` la vacía; `hash -d nombre...` olvida los comandos indicados y
+ * `hash nombre...` los resuelve y los agrega por adelantado.
+ */
+static int hash_builtin(char* const argv[], int output_fd)
+{
+    if (argv[1] == NULL)
     {
-        *input_token = '\0';
-        input_fd = open(input_token + 1, O_RDONLY);
-        if (input_fd == -1)
-        {
-            perror("Error opening input file");
-            exit(EXIT_FAILURE);
-        }
+        FILE* out = open_stage_output(output_fd);
+        if (out == NULL)
+            return EXIT_FAILURE;
+        path_cache_print(out);
+        return close_stage_output(out);
     }
 
-    // Handle output redirection
-    char* output_token = strchr(command, '>');
-    if (output_token != NULL)
+    if (strcmp(argv[1], "-r") == 0)
     {
-        *output_token = '\0';
-        char* output_file_path = output_token + 1;
+        path_cache_clear();
+        return 0;
+    }
 
-        char full_output_path[COMMAND_BUFFER_SIZE];
-        if (output_file_path[0] == '/')
+    bool forget = strcmp(argv[1], "-d") == 0;
+    int status = 0;
+    for (int i = forget ? 2 : 1; argv[i] != NULL; i++)
+    {
+        if (forget)
         {
-            // Absolute path
-            snprintf(full_output_path, sizeof(full_output_path), "%s", output_file_path);
+            path_cache_forget(argv[i]);
         }
-        else
+        else if (path_cache_seed(argv[i]) == -1)
         {
-            // Relative path, construct full path based on current working directory
-            char cwd[COMMAND_BUFFER_SIZE];
-            if (getcwd(cwd, sizeof(cwd)) == NULL)
-            {
-                perror("getcwd");
-                exit(EXIT_FAILURE);
-            }
-
-            // Ensure that the destination buffer has enough space for both strings
-            if ((size_t)snprintf(full_output_path, sizeof(full_output_path), "%s/%s", cwd, output_file_path) >=
-                sizeof(full_output_path))
-            {
-                fprintf(stderr, "Error: Output path is too long\n");
-                exit(EXIT_FAILURE);
-            }
+            fprintf(stderr, "hash: %s: no encontrado\n", argv[i]);
+            status = EXIT_FAILURE;
         }
+    }
+    return status;
+}
 
-        output_fd = open(full_output_path, O_WRONLY | O_CREAT | O_TRUNC, FILE_PERMISSIONS);
-        if (output_fd == -1)
-        {
-            perror("Error opening output file");
-            exit(EXIT_FAILURE);
-        }
+/**
+ * @brief Comando interno `stats`: muestra las latencias y los contadores de comandos de la propia shell.
+ *
+ * `stats --reset` los vacía y `stats --serve [ruta]` los exporta en formato Prometheus por un socket Unix.
+ */
+static int stats_builtin(char* const argv[], int output_fd)
+{
+    if (argv[1] == NULL)
+    {
+        FILE* out = open_stage_output(output_fd);
+        if (out == NULL)
+            return EXIT_FAILURE;
+        stats_print(out);
+        return close_stage_output(out);
     }
-    pid_t fork_ID = fork();
 
-    switch (fork_ID)
+    if (strcmp(argv[1], "--reset") == 0 && argv[2] == NULL)
     {
-    case -1:
-        perror("Fork failed.\n");
-        exit(EXIT_FAILURE);
-        break;
+        stats_reset();
+        return 0;
+    }
+    if (strcmp(argv[1], "--serve") == 0 && (argv[2] == NULL || argv[3] == NULL))
+        return stats_serve(argv[2] != NULL ? argv[2] : STATS_DEFAULT_SOCKET) == 0 ? 0 : EXIT_FAILURE;
 
-    case 0:
+    fprintf(stderr, "uso: stats [--reset | --serve [ruta]]\n");
+    return EXIT_FAILURE;
+}
 
-        // Set up input redirection
+/**
+ * @brief Identifica los comandos internos que pueden formar parte de una tubería.
+ *
+ * @return La función del comando interno, o NULL si el nombre corresponde a un programa externo.
+ */
+static builtin_function find_pipeline_builtin(const char* name)
+{
+    const builtin* entry = find_builtin(name, strlen(name));
+    if (entry == NULL)
+        return NULL;
 
-        if (input_fd != -1)
-        {
-            dup2(input_fd, STDIN_FILENO);
-            close(input_fd);
-        }
+    switch (entry->type)
+    {
+    case CMD_ECHO:
+        return echo_builtin;
+    case CMD_JOBS:
+        return jobs_builtin;
+    case CMD_HASH:
+        return hash_builtin;
+    case CMD_STATS:
+        return stats_builtin;
+    default:
+        return NULL;
+    }
+}
 
-        // Set up output redirection
-        if (output_fd != -1)
-        {
-            dup2(output_fd, STDOUT_FILENO);
-            close(output_fd);
-        }
+bool is_pipeline_command(command_type type)
+{
+    return type == CMD_EXTERNAL || type == CMD_ECHO || type == CMD_JOBS || type == CMD_HASH || type == CMD_STATS;
+}
 
-        // Handle pipe
-        if (pipe_flag)
-        {
-            int pipefd[2];
-            if (pipe(pipefd) == -1)
-            {
-                perror("pipe");
-                exit(EXIT_FAILURE);
-            }
-
-            pid_t pipe_pid = fork();
-
-            if (pipe_pid == -1)
-            {
-                perror("fork");
-                exit(EXIT_FAILURE);
-            }
-            else if (pipe_pid == 0) // Child process for the first command
-            {
-                close(pipefd[0]); // Close unused read end
-
-                // Redirect stdout to the pipe
-                dup2(pipefd[1], STDOUT_FILENO);
-                close(pipefd[1]); // Close the write end of the pipe
-
-                execl("/bin/sh", "sh", "-c", command, NULL);
-
-                perror("execl");
-                exit(EXIT_FAILURE);
-            }
-            else // Parent process
-            {
-                close(pipefd[1]); // Close the write end of the pipe
-
-                // Redirect stdin to read from the pipe
-                dup2(pipefd[0], STDIN_FILENO);
-                close(pipefd[0]); // Close the read end of the pipe
-
-                execl("/bin/sh", "sh", "-c", pipe_token + 1, NULL);
-
-                perror("execl");
-                exit(EXIT_FAILURE);
-            }
-        }
-        else // No pipe
+/**
+ * @brief Lanza cada tubería de una lista ya analizada y espera a las que corren en primer plano.
+ */
+static void run_command_list(const command_list* list)
+{
+    for (int i = 0; i < list->num_pipelines; i++)
+    {
+        const pipeline* pl = &list->pipelines[i];
+        pid_t pids[pl->num_commands];
+        pid_t pgid;
+        char* text = pipeline_to_string(pl);
+        sigset_t old_mask;
+
+        int inline_status;
+
+        for (int j = 0; j < pl->num_commands; j++)
         {
-            execl("/bin/sh", "sh", "-c", command, NULL);
-            perror("execl");
-            exit(EXIT_FAILURE);
+            const char* name = pl->commands[j].argv[0];
+            stats_count_command(find_pipeline_builtin(name) != NULL ? STATS_INTERNAL : STATS_EXTERNAL, name);
         }
+
+        block_sigchld(&old_mask);
+        int terminal_fd = pl->background ? -1 : jobs_terminal_fd();
+        int launched = launch_pipeline(pl, find_pipeline_builtin, pids, &pgid, &inline_status, terminal_fd);
+        if (launched > 0 || inline_status == -1)
+            run_job(pids, launched, pgid, text != NULL ? text : pl->commands[0].argv[0], pl->background);
+        if (inline_status != -1)
+            last_exit_status = inline_status; // La última etapa se ejecutó dentro de la shell
+        sigprocmask(SIG_SETMASK, &old_mask, NULL);
+        free(text);
+    }
+}
+
+/**
+ * @brief Ejecuta una línea de comandos externos ya analizada, o la delega en /bin/sh si el parser no la interpreta.
+ */
+static void run_external(char* command, parse_status status, const command_list* list)
+{
+    switch (status)
+    {
+    case PARSE_OK:
+        run_command_list(list);
+        break;
+    case PARSE_UNSUPPORTED:
+        run_with_system_shell(command);
+        break;
+    case PARSE_SYNTAX_ERROR:
+        last_exit_status = SYNTAX_ERROR_STATUS; // El parser ya informó el error
         break;
+    }
 
-    default:
-        foreground_pid = fork_ID; // Asigna el proceso en primer plano
+    jobs_notify();
+}
 
-        if (background_flag == 0)
-            waitpid(fork_ID, 0, 0); // Wait for the child process to finish in the foreground
-        else
-        {
-            job_ID++;
-            printf("[%d] %d\n", job_ID, fork_ID);
-
-            for (int i = 0; i < BACKGROUND; i++)
-            {
-                if (pid_bg[i] == 0)
-                {
-                    pid_bg[i] = fork_ID;
-                    job_bg[i] = job_ID;
-                    break;
-                }
-            }
-
-            // Non-blocking wait for background processes
-            waitpid(-1, NULL, WNOHANG);
-        }
+/**
+ * @brief Registra los procesos de una tubería como trabajo en primer plano, lo espera y suma sus recursos.
+ *
+ * Debe llamarse con SIGCHLD bloqueada desde antes de lanzar los procesos.
+ *
+ * @return Código de salida de la tubería.
+ */
+static int wait_measured(const pid_t* pids, int num_pids, pid_t pgid, const char* text, struct rusage* usage)
+{
+    if (num_pids == 0)
+        return COMMAND_NOT_FOUND_STATUS;
 
-        // Close file descriptors in the parent process
-        if (input_fd != -1)
-            close(input_fd);
-        if (output_fd != -1)
-            close(output_fd);
+    job* j = jobs_add(pids, num_pids, pgid, text, false);
+    if (j == NULL)
+    {
+        perror("Error al registrar el trabajo");
+        return EXIT_FAILURE;
+    }
+    struct rusage job_usage;
+    int status = jobs_wait_usage(j, true, &job_usage);
+    jobs_add_usage(usage, &job_usage);
+    return status;
+}
 
-        for (int i = 0; i < BACKGROUND; i++)
-        {
-            if (flags[i] == 1)
-            {
-                printf("[%d]+ Done \n", job_bg[i]);
-                flags[i] = 0;
-                pid_bg[i] = 0;
-            }
-        }
-        background_flag = 0;
+/**
+ * @brief Ejecuta una vez el comando medido por `bench`, por el mismo camino que run_external().
+ *
+ * Todas las tuberías se esperan en primer plano, aunque terminen en '&', para medirlas completas.
+ *
+ * @param data Comando ya preparado (prepared_command) con un tipo que admite tuberías.
+ */
+static int run_measured(const char* command, void* data, struct rusage* usage)
+{
+    const prepared_command* prepared = data;
+    memset(usage, 0, sizeof(*usage));
+    sigset_t old_mask;
 
-        break;
+    if (prepared->status == PARSE_UNSUPPORTED)
+    {
+        block_sigchld(&old_mask);
+        pid_t pid = spawn_shell(command, -1, -1, 0);
+        int terminal_fd = jobs_terminal_fd();
+        if (pid > 0 && terminal_fd != -1)
+            tcsetpgrp(terminal_fd, pid);
+        int status = wait_measured(&pid, pid > 0 ? 1 : 0, pid, command, usage);
+        sigprocmask(SIG_SETMASK, &old_mask, NULL);
+        return status;
+    }
+
+    int status = 0;
+    for (int i = 0; i < prepared->list.num_pipelines; i++)
+    {
+        const pipeline* pl = &prepared->list.pipelines[i];
+        pid_t pids[pl->num_commands];
+        pid_t pgid;
+        int inline_status;
+
+        block_sigchld(&old_mask);
+        int launched = launch_pipeline(pl, find_pipeline_builtin, pids, &pgid, &inline_status, jobs_terminal_fd());
+        if (launched > 0 || inline_status == -1)
+            status = wait_measured(pids, launched, pgid, pl->commands[0].argv[0], usage);
+        if (inline_status != -1)
+            status = inline_status;
+        sigprocmask(SIG_SETMASK, &old_mask, NULL);
     }
+    return status;
 }
 
 /**
- * @brief Ejecuta el comando `echo`, permitiendo expandir variables de entorno.
+ * @brief Comando interno `bench`: mide un comando ejecutándolo varias veces (ver bench_parse_options()).
+ *
+ * Solo se miden comandos externos y tuberías, que pueden incluir `echo`, `jobs` y `hash`; el resto de los comandos
+ * internos cambian el estado de la shell en lugar de lanzar procesos. La línea se analiza una sola vez.
  *
+ * @param args Resto de la línea después de la palabra `bench`, o NULL.
  */
-static void echo(char* comment)
+static void bench_builtin(char* args)
 {
-    /* comments contains the full length command i.e "echo hello" so we grab only the arg. */
-    comment = strtok(NULL, " ");
+    bench_options options;
+    if (bench_parse_options(args, &options) == -1)
+    {
+        last_exit_status = EXIT_FAILURE;
+        return;
+    }
 
-    if (comment == NULL)
+    char* command = strdup(options.command);
+    if (command == NULL)
     {
-        printf("\n");
+        perror("bench");
+        last_exit_status = EXIT_FAILURE;
+        return;
     }
-    else if (comment[0] == '$')
+    prepared_command prepared;
+    prepare_command(command, &prepared);
+    options.command = command;
+
+    if (!is_pipeline_command(prepared.type))
     {
-        char* env_value = getenv(comment + 1);
-        if (env_value != NULL)
-        {
-            printf("%s\n", env_value);
-        }
-        else
-        {
-            fprintf(stderr, "Error: La variable de entorno '%s' no está definida.\n", comment + 1);
-        }
+        fprintf(stderr, "bench: solo se pueden medir comandos externos y tuberías\n");
+        last_exit_status = EXIT_FAILURE;
+    }
+    else if (prepared.status == PARSE_SYNTAX_ERROR)
+    {
+        last_exit_status = SYNTAX_ERROR_STATUS; // El parser ya informó el error
     }
     else
     {
-        printf("%s\n", comment);
+        last_exit_status = bench_command(&options, run_measured, &prepared, stdout);
     }
+
+    free_prepared_command(&prepared);
+    free(command);
+    jobs_notify();
+}
+
+/**
+ * @brief Ejecuta un comando externo con soporte para redirección y tuberías.
+ *
+ * La línea se analiza con el parser de la shell y cada tubería se lanza completa, con todas sus etapas conectadas y
+ * sin shells intermedias. Solo se recurre a /bin/sh cuando la línea contiene construcciones que no interpretamos.
+ *
+ */
+void external_command(char* command)
+{
+    command_list list;
+    parse_status status = parse_command_line(command, &list);
+    run_external(command, status, &list);
+    if (status == PARSE_OK)
+        free_command_list(&list);
 }
 
 /**
@@ -436,12 +589,17 @@ static void echo(char* comment)
  * el nuevo directorio de trabajo. Si no se proporciona ningún argumento,
  * cambia al directorio de inicio del usuario.
  *
- * @return 0 si el cambio de directorio es exitoso, -1 si ocurre un error.
+ * @param argv Argumentos del comando, con sus variables ya expandidas.
  */
-static void cd(char* directory)
+static void cd(char* const argv[])
 {
-
-    directory = strtok(NULL, " ");
+    if (argv[1] != NULL && argv[2] != NULL)
+    {
+        fprintf(stderr, "cd: demasiados argumentos\n");
+        last_exit_status = EXIT_FAILURE;
+        return;
+    }
+    const char* directory = argv[1];
 
     if (directory == NULL)
         directory = getenv("HOME");
@@ -450,7 +608,10 @@ static void cd(char* directory)
         directory = getenv("OLDPWD");
 
     if (chdir(directory) == -1)
+    {
         printf("cd: %s: No such file or directory\n", directory);
+        last_exit_status = EXIT_FAILURE;
+    }
 
     char* cwd = malloc(sizeof(char) * COMMAND_BUFFER_SIZE);
     if (getcwd(cwd, COMMAND_BUFFER_SIZE) == NULL)
@@ -461,6 +622,59 @@ static void cd(char* directory)
     setenv("OLDPWD", getenv("PWD"), 1);
     setenv("PWD", cwd, 1);
     free(cwd);
+    refresh_prompt();
+}
+
+
+/**
+ * @brief Continúa un trabajo en primer plano (`fg`) o en segundo plano (`bg`).
+ *
+ * Sin argumentos actúa sobre el trabajo actual; acepta `%n`, `n` o el PID de alguno de sus procesos.
+ */
+static void continue_job(char* const argv[], bool foreground)
+{
+    const char* name = foreground ? "fg" : "bg";
+    const char* args = argv[1];
+
+    job* j = jobs_find(args);
+    if (j == NULL)
+    {
+        fprintf(stderr, "%s: %s: no existe ese trabajo\n", name, args != NULL ? args : "actual");
+        last_exit_status = EXIT_FAILURE;
+        return;
+    }
+    if (!foreground && j->state == JOB_RUNNING)
+    {
+        fprintf(stderr, "bg: el trabajo %d ya está en segundo plano\n", j->id);
+        return;
+    }
+    last_exit_status = jobs_continue(j, foreground);
+}
+
+/**
+ * @brief Espera a los trabajos indicados o, sin argumentos, a todos los trabajos en segundo plano.
+ */
+static void wait_builtin(char* const argv[])
+{
+    if (argv[1] == NULL)
+    {
+        last_exit_status = jobs_wait_all();
+        return;
+    }
+
+    for (int i = 1; argv[i] != NULL; i++)
+    {
+        job* j = jobs_find(argv[i]);
+        if (j == NULL)
+        {
+            fprintf(stderr, "wait: %s: no existe ese trabajo\n", argv[i]);
+            last_exit_status = COMMAND_NOT_FOUND_STATUS;
+        }
+        else if (j->state != JOB_STOPPED)
+        {
+            last_exit_status = jobs_wait(j, false);
+        }
+    }
 }
 
 bool handle_start_monitor(void)
@@ -482,6 +696,40 @@ bool handle_status_monitor(void)
     return true;
 }
 
+/**
+ * @brief Imprime las muestras de una trama, una por línea, en el formato de exposición.
+ */
+static void print_snapshot(const metrics_snapshot* snapshot)
+{
+    for (uint32_t i = 0; i < snapshot->num_samples; i++)
+    {
+        const metric_sample* sample = &snapshot->samples[i];
+        const char* labels = metrics_snapshot_string(snapshot, sample->labels_id);
+        if (*labels != '\0')
+            printf("%s{%s} %.17g\n", metrics_snapshot_string(snapshot, sample->name_id), labels, sample->value);
+        else
+            printf("%s %.17g\n", metrics_snapshot_string(snapshot, sample->name_id), sample->value);
+    }
+    if (snapshot->truncated)
+        printf("(trama incompleta: el wrapper se quedó sin memoria)\n");
+}
+
+/**
+ * @brief Abre la memoria compartida en la que publica el wrapper, informando por qué no se pudo.
+ *
+ * @return true si quedó abierta.
+ */
+static bool open_metrics(metrics_shm* shm)
+{
+    if (metrics_shm_open(shm, METRICS_SHM_NAME) == 0)
+        return true;
+    if (errno == ENOENT)
+        printf("El wrapper todavía no publicó métricas.\n");
+    else
+        perror("Error al abrir la memoria compartida de métricas");
+    return false;
+}
+
 bool handle_expose_metrics(void)
 {
     status current_status = status_monitor();
@@ -490,48 +738,28 @@ bool handle_expose_metrics(void)
         printf("El monitor no está corriendo, inserte el comando: start_monitor \n");
         return true;
     }
-    int fd = open("/tmp/metrics_pipe", O_RDONLY);
-    if (fd == -1)
-    {
-        perror("Error al abrir la FIFO");
+    metrics_shm shm;
+    if (!open_metrics(&shm))
         return true;
-    }
-    char buffer[COMMAND_BUFFER_SIZE];
-    char acumulador[BUFFER_SIZE * 4] = ""; // Buffer acumulativo
-    size_t acumulado_len = 0;
-    bool found_end_marker = false;
-    // Bucle para leer de la FIFO hasta encontrar el marcador "<END_OF_METRICS>"
-    while (!found_end_marker)
-    {
-        ssize_t bytes_read = read(fd, buffer, sizeof(buffer) - 1);
-        if (bytes_read < 0)
-        {
-            perror("Error al leer de la FIFO");
-            close(fd);
-            return true;
-        }
-        else if (bytes_read == 0)
-        {
-            // Si no se leyeron bytes, la FIFO está vacía
-            continue;
-        }
-        buffer[bytes_read] = '\0'; // Aseguramos que el buffer está terminado en '\0'
-        // Acumular los datos leídos
-        strncat(acumulador, buffer, sizeof(acumulador) - acumulado_len - 1);
-        acumulado_len += bytes_read;
-        // Buscar el marcador de fin de las métricas
-        char* delimitador_pos = strstr(acumulador, "<END_OF_METRICS>");
-        if (delimitador_pos)
-        {
-            *delimitador_pos = '\0'; // Termina el bloque de métricas en el delimitador
-            found_end_marker = true;
-        }
-    }
-    printf("\n%s\n", acumulador);
-    close(fd);
+
+    metrics_snapshot snapshot = {0};
+    if (metrics_shm_read(&shm, &snapshot) == 0)
+        print_snapshot(&snapshot);
+    else
+        printf("El wrapper todavía no publicó métricas.\n");
+
+    metrics_snapshot_free(&snapshot);
+    metrics_shm_close(&shm);
     return true;
 }
 
+/**
+ * @brief Muestra las métricas a medida que el wrapper publica tramas nuevas hasta que el usuario presiona
+ * Ctrl-C.
+ *
+ * Entre consultas a la memoria compartida, el bucle de eventos atiende SIGINT y la finalización de trabajos en
+ * segundo plano.
+ */
 bool handle_expose_metrics_realtime(void)
 {
     status current_status = status_monitor();
@@ -540,55 +768,37 @@ bool handle_expose_metrics_realtime(void)
         printf("El monitor no está corriendo, inserte el comando: start_monitor \n");
         return true;
     }
-    realtime = true;
-
-    int fd = open("/tmp/metrics_pipe", O_RDONLY);
-    if (fd == -1)
+    if (!event_loop_active())
     {
-        perror("Error al abrir la FIFO");
-        return false;
+        fprintf(stderr, "El modo en tiempo real requiere el bucle de eventos de la shell.\n");
+        return true;
     }
+    metrics_shm shm;
+    if (!open_metrics(&shm))
+        return true;
 
-    char buffer[COMMAND_BUFFER_SIZE];
-    char acumulador[BUFFER_SIZE * 4] = "";
-    size_t acumulado_len = 0;
-
+    metrics_snapshot snapshot = {0};
+    uint64_t shown = 0;
+    realtime = true;
     while (realtime)
     {
-        ssize_t bytes_read = read(fd, buffer, sizeof(buffer) - 1);
-        if (bytes_read < 0)
-        {
-            perror("Error al leer de la FIFO");
-            close(fd);
-            return false;
-        }
-        else if (bytes_read == 0)
-        {
-            continue;
-        }
-
-        buffer[bytes_read] = '\0';
-
-        strncat(acumulador, buffer, sizeof(acumulador) - acumulado_len - 1);
-        acumulado_len += bytes_read;
-
-        char* delimitador_pos = strstr(acumulador, "<END_OF_METRICS>");
-        if (delimitador_pos)
+        if (metrics_shm_latest(&shm) != shown && metrics_shm_read(&shm, &snapshot) == 0)
         {
-            int unused = system("clear");
-            (void)unused;
-            usleep(20000);
-            *delimitador_pos = '\0';
-            printf("\n%s\n", acumulador);
+            shown = snapshot.generation;
+            printf("\033[2J\033[1;1H\n"); // Limpia la pantalla sin lanzar `clear`
+            print_snapshot(&snapshot);
             printf("\n------------------------------------------------------------------\n control c para cerrar");
-            memset(acumulador, 0, sizeof(acumulador));
-            acumulado_len = 0;
-            acumulador[0] = '\0';
+            fflush(stdout);
         }
+        if (event_loop_dispatch(METRICS_POLL_MS) == -1)
+            break;
+        jobs_notify();
     }
 
-    close(fd);
+    metrics_snapshot_free(&snapshot);
+    metrics_shm_close(&shm);
     realtime = false;
+    printf("\n");
     return true;
 }
 
@@ -603,203 +813,357 @@ bool handle_metrics_help(void)
     printf(" - status_monitor: Muestra el estado del monitor. \n");
     return true;
 }
-bool monitor_comand(char* comand)
+/**
+ * @struct monitor_command
+ * @brief Comando del monitor y la función que lo atiende.
+ */
+struct monitor_command
 {
-    struct command
-    {
-        const char* name;
-        bool (*handler)(void);
-    };
-
-    struct command commands[] = {{"start_monitor", handle_start_monitor},
-                                 {"stop_monitor", handle_stop_monitor},
-                                 {"status_monitor", handle_status_monitor},
-                                 {"expose metrics", handle_expose_metrics},
-                                 {"expose metrics realtime", handle_expose_metrics_realtime},
-                                 {"metrics help", handle_metrics_help}};
+    const char* name;
+    bool (*handler)(void);
+};
+
+static const struct monitor_command monitor_commands[] = {
+    {"start_monitor", handle_start_monitor},
+    {"stop_monitor", handle_stop_monitor},
+    {"status_monitor", handle_status_monitor},
+    {"expose metrics", handle_expose_metrics},
+    {"expose metrics realtime", handle_expose_metrics_realtime},
+    {"metrics help", handle_metrics_help}};
 
-    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
+/**
+ * @brief Busca un comando del monitor por su texto completo.
+ *
+ * @return El comando, o NULL si la línea no es un comando del monitor.
+ */
+static const struct monitor_command* find_monitor_command(const char* comand)
+{
+    for (size_t i = 0; i < sizeof(monitor_commands) / sizeof(monitor_commands[0]); i++)
     {
-        if (strcmp(comand, commands[i].name) == 0)
-        {
-            return commands[i].handler();
-        }
+        if (strcmp(comand, monitor_commands[i].name) == 0)
+            return &monitor_commands[i];
     }
+    return NULL; // Si el comando no es reconocido
+}
+
+bool is_monitor_command(const char* command)
+{
+    return find_monitor_command(command) != NULL;
+}
 
-    return false; // Si el comando no es reconocido
+bool monitor_comand(char* comand)
+{
+    const struct monitor_command* command = find_monitor_command(comand);
+    return command != NULL && command->handler();
 }
 
 /**
- * @brief Verifica si un archivo es un archivo de configuración.
+ * @brief Busca archivos de configuración en un directorio y sus subdirectorios y muestra su contenido.
  *
- * Esta función recibe un nombre de archivo y verifica si su extensión es ".config" o ".json".
- * Si el archivo tiene una de estas extensiones, se considera un archivo de configuración.
+ * Si el directorio está dentro de una raíz indexada (`scan --index`), la respuesta sale del índice, que solo relee
+ * los directorios que cambiaron. En otro caso el árbol se recorre en paralelo con scan_config_files(), sin cambiar el
+ * directorio de trabajo. Los archivos se muestran ordenados por ruta.
  *
- * @return 1 si es un archivo de configuración, 0 si no lo es.
+ * Uso: `scan [opción] [directorio]`; sin directorio se usa el actual. Opciones: `--index` indexa el directorio,
+ * `--rebuild` reconstruye el índice que lo contiene, `--unindex` lo quita y `--stats` muestra el estado de los
+ * índices. `--grep TEXTO` muestra solo los archivos que contienen el texto (literal; entre comillas si tiene
+ * espacios) y `--validate` solo los ".json" que no son JSON válido; en ambos casos el código de salida es 0 si se
+ * mostró algún archivo y 1 si no.
+ *
+ * @param argv Argumentos del comando, con sus variables ya expandidas.
  */
-int is_config_file(const char* filename)
+static void scan_builtin(char* const argv[])
 {
-    const char* ext = strrchr(filename, '.');
-    if (ext != NULL)
+    int next = 1;
+    const char* option = argv[next] != NULL && strncmp(argv[next], "--", 2) == 0 ? argv[next++] : NULL;
+    const char* pattern = NULL;
+    if (option != NULL && strcmp(option, "--grep") == 0)
     {
-        if (strcmp(ext, ".config") == 0 || strcmp(ext, ".json") == 0)
+        pattern = argv[next] != NULL ? argv[next++] : NULL;
+        if (pattern == NULL || *pattern == '\0')
         {
-            return 1; // Es un archivo de configuración
+            fprintf(stderr, "scan: --grep requiere un texto a buscar\n");
+            last_exit_status = EXIT_FAILURE;
+            return;
         }
     }
-    return 0; // No es un archivo de configuración
+    const char* directory = argv[next] != NULL ? argv[next++] : NULL;
+    if (argv[next] != NULL)
+    {
+        fprintf(stderr, "uso: scan [--index | --rebuild | --unindex | --stats | --grep TEXTO | --validate] "
+                        "[directorio]\n");
+        last_exit_status = EXIT_FAILURE;
+        return;
+    }
+
+    if (option != NULL && strcmp(option, "--stats") == 0)
+    {
+        config_index_print_stats();
+        return;
+    }
+
+    // Los índices se identifican por su ruta absoluta
+    char* root = directory != NULL ? realpath(directory, NULL) : get_cwd();
+    if (root == NULL)
+    {
+        if (directory != NULL)
+            fprintf(stderr, "scan: %s: %s\n", directory, strerror(errno));
+        last_exit_status = EXIT_FAILURE;
+        return;
+    }
+
+    bool filtered = option != NULL && (strcmp(option, "--grep") == 0 || strcmp(option, "--validate") == 0);
+    filter_kind filter = pattern != NULL ? FILTER_GREP : FILTER_INVALID;
+    if (option != NULL && !filtered)
+    {
+        int status = -1;
+        if (strcmp(option, "--index") == 0)
+        {
+            if ((status = config_index_register(root)) == -1)
+                fprintf(stderr, "scan: no se pudo indexar %s\n", root);
+        }
+        else if (strcmp(option, "--rebuild") == 0 || strcmp(option, "--unindex") == 0)
+        {
+            status = strcmp(option, "--rebuild") == 0 ? config_index_rebuild(root) : config_index_unregister(root);
+            if (status == -1)
+                fprintf(stderr, "scan: %s no está dentro de un directorio indexado\n", root);
+        }
+        else
+            fprintf(stderr,
+                    "scan: opción desconocida '%s' (use --index, --rebuild, --unindex, --stats, --grep o --validate)\n",
+                    option);
+        last_exit_status = status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        free(root);
+        return;
+    }
+
+    printf("Explorando el directorio: %s en busca de archivos '.config' o '.json'\n", root);
+    scan_result result;
+    if (config_index_scan(root, &result) == 0 || scan_config_files(root, 0, &result) == 0)
+    {
+        if (filtered)
+        {
+            filter_config_files(&result, filter, pattern, 0);
+            last_exit_status = result.count > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        fflush(stdout);
+        for (size_t i = 0; i < result.count; i++)
+            write_config_file(result.paths[i], STDOUT_FILENO);
+        scan_result_free(&result);
+    }
+    free(root);
 }
 
 /**
- * @brief Lee y muestra el contenido de un archivo de configuración.
+ * @brief Instala los manejadores de SIGINT, SIGTSTP, SIGQUIT y SIGCHLD una única vez.
  *
- * Esta función abre el archivo especificado en modo lectura y muestra su contenido línea por línea en la consola.
- * Si el archivo no se puede abrir, se imprime un mensaje de error.
+ * Con el bucle de eventos activo las señales se atienden de forma síncrona desde el bucle; en otro caso se
+ * instalan como manejadores asíncronos.
  */
-void read_config_file(const char* file_path)
+void setup_signal_handlers(void)
 {
-    FILE* file = fopen(file_path, "r");
-    if (file == NULL)
+    if (event_loop_active())
     {
-        perror("No se pudo abrir el archivo");
-        return;
+        event_loop_handle_signal(SIGINT, ctrl_c_Handler);
+        event_loop_handle_signal(SIGTSTP, ctrl_z_Handler);
+        event_loop_handle_signal(SIGQUIT, sigquit_Handler);
     }
-    char line[BUFFER_SIZE];
-    printf("\033[1;31mArchivo de configuracion encontrado: %s\ncontenido de %s:\033[38;5;87m\n", file_path, file_path);
-    while (fgets(line, sizeof(line), file) != NULL)
+    else
     {
-        printf("%s", line);
+        signal(SIGINT, ctrl_c_Handler);
+        signal(SIGTSTP, ctrl_z_Handler);
+        signal(SIGQUIT, sigquit_Handler);
     }
-    printf("\n");
-    fclose(file);
+    jobs_init();
+}
+
+/**
+ * @brief Devuelve el código de salida del último comando ejecutado.
+ */
+int get_last_exit_status(void)
+{
+    return last_exit_status;
+}
+
+/**
+ * @brief Clasifica la línea y analiza los comandos externos.
+ */
+void prepare_command(char* command, prepared_command* prepared)
+{
+    uint64_t start = stats_now();
+
+    /* Elimina el salto de línea al final del comando */
+    command[strcspn(command, "\n")] = '\0';
+
+    prepared->type = lookup_builtin(command);
+    prepared->status = PARSE_OK;
+    prepared->list.pipelines = NULL;
+    prepared->list.num_pipelines = 0;
+    prepared->list.expanded = false;
+    if (is_pipeline_command(prepared->type))
+        prepared->status = parse_command_line(command, &prepared->list);
+
+    stats_observe_since(STATS_DISPATCH, start);
+}
+
+/**
+ * @brief Libera la lista de tuberías de un comando externo preparado.
+ */
+void free_prepared_command(prepared_command* prepared)
+{
+    if (is_pipeline_command(prepared->type) && prepared->status == PARSE_OK)
+        free_command_list(&prepared->list);
 }
 
 /**
- * @brief Explora recursivamente el directorio actual y subdirectorios en busca de archivos de configuración.
+ * @brief Separa en palabras la línea de un comando interno que no forma tuberías, expandiendo sus variables.
+ *
+ * Se analiza al ejecutarla, como las tuberías con variables, para que las expansiones usen el entorno de ese momento.
  *
- * Esta función recursiva explora el directorio en el que se encuentra, buscando archivos de configuración con las
- * extensiones ".config" y ".json". Cuando se encuentra un archivo de este tipo, se lee y muestra su contenido.
- * Además, la función realiza llamadas recursivas en los subdirectorios.
+ * @return 0 si la línea es un único comando simple, -1 si no (el error ya se informó y quedó en last_exit_status).
  */
-void explore_recursive_config()
+static int parse_builtin_arguments(const char* command, command_list* list)
 {
-    char* cwd = get_cwd(); // Usar la función get_cwd
-    if (cwd == NULL)
-    {
-        return; // Salir si no se pudo obtener el directorio actual
-    }
-    struct dirent* entry;
-    struct stat statbuf;
-    DIR* dp = opendir(cwd);
+    parse_status status = parse_command_line(command, list);
+    if (status == PARSE_OK && list->num_pipelines == 1 && list->pipelines[0].num_commands == 1 &&
+        list->pipelines[0].commands[0].num_redirections == 0 && !list->pipelines[0].background)
+        return 0;
+
+    if (status != PARSE_SYNTAX_ERROR) // El parser ya informó los errores de sintaxis
+        fprintf(stderr, "%.*s: los comandos internos no admiten tuberías, redirecciones, `;`, `&` ni construcciones "
+                        "de /bin/sh\n",
+                (int)parser_word_length(command + strspn(command, " \t")), command + strspn(command, " \t"));
+    if (status == PARSE_OK)
+        free_command_list(list);
+    last_exit_status = SYNTAX_ERROR_STATUS;
+    return -1;
+}
+
+/**
+ * @brief Une los argumentos con un espacio, para los comandos internos que interpretan la línea como texto.
+ *
+ * @return Cadena reservada con malloc, o NULL si no hay memoria.
+ */
+static char* join_arguments(char* const argv[])
+{
+    size_t length = 1;
+    for (int i = 0; argv[i] != NULL; i++)
+        length += strlen(argv[i]) + 1;
+    char* line = malloc(length);
+    if (line == NULL)
+        return NULL;
+    char* end = line;
+    for (int i = 0; argv[i] != NULL; i++)
+        end += sprintf(end, i > 0 ? " %s" : "%s", argv[i]);
+    *end = '\0';
+    return line;
+}
+
+/**
+ * @brief Ejecuta un comando ya clasificado.
+ *
+ * Llama a la función correspondiente según el tipo resuelto, ya sea un
+ * comando interno o externo.
+ *
+ */
+void execute_prepared_command(char* command, const prepared_command* prepared)
+{
+    last_exit_status = 0;
 
-    if (dp == NULL)
+    // Los comandos internos que no forman tuberías se miden acá; los demás, al lanzar cada etapa
+    bool measured = !is_pipeline_command(prepared->type);
+    uint64_t start = stats_now();
+    if (measured)
     {
-        perror("No se pudo abrir el directorio");
-        free(cwd);
-        return;
+        char name[BUILTIN_NAME_SIZE];
+        snprintf(name, sizeof(name), "%.*s", (int)parser_word_length(command), command);
+        stats_count_command(STATS_INTERNAL, name);
     }
 
-    // Recorrer los elementos del directorio
-    while ((entry = readdir(dp)) != NULL)
+    // `bench` se excluye: su comando se analiza completo, con tuberías y redirecciones, en cada medición
+    command_list arguments;
+    char** argv = NULL;
+    if (measured && prepared->type != CMD_BENCH)
     {
-        char path[BUFFER_SIZE];
-        snprintf(path, sizeof(path), "%s/%s", cwd, entry->d_name);
-
-        // Obtener información sobre el archivo
-        if (stat(path, &statbuf) == -1)
+        if (parse_builtin_arguments(command, &arguments) == -1)
         {
-            perror("No se pudo obtener información sobre el archivo");
-            continue;
+            stats_observe_since(STATS_BUILTIN, start);
+            return;
         }
+        argv = arguments.pipelines[0].commands[0].argv;
+    }
 
-        // Si es un directorio, hacer llamada recursiva
-        if (S_ISDIR(statbuf.st_mode))
+    switch (prepared->type)
+    {
+    case CMD_CONFIG:
+    case CMD_MONITOR: {
+        char* line = join_arguments(argv);
+        if (line == NULL)
         {
-            // Ignorar los directorios "." y ".."
-            if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
-            {
-                chdir(path);                // Cambiar al nuevo directorio
-                explore_recursive_config(); // Llamada recursiva
-                chdir(cwd);                 // Regresar al directorio original
-            }
+            perror("Error al asignar memoria");
+            last_exit_status = EXIT_FAILURE;
         }
-        else if (S_ISREG(statbuf.st_mode) && is_config_file(entry->d_name))
+        else if (!(prepared->type == CMD_CONFIG ? JSON_command(line, get_config()) : monitor_comand(line)))
         {
-            // Si es un archivo .config o .json, leerlo
-            read_config_file(path);
+            // La línea se reconoció antes de expandir las variables y la expansión cambió el subcomando
+            fprintf(stderr, "%s: comando no reconocido\n", line);
+            last_exit_status = EXIT_FAILURE;
         }
+        free(line);
+        break;
+    }
+    case CMD_QUIT:
+        signal_handler(SIGTERM);
+        exit(EXIT_SUCCESS);
+        break;
+    case CMD_CD:
+        cd(argv);
+        break;
+    case CMD_CLR:
+        printf("\033[2J\033[1;1H");
+        fflush(stdout);
+        break;
+    case CMD_SCAN:
+        scan_builtin(argv);
+        break;
+    case CMD_FG:
+    case CMD_BG:
+        continue_job(argv, prepared->type == CMD_FG);
+        break;
+    case CMD_WAIT:
+        wait_builtin(argv);
+        break;
+    case CMD_BENCH:
+        strtok(command, " ");            // Extrae y descarta la palabra "bench"
+        bench_builtin(strtok(NULL, "")); // El resto de la línea es el comando a medir, con sus opciones
+        break;
+    case CMD_ECHO:
+    case CMD_JOBS:
+    case CMD_HASH:
+    case CMD_STATS:
+    case CMD_EXTERNAL:
+        run_external(command, prepared->status, &prepared->list); // Maneja cualquier otro comando como externo
+        break;
     }
 
-    closedir(dp);
-    free(cwd); // Liberar la memoria asignada para cwd
+    if (argv != NULL)
+        free_command_list(&arguments);
+    if (measured)
+        stats_observe_since(STATS_BUILTIN, start);
 }
 
 /**
  * @brief Ejecuta un comando ingresado por el usuario.
  *
- * Esta función configura los manejadores de señales y limpia el
- * comando ingresado. Separa el comando de sus argumentos y llama
- * a la función correspondiente para ejecutarlo, ya sea un comando interno
+ * Esta función limpia el comando ingresado, lo clasifica y llama a la
+ * función correspondiente para ejecutarlo, ya sea un comando interno
  * o externo.
  *
  */
 void execute_command(char* command)
 {
-    /* Configuración de señales */
-    signal(SIGINT, ctrl_c_Handler);
-    signal(SIGCHLD, CHLD_Handler);
-    signal(SIGTSTP, ctrl_z_Handler);
-    signal(SIGQUIT, sigquit_Handler);
-    /* Elimina el salto de línea al final del comando */
-    command[strcspn(command, "\n")] = '\0';
-    /* Comprueba si es un comando JSON */
-    if (JSON_command(command, get_config()))
-    {
-        return; // Si es un comando JSON y se ejecutó, termina la función
-    }
-    /* Comprueba si es un comando monitor */
-    if (monitor_comand(command))
-    {
-        return; // Si es un comando monitor y se ejecutó, termina la función
-    }
-    /* Procesa comandos principales */
-    char* cwd;
-    char* cmd = strdup(command);
-    strtok(cmd, " "); // Extrae el comando base (antes de los argumentos)
-
-    if (cmd != NULL)
-    {
-        command_type cmd_type = parse_command(cmd);
-        free(cmd); // Liberamos memoria después de analizar
-
-        switch (cmd_type)
-        {
-        case CMD_QUIT:
-            signal_handler(SIGTERM);
-            exit(EXIT_SUCCESS);
-            break;
-        case CMD_CD:
-            strtok(command, " "); // Extrae y descarta la palabra "cd"
-            cd(NULL);             // Llama a `cd` con la siguiente parte del comando
-            break;
-        case CMD_CLR:
-            printf("\033[2J\033[1;1H");
-            fflush(stdout);
-            break;
-        case CMD_ECHO:
-            if (strchr(command, '$') != NULL)
-                echo(command); // Usa la función personalizada
-            else
-                system(command); // Usa el `echo` del sistema
-            break;
-        case CMD_SCAN:
-            cwd = get_cwd();
-            printf("Explorando el directorio: %s en busca de archivos '.config' o '.json'\n", cwd);
-            explore_recursive_config();
-            break;
-        case CMD_EXTERNAL:
-            external_command(command); // Maneja cualquier otro comando como externo
-            break;
-        }
-    }
+    prepared_command prepared;
+    prepare_command(command, &prepared);
+    execute_prepared_command(command, &prepared);
+    free_prepared_command(&prepared);
 }
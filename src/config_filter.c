@@ -0,0 +1,172 @@
+#define _GNU_SOURCE // Para memmem()
+#include "config_filter.h"
+#include <cjson/cJSON.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Resultado de examinar un archivo.
+ */
+typedef enum
+{
+    FILE_DISCARD = 0, /**< El archivo no cumple el criterio. */
+    FILE_KEEP         /**< El archivo cumple el criterio. */
+} file_verdict;
+
+/**
+ * @struct filter_context
+ * @brief Estado compartido por los hilos del filtro.
+ */
+typedef struct
+{
+    const scan_result* result; /**< Archivos a examinar. */
+    filter_kind kind;          /**< Criterio del filtro. */
+    const char* pattern;       /**< Texto buscado con FILTER_GREP. */
+    size_t pattern_length;     /**< Longitud de `pattern`. */
+    unsigned char* keep;       /**< Veredicto (file_verdict) de cada archivo. */
+    atomic_size_t next;        /**< Próximo archivo sin asignar. */
+} filter_context;
+
+/**
+ * @brief Verifica si un nombre de archivo termina en ".json".
+ */
+static bool is_json_path(const char* path)
+{
+    size_t length = strlen(path);
+    return length >= 5 && strcmp(path + length - 5, ".json") == 0;
+}
+
+/**
+ * @brief Verifica que cJSON acepte el contenido completo como un único valor JSON.
+ *
+ * cJSON deja de leer al terminar el primer valor, así que lo que sigue solo puede ser espacio en blanco.
+ */
+static bool is_valid_json(const char* data, size_t size)
+{
+    const char* end = NULL;
+    cJSON* json = cJSON_ParseWithLengthOpts(data, size, &end, false);
+    if (json == NULL)
+        return false;
+    cJSON_Delete(json);
+    while (end < data + size && isspace((unsigned char)*end))
+        end++;
+    return end == data + size;
+}
+
+/**
+ * @brief Aplica el criterio del filtro a un archivo proyectándolo en memoria.
+ *
+ * Un archivo que no se puede leer se descarta con FILTER_GREP y se conserva con FILTER_INVALID, para que `scan`
+ * informe el error al intentar mostrarlo.
+ */
+static file_verdict examine_file(const filter_context* ctx, const char* path)
+{
+    bool grep = ctx->kind == FILTER_GREP;
+    if (!grep && !is_json_path(path))
+        return FILE_DISCARD;
+
+    int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd == -1)
+        return grep ? FILE_DISCARD : FILE_KEEP;
+    struct stat st;
+    if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode))
+    {
+        close(fd);
+        return grep ? FILE_DISCARD : FILE_KEEP;
+    }
+    if (st.st_size == 0)
+    {
+        close(fd);
+        return grep ? FILE_DISCARD : FILE_KEEP; // Un archivo vacío no contiene el texto ni es JSON válido
+    }
+
+    size_t size = (size_t)st.st_size;
+    char* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return grep ? FILE_DISCARD : FILE_KEEP;
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    bool match = grep ? memmem(data, size, ctx->pattern, ctx->pattern_length) != NULL : !is_valid_json(data, size);
+    munmap(data, size);
+    return match ? FILE_KEEP : FILE_DISCARD;
+}
+
+/**
+ * @brief Cuerpo de cada hilo: toma archivos pendientes hasta que no queden.
+ */
+static void* filter_worker_run(void* arg)
+{
+    filter_context* ctx = arg;
+    size_t i;
+    while ((i = atomic_fetch_add(&ctx->next, 1)) < ctx->result->count)
+        ctx->keep[i] = (unsigned char)examine_file(ctx, ctx->result->paths[i]);
+    return NULL;
+}
+
+/**
+ * @brief Filtra en el lugar los archivos de un resultado de `scan` según su contenido.
+ */
+int filter_config_files(scan_result* result, filter_kind kind, const char* pattern, int num_threads)
+{
+    if (result->count == 0)
+        return 0;
+
+    if (num_threads <= 0)
+    {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cores > 0 ? (int)cores : 1;
+    }
+    if (num_threads > SCAN_MAX_THREADS)
+        num_threads = SCAN_MAX_THREADS;
+    if ((size_t)num_threads > result->count)
+        num_threads = (int)result->count;
+
+    filter_context ctx;
+    ctx.result = result;
+    ctx.kind = kind;
+    ctx.pattern = pattern;
+    ctx.pattern_length = kind == FILTER_GREP ? strlen(pattern) : 0;
+    ctx.keep = calloc(result->count, 1);
+    if (ctx.keep == NULL)
+        return -1;
+    atomic_init(&ctx.next, 0);
+
+    // Los hilos bloquean todas las señales, para que las de la shell sigan llegando al hilo principal
+    sigset_t all_signals, old_mask;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_BLOCK, &all_signals, &old_mask);
+    pthread_t threads[SCAN_MAX_THREADS];
+    bool started[SCAN_MAX_THREADS] = {false};
+    for (int i = 1; i < num_threads; i++)
+        started[i] = pthread_create(&threads[i], NULL, filter_worker_run, &ctx) == 0;
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+
+    filter_worker_run(&ctx);
+    for (int i = 1; i < num_threads; i++)
+    {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < result->count; i++)
+    {
+        if (ctx.keep[i] == FILE_KEEP)
+            result->paths[kept++] = result->paths[i];
+        else
+            free(result->paths[i]);
+    }
+    result->count = kept;
+    free(ctx.keep);
+    return 0;
+}
@@ -0,0 +1,1496 @@
+#include "config_index.h"
+#include "event_loop.h"
+#include "file_util.h"
+#include "hash.h"
+#include "script_cache.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <time.h>
+#include <unistd.h>
+
+#define INDEX_MAGIC "SHI1"                 // Identifica el formato del archivo de índice
+#define INDEX_ROOTS_FILE "scan-roots"      // Archivo con las raíces registradas, una por línea
+#define INITIAL_INDEX_CAPACITY 64          // Capacidad inicial de los arreglos del índice
+#define INOTIFY_BUFFER_SIZE 65536          // Bytes que se leen del descriptor de inotify por llamada
+#define NO_SLOT SIZE_MAX                   // Posición vacía de la tabla, o directorio sin padre
+#define WATCH_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+
+/**
+ * @struct index_header
+ * @brief Encabezado del archivo de índice, seguido de la raíz (terminada en '\0') y de un registro por directorio.
+ *
+ * Cada registro es: ruta relativa (u32 + bytes + '\0'), dispositivo e inodo (u64), fecha de modificación (segundos y
+ * nanosegundos, i64), cantidad de archivos (u32) y sus nombres. Los enteros se guardan en el orden de bytes de la
+ * máquina, como en la caché de scripts.
+ */
+typedef struct
+{
+    char magic[4];        /**< INDEX_MAGIC. */
+    uint32_t root_length; /**< Longitud de la raíz. */
+    int64_t updated_sec;  /**< Inicio de la última actualización (segundos). */
+    int64_t updated_nsec; /**< Inicio de la última actualización (nanosegundos). */
+    uint32_t num_dirs;    /**< Cantidad de registros. */
+    uint32_t reserved;    /**< Relleno, siempre cero. */
+} index_header;
+
+/**
+ * @struct index_dir
+ * @brief Directorio del árbol indexado.
+ */
+typedef struct
+{
+    char* path;         /**< Ruta relativa a la raíz ("." para la raíz). */
+    char** files;       /**< Nombres de los archivos de configuración del directorio. */
+    size_t num_files;   /**< Cantidad de archivos. */
+    size_t parent;      /**< Posición del directorio padre, o NO_SLOT para la raíz. */
+    uint64_t dev;       /**< Dispositivo. */
+    uint64_t ino;       /**< Inodo. */
+    int64_t mtime_sec;  /**< Fecha de modificación al leerlo (segundos). */
+    int64_t mtime_nsec; /**< Fecha de modificación al leerlo (nanosegundos). */
+    int wd;             /**< Vigilancia de inotify, o -1. */
+    bool dirty;         /**< Cambió desde que se leyó; debe volver a leerse. */
+    bool dead;          /**< Ya no existe; se elimina al compactar. */
+    bool replaced;      /**< Otro directorio ocupa ahora su ruta; sus subdirectorios indexados se descartan. */
+    bool reread;        /**< Se volvió a leer en la actualización en curso y `subdirs` es válido. */
+    char** subdirs;     /**< Subdirectorios leídos en la actualización en curso, ordenados. */
+    size_t num_subdirs; /**< Cantidad de subdirectorios leídos. */
+} index_dir;
+
+/**
+ * @struct config_index
+ * @brief Índice cargado de una raíz registrada.
+ */
+typedef struct config_index
+{
+    char* root;                /**< Raíz absoluta. */
+    index_dir* dirs;           /**< Directorios del árbol. */
+    size_t num_dirs;           /**< Cantidad de directorios. */
+    size_t capacity;           /**< Capacidad de `dirs`. */
+    size_t* table;             /**< Posiciones de `dirs` por ruta (direccionamiento abierto). */
+    size_t table_size;         /**< Capacidad de la tabla (potencia de 2). */
+    int inotify_fd;            /**< Descriptor de inotify, o -1 si el vigilante no está activo. */
+    size_t* watch_slots;       /**< Posición del directorio de cada vigilancia, indexado por descriptor. */
+    size_t num_watch_slots;    /**< Capacidad de `watch_slots`. */
+    size_t num_watches;        /**< Vigilancias activas. */
+    bool needs_validation;     /**< Los cambios pueden no estar marcados: se comparan las fechas de modificación. */
+    int64_t updated_sec;       /**< Inicio de la última actualización (segundos). */
+    int64_t updated_nsec;      /**< Inicio de la última actualización (nanosegundos). */
+    size_t last_reread;        /**< Directorios releídos en la última actualización. */
+    size_t last_walked;        /**< Directorios nuevos recorridos en la última actualización. */
+    struct config_index* next; /**< Siguiente índice cargado. */
+} config_index;
+
+static config_index* loaded_indexes = NULL; // Índices cargados en esta shell
+
+/**
+ * @brief Devuelve la ruta del directorio que contiene `path` ("." si no tiene barras), reservada con malloc.
+ */
+static char* parent_path(const char* path)
+{
+    const char* slash = strrchr(path, '/');
+    return slash == NULL ? strdup(".") : strndup(path, (size_t)(slash - path));
+}
+
+/**
+ * @brief Devuelve el último componente de una ruta.
+ */
+static const char* base_name(const char* path)
+{
+    const char* slash = strrchr(path, '/');
+    return slash == NULL ? path : slash + 1;
+}
+
+/**
+ * @brief Indica si `path` es `root` o está dentro de él.
+ */
+static bool is_under(const char* path, const char* root)
+{
+    size_t len = strlen(root);
+    if (strncmp(path, root, len) != 0)
+        return false;
+    return path[len] == '\0' || path[len] == '/' || (len > 0 && root[len - 1] == '/');
+}
+
+/**
+ * @brief Agrega un nombre a un arreglo de cadenas que crece de a uno; el arreglo pasa a ser dueño del nombre.
+ *
+ * @return 0 si se agregó, -1 si no hay memoria (el nombre se libera).
+ */
+static int append_name(char*** names, size_t* count, char* name)
+{
+    char** grown = name != NULL ? realloc(*names, (*count + 1) * sizeof(char*)) : NULL;
+    if (grown == NULL)
+    {
+        free(name);
+        return -1;
+    }
+    grown[(*count)++] = name;
+    *names = grown;
+    return 0;
+}
+
+/**
+ * @brief Libera un arreglo de cadenas.
+ */
+static void free_names(char** names, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        free(names[i]);
+    free(names);
+}
+
+/**
+ * @brief Comparador de cadenas para qsort y bsearch.
+ */
+static int compare_names(const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/**
+ * @brief Reserva una tabla de rutas vacía con lugar para `num_dirs` directorios.
+ *
+ * @param size Donde se guarda la cantidad de posiciones de la tabla.
+ * @return La tabla, o NULL si no hay memoria.
+ */
+static size_t* alloc_table(size_t num_dirs, size_t* size)
+{
+    *size = INITIAL_INDEX_CAPACITY;
+    while (*size < num_dirs * 2 + 1)
+        *size *= 2;
+    size_t* table = malloc(*size * sizeof(size_t));
+    if (table == NULL)
+        return NULL;
+    for (size_t i = 0; i < *size; i++)
+        table[i] = NO_SLOT;
+    return table;
+}
+
+/**
+ * @brief Llena una tabla vacía de alloc_table() con todos los directorios y reemplaza la del índice.
+ */
+static void install_table(config_index* idx, size_t* table, size_t size)
+{
+    for (size_t slot = 0; slot < idx->num_dirs; slot++)
+    {
+        size_t i = (size_t)fnv1a64(idx->dirs[slot].path, strlen(idx->dirs[slot].path)) & (size - 1);
+        while (table[i] != NO_SLOT)
+            i = (i + 1) & (size - 1);
+        table[i] = slot;
+    }
+    free(idx->table);
+    idx->table = table;
+    idx->table_size = size;
+}
+
+/**
+ * @brief Reconstruye la tabla de rutas con todos los directorios del índice.
+ *
+ * @return 0 si la tabla se reconstruyó, -1 si no hay memoria (la tabla anterior se conserva).
+ */
+static int rebuild_table(config_index* idx)
+{
+    size_t size;
+    size_t* table = alloc_table(idx->num_dirs, &size);
+    if (table == NULL)
+        return -1;
+    install_table(idx, table, size);
+    return 0;
+}
+
+/**
+ * @brief Busca un directorio por su ruta relativa.
+ *
+ * @return Posición del directorio, o NO_SLOT si no está indexado.
+ */
+static size_t find_dir(const config_index* idx, const char* path)
+{
+    if (idx->table == NULL)
+        return NO_SLOT;
+    size_t mask = idx->table_size - 1;
+    for (size_t i = (size_t)fnv1a64(path, strlen(path)) & mask; idx->table[i] != NO_SLOT; i = (i + 1) & mask)
+    {
+        if (strcmp(idx->dirs[idx->table[i]].path, path) == 0)
+            return idx->table[i];
+    }
+    return NO_SLOT;
+}
+
+/**
+ * @brief Agrega un directorio al índice; el índice pasa a ser dueño de la ruta.
+ *
+ * @return Posición del directorio, o NO_SLOT si no hay memoria (la ruta se libera).
+ */
+static size_t add_dir(config_index* idx, char* path, const struct stat* st)
+{
+    if (path == NULL)
+        return NO_SLOT;
+    if (idx->num_dirs == idx->capacity)
+    {
+        size_t new_capacity = idx->capacity ? idx->capacity * 2 : INITIAL_INDEX_CAPACITY;
+        index_dir* dirs = realloc(idx->dirs, new_capacity * sizeof(index_dir));
+        if (dirs == NULL)
+        {
+            free(path);
+            return NO_SLOT;
+        }
+        idx->dirs = dirs;
+        idx->capacity = new_capacity;
+    }
+
+    size_t slot = idx->num_dirs;
+    index_dir* dir = &idx->dirs[slot];
+    memset(dir, 0, sizeof(*dir));
+    dir->path = path;
+    dir->parent = NO_SLOT;
+    dir->wd = -1;
+    if (st != NULL)
+    {
+        dir->dev = (uint64_t)st->st_dev;
+        dir->ino = (uint64_t)st->st_ino;
+        dir->mtime_sec = (int64_t)st->st_mtim.tv_sec;
+        dir->mtime_nsec = (int64_t)st->st_mtim.tv_nsec;
+    }
+    idx->num_dirs++;
+
+    if (idx->num_dirs * 2 > idx->table_size)
+    {
+        // La tabla nueva ya incluye el directorio agregado
+        if (rebuild_table(idx) == -1)
+        {
+            idx->num_dirs--;
+            free(path);
+            return NO_SLOT;
+        }
+        return slot;
+    }
+    size_t mask = idx->table_size - 1;
+    size_t i = (size_t)fnv1a64(path, strlen(path)) & mask;
+    while (idx->table[i] != NO_SLOT)
+        i = (i + 1) & mask;
+    idx->table[i] = slot;
+    return slot;
+}
+
+/**
+ * @brief Asigna el padre de los directorios a partir de la posición `first`.
+ */
+static void link_parents(config_index* idx, size_t first)
+{
+    for (size_t slot = first; slot < idx->num_dirs; slot++)
+    {
+        index_dir* dir = &idx->dirs[slot];
+        if (strcmp(dir->path, ".") == 0)
+            continue;
+        char* parent = parent_path(dir->path);
+        if (parent != NULL)
+            dir->parent = find_dir(idx, parent);
+        free(parent);
+    }
+}
+
+/**
+ * @brief Arma la ruta absoluta de un directorio del índice.
+ */
+static char* absolute_path(const config_index* idx, const char* rel_path)
+{
+    return strcmp(rel_path, ".") == 0 ? strdup(idx->root) : join_path(idx->root, rel_path);
+}
+
+/**
+ * @brief Arma la ruta de un archivo del directorio de caché de la shell, creando los directorios si se pide.
+ */
+static char* cache_path(const char* name, bool create_dirs)
+{
+    char* base = cache_directory(create_dirs);
+    if (base == NULL)
+        return NULL;
+    char* path = join_path(base, name);
+    free(base);
+    return path;
+}
+
+/**
+ * @brief Arma la ruta del archivo de índice de una raíz.
+ */
+static char* index_file_path(const char* root, bool create_dirs)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.index", (unsigned long long)fnv1a64(root, strlen(root)));
+    return cache_path(name, create_dirs);
+}
+
+/**
+ * @brief Reemplaza un archivo de forma atómica con el contenido dado.
+ */
+static int replace_file(const char* path, const void* data, size_t size)
+{
+    size_t tmp_len = strlen(path) + sizeof(".XXXXXX");
+    char tmp_path[tmp_len];
+    snprintf(tmp_path, tmp_len, "%s.XXXXXX", path);
+    int fd = mkstemp(tmp_path);
+    if (fd == -1)
+        return -1;
+    bool ok = write_all(fd, data, size);
+    if (close(fd) == -1)
+        ok = false;
+    if (!ok || rename(tmp_path, path) == -1)
+    {
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Lee un archivo completo en memoria.
+ *
+ * @return Contenido reservado con malloc (con un '\0' adicional), o NULL si no se pudo leer.
+ */
+static char* read_file(const char* path, size_t* size)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return NULL;
+    struct stat st;
+    char* data = NULL;
+    if (fstat(fd, &st) == 0 && (data = malloc((size_t)st.st_size + 1)) != NULL)
+    {
+        size_t done = 0;
+        while (done < (size_t)st.st_size)
+        {
+            ssize_t n = read(fd, data + done, (size_t)st.st_size - done);
+            if (n == -1 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            done += (size_t)n;
+        }
+        data[done] = '\0';
+        *size = done;
+    }
+    close(fd);
+    return data;
+}
+
+/**
+ * @struct byte_buffer
+ * @brief Buffer creciente donde se serializa el índice.
+ */
+typedef struct
+{
+    unsigned char* data; /**< Bytes escritos. */
+    size_t size;         /**< Bytes usados. */
+    size_t capacity;     /**< Capacidad. */
+    bool failed;         /**< Falló una reserva de memoria. */
+} byte_buffer;
+
+/**
+ * @brief Agrega bytes al buffer.
+ */
+static void put(byte_buffer* buffer, const void* data, size_t size)
+{
+    if (buffer->failed)
+        return;
+    if (buffer->size + size > buffer->capacity)
+    {
+        size_t new_capacity = buffer->capacity ? buffer->capacity : 4096;
+        while (buffer->size + size > new_capacity)
+            new_capacity *= 2;
+        unsigned char* data_grown = realloc(buffer->data, new_capacity);
+        if (data_grown == NULL)
+        {
+            buffer->failed = true;
+            return;
+        }
+        buffer->data = data_grown;
+        buffer->capacity = new_capacity;
+    }
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+}
+
+/**
+ * @brief Agrega una cadena como longitud (u32), bytes y '\0'.
+ */
+static void put_string(byte_buffer* buffer, const char* value)
+{
+    uint32_t length = (uint32_t)strlen(value);
+    put(buffer, &length, sizeof(length));
+    put(buffer, value, length + 1);
+}
+
+/**
+ * @brief Guarda el índice en su archivo.
+ *
+ * @return 0 si se guardó, -1 en caso de error.
+ */
+static int save_index(const config_index* idx)
+{
+    char* path = index_file_path(idx->root, true);
+    if (path == NULL)
+        return -1;
+
+    index_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+    header.root_length = (uint32_t)strlen(idx->root);
+    header.updated_sec = idx->updated_sec;
+    header.updated_nsec = idx->updated_nsec;
+    header.num_dirs = (uint32_t)idx->num_dirs;
+
+    byte_buffer buffer = {NULL, 0, 0, false};
+    put(&buffer, &header, sizeof(header));
+    put(&buffer, idx->root, header.root_length + 1);
+    for (size_t slot = 0; slot < idx->num_dirs; slot++)
+    {
+        const index_dir* dir = &idx->dirs[slot];
+        uint32_t num_files = (uint32_t)dir->num_files;
+        put_string(&buffer, dir->path);
+        put(&buffer, &dir->dev, sizeof(dir->dev));
+        put(&buffer, &dir->ino, sizeof(dir->ino));
+        put(&buffer, &dir->mtime_sec, sizeof(dir->mtime_sec));
+        put(&buffer, &dir->mtime_nsec, sizeof(dir->mtime_nsec));
+        put(&buffer, &num_files, sizeof(num_files));
+        for (size_t i = 0; i < dir->num_files; i++)
+            put_string(&buffer, dir->files[i]);
+    }
+
+    int status = buffer.failed ? -1 : replace_file(path, buffer.data, buffer.size);
+    free(buffer.data);
+    free(path);
+    return status;
+}
+
+/**
+ * @struct cursor
+ * @brief Posición de lectura dentro del archivo de índice, con el límite que no debe superarse.
+ */
+typedef struct
+{
+    const char* pos; /**< Próximo byte a leer. */
+    const char* end; /**< Fin del contenido. */
+} cursor;
+
+/**
+ * @brief Lee `size` bytes.
+ */
+static bool take(cursor* c, void* value, size_t size)
+{
+    if ((size_t)(c->end - c->pos) < size)
+        return false;
+    memcpy(value, c->pos, size);
+    c->pos += size;
+    return true;
+}
+
+/**
+ * @brief Lee una cadena guardada con put_string() y la copia con malloc.
+ */
+static char* take_string(cursor* c)
+{
+    uint32_t length;
+    if (!take(c, &length, sizeof(length)) || (size_t)(c->end - c->pos) <= length || c->pos[length] != '\0')
+        return NULL;
+    char* value = strndup(c->pos, length);
+    c->pos += length + 1;
+    return value;
+}
+
+/**
+ * @brief Libera los arreglos de un directorio del índice.
+ */
+static void free_dir(index_dir* dir)
+{
+    free(dir->path);
+    free_names(dir->files, dir->num_files);
+    free_names(dir->subdirs, dir->num_subdirs);
+}
+
+/**
+ * @brief Crea un índice vacío para una raíz.
+ */
+static config_index* new_index(const char* root)
+{
+    config_index* idx = calloc(1, sizeof(config_index));
+    if (idx == NULL)
+        return NULL;
+    idx->root = strdup(root);
+    idx->inotify_fd = -1;
+    idx->needs_validation = true;
+    if (idx->root == NULL || rebuild_table(idx) == -1)
+    {
+        free(idx->root);
+        free(idx);
+        return NULL;
+    }
+    return idx;
+}
+
+static void stop_watching(config_index* idx);
+
+/**
+ * @brief Libera un índice y detiene su vigilante.
+ */
+static void free_index(config_index* idx)
+{
+    stop_watching(idx);
+    for (size_t slot = 0; slot < idx->num_dirs; slot++)
+        free_dir(&idx->dirs[slot]);
+    free(idx->dirs);
+    free(idx->table);
+    free(idx->root);
+    free(idx);
+}
+
+/**
+ * @brief Carga el índice guardado de una raíz.
+ *
+ * El índice cargado se valida con las fechas de modificación en la primera actualización, porque el árbol pudo
+ * cambiar mientras ninguna shell lo vigilaba.
+ *
+ * @return Índice cargado, o NULL si no existe o es inválido.
+ */
+static config_index* load_index(const char* root)
+{
+    char* path = index_file_path(root, false);
+    size_t size = 0;
+    char* data = path != NULL ? read_file(path, &size) : NULL;
+    free(path);
+    if (data == NULL)
+        return NULL;
+
+    cursor c = {data, data + size};
+    index_header header;
+    config_index* idx = NULL;
+    if (take(&c, &header, sizeof(header)) && memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) == 0 &&
+        header.root_length == strlen(root) && (size_t)(c.end - c.pos) > header.root_length &&
+        memcmp(c.pos, root, header.root_length + 1) == 0)
+    {
+        c.pos += header.root_length + 1;
+        idx = new_index(root);
+    }
+
+    bool ok = idx != NULL;
+    for (uint32_t i = 0; ok && i < header.num_dirs; i++)
+    {
+        uint64_t dev, ino;
+        int64_t mtime_sec, mtime_nsec;
+        uint32_t num_files;
+        char* dir_path = take_string(&c);
+        ok = take(&c, &dev, sizeof(dev)) && take(&c, &ino, sizeof(ino)) && take(&c, &mtime_sec, sizeof(mtime_sec)) &&
+             take(&c, &mtime_nsec, sizeof(mtime_nsec)) && take(&c, &num_files, sizeof(num_files));
+        size_t slot = ok ? add_dir(idx, dir_path, NULL) : NO_SLOT;
+        if (slot == NO_SLOT)
+        {
+            if (!ok)
+                free(dir_path);
+            ok = false;
+            break;
+        }
+        index_dir* dir = &idx->dirs[slot];
+        dir->dev = dev;
+        dir->ino = ino;
+        dir->mtime_sec = mtime_sec;
+        dir->mtime_nsec = mtime_nsec;
+        for (uint32_t j = 0; ok && j < num_files; j++)
+            ok = append_name(&dir->files, &dir->num_files, take_string(&c)) == 0;
+    }
+    free(data);
+
+    if (!ok)
+    {
+        if (idx != NULL)
+            free_index(idx);
+        return NULL;
+    }
+    idx->updated_sec = header.updated_sec;
+    idx->updated_nsec = header.updated_nsec;
+    link_parents(idx, 0);
+    return idx;
+}
+
+/**
+ * @struct walk_state
+ * @brief Datos del recorrido de un subárbol para agregar sus directorios al índice.
+ */
+typedef struct
+{
+    config_index* idx;    /**< Índice al que se agregan los directorios. */
+    const char* prefix;   /**< Ruta relativa del subárbol dentro de la raíz ("." para la raíz). */
+    pthread_mutex_t lock; /**< Serializa las llamadas de los hilos del recorrido. */
+    bool failed;          /**< No se pudo agregar algún directorio. */
+} walk_state;
+
+/**
+ * @brief Agrega al índice un directorio informado por scan_tree().
+ */
+static void on_walk_directory(const char* rel_path, const struct stat* st, void* data)
+{
+    walk_state* state = data;
+    char* path = strcmp(rel_path, ".") == 0 ? strdup(state->prefix) : join_path(state->prefix, rel_path);
+    pthread_mutex_lock(&state->lock);
+    if (add_dir(state->idx, path, st) == NO_SLOT)
+        state->failed = true;
+    pthread_mutex_unlock(&state->lock);
+}
+
+/**
+ * @brief Recorre un subárbol con scan_tree() y agrega sus directorios y archivos al índice.
+ *
+ * @param rel_path Ruta del subárbol relativa a la raíz ("." para todo el árbol).
+ * @return 0 si el recorrido terminó, -1 en caso de error.
+ */
+static int walk_subtree(config_index* idx, const char* rel_path)
+{
+    char* start = absolute_path(idx, rel_path);
+    if (start == NULL)
+        return -1;
+
+    size_t first = idx->num_dirs;
+    walk_state state = {idx, rel_path, PTHREAD_MUTEX_INITIALIZER, false};
+    scan_result result;
+    int status = scan_tree(start, 0, on_walk_directory, &state, &result);
+    free(start);
+    pthread_mutex_destroy(&state.lock);
+    if (status == -1)
+        return -1;
+
+    // Las rutas encontradas son absolutas; se agrupan por directorio relativo a la raíz
+    size_t root_len = strlen(idx->root);
+    for (size_t i = 0; i < result.count; i++)
+    {
+        const char* rel_file = result.paths[i] + root_len;
+        if (*rel_file == '/')
+            rel_file++;
+        char* dir_path = parent_path(rel_file);
+        size_t slot = dir_path != NULL ? find_dir(idx, dir_path) : NO_SLOT;
+        free(dir_path);
+        if (slot == NO_SLOT)
+            continue;
+        index_dir* dir = &idx->dirs[slot];
+        if (append_name(&dir->files, &dir->num_files, strdup(base_name(rel_file))) == -1)
+            state.failed = true;
+    }
+    scan_result_free(&result);
+    link_parents(idx, first);
+    idx->last_walked += idx->num_dirs - first;
+    return state.failed ? -1 : 0;
+}
+
+/**
+ * @brief Comienza a vigilar un directorio del índice.
+ *
+ * Después de agregar la vigilancia se compara el estado del directorio con el guardado, para no perder los cambios
+ * ocurridos entre la lectura y la vigilancia.
+ *
+ * Un directorio que ya no existe o no puede leerse queda sin vigilar y marcado para releerse; la actualización lo
+ * descarta o vuelve a intentarlo.
+ *
+ * @return 0 si la vigilancia se agregó o el directorio ya no es vigilable, -1 si se agotaron las vigilancias o la
+ * memoria.
+ */
+static int watch_dir(config_index* idx, size_t slot)
+{
+    index_dir* dir = &idx->dirs[slot];
+    char* path = absolute_path(idx, dir->path);
+    if (path == NULL)
+        return -1;
+    int wd = inotify_add_watch(idx->inotify_fd, path, WATCH_MASK);
+    struct stat st;
+    bool changed = wd != -1 && (stat(path, &st) == -1 || (uint64_t)st.st_dev != dir->dev ||
+                                (uint64_t)st.st_ino != dir->ino || (int64_t)st.st_mtim.tv_sec != dir->mtime_sec ||
+                                (int64_t)st.st_mtim.tv_nsec != dir->mtime_nsec);
+    free(path);
+    if (wd == -1)
+    {
+        dir->dirty = true;
+        return errno == ENOSPC || errno == ENOMEM ? -1 : 0;
+    }
+
+    if ((size_t)wd >= idx->num_watch_slots)
+    {
+        size_t new_size = idx->num_watch_slots ? idx->num_watch_slots : INITIAL_INDEX_CAPACITY;
+        while (new_size <= (size_t)wd)
+            new_size *= 2;
+        size_t* slots = realloc(idx->watch_slots, new_size * sizeof(size_t));
+        if (slots == NULL)
+        {
+            inotify_rm_watch(idx->inotify_fd, wd);
+            return -1;
+        }
+        for (size_t i = idx->num_watch_slots; i < new_size; i++)
+            slots[i] = NO_SLOT;
+        idx->watch_slots = slots;
+        idx->num_watch_slots = new_size;
+    }
+    if (idx->watch_slots[wd] == NO_SLOT)
+        idx->num_watches++;
+    idx->watch_slots[wd] = slot;
+    dir->wd = wd;
+    dir->dirty = dir->dirty || changed;
+    return 0;
+}
+
+/**
+ * @brief Marca como modificado el directorio de una vigilancia y, si se pide, también a su padre.
+ */
+static void mark_watch_dirty(config_index* idx, int wd, bool parent_too)
+{
+    if (wd < 0 || (size_t)wd >= idx->num_watch_slots || idx->watch_slots[wd] == NO_SLOT)
+        return;
+    index_dir* dir = &idx->dirs[idx->watch_slots[wd]];
+    dir->dirty = true;
+    if (!parent_too)
+        return;
+    if (dir->parent == NO_SLOT)
+        idx->needs_validation = true; // La raíz se movió o se borró
+    else
+        idx->dirs[dir->parent].dirty = true;
+}
+
+/**
+ * @brief Lee todos los eventos pendientes del vigilante y marca los directorios que cambiaron.
+ */
+static void drain_events(config_index* idx)
+{
+    char buffer[INOTIFY_BUFFER_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+    for (;;)
+    {
+        ssize_t n = read(idx->inotify_fd, buffer, sizeof(buffer));
+        if (n == -1 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;
+
+        for (char* p = buffer; p < buffer + n;)
+        {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                idx->needs_validation = true; // Se perdieron eventos
+                continue;
+            }
+            if (event->mask & IN_IGNORED)
+            {
+                // La vigilancia terminó (directorio borrado o desmontado); se relee y se vuelve a vigilar si existe
+                mark_watch_dirty(idx, event->wd, true);
+                if ((size_t)event->wd < idx->num_watch_slots && idx->watch_slots[event->wd] != NO_SLOT)
+                {
+                    idx->dirs[idx->watch_slots[event->wd]].wd = -1;
+                    idx->watch_slots[event->wd] = NO_SLOT;
+                    idx->num_watches--;
+                }
+                continue;
+            }
+            mark_watch_dirty(idx, event->wd, (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT)) != 0);
+        }
+    }
+}
+
+/**
+ * @brief Atiende el descriptor de inotify desde el bucle de eventos de la shell.
+ */
+static void on_inotify_ready(int fd, void* data)
+{
+    (void)fd;
+    drain_events(data);
+}
+
+/**
+ * @brief Detiene el vigilante: a partir de ahí los cambios se detectan comparando fechas de modificación.
+ */
+static void stop_watching(config_index* idx)
+{
+    if (idx->inotify_fd == -1)
+        return;
+    if (event_loop_active())
+        event_loop_remove_fd(idx->inotify_fd);
+    close(idx->inotify_fd);
+    idx->inotify_fd = -1;
+    free(idx->watch_slots);
+    idx->watch_slots = NULL;
+    idx->num_watch_slots = 0;
+    idx->num_watches = 0;
+    for (size_t slot = 0; slot < idx->num_dirs; slot++)
+        idx->dirs[slot].wd = -1;
+    idx->needs_validation = true;
+}
+
+/**
+ * @brief Vigila todos los directorios del índice con inotify.
+ *
+ * Si no se pueden vigilar todos (por ejemplo, por el límite de `max_user_watches`), el vigilante se descarta y el
+ * índice se valida con fechas de modificación en cada consulta. Con el bucle de eventos activo, los eventos se leen
+ * mientras la shell espera la entrada; en cualquier caso se leen antes de cada consulta.
+ */
+static void start_watching(config_index* idx)
+{
+    if (idx->inotify_fd != -1)
+        return;
+    idx->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (idx->inotify_fd == -1)
+        return;
+    for (size_t slot = 0; slot < idx->num_dirs; slot++)
+    {
+        if (watch_dir(idx, slot) == -1)
+        {
+            stop_watching(idx);
+            return;
+        }
+    }
+    if (event_loop_active())
+        event_loop_add_fd(idx->inotify_fd, on_inotify_ready, idx);
+}
+
+/**
+ * @brief Compara el estado de cada directorio con el guardado y marca los que cambiaron.
+ *
+ * Un directorio modificado en el mismo segundo en que empezó la última actualización se relee siempre: su fecha de
+ * modificación no alcanza para saber si la lectura vio el último cambio.
+ */
+static void validate_dirs(config_index* idx, int root_fd)
+{
+    for (size_t slot = 0; slot < idx->num_dirs; slot++)
+    {
+        index_dir* dir = &idx->dirs[slot];
+        struct stat st;
+        if (fstatat(root_fd, dir->path, &st, 0) == -1 || !S_ISDIR(st.st_mode))
+            dir->dead = true;
+        else if ((uint64_t)st.st_dev != dir->dev || (uint64_t)st.st_ino != dir->ino ||
+                 (int64_t)st.st_mtim.tv_sec != dir->mtime_sec || (int64_t)st.st_mtim.tv_nsec != dir->mtime_nsec ||
+                 dir->mtime_sec >= idx->updated_sec)
+            dir->dirty = true;
+    }
+    idx->needs_validation = false;
+}
+
+/**
+ * @brief Vuelve a leer un directorio: actualiza sus archivos y guarda la lista de sus subdirectorios.
+ *
+ * Las listas se arman aparte y reemplazan a las anteriores solo si la lectura se completó: si falta memoria, el
+ * directorio conserva su contenido y su fecha anteriores y queda pendiente para la próxima actualización.
+ *
+ * @return 0 si se releyó (o dejó de existir), -1 si no hay memoria.
+ */
+static int reread_dir(config_index* idx, int root_fd, size_t slot)
+{
+    index_dir* dir = &idx->dirs[slot];
+    dir->dirty = false;
+    int fd = openat(root_fd, dir->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) == -1)
+    {
+        if (fd != -1)
+            close(fd);
+        dir->dead = true;
+        return 0;
+    }
+    DIR* stream = fdopendir(fd);
+    if (stream == NULL)
+    {
+        close(fd);
+        dir->dead = true;
+        return 0;
+    }
+    uint64_t dev = (uint64_t)st.st_dev;
+    uint64_t ino = (uint64_t)st.st_ino;
+    int64_t mtime_sec = (int64_t)st.st_mtim.tv_sec;
+    int64_t mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+
+    char** files = NULL;
+    char** subdirs = NULL;
+    size_t num_files = 0;
+    size_t num_subdirs = 0;
+    int status = 0;
+    struct dirent* entry;
+    while (status == 0 && (entry = readdir(stream)) != NULL)
+    {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+            continue;
+        unsigned char type = entry->d_type;
+        if (type == DT_LNK || type == DT_UNKNOWN)
+        {
+            if (fstatat(dirfd(stream), name, &st, 0) == -1)
+                continue;
+            type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+        }
+        if (type == DT_DIR)
+            status = append_name(&subdirs, &num_subdirs, strdup(name));
+        else if (type == DT_REG && is_config_file_name(name))
+            status = append_name(&files, &num_files, strdup(name));
+    }
+    closedir(stream);
+    if (status == -1)
+    {
+        free_names(files, num_files);
+        free_names(subdirs, num_subdirs);
+        dir->dirty = true;
+        return -1;
+    }
+
+    if (dev != dir->dev || ino != dir->ino)
+        dir->replaced = true;
+    dir->dev = dev;
+    dir->ino = ino;
+    dir->mtime_sec = mtime_sec;
+    dir->mtime_nsec = mtime_nsec;
+    free_names(dir->files, dir->num_files);
+    dir->files = files;
+    dir->num_files = num_files;
+    qsort(subdirs, num_subdirs, sizeof(char*), compare_names);
+    free_names(dir->subdirs, dir->num_subdirs);
+    dir->subdirs = subdirs;
+    dir->num_subdirs = num_subdirs;
+    dir->reread = true;
+    if (idx->inotify_fd != -1 && dir->wd == -1)
+        watch_dir(idx, slot);
+    return 0;
+}
+
+/**
+ * @brief Indica si un directorio dejó de existir: porque se borró, o porque su padre ya no lo lista o se reemplazó.
+ */
+static bool is_removed(config_index* idx, size_t slot)
+{
+    index_dir* dir = &idx->dirs[slot];
+    if (dir->dead || dir->parent == NO_SLOT)
+        return dir->dead;
+
+    index_dir* parent = &idx->dirs[dir->parent];
+    const char* name = base_name(dir->path);
+    bool listed = !parent->reread ||
+                  bsearch(&name, parent->subdirs, parent->num_subdirs, sizeof(char*), compare_names) != NULL;
+    if (parent->replaced || !listed || is_removed(idx, dir->parent))
+        dir->dead = true;
+    return dir->dead;
+}
+
+/**
+ * @brief Elimina del índice los directorios muertos, sus vigilancias y sus posiciones en la tabla.
+ *
+ * La tabla nueva se reserva antes de mover los directorios: si falta memoria, el índice queda sin compactar y con
+ * la tabla anterior, que sigue siendo válida.
+ *
+ * @return 0 si el índice se compactó, -1 si no hay memoria.
+ */
+static int compact(config_index* idx)
+{
+    size_t live = 0;
+    for (size_t slot = 0; slot < idx->num_dirs; slot++)
+        live += !idx->dirs[slot].dead;
+    size_t size;
+    size_t* table = alloc_table(live, &size);
+    size_t* remap = malloc((idx->num_dirs ? idx->num_dirs : 1) * sizeof(size_t));
+    if (table == NULL || remap == NULL)
+    {
+        free(table);
+        free(remap);
+        return -1;
+    }
+
+    size_t kept = 0;
+    for (size_t slot = 0; slot < idx->num_dirs; slot++)
+    {
+        index_dir* dir = &idx->dirs[slot];
+        if (!dir->dead)
+        {
+            remap[slot] = kept;
+            idx->dirs[kept++] = *dir;
+            continue;
+        }
+        remap[slot] = NO_SLOT;
+        if (dir->wd != -1)
+        {
+            idx->watch_slots[dir->wd] = NO_SLOT;
+            idx->num_watches--;
+            inotify_rm_watch(idx->inotify_fd, dir->wd);
+        }
+        free_dir(dir);
+    }
+    idx->num_dirs = kept;
+    for (size_t slot = 0; slot < kept; slot++)
+    {
+        index_dir* dir = &idx->dirs[slot];
+        if (dir->parent != NO_SLOT)
+            dir->parent = remap[dir->parent];
+        if (dir->wd != -1)
+            idx->watch_slots[dir->wd] = slot;
+    }
+    free(remap);
+    install_table(idx, table, size);
+    return 0;
+}
+
+/**
+ * @brief Indica si un directorio con esa identidad ya está en el índice (se alcanzó por otro camino).
+ */
+static bool has_identity(const config_index* idx, uint64_t dev, uint64_t ino)
+{
+    for (size_t slot = 0; slot < idx->num_dirs; slot++)
+    {
+        if (idx->dirs[slot].dev == dev && idx->dirs[slot].ino == ino)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Junta los subdirectorios de los directorios releídos que todavía no están en el índice.
+ *
+ * Los enlaces simbólicos a directorios se separan en `links`: se recorren después que los directorios reales, y solo
+ * si su destino no quedó indexado por su ruta real, igual que en el recorrido completo.
+ *
+ * @return 0 si se juntaron todos, -1 si falta memoria: el directorio afectado queda pendiente para releerse.
+ */
+static int collect_new_subdirs(config_index* idx, int root_fd, char*** paths, size_t* count, char*** links,
+                               size_t* num_links)
+{
+    int status = 0;
+    for (size_t slot = 0; slot < idx->num_dirs; slot++)
+    {
+        index_dir* dir = &idx->dirs[slot];
+        for (size_t i = 0; dir->reread && i < dir->num_subdirs; i++)
+        {
+            char* child = join_path(dir->path, dir->subdirs[i]);
+            if (child != NULL && find_dir(idx, child) != NO_SLOT)
+            {
+                free(child);
+                continue;
+            }
+            struct stat st;
+            bool is_link = child != NULL && fstatat(root_fd, child, &st, AT_SYMLINK_NOFOLLOW) == 0 &&
+                           S_ISLNK(st.st_mode);
+            if (is_link ? append_name(links, num_links, child) == -1 : append_name(paths, count, child) == -1)
+            {
+                dir->dirty = true;
+                status = -1;
+            }
+        }
+        free_names(dir->subdirs, dir->num_subdirs);
+        dir->subdirs = NULL;
+        dir->num_subdirs = 0;
+        dir->reread = false;
+        dir->replaced = false;
+    }
+    return status;
+}
+
+/**
+ * @brief Pone el índice al día releyendo solo los directorios que cambiaron y recorriendo solo los nuevos.
+ *
+ * @return 0 si el índice quedó al día, -1 si la raíz no puede abrirse o algún directorio no pudo releerse.
+ */
+static int refresh_index(config_index* idx)
+{
+    struct timespec start;
+    clock_gettime(CLOCK_REALTIME, &start);
+    int root_fd = open(idx->root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (root_fd == -1)
+        return -1;
+
+    if (idx->inotify_fd != -1)
+        drain_events(idx);
+    if (idx->inotify_fd == -1 || idx->needs_validation)
+        validate_dirs(idx, root_fd);
+
+    size_t reread = 0;
+    int status = 0;
+    for (size_t slot = 0; slot < idx->num_dirs; slot++)
+    {
+        if (idx->dirs[slot].dirty && !idx->dirs[slot].dead)
+        {
+            if (reread_dir(idx, root_fd, slot) == -1)
+                status = -1; // Sigue marcado: se releerá en la próxima consulta
+            else
+                reread++;
+        }
+    }
+
+    bool removed = false;
+    for (size_t slot = 0; slot < idx->num_dirs; slot++)
+        removed = is_removed(idx, slot) || removed;
+    if (removed && compact(idx) == -1)
+    {
+        // La tabla todavía contiene los directorios muertos, que ocultarían a los nuevos con la misma ruta: los
+        // subdirectorios releídos y las marcas se conservan para completar la actualización en la próxima consulta
+        close(root_fd);
+        return -1;
+    }
+
+    char** new_dirs = NULL;
+    char** new_links = NULL;
+    size_t num_new_dirs = 0;
+    size_t num_new_links = 0;
+    if (collect_new_subdirs(idx, root_fd, &new_dirs, &num_new_dirs, &new_links, &num_new_links) == -1)
+        status = -1;
+    idx->last_walked = 0;
+    size_t first = idx->num_dirs;
+    if (find_dir(idx, ".") == NO_SLOT)
+        walk_subtree(idx, "."); // La raíz se reemplazó por completo
+    for (size_t i = 0; i < num_new_dirs; i++)
+        walk_subtree(idx, new_dirs[i]);
+    qsort(new_links, num_new_links, sizeof(char*), compare_names);
+    for (size_t i = 0; i < num_new_links; i++)
+    {
+        struct stat st;
+        if (fstatat(root_fd, new_links[i], &st, 0) == 0 &&
+            !has_identity(idx, (uint64_t)st.st_dev, (uint64_t)st.st_ino))
+            walk_subtree(idx, new_links[i]);
+    }
+    free_names(new_dirs, num_new_dirs);
+    free_names(new_links, num_new_links);
+    for (size_t slot = first; idx->inotify_fd != -1 && slot < idx->num_dirs; slot++)
+    {
+        if (watch_dir(idx, slot) == -1)
+            stop_watching(idx);
+    }
+    close(root_fd);
+
+    idx->last_reread = reread;
+    idx->updated_sec = (int64_t)start.tv_sec;
+    idx->updated_nsec = (int64_t)start.tv_nsec;
+    if (reread > 0 || removed || idx->last_walked > 0)
+        save_index(idx);
+    return status;
+}
+
+/**
+ * @brief Construye desde cero el índice de una raíz, lo guarda y empieza a vigilarlo.
+ */
+static config_index* build_index(const char* root)
+{
+    config_index* idx = new_index(root);
+    if (idx == NULL)
+        return NULL;
+    struct timespec start;
+    clock_gettime(CLOCK_REALTIME, &start);
+    if (walk_subtree(idx, ".") == -1)
+    {
+        free_index(idx);
+        return NULL;
+    }
+    idx->updated_sec = (int64_t)start.tv_sec;
+    idx->updated_nsec = (int64_t)start.tv_nsec;
+    idx->needs_validation = false;
+    save_index(idx);
+    start_watching(idx);
+    return idx;
+}
+
+/**
+ * @brief Lee las raíces registradas.
+ *
+ * @return Cantidad de raíces; `*roots` queda reservado con malloc (o NULL si no hay ninguna).
+ */
+static size_t read_roots(char*** roots)
+{
+    *roots = NULL;
+    size_t count = 0;
+    char* path = cache_path(INDEX_ROOTS_FILE, false);
+    size_t size;
+    char* data = path != NULL ? read_file(path, &size) : NULL;
+    free(path);
+    if (data == NULL)
+        return 0;
+    for (char* line = strtok(data, "\n"); line != NULL; line = strtok(NULL, "\n"))
+    {
+        if (*line == '/')
+            append_name(roots, &count, strdup(line));
+    }
+    free(data);
+    return count;
+}
+
+/**
+ * @brief Guarda la lista de raíces registradas.
+ */
+static int write_roots(char** roots, size_t count)
+{
+    char* path = cache_path(INDEX_ROOTS_FILE, true);
+    if (path == NULL)
+        return -1;
+    byte_buffer buffer = {NULL, 0, 0, false};
+    for (size_t i = 0; i < count; i++)
+    {
+        put(&buffer, roots[i], strlen(roots[i]));
+        put(&buffer, "\n", 1);
+    }
+    int status = buffer.failed ? -1 : replace_file(path, buffer.data, buffer.size);
+    free(buffer.data);
+    free(path);
+    return status;
+}
+
+/**
+ * @brief Busca la raíz registrada más específica que contiene `path`.
+ *
+ * @return Raíz reservada con malloc, o NULL si `path` no está indexado.
+ */
+static char* find_root(const char* path)
+{
+    char** roots;
+    size_t count = read_roots(&roots);
+    char* best = NULL;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (is_under(path, roots[i]) && (best == NULL || strlen(roots[i]) > strlen(best)))
+            best = roots[i];
+    }
+    best = best != NULL ? strdup(best) : NULL;
+    free_names(roots, count);
+    return best;
+}
+
+/**
+ * @brief Busca un índice entre los cargados.
+ */
+static config_index* find_loaded(const char* root)
+{
+    for (config_index* idx = loaded_indexes; idx != NULL; idx = idx->next)
+    {
+        if (strcmp(idx->root, root) == 0)
+            return idx;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Descarga un índice: lo quita de la lista de cargados y lo libera.
+ */
+static void unload(const char* root)
+{
+    for (config_index** link = &loaded_indexes; *link != NULL; link = &(*link)->next)
+    {
+        if (strcmp((*link)->root, root) == 0)
+        {
+            config_index* idx = *link;
+            *link = idx->next;
+            free_index(idx);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Devuelve el índice de una raíz: el cargado, el guardado en disco o uno nuevo si se pide construirlo.
+ */
+static config_index* get_index(const char* root, bool build)
+{
+    config_index* idx = find_loaded(root);
+    if (idx != NULL)
+        return idx;
+    idx = load_index(root);
+    if (idx != NULL)
+        start_watching(idx);
+    else if (build)
+        idx = build_index(root);
+    if (idx != NULL)
+    {
+        idx->next = loaded_indexes;
+        loaded_indexes = idx;
+    }
+    return idx;
+}
+
+/**
+ * @brief Cuenta los archivos de configuración del índice.
+ */
+static size_t count_files(const config_index* idx)
+{
+    size_t total = 0;
+    for (size_t slot = 0; slot < idx->num_dirs; slot++)
+        total += idx->dirs[slot].num_files;
+    return total;
+}
+
+/**
+ * @brief Registra un directorio como raíz indexada y construye su índice.
+ */
+int config_index_register(const char* root)
+{
+    char* real = realpath(root, NULL);
+    if (real == NULL)
+        return -1;
+
+    char** roots;
+    size_t count = read_roots(&roots);
+    bool known = false;
+    for (size_t i = 0; i < count; i++)
+        known = known || strcmp(roots[i], real) == 0;
+    int status = 0;
+    if (!known)
+    {
+        char* copy = strdup(real);
+        status = append_name(&roots, &count, copy) == -1 ? -1 : write_roots(roots, count);
+    }
+    free_names(roots, count);
+
+    if (status == 0)
+    {
+        unload(real);
+        config_index* idx = build_index(real);
+        if (idx == NULL)
+            status = -1;
+        else
+        {
+            idx->next = loaded_indexes;
+            loaded_indexes = idx;
+            printf("Índice creado para %s: %zu directorios, %zu archivos de configuración\n", real, idx->num_dirs,
+                   count_files(idx));
+        }
+    }
+    free(real);
+    return status;
+}
+
+/**
+ * @brief Quita una raíz del registro y borra su índice.
+ */
+int config_index_unregister(const char* path)
+{
+    char* root = find_root(path);
+    if (root == NULL)
+        return -1;
+
+    char** roots;
+    size_t count = read_roots(&roots);
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (strcmp(roots[i], root) == 0)
+            free(roots[i]);
+        else
+            roots[kept++] = roots[i];
+    }
+    int status = write_roots(roots, kept);
+    free_names(roots, kept);
+
+    unload(root);
+    char* index_path = index_file_path(root, false);
+    if (index_path != NULL)
+        unlink(index_path);
+    free(index_path);
+    free(root);
+    return status;
+}
+
+/**
+ * @brief Vuelve a recorrer por completo la raíz registrada que contiene `path` y reemplaza su índice.
+ */
+int config_index_rebuild(const char* path)
+{
+    char* root = find_root(path);
+    if (root == NULL)
+        return -1;
+    unload(root);
+    config_index* idx = build_index(root);
+    free(root);
+    if (idx == NULL)
+        return -1;
+    idx->next = loaded_indexes;
+    loaded_indexes = idx;
+    printf("Índice reconstruido para %s: %zu directorios, %zu archivos de configuración\n", idx->root, idx->num_dirs,
+           count_files(idx));
+    return 0;
+}
+
+/**
+ * @brief Responde `scan` desde el índice si `path` está dentro de una raíz registrada.
+ */
+int config_index_scan(const char* path, scan_result* result)
+{
+    result->paths = NULL;
+    result->count = 0;
+    char* root = find_root(path);
+    if (root == NULL)
+        return -1;
+    config_index* idx = get_index(root, true);
+    free(root);
+    if (idx == NULL || refresh_index(idx) == -1)
+        return -1;
+
+    // Ruta de búsqueda relativa a la raíz: "." para la raíz misma
+    const char* prefix = path + strlen(idx->root);
+    while (*prefix == '/')
+        prefix++;
+    if (*prefix == '\0')
+        prefix = ".";
+
+    for (size_t slot = 0; slot < idx->num_dirs; slot++)
+    {
+        const index_dir* dir = &idx->dirs[slot];
+        if (strcmp(prefix, ".") != 0 && !is_under(dir->path, prefix))
+            continue;
+        for (size_t i = 0; i < dir->num_files; i++)
+        {
+            char* rel_file = join_path(dir->path, dir->files[i]);
+            char* file = rel_file != NULL ? join_path(idx->root, rel_file) : NULL;
+            free(rel_file);
+            if (file == NULL || append_name(&result->paths, &result->count, file) == -1)
+            {
+                scan_result_free(result);
+                return -1;
+            }
+        }
+    }
+    qsort(result->paths, result->count, sizeof(char*), compare_names);
+    return 0;
+}
+
+/**
+ * @brief Muestra el tamaño y la antigüedad del índice de cada raíz registrada.
+ */
+void config_index_print_stats(void)
+{
+    char** roots;
+    size_t count = read_roots(&roots);
+    if (count == 0)
+        printf("No hay directorios indexados (use 'scan --index' para indexar el directorio actual)\n");
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    for (size_t i = 0; i < count; i++)
+    {
+        printf("Índice de %s\n", roots[i]);
+        config_index* idx = get_index(roots[i], false);
+        char* index_path = index_file_path(roots[i], false);
+        struct stat st;
+        if (idx == NULL || index_path == NULL || stat(index_path, &st) == -1)
+        {
+            printf("  sin índice guardado (use 'scan --rebuild')\n");
+            free(index_path);
+            continue;
+        }
+        if (idx->inotify_fd != -1)
+            drain_events(idx);
+        size_t dirty = 0;
+        for (size_t slot = 0; slot < idx->num_dirs; slot++)
+            dirty += idx->dirs[slot].dirty;
+
+        printf("  archivo: %s (%lld bytes)\n", index_path, (long long)st.st_size);
+        printf("  directorios: %zu, archivos de configuración: %zu\n", idx->num_dirs, count_files(idx));
+        printf("  última actualización: hace %lld s (%zu directorios releídos, %zu recorridos)\n",
+               (long long)(now.tv_sec - idx->updated_sec), idx->last_reread, idx->last_walked);
+        if (idx->inotify_fd != -1)
+            printf("  vigilancia: activa sobre %zu directorios\n", idx->num_watches);
+        else
+            printf("  vigilancia: inactiva; los cambios se detectan por fecha de modificación\n");
+        if (idx->needs_validation)
+            printf("  pendientes: se validará todo el árbol en la próxima consulta\n");
+        else
+            printf("  pendientes: %zu directorios por releer\n", dirty);
+        free(index_path);
+    }
+    free_names(roots, count);
+}
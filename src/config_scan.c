@@ -0,0 +1,747 @@
+#include "config_scan.h"
+#include "file_util.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define INITIAL_QUEUE_CAPACITY 64     // Capacidad inicial de la cola de directorios de cada hilo
+#define INITIAL_VISITED_CAPACITY 1024 // Capacidad inicial del conjunto de directorios visitados (potencia de 2)
+#define IDLE_WAIT_NS 1000000          // Espera máxima de un hilo sin trabajo antes de volver a buscar (1 ms)
+#define COPY_CHUNK_SIZE (256 * 1024)  // Bloque de copia cuando la salida es una terminal
+#define SENDFILE_CHUNK (1L << 30)     // Máximo de bytes por llamada a sendfile()
+#define HEADER_FORMAT "\033[1;31mArchivo de configuracion encontrado: %s\ncontenido de %s:\033[38;5;87m\n"
+
+/**
+ * @struct work_queue
+ * @brief Directorios pendientes de un hilo.
+ *
+ * El dueño agrega y toma por el final, lo que mantiene el recorrido en profundidad y acota la cola; los demás hilos
+ * roban por el principio, donde están los directorios más cercanos a la raíz y con más trabajo por delante.
+ */
+typedef struct
+{
+    char** items;         /**< Rutas relativas a la raíz. */
+    size_t head;          /**< Primer elemento pendiente. */
+    size_t tail;          /**< Posición siguiente al último elemento. */
+    size_t capacity;      /**< Capacidad del arreglo. */
+    pthread_mutex_t lock; /**< Protege la cola frente a los robos. */
+} work_queue;
+
+/**
+ * @struct path_list
+ * @brief Arreglo dinámico de rutas.
+ */
+typedef struct
+{
+    char** items;    /**< Rutas reservadas con malloc. */
+    size_t count;    /**< Cantidad de rutas. */
+    size_t capacity; /**< Capacidad del arreglo. */
+} path_list;
+
+/**
+ * @brief Estado de un directorio en el conjunto de visitados.
+ */
+typedef enum
+{
+    DIR_UNSEEN = 0,   /**< Posición libre de la tabla. */
+    DIR_VISITED,      /**< Directorio ya leído (o en lectura). */
+    DIR_RESERVED_LINK /**< Directorio pendiente que se alcanzó por un enlace simbólico. */
+} dir_state;
+
+/**
+ * @struct dir_key
+ * @brief Identidad de un directorio visitado.
+ */
+typedef struct
+{
+    dev_t dev; /**< Dispositivo. */
+    ino_t ino; /**< Inodo. */
+} dir_key;
+
+typedef struct scan_context scan_context;
+
+/**
+ * @struct scan_worker
+ * @brief Estado de un hilo del recorrido.
+ */
+typedef struct
+{
+    scan_context* ctx; /**< Recorrido al que pertenece. */
+    work_queue queue;  /**< Directorios pendientes propios. */
+    path_list found;   /**< Archivos encontrados por este hilo. */
+    path_list links;   /**< Enlaces simbólicos a directorios, que se recorren en la ronda siguiente. */
+    int index;         /**< Posición del hilo en el arreglo de hilos. */
+} scan_worker;
+
+/**
+ * @struct scan_context
+ * @brief Estado compartido por todos los hilos del recorrido.
+ */
+struct scan_context
+{
+    const char* root;               /**< Raíz tal como se recibió, para armar las rutas encontradas. */
+    int root_fd;                    /**< Descriptor de la raíz, base de todos los openat(). */
+    scan_worker* workers;           /**< Hilos del recorrido. */
+    int num_workers;                /**< Cantidad de hilos. */
+    scan_dir_callback on_directory; /**< Función a invocar por cada directorio leído, o NULL. */
+    void* data;                     /**< Dato para `on_directory`. */
+    atomic_size_t pending;          /**< Directorios encolados o en proceso. */
+    atomic_int idle;                /**< Hilos esperando trabajo. */
+    atomic_bool failed;             /**< Falló una reserva de memoria. */
+    pthread_mutex_t idle_lock;      /**< Protege la espera de los hilos sin trabajo. */
+    pthread_cond_t idle_cond;       /**< Despierta a los hilos sin trabajo. */
+    pthread_mutex_t visited_lock;   /**< Protege el conjunto de directorios visitados. */
+    dir_key* visited;               /**< Tabla de direccionamiento abierto con los directorios visitados. */
+    unsigned char* visited_state;   /**< Estado (dir_state) de cada posición de `visited`. */
+    size_t visited_count;           /**< Directorios visitados. */
+    size_t visited_capacity;        /**< Capacidad de la tabla (potencia de 2). */
+};
+
+/**
+ * @brief Verifica si un nombre de archivo tiene extensión ".config" o ".json".
+ */
+bool is_config_file_name(const char* name)
+{
+    const char* ext = strrchr(name, '.');
+    return ext != NULL && (strcmp(ext, ".config") == 0 || strcmp(ext, ".json") == 0);
+}
+
+/**
+ * @brief Agrega una ruta a la lista, que pasa a ser dueña de ella.
+ *
+ * @return 0 si se agregó, -1 si no hay memoria (la ruta se libera).
+ */
+static int append_path(path_list* list, char* path)
+{
+    if (list->count == list->capacity)
+    {
+        size_t new_capacity = list->capacity ? list->capacity * 2 : INITIAL_QUEUE_CAPACITY;
+        char** items = realloc(list->items, new_capacity * sizeof(char*));
+        if (items == NULL)
+        {
+            free(path);
+            return -1;
+        }
+        list->items = items;
+        list->capacity = new_capacity;
+    }
+    list->items[list->count++] = path;
+    return 0;
+}
+
+/**
+ * @brief Libera las rutas de la lista y la deja vacía.
+ */
+static void free_paths(path_list* list)
+{
+    for (size_t i = 0; i < list->count; i++)
+        free(list->items[i]);
+    free(list->items);
+    list->items = NULL;
+    list->count = list->capacity = 0;
+}
+
+/**
+ * @brief Dispersión de la identidad de un directorio para la tabla de visitados.
+ */
+static size_t hash_key(dev_t dev, ino_t ino)
+{
+    uint64_t h = (uint64_t)ino * 0x9E3779B97F4A7C15ULL ^ (uint64_t)dev;
+    return (size_t)(h ^ (h >> 29));
+}
+
+/**
+ * @brief Busca una identidad en una tabla con lugar libre y la inserta con `state` si no estaba.
+ *
+ * @return Estado previo de la identidad (DIR_UNSEEN si se insertó).
+ */
+static dir_state insert_key(dir_key* table, unsigned char* states, size_t capacity, dev_t dev, ino_t ino,
+                            dir_state state)
+{
+    size_t mask = capacity - 1;
+    for (size_t i = hash_key(dev, ino) & mask;; i = (i + 1) & mask)
+    {
+        if (states[i] == DIR_UNSEEN)
+        {
+            states[i] = (unsigned char)state;
+            table[i].dev = dev;
+            table[i].ino = ino;
+            return DIR_UNSEEN;
+        }
+        if (table[i].dev == dev && table[i].ino == ino)
+        {
+            dir_state previous = (dir_state)states[i];
+            if (previous == DIR_RESERVED_LINK && state == DIR_VISITED)
+                states[i] = DIR_VISITED;
+            return previous;
+        }
+    }
+}
+
+/**
+ * @brief Registra un directorio en el conjunto de visitados.
+ *
+ * Con DIR_VISITED se reclama la lectura del directorio; con DIR_RESERVED_LINK se aparta para un enlace simbólico,
+ * que luego lo reclama con DIR_VISITED.
+ *
+ * @return true si el directorio se reclamó o apartó, false si ya se había visitado (o apartado, al apartar) o no hay
+ * memoria para registrarlo.
+ */
+static bool mark_visited(scan_context* ctx, dev_t dev, ino_t ino, dir_state state)
+{
+    pthread_mutex_lock(&ctx->visited_lock);
+    if ((ctx->visited_count + 1) * 2 > ctx->visited_capacity)
+    {
+        size_t new_capacity = ctx->visited_capacity * 2;
+        dir_key* table = malloc(new_capacity * sizeof(dir_key));
+        unsigned char* states = calloc(new_capacity, 1);
+        if (table == NULL || states == NULL)
+        {
+            free(table);
+            free(states);
+            pthread_mutex_unlock(&ctx->visited_lock);
+            atomic_store(&ctx->failed, true);
+            return false;
+        }
+        for (size_t i = 0; i < ctx->visited_capacity; i++)
+        {
+            if (ctx->visited_state[i] != DIR_UNSEEN)
+                insert_key(table, states, new_capacity, ctx->visited[i].dev, ctx->visited[i].ino,
+                           (dir_state)ctx->visited_state[i]);
+        }
+        free(ctx->visited);
+        free(ctx->visited_state);
+        ctx->visited = table;
+        ctx->visited_state = states;
+        ctx->visited_capacity = new_capacity;
+    }
+    dir_state previous = insert_key(ctx->visited, ctx->visited_state, ctx->visited_capacity, dev, ino, state);
+    if (previous == DIR_UNSEEN)
+        ctx->visited_count++;
+    pthread_mutex_unlock(&ctx->visited_lock);
+    return previous == DIR_UNSEEN || (previous == DIR_RESERVED_LINK && state == DIR_VISITED);
+}
+
+/**
+ * @brief Encola un directorio en la cola propia del hilo y despierta a un hilo sin trabajo si lo hay.
+ *
+ * El contador de pendientes se incrementa antes de encolar, para que ningún hilo vea el recorrido terminado mientras
+ * el directorio todavía existe en alguna cola.
+ */
+static void push_work(scan_worker* worker, char* path)
+{
+    scan_context* ctx = worker->ctx;
+    work_queue* queue = &worker->queue;
+
+    atomic_fetch_add(&ctx->pending, 1);
+    pthread_mutex_lock(&queue->lock);
+    if (queue->tail == queue->capacity && queue->head > 0)
+    {
+        memmove(queue->items, queue->items + queue->head, (queue->tail - queue->head) * sizeof(char*));
+        queue->tail -= queue->head;
+        queue->head = 0;
+    }
+    if (queue->tail == queue->capacity)
+    {
+        size_t new_capacity = queue->capacity ? queue->capacity * 2 : INITIAL_QUEUE_CAPACITY;
+        char** items = realloc(queue->items, new_capacity * sizeof(char*));
+        if (items == NULL)
+        {
+            pthread_mutex_unlock(&queue->lock);
+            atomic_store(&ctx->failed, true);
+            atomic_fetch_sub(&ctx->pending, 1);
+            free(path);
+            return;
+        }
+        queue->items = items;
+        queue->capacity = new_capacity;
+    }
+    queue->items[queue->tail++] = path;
+    pthread_mutex_unlock(&queue->lock);
+
+    if (atomic_load(&ctx->idle) > 0)
+    {
+        pthread_mutex_lock(&ctx->idle_lock);
+        pthread_cond_signal(&ctx->idle_cond);
+        pthread_mutex_unlock(&ctx->idle_lock);
+    }
+}
+
+/**
+ * @brief Toma el directorio más reciente de la cola propia.
+ */
+static char* pop_work(scan_worker* worker)
+{
+    work_queue* queue = &worker->queue;
+    char* path = NULL;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->tail > queue->head)
+        path = queue->items[--queue->tail];
+    if (queue->tail == queue->head)
+        queue->head = queue->tail = 0;
+    pthread_mutex_unlock(&queue->lock);
+    return path;
+}
+
+/**
+ * @brief Roba el directorio más antiguo de la cola de otro hilo, recorriéndolos a partir del siguiente.
+ */
+static char* steal_work(scan_worker* worker)
+{
+    scan_context* ctx = worker->ctx;
+    for (int i = 1; i < ctx->num_workers; i++)
+    {
+        work_queue* queue = &ctx->workers[(worker->index + i) % ctx->num_workers].queue;
+        char* path = NULL;
+        pthread_mutex_lock(&queue->lock);
+        if (queue->tail > queue->head)
+            path = queue->items[queue->head++];
+        pthread_mutex_unlock(&queue->lock);
+        if (path != NULL)
+            return path;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Lee un directorio: encola sus subdirectorios y registra sus archivos de configuración.
+ *
+ * @param rel_path Ruta del directorio relativa a la raíz.
+ */
+static void scan_directory(scan_worker* worker, const char* rel_path)
+{
+    scan_context* ctx = worker->ctx;
+    int fd = openat(ctx->root_fd, rel_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        fprintf(stderr, "No se pudo abrir el directorio %s/%s: %s\n", ctx->root, rel_path, strerror(errno));
+        return;
+    }
+
+    struct stat dir_stat;
+    if (fstat(fd, &dir_stat) == -1 || !mark_visited(ctx, dir_stat.st_dev, dir_stat.st_ino, DIR_VISITED))
+    {
+        close(fd); // Ya visitado por otro camino (enlace simbólico), o error
+        return;
+    }
+    if (ctx->on_directory != NULL)
+        ctx->on_directory(rel_path, &dir_stat, ctx->data);
+
+    DIR* dir = fdopendir(fd);
+    if (dir == NULL)
+    {
+        close(fd);
+        return;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+            continue;
+
+        // El tipo de la entrada evita un stat por archivo; solo se resuelven enlaces y sistemas sin d_type
+        unsigned char type = entry->d_type;
+        struct stat st;
+        if (type == DT_UNKNOWN)
+        {
+            if (fstatat(dirfd(dir), name, &st, AT_SYMLINK_NOFOLLOW) == -1)
+                continue;
+            type = S_ISLNK(st.st_mode)   ? DT_LNK
+                   : S_ISDIR(st.st_mode) ? DT_DIR
+                   : S_ISREG(st.st_mode) ? DT_REG
+                                         : DT_UNKNOWN;
+        }
+        bool is_link = type == DT_LNK;
+        if (is_link)
+        {
+            if (fstatat(dirfd(dir), name, &st, 0) == -1)
+                continue; // Enlace roto
+            type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+        }
+        if (type != DT_DIR && (type != DT_REG || !is_config_file_name(name)))
+            continue;
+
+        char* child = join_path(rel_path, name);
+        if (child != NULL && type == DT_REG)
+        {
+            char* full_path = join_path(ctx->root, child);
+            free(child);
+            child = full_path;
+        }
+        if (child == NULL)
+            atomic_store(&ctx->failed, true);
+        else if (type == DT_REG)
+        {
+            if (append_path(&worker->found, child) == -1)
+                atomic_store(&ctx->failed, true);
+        }
+        else if (is_link)
+        {
+            // Los directorios enlazados esperan a la ronda siguiente, para que un directorio alcanzable por su ruta
+            // real se muestre siempre con ella
+            if (append_path(&worker->links, child) == -1)
+                atomic_store(&ctx->failed, true);
+        }
+        else
+            push_work(worker, child);
+    }
+    closedir(dir);
+}
+
+/**
+ * @brief Espera brevemente a que aparezca trabajo o termine el recorrido.
+ *
+ * La espera tiene un límite para no depender de que cada encolado llegue a despertar al hilo.
+ */
+static void wait_for_work(scan_context* ctx)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += IDLE_WAIT_NS;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&ctx->idle_lock);
+    atomic_fetch_add(&ctx->idle, 1);
+    if (atomic_load(&ctx->pending) != 0)
+        pthread_cond_timedwait(&ctx->idle_cond, &ctx->idle_lock, &deadline);
+    atomic_fetch_sub(&ctx->idle, 1);
+    pthread_mutex_unlock(&ctx->idle_lock);
+}
+
+/**
+ * @brief Bucle de un hilo: procesa su cola, roba cuando se vacía y termina cuando no queda nada pendiente.
+ */
+static void* scan_worker_run(void* arg)
+{
+    scan_worker* worker = arg;
+    scan_context* ctx = worker->ctx;
+
+    for (;;)
+    {
+        char* path = pop_work(worker);
+        if (path == NULL)
+            path = steal_work(worker);
+        if (path != NULL)
+        {
+            scan_directory(worker, path);
+            free(path);
+            if (atomic_fetch_sub(&ctx->pending, 1) == 1)
+            {
+                pthread_mutex_lock(&ctx->idle_lock);
+                pthread_cond_broadcast(&ctx->idle_cond);
+                pthread_mutex_unlock(&ctx->idle_lock);
+            }
+            continue;
+        }
+        if (atomic_load(&ctx->pending) == 0)
+            break;
+        wait_for_work(ctx);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Comparador de rutas para qsort.
+ */
+static int compare_paths(const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/**
+ * @brief Reúne las rutas encontradas por cada hilo en un único arreglo ordenado.
+ */
+static int collect_results(scan_context* ctx, scan_result* result)
+{
+    size_t total = 0;
+    for (int i = 0; i < ctx->num_workers; i++)
+        total += ctx->workers[i].found.count;
+
+    result->paths = malloc((total ? total : 1) * sizeof(char*));
+    result->count = 0;
+    if (result->paths == NULL)
+        return -1;
+    for (int i = 0; i < ctx->num_workers; i++)
+    {
+        path_list* found = &ctx->workers[i].found;
+        memcpy(result->paths + result->count, found->items, found->count * sizeof(char*));
+        result->count += found->count;
+        found->count = 0;
+    }
+    qsort(result->paths, result->count, sizeof(char*), compare_paths);
+    return 0;
+}
+
+/**
+ * @brief Ejecuta una ronda del recorrido: el hilo que llama y `num_workers - 1` hilos nuevos vacían las colas.
+ *
+ * Los hilos bloquean todas las señales, para que las de la shell sigan llegando al hilo principal. Si no se puede
+ * crear un hilo, su cola queda vacía y los demás hacen su parte.
+ */
+static void run_round(scan_context* ctx)
+{
+    sigset_t all_signals, old_mask;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_BLOCK, &all_signals, &old_mask);
+    pthread_t threads[SCAN_MAX_THREADS];
+    bool started[SCAN_MAX_THREADS] = {false};
+    for (int i = 1; i < ctx->num_workers; i++)
+        started[i] = pthread_create(&threads[i], NULL, scan_worker_run, &ctx->workers[i]) == 0;
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+
+    scan_worker_run(&ctx->workers[0]);
+    for (int i = 1; i < ctx->num_workers; i++)
+    {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+    }
+}
+
+/**
+ * @brief Encola para la ronda siguiente los directorios enlazados que todavía no se visitaron.
+ *
+ * Los enlaces se procesan en orden alfabético y cada destino se aparta para el primero que lo alcanza, de modo que
+ * el camino por el que se muestra un directorio enlazado no depende del orden en que terminaron los hilos.
+ *
+ * @return Cantidad de directorios encolados.
+ */
+static size_t queue_links(scan_context* ctx)
+{
+    path_list links = {NULL, 0, 0};
+    for (int i = 0; i < ctx->num_workers; i++)
+    {
+        path_list* worker_links = &ctx->workers[i].links;
+        for (size_t j = 0; j < worker_links->count; j++)
+        {
+            if (append_path(&links, worker_links->items[j]) == -1)
+                atomic_store(&ctx->failed, true);
+        }
+        worker_links->count = 0;
+    }
+    qsort(links.items, links.count, sizeof(char*), compare_paths);
+
+    size_t queued = 0;
+    for (size_t i = 0; i < links.count; i++)
+    {
+        struct stat st;
+        if (fstatat(ctx->root_fd, links.items[i], &st, 0) == 0 && S_ISDIR(st.st_mode) &&
+            mark_visited(ctx, st.st_dev, st.st_ino, DIR_RESERVED_LINK))
+        {
+            push_work(&ctx->workers[0], links.items[i]);
+            queued++;
+        }
+        else
+            free(links.items[i]);
+    }
+    free(links.items);
+    return queued;
+}
+
+/**
+ * @brief Busca archivos ".config" y ".json" en un árbol de directorios sin cambiar el directorio de trabajo.
+ *
+ * El recorrido se hace por rondas: la primera sigue solo directorios reales, y cada ronda siguiente parte de los
+ * enlaces simbólicos a directorios encontrados en la anterior.
+ */
+int scan_tree(const char* root, int num_threads, scan_dir_callback on_directory, void* data, scan_result* result)
+{
+    result->paths = NULL;
+    result->count = 0;
+
+    if (num_threads <= 0)
+    {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cores > 0 ? (int)cores : 1;
+    }
+    if (num_threads > SCAN_MAX_THREADS)
+        num_threads = SCAN_MAX_THREADS;
+
+    scan_context ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.root = root;
+    ctx.on_directory = on_directory;
+    ctx.data = data;
+    ctx.root_fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (ctx.root_fd == -1)
+    {
+        fprintf(stderr, "No se pudo abrir el directorio %s: %s\n", root, strerror(errno));
+        return -1;
+    }
+    ctx.num_workers = num_threads;
+    ctx.workers = calloc((size_t)num_threads, sizeof(scan_worker));
+    ctx.visited_capacity = INITIAL_VISITED_CAPACITY;
+    ctx.visited = malloc(ctx.visited_capacity * sizeof(dir_key));
+    ctx.visited_state = calloc(ctx.visited_capacity, 1);
+    char* start = strdup(".");
+    if (ctx.workers == NULL || ctx.visited == NULL || ctx.visited_state == NULL || start == NULL)
+    {
+        free(ctx.workers);
+        free(ctx.visited);
+        free(ctx.visited_state);
+        free(start);
+        close(ctx.root_fd);
+        return -1;
+    }
+    atomic_init(&ctx.pending, 0);
+    atomic_init(&ctx.idle, 0);
+    atomic_init(&ctx.failed, false);
+    pthread_mutex_init(&ctx.idle_lock, NULL);
+    pthread_cond_init(&ctx.idle_cond, NULL);
+    pthread_mutex_init(&ctx.visited_lock, NULL);
+    for (int i = 0; i < num_threads; i++)
+    {
+        ctx.workers[i].ctx = &ctx;
+        ctx.workers[i].index = i;
+        pthread_mutex_init(&ctx.workers[i].queue.lock, NULL);
+    }
+
+    push_work(&ctx.workers[0], start);
+    do
+        run_round(&ctx);
+    while (queue_links(&ctx) > 0);
+
+    int status = atomic_load(&ctx.failed) ? -1 : collect_results(&ctx, result);
+
+    for (int i = 0; i < num_threads; i++)
+    {
+        scan_worker* worker = &ctx.workers[i];
+        free_paths(&worker->found);
+        free_paths(&worker->links);
+        free(worker->queue.items);
+        pthread_mutex_destroy(&worker->queue.lock);
+    }
+    free(ctx.workers);
+    free(ctx.visited);
+    free(ctx.visited_state);
+    pthread_mutex_destroy(&ctx.idle_lock);
+    pthread_cond_destroy(&ctx.idle_cond);
+    pthread_mutex_destroy(&ctx.visited_lock);
+    close(ctx.root_fd);
+    return status;
+}
+
+/**
+ * @brief Libera las rutas de un resultado.
+ */
+void scan_result_free(scan_result* result)
+{
+    for (size_t i = 0; i < result->count; i++)
+        free(result->paths[i]);
+    free(result->paths);
+    result->paths = NULL;
+    result->count = 0;
+}
+
+/**
+ * @brief Busca archivos ".config" y ".json" en un árbol de directorios sin cambiar el directorio de trabajo.
+ */
+int scan_config_files(const char* root, int num_threads, scan_result* result)
+{
+    return scan_tree(root, num_threads, NULL, NULL, result);
+}
+
+/**
+ * @brief Copia el resto de un archivo con read/write en bloques grandes.
+ */
+static int copy_with_buffer(int in_fd, int out_fd)
+{
+    char* buffer = malloc(COPY_CHUNK_SIZE);
+    if (buffer == NULL)
+        return -1;
+    int status = 0;
+    for (;;)
+    {
+        ssize_t n = read(in_fd, buffer, COPY_CHUNK_SIZE);
+        if (n == -1 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            status = n == 0 ? 0 : -1;
+            break;
+        }
+        if (!write_all(out_fd, buffer, (size_t)n))
+        {
+            status = -1;
+            break;
+        }
+    }
+    free(buffer);
+    return status;
+}
+
+/**
+ * @brief Copia el resto de un archivo dentro del kernel con sendfile().
+ *
+ * @return 0 si se copió todo, -1 en caso de error, o 1 si sendfile() no admite los descriptores y no se copió nada.
+ */
+static int copy_with_sendfile(int in_fd, int out_fd)
+{
+    bool sent = false;
+    for (;;)
+    {
+        ssize_t n = sendfile(out_fd, in_fd, NULL, SENDFILE_CHUNK);
+        if (n == 0)
+            return 0;
+        if (n > 0)
+        {
+            sent = true;
+            continue;
+        }
+        if (errno == EINTR)
+            continue;
+        return !sent && (errno == EINVAL || errno == ENOSYS) ? 1 : -1;
+    }
+}
+
+/**
+ * @brief Escribe el encabezado y el contenido de un archivo de configuración encontrado.
+ */
+int write_config_file(const char* path, int output_fd)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        perror("No se pudo abrir el archivo");
+        return -1;
+    }
+
+    int length = snprintf(NULL, 0, HEADER_FORMAT, path, path);
+    char* header = length > 0 ? malloc((size_t)length + 1) : NULL;
+    int status = -1;
+    if (header != NULL)
+    {
+        snprintf(header, (size_t)length + 1, HEADER_FORMAT, path, path);
+        status = write_all(output_fd, header, (size_t)length) ? 0 : -1;
+        free(header);
+    }
+
+    if (status == 0)
+    {
+        // En una terminal no hay ganancia en copiar dentro del kernel: se usan bloques grandes
+        status = isatty(output_fd) ? 1 : copy_with_sendfile(fd, output_fd);
+        if (status == 1)
+            status = copy_with_buffer(fd, output_fd);
+    }
+    if (status == 0)
+        status = write_all(output_fd, "\n", 1) ? 0 : -1;
+    close(fd);
+    return status;
+}
@@ -0,0 +1,239 @@
+#include "event_loop.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+#define MAX_EVENTS 16      // Eventos que se obtienen por cada llamada a epoll_wait
+#define INITIAL_WATCHERS 8 // Capacidad inicial de la lista de descriptores vigilados
+
+/**
+ * @struct watcher
+ * @brief Descriptor vigilado por el bucle y la función que lo atiende.
+ */
+typedef struct
+{
+    int fd;                  /**< Descriptor vigilado. */
+    event_callback callback; /**< Función a invocar cuando el descriptor está listo. */
+    void* data;              /**< Puntero que se entrega a la función. */
+} watcher;
+
+static int epoll_fd = -1;                     // Instancia de epoll, o -1 si el bucle no se inicializó
+static int signal_fd = -1;                    // signalfd por el que llegan las señales atendidas
+static sigset_t handled_signals;              // Señales bloqueadas y atendidas a través de signal_fd
+static signal_callback signal_callbacks[NSIG]; // Función asociada a cada señal atendida
+static watcher* watchers = NULL;              // Descriptores vigilados
+static int num_watchers = 0;                  // Cantidad de descriptores vigilados
+static int watchers_capacity = 0;             // Capacidad de la lista de descriptores
+
+/**
+ * @brief Crea la instancia de epoll y el signalfd, inicialmente sin señales.
+ *
+ * @return 0 si el bucle se inicializó, -1 en caso de error.
+ */
+int event_loop_init(void)
+{
+    if (epoll_fd != -1)
+        return 0;
+
+    sigemptyset(&handled_signals);
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1)
+        return -1;
+
+    signal_fd = signalfd(-1, &handled_signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    struct epoll_event event = {.events = EPOLLIN, .data.fd = signal_fd};
+    if (signal_fd == -1 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, signal_fd, &event) == -1)
+    {
+        if (signal_fd != -1)
+            close(signal_fd);
+        close(epoll_fd);
+        signal_fd = -1;
+        epoll_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Indica si el bucle está inicializado.
+ */
+bool event_loop_active(void)
+{
+    return epoll_fd != -1;
+}
+
+/**
+ * @brief Bloquea la señal y la agrega al conjunto que entrega el signalfd.
+ *
+ * @return 0 si la señal quedó registrada, -1 en caso de error.
+ */
+int event_loop_handle_signal(int sig, signal_callback callback)
+{
+    if (signal_fd == -1 || sig <= 0 || sig >= NSIG)
+        return -1;
+
+    sigset_t block;
+    sigemptyset(&block);
+    sigaddset(&block, sig);
+    if (sigprocmask(SIG_BLOCK, &block, NULL) == -1)
+        return -1;
+
+    sigaddset(&handled_signals, sig);
+    if (signalfd(signal_fd, &handled_signals, 0) == -1)
+        return -1;
+    signal_callbacks[sig] = callback;
+    return 0;
+}
+
+/**
+ * @brief Busca un descriptor en la lista de vigilados.
+ *
+ * @return Posición del descriptor, o -1 si no está.
+ */
+static int find_watcher(int fd)
+{
+    for (int i = 0; i < num_watchers; i++)
+    {
+        if (watchers[i].fd == fd)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Agrega el descriptor a epoll y a la lista de vigilados.
+ *
+ * @return 0 si el descriptor quedó registrado, -1 en caso de error.
+ */
+int event_loop_add_fd(int fd, event_callback callback, void* data)
+{
+    if (epoll_fd == -1)
+        return -1;
+
+    if (num_watchers == watchers_capacity)
+    {
+        int new_capacity = watchers_capacity ? watchers_capacity * 2 : INITIAL_WATCHERS;
+        watcher* new_watchers = realloc(watchers, (size_t)new_capacity * sizeof(watcher));
+        if (new_watchers == NULL)
+            return -1;
+        watchers = new_watchers;
+        watchers_capacity = new_capacity;
+    }
+
+    struct epoll_event event = {.events = EPOLLIN, .data.fd = fd};
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1)
+        return -1;
+
+    watchers[num_watchers].fd = fd;
+    watchers[num_watchers].callback = callback;
+    watchers[num_watchers].data = data;
+    num_watchers++;
+    return 0;
+}
+
+/**
+ * @brief Quita el descriptor de epoll y de la lista de vigilados.
+ */
+void event_loop_remove_fd(int fd)
+{
+    int index = find_watcher(fd);
+    if (index == -1)
+        return;
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    watchers[index] = watchers[--num_watchers];
+}
+
+/**
+ * @brief Lee todas las señales pendientes del signalfd e invoca la función de cada una.
+ *
+ * @return Cantidad de señales atendidas.
+ */
+static int dispatch_signals(void)
+{
+    struct signalfd_siginfo info;
+    int handled = 0;
+
+    while (read(signal_fd, &info, sizeof(info)) == (ssize_t)sizeof(info))
+    {
+        int sig = (int)info.ssi_signo;
+        if (sig > 0 && sig < NSIG && signal_callbacks[sig] != NULL)
+            signal_callbacks[sig](sig);
+        handled++;
+    }
+    return handled;
+}
+
+/**
+ * @brief Espera con epoll_wait y atiende los eventos obtenidos.
+ *
+ * Las señales se atienden antes que los descriptores, para que por ejemplo un trabajo ya terminado figure como tal
+ * al procesar la entrada. Un descriptor que se deja de vigilar durante el despacho ya no se atiende.
+ *
+ * @return Cantidad de eventos atendidos, o -1 en caso de error.
+ */
+int event_loop_dispatch(int timeout_ms)
+{
+    if (epoll_fd == -1)
+        return -1;
+
+    struct epoll_event events[MAX_EVENTS];
+    int count = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
+    if (count == -1)
+        return errno == EINTR ? 0 : -1;
+
+    int handled = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (events[i].data.fd == signal_fd)
+            handled += dispatch_signals();
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        int fd = events[i].data.fd;
+        if (fd == signal_fd)
+            continue;
+
+        int index = find_watcher(fd);
+        if (index == -1)
+            continue;
+        watchers[index].callback(fd, watchers[index].data);
+        handled++;
+    }
+    return handled;
+}
+
+/**
+ * @brief Marca que el descriptor esperado por event_loop_wait_readable() está listo.
+ */
+static void mark_ready(int fd, void* data)
+{
+    (void)fd;
+    *(bool*)data = true;
+}
+
+/**
+ * @brief Registra el descriptor solo mientras dura la espera.
+ *
+ * Mientras la shell ejecuta un comando, la entrada pertenece al trabajo en primer plano: por eso el descriptor no
+ * queda vigilado de forma permanente.
+ */
+void event_loop_wait_readable(int fd)
+{
+    bool ready = false;
+    if (event_loop_add_fd(fd, mark_ready, &ready) == -1)
+        return; // epoll no admite el descriptor (p. ej. un archivo regular): siempre se puede leer
+
+    while (!ready)
+    {
+        if (event_loop_dispatch(-1) == -1)
+            break;
+    }
+    event_loop_remove_fd(fd);
+}
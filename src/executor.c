@@ -0,0 +1,437 @@
+#define _GNU_SOURCE // Para close_range()
+#include "executor.h"
+#include "command_processor.h"
+#include "path_cache.h"
+#include "shell_stats.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+extern char** environ;
+
+/**
+ * @brief Busca el ejecutable en cada directorio de $PATH.
+ *
+ * @return Puntero a la ruta resuelta, o NULL si no se encontró.
+ */
+char* resolve_command_path(const char* name, char* buffer, size_t size)
+{
+    if (strchr(name, '/') != NULL)
+    {
+        // Ruta relativa o absoluta: no se busca en $PATH
+        if ((size_t)snprintf(buffer, size, "%s", name) >= size)
+            return NULL;
+        return buffer;
+    }
+
+    const char* path = getenv("PATH");
+    if (path == NULL)
+        path = "/usr/local/bin:/usr/bin:/bin";
+
+    size_t name_len = strlen(name);
+    while (*path != '\0')
+    {
+        const char* end = strchr(path, ':');
+        if (end == NULL)
+            end = path + strlen(path);
+        size_t dir_len = (size_t)(end - path);
+
+        // Un elemento vacío de $PATH representa el directorio actual
+        if (dir_len == 0 && name_len + 3 <= size)
+        {
+            snprintf(buffer, size, "./%s", name);
+        }
+        else if (dir_len + name_len + 2 <= size)
+        {
+            memcpy(buffer, path, dir_len);
+            buffer[dir_len] = '/';
+            memcpy(buffer + dir_len + 1, name, name_len + 1);
+        }
+        else
+        {
+            buffer[0] = '\0';
+        }
+
+        if (buffer[0] != '\0' && access(buffer, X_OK) == 0)
+            return buffer;
+
+        path = (*end == ':') ? end + 1 : end;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Crea una tubería con FD_CLOEXEC en ambos extremos.
+ *
+ * @return 0 si la tubería se creó correctamente, -1 en caso de error.
+ */
+int cloexec_pipe(int pipefd[2])
+{
+    if (pipe(pipefd) == -1)
+        return -1;
+    fcntl(pipefd[0], F_SETFD, FD_CLOEXEC);
+    fcntl(pipefd[1], F_SETFD, FD_CLOEXEC);
+    return 0;
+}
+
+/**
+ * @brief Lanza un ejecutable ya resuelto redirigiendo stdin/stdout/stderr si corresponde.
+ *
+ * El hijo entra en el grupo de procesos indicado, recupera la acción por defecto de las señales de control de
+ * trabajos, que la shell maneja o ignora, y arranca sin señales bloqueadas aunque la shell las reciba por signalfd.
+ *
+ * @return 0 si el proceso se creó, o el código de error de posix_spawn.
+ */
+static int spawn_path(const char* path, char* const argv[], int input_fd, int output_fd, int error_fd, pid_t pgid,
+                      pid_t* pid)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGINT);
+    sigaddset(&defaults, SIGQUIT);
+    sigaddset(&defaults, SIGTSTP);
+    sigaddset(&defaults, SIGTTIN);
+    sigaddset(&defaults, SIGTTOU);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    sigset_t unblocked;
+    sigemptyset(&unblocked);
+    posix_spawnattr_setsigmask(&attr, &unblocked);
+    short spawn_flags = POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK;
+    if (pgid >= 0)
+    {
+        posix_spawnattr_setpgroup(&attr, pgid);
+        spawn_flags |= POSIX_SPAWN_SETPGROUP;
+    }
+    posix_spawnattr_setflags(&attr, spawn_flags);
+
+    // Los descriptores originales se abren con O_CLOEXEC, por lo que solo queda la copia en 0/1/2
+    if (input_fd != -1)
+        posix_spawn_file_actions_adddup2(&actions, input_fd, STDIN_FILENO);
+    if (output_fd != -1)
+        posix_spawn_file_actions_adddup2(&actions, output_fd, STDOUT_FILENO);
+    if (error_fd != -1)
+        posix_spawn_file_actions_adddup2(&actions, error_fd, STDERR_FILENO);
+
+    // posix_spawn() vuelve cuando el hijo ya ejecutó el programa (o falló al intentarlo)
+    uint64_t start = stats_now();
+    int error = posix_spawn(pid, path, &actions, &attr, argv, environ);
+    if (error == 0)
+        stats_observe_since(STATS_SPAWN, start);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    return error;
+}
+
+/**
+ * @brief Resuelve y lanza un comando sin intermediarios.
+ *
+ * Las rutas de los comandos sin '/' se obtienen de la tabla de rutas; si el ejecutable almacenado ya no existe, se
+ * descarta la entrada y se vuelve a buscar en $PATH una única vez.
+ *
+ * @return PID del proceso creado, o -1 si ocurre un error.
+ */
+pid_t spawn_command(char* const argv[], int input_fd, int output_fd, int error_fd, pid_t pgid)
+{
+    char buffer[PATH_BUFFER_SIZE];
+    bool cached = strchr(argv[0], '/') == NULL;
+    const char* path = cached ? path_cache_lookup(argv[0]) : resolve_command_path(argv[0], buffer, sizeof(buffer));
+    if (path == NULL)
+    {
+        fprintf(stderr, "%s: comando no encontrado\n", argv[0]);
+        return -1;
+    }
+
+    pid_t pid;
+    int error = spawn_path(path, argv, input_fd, output_fd, error_fd, pgid, &pid);
+    if (error == ENOENT && cached)
+    {
+        path_cache_forget(argv[0]);
+        path = path_cache_lookup(argv[0]);
+        if (path != NULL)
+            error = spawn_path(path, argv, input_fd, output_fd, error_fd, pgid, &pid);
+    }
+
+    if (error != 0)
+    {
+        fprintf(stderr, "%s: %s\n", argv[0], strerror(error));
+        return -1;
+    }
+    return pid;
+}
+
+/**
+ * @brief Lanza un comando mediante `/bin/sh -c`.
+ *
+ * @return PID del proceso creado, o -1 si ocurre un error.
+ */
+pid_t spawn_shell(const char* command, int input_fd, int output_fd, pid_t pgid)
+{
+    char* const argv[] = {"sh", "-c", (char*)command, NULL};
+    pid_t pid;
+    int error = spawn_path("/bin/sh", argv, input_fd, output_fd, -1, pgid, &pid);
+    if (error != 0)
+    {
+        fprintf(stderr, "sh: %s\n", strerror(error));
+        return -1;
+    }
+    return pid;
+}
+
+/**
+ * @brief Abre las redirecciones de un comando y reemplaza los descriptores de la etapa.
+ *
+ * Cada archivo se abre en orden (creando o truncando los destinos) y el último de cada tipo es el que se usa.
+ *
+ * @return 0 si todas las redirecciones se abrieron, -1 si alguna falló.
+ */
+static int open_redirections(const simple_command* cmd, int* input_fd, int* output_fd, int* error_fd, int* opened,
+                             int* num_opened)
+{
+    for (int i = 0; i < cmd->num_redirections; i++)
+    {
+        const redirection* redir = &cmd->redirections[i];
+        int flags;
+        int* target;
+        switch (redir->type)
+        {
+        case REDIR_IN:
+            flags = O_RDONLY;
+            target = input_fd;
+            break;
+        case REDIR_APPEND:
+            flags = O_WRONLY | O_CREAT | O_APPEND;
+            target = output_fd;
+            break;
+        case REDIR_ERR:
+            flags = O_WRONLY | O_CREAT | O_TRUNC;
+            target = error_fd;
+            break;
+        case REDIR_OUT:
+        default:
+            flags = O_WRONLY | O_CREAT | O_TRUNC;
+            target = output_fd;
+            break;
+        }
+
+        int fd = open(redir->path, flags | O_CLOEXEC, FILE_PERMISSIONS);
+        if (fd == -1)
+        {
+            perror(redir->path);
+            return -1;
+        }
+        opened[(*num_opened)++] = fd;
+        *target = fd;
+    }
+    return 0;
+}
+
+/**
+ * @brief Crea un proceso hijo que ejecuta el comando interno con los descriptores de su etapa.
+ *
+ * El hijo recupera la acción por defecto de las señales de control de trabajos y la máscara vacía, igual que los
+ * programas lanzados con posix_spawn, y termina con _exit para no ejecutar los manejadores de salida de la shell.
+ * Como no llama a exec, FD_CLOEXEC no cierra nada: cierra él mismo todo descriptor por encima de stderr, para que
+ * ningún extremo de tubería heredado (en particular, el de lectura de su propia salida) le impida recibir EPIPE.
+ *
+ * @return PID del proceso creado, o -1 si ocurre un error.
+ */
+pid_t spawn_builtin(builtin_function function, char* const argv[], int input_fd, int output_fd, int error_fd,
+                    pid_t pgid)
+{
+    // Lo que quede en los buffers de la shell no debe duplicarse en el hijo
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        perror("fork");
+        return -1;
+    }
+
+    if (pid == 0)
+    {
+        if (pgid >= 0)
+            setpgid(0, pgid);
+        const int defaults[] = {SIGINT, SIGQUIT, SIGTSTP, SIGTTIN, SIGTTOU, SIGPIPE};
+        for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++)
+            signal(defaults[i], SIG_DFL);
+        sigset_t unblocked;
+        sigemptyset(&unblocked);
+        sigprocmask(SIG_SETMASK, &unblocked, NULL);
+
+        if (input_fd != -1)
+            dup2(input_fd, STDIN_FILENO);
+        if (output_fd != -1)
+            dup2(output_fd, STDOUT_FILENO);
+        if (error_fd != -1)
+            dup2(error_fd, STDERR_FILENO);
+        if (close_range(3, ~0U, 0) == -1)
+        {
+            for (int fd = 3; fd < sysconf(_SC_OPEN_MAX); fd++)
+                close(fd);
+        }
+
+        int status = function(argv, STDOUT_FILENO);
+        fflush(stdout);
+        fflush(stderr);
+        _exit(status);
+    }
+
+    // También lo hace el padre, para que el grupo exista antes de que lo usen las etapas siguientes
+    if (pgid >= 0)
+        setpgid(pid, pgid == 0 ? pid : pgid);
+    return pid;
+}
+
+/**
+ * @brief Ejecuta un comando interno dentro de la shell, con stderr redirigido si la etapa lo indica.
+ *
+ * SIGPIPE se ignora mientras tanto: si el lector de la tubería ya terminó, la escritura falla con EPIPE en lugar de
+ * terminar la shell.
+ *
+ * @return Código de salida del comando interno.
+ */
+static int run_inline(builtin_function function, char* const argv[], int output_fd, int error_fd)
+{
+    int saved_stderr = -1;
+    if (error_fd != -1)
+    {
+        fflush(stderr);
+        saved_stderr = fcntl(STDERR_FILENO, F_DUPFD_CLOEXEC, 0);
+        dup2(error_fd, STDERR_FILENO);
+    }
+
+    struct sigaction ignore, previous;
+    memset(&ignore, 0, sizeof(ignore));
+    ignore.sa_handler = SIG_IGN;
+    sigemptyset(&ignore.sa_mask);
+    sigaction(SIGPIPE, &ignore, &previous);
+
+    uint64_t start = stats_now();
+    int status = function(argv, output_fd != -1 ? output_fd : STDOUT_FILENO);
+    stats_observe_since(STATS_BUILTIN, start);
+
+    sigaction(SIGPIPE, &previous, NULL);
+    if (saved_stderr != -1)
+    {
+        fflush(stderr);
+        dup2(saved_stderr, STDERR_FILENO);
+        close(saved_stderr);
+    }
+    return status;
+}
+
+/**
+ * @brief Lanza cada etapa de la tubería conectando stdout de una con stdin de la siguiente.
+ *
+ * La primera etapa que se lanza con éxito crea el grupo de procesos y las siguientes se unen a él. Si corresponde,
+ * el grupo recibe la terminal en ese momento, para que un programa que la usa apenas arranca no reciba SIGTTIN o
+ * SIGTTOU. Si la primera etapa se ejecuta dentro de la shell, se guarda una copia de sus descriptores y se ejecuta
+ * al final.
+ *
+ * @return Cantidad de procesos creados.
+ */
+int launch_pipeline(const pipeline* pl, builtin_lookup lookup, pid_t* pids, pid_t* pgid, int* inline_status,
+                    int terminal_fd)
+{
+    *pgid = 0;
+    *inline_status = -1;
+    int launched = 0;
+    int last = pl->num_commands - 1;
+    int previous_read = -1; // Extremo de lectura de la tubería de la etapa anterior
+    builtin_function head = NULL; // Primera etapa, si se ejecuta dentro de la shell después de lanzar las demás
+    int head_output = -1;
+    int head_error = -1;
+
+    for (int i = 0; i < pl->num_commands; i++)
+    {
+        const simple_command* cmd = &pl->commands[i];
+        int pipefd[2] = {-1, -1};
+        if (i < last && cloexec_pipe(pipefd) == -1)
+        {
+            perror("pipe");
+            break;
+        }
+
+        int input_fd = previous_read;
+        int output_fd = pipefd[1];
+        int error_fd = -1;
+        int opened[cmd->num_redirections + 1];
+        int num_opened = 0;
+        builtin_function function = lookup != NULL ? lookup(cmd->argv[0]) : NULL;
+        bool run_here = function != NULL && !pl->background && (i == 0 || i == last);
+
+        if (open_redirections(cmd, &input_fd, &output_fd, &error_fd, opened, &num_opened) == 0)
+        {
+            pid_t pid = -1;
+            if (run_here && i == last)
+            {
+                *inline_status = run_inline(function, cmd->argv, output_fd, error_fd);
+            }
+            else if (run_here)
+            {
+                head = function;
+                head_output = fcntl(output_fd, F_DUPFD_CLOEXEC, 0);
+                head_error = error_fd != -1 ? fcntl(error_fd, F_DUPFD_CLOEXEC, 0) : -1;
+            }
+            else if (function != NULL)
+            {
+                pid = spawn_builtin(function, cmd->argv, input_fd, output_fd, error_fd, *pgid);
+            }
+            else
+            {
+                pid = spawn_command(cmd->argv, input_fd, output_fd, error_fd, *pgid);
+            }
+
+            if (pid > 0)
+            {
+                if (launched == 0)
+                {
+                    *pgid = pid;
+                    if (terminal_fd != -1)
+                        tcsetpgrp(terminal_fd, pid);
+                }
+                pids[launched++] = pid;
+            }
+        }
+        else if (run_here && i == last)
+        {
+            *inline_status = EXIT_FAILURE;
+        }
+
+        // El padre no conserva ningún extremo que ya haya heredado el hijo
+        for (int j = 0; j < num_opened; j++)
+            close(opened[j]);
+        if (pipefd[1] != -1)
+            close(pipefd[1]);
+        if (previous_read != -1)
+            close(previous_read);
+        previous_read = pipefd[0];
+    }
+
+    if (previous_read != -1)
+        close(previous_read);
+
+    if (head != NULL)
+    {
+        run_inline(head, pl->commands[0].argv, head_output, head_error);
+        if (head_output != -1)
+            close(head_output);
+        if (head_error != -1)
+            close(head_error);
+    }
+    return launched;
+}
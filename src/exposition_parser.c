@@ -0,0 +1,218 @@
+#include "exposition_parser.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Copia a `buffer` los caracteres de [start, end) para convertirlos con strtod()/strtoll().
+ *
+ * @return true si entraron en el buffer.
+ */
+static bool copy_token(char* buffer, size_t size, const char* start, const char* end)
+{
+    size_t length = (size_t)(end - start);
+    if (length == 0 || length >= size)
+        return false;
+    memcpy(buffer, start, length);
+    buffer[length] = '\0';
+    return true;
+}
+
+/**
+ * @brief Analiza una línea del formato de exposición.
+ */
+int exposition_parse_line(const char* line, size_t length, exposition_sample* sample)
+{
+    const char* p = line;
+    const char* end = line + length;
+    if (p < end && end[-1] == '\r')
+        end--; // Fin de línea CRLF
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    if (p == end || *p == '#')
+        return 0;
+
+    const char* name = p;
+    while (p < end && *p != '{' && *p != ' ' && *p != '\t')
+        p++;
+    size_t name_length = (size_t)(p - name);
+
+    const char* labels = NULL;
+    size_t labels_length = 0;
+    if (p < end && *p == '{')
+    {
+        // Las llaves dentro de un valor entre comillas no cierran las etiquetas
+        labels = ++p;
+        bool quoted = false;
+        while (p < end && (quoted || *p != '}'))
+        {
+            if (*p == '\\' && quoted && p + 1 < end)
+                p++;
+            else if (*p == '"')
+                quoted = !quoted;
+            p++;
+        }
+        if (p == end)
+            return 0;
+        labels_length = (size_t)(p - labels);
+        p++;
+    }
+
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    const char* token = p;
+    while (p < end && *p != ' ' && *p != '\t')
+        p++;
+    char number[64];
+    if (name_length == 0 || !copy_token(number, sizeof(number), token, p))
+        return 0;
+    char* number_end;
+    double value = strtod(number, &number_end);
+    if (*number_end != '\0')
+        return 0;
+
+    int64_t timestamp_ms = 0;
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    if (p < end && copy_token(number, sizeof(number), p, end))
+        timestamp_ms = strtoll(number, NULL, 10);
+
+    sample->name = name;
+    sample->name_length = name_length;
+    sample->labels = labels;
+    sample->labels_length = labels_length;
+    sample->value = value;
+    sample->timestamp_ms = timestamp_ms;
+    return 1;
+}
+
+/**
+ * @brief Inicializa un analizador.
+ */
+void exposition_parser_init(exposition_parser* parser, exposition_filter filter, exposition_callback callback,
+                            void* data)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->filter = filter;
+    parser->callback = callback;
+    parser->data = data;
+}
+
+/**
+ * @brief Descarta la línea pendiente y los contadores, conservando la memoria.
+ */
+void exposition_parser_reset(exposition_parser* parser)
+{
+    parser->pending_size = 0;
+    parser->samples = 0;
+    parser->filtered = 0;
+}
+
+/**
+ * @brief Analiza una línea completa y entrega su muestra, si tiene.
+ */
+static void emit_line(exposition_parser* parser, const char* line, size_t length)
+{
+    if (parser->filter != NULL)
+    {
+        // Solo el nombre: las líneas descartadas no llegan a convertir el valor
+        const char* end = line + length;
+        const char* name = line;
+        while (name < end && (*name == ' ' || *name == '\t'))
+            name++;
+        if (name == end || *name == '#')
+            return;
+        const char* name_end = name;
+        while (name_end < end && *name_end != '{' && *name_end != ' ' && *name_end != '\t')
+            name_end++;
+        if (!parser->filter(name, (size_t)(name_end - name), parser->data))
+        {
+            parser->filtered++;
+            return;
+        }
+    }
+
+    exposition_sample sample;
+    if (exposition_parse_line(line, length, &sample))
+    {
+        parser->samples++;
+        parser->callback(&sample, parser->data);
+    }
+}
+
+/**
+ * @brief Agrega bytes a la línea pendiente.
+ *
+ * @return 0 si se guardaron, -1 si no hay memoria.
+ */
+static int append_pending(exposition_parser* parser, const char* bytes, size_t length)
+{
+    size_t needed = parser->pending_size + length;
+    if (needed > parser->pending_capacity)
+    {
+        size_t capacity = parser->pending_capacity ? parser->pending_capacity * 2 : 256;
+        while (capacity < needed)
+            capacity *= 2;
+        char* grown = realloc(parser->pending, capacity);
+        if (grown == NULL)
+            return -1;
+        parser->pending = grown;
+        parser->pending_capacity = capacity;
+    }
+    memcpy(parser->pending + parser->pending_size, bytes, length);
+    parser->pending_size = needed;
+    return 0;
+}
+
+/**
+ * @brief Analiza un trozo de la exposición y entrega las muestras de las líneas que se completaron.
+ */
+int exposition_parser_feed(exposition_parser* parser, const char* bytes, size_t length)
+{
+    const char* end = bytes + length;
+    const char* newline = memchr(bytes, '\n', length);
+    if (newline == NULL)
+        return append_pending(parser, bytes, length);
+
+    // La primera línea completa el comienzo que quedó del trozo anterior
+    const char* line = bytes;
+    if (parser->pending_size > 0)
+    {
+        if (append_pending(parser, bytes, (size_t)(newline - bytes)) == -1)
+            return -1;
+        emit_line(parser, parser->pending, parser->pending_size);
+        parser->pending_size = 0;
+        line = newline + 1;
+        newline = memchr(line, '\n', (size_t)(end - line));
+    }
+
+    // Las demás se analizan en el lugar, sin copiarlas
+    while (newline != NULL)
+    {
+        emit_line(parser, line, (size_t)(newline - line));
+        line = newline + 1;
+        newline = memchr(line, '\n', (size_t)(end - line));
+    }
+    return append_pending(parser, line, (size_t)(end - line));
+}
+
+/**
+ * @brief Analiza la última línea si la exposición no terminaba en '\n'.
+ */
+void exposition_parser_finish(exposition_parser* parser)
+{
+    if (parser->pending_size > 0)
+        emit_line(parser, parser->pending, parser->pending_size);
+    parser->pending_size = 0;
+}
+
+/**
+ * @brief Libera la memoria del analizador.
+ */
+void exposition_parser_free(exposition_parser* parser)
+{
+    free(parser->pending);
+    parser->pending = NULL;
+    parser->pending_size = 0;
+    parser->pending_capacity = 0;
+}
@@ -0,0 +1,43 @@
+#include "file_util.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Concatena dos componentes de ruta con una barra.
+ */
+char* join_path(const char* dir, const char* name)
+{
+    if (strcmp(dir, ".") == 0)
+        return strdup(name);
+    size_t dir_len = strlen(dir);
+    size_t name_len = strlen(name);
+    char* path = malloc(dir_len + name_len + 2);
+    if (path == NULL)
+        return NULL;
+    memcpy(path, dir, dir_len);
+    if (dir_len == 0 || dir[dir_len - 1] != '/')
+        path[dir_len++] = '/';
+    memcpy(path + dir_len, name, name_len + 1);
+    return path;
+}
+
+/**
+ * @brief Escribe todo el contenido en un descriptor, reintentando las escrituras parciales.
+ */
+bool write_all(int fd, const void* data, size_t size)
+{
+    const char* p = data;
+    while (size > 0)
+    {
+        ssize_t n = write(fd, p, size);
+        if (n == -1 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
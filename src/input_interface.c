@@ -1,4 +1,7 @@
 #include "input_interface.h"
+#include "event_loop.h"
+#include "line_reader.h"
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,6 +10,12 @@
 char* username;
 char hostname[HOSTNAME_SIZE]; // Buffer para hostname
 char* current_working_directory;
+static line_buffer input;        // Buffer de la entrada interactiva, reutilizado en cada prompt
+static line_buffer pending;      // Bytes leídos de la entrada estándar que todavía no se devolvieron
+static size_t pending_start = 0; // Comienzo de los bytes pendientes dentro de pending
+static size_t pending_end = 0;   // Fin de los bytes pendientes dentro de pending
+static char* prompt = NULL;      // Prompt ya compuesto, o NULL si todavía no se armó
+static size_t prompt_length = 0; // Longitud del prompt en bytes
 
 /**
  * @brief Imprime el encabezado del terminal con un arte ASCII y ayuda de comandos personalizados.
@@ -38,67 +47,175 @@ static void print_header()
 }
 
 /**
- * @brief Imprime la línea del comando con el formato `user@hostname: <current path>$`.
+ * @brief Lee el usuario, el hostname y el directorio actual, y compone el prompt en un único buffer.
  *
- * Esta función actualiza las variables necesarias para mostrar el nombre de
- * usuario, el hostname y el directorio de trabajo actual. Si el directorio
- * actual es el directorio home del usuario, imprime `~` en su lugar.
+ * El prompt tiene el formato `user@hostname: <current path>$`. Si el directorio actual es el directorio home del
+ * usuario, muestra `~` en su lugar.
  */
-static void print_line()
+static void build_prompt()
 {
-    /* Refresh variables */
-    username = getenv("USER");                 // Obtiene el nombre de usuario
-    gethostname(hostname, sizeof(hostname));   // Almacena el hostname
-    current_working_directory = getenv("PWD"); // Obtiene el directorio de trabajo actual
+    username = getenv("USER");
+    gethostname(hostname, sizeof(hostname));
+    hostname[sizeof(hostname) - 1] = '\0'; // gethostname() no termina la cadena si el nombre no entra
+    current_working_directory = getenv("PWD");
+
+    const char* home = getenv("HOME");
+    const char* user = username != NULL ? username : "";
+    const char* cwd = current_working_directory != NULL ? current_working_directory : "";
+    if (home != NULL && strcmp(cwd, home) == 0)
+        cwd = "~/";
 
-    printf("╭─");
-    printf(GREEN "%s@%s" RESET ":", username, hostname);
+    const char* format = "╭─" GREEN "%s@%s" RESET ":" RESET "%s\n╰─$ ";
+    int length = snprintf(NULL, 0, format, user, hostname, cwd);
+    char* text = length >= 0 ? malloc((size_t)length + 1) : NULL;
+    if (text == NULL)
+        return; // Se sigue usando el prompt anterior, si lo hay
+    snprintf(text, (size_t)length + 1, format, user, hostname, cwd);
 
-    /* If cwd is /home/user print "~" instead of "cwd" */
-    if (strcmp(current_working_directory, getenv("HOME")) == 0)
-        printf(RESET "~/\n");
-    else
-        printf(RESET "%s\n", current_working_directory);
+    free(prompt);
+    prompt = text;
+    prompt_length = (size_t)length;
+}
+
+/**
+ * @brief Vuelve a componer el prompt porque cambió el directorio o el entorno.
+ */
+void refresh_prompt()
+{
+    build_prompt();
+}
+
+/**
+ * @brief Imprime la línea del comando con una sola escritura.
+ *
+ * La salida pendiente de stdout se vacía antes, para que el prompt quede después de ella.
+ */
+static void print_line()
+{
+    if (prompt == NULL)
+        build_prompt();
+    fflush(stdout);
+    if (prompt == NULL)
+        return;
 
-    printf("╰─$ ");
+    const char* data = prompt;
+    size_t size = prompt_length;
+    while (size > 0)
+    {
+        ssize_t written = write(STDOUT_FILENO, data, size);
+        if (written <= 0)
+            break;
+        data += written;
+        size -= (size_t)written;
+    }
 }
 
 /**
  * @brief Inicializa las variables necesarias para imprimir en el terminal.
  *
  * Esta función obtiene el nombre de usuario, el hostname y el directorio
- * de trabajo actual al iniciar el terminal. Además, imprime el encabezado
- * del terminal.
+ * de trabajo actual al iniciar el terminal y compone el prompt, que se
+ * reutiliza hasta la próxima llamada a refresh_prompt(). Además, limpia la
+ * pantalla con secuencias de escape (sin lanzar `clear`) e imprime el
+ * encabezado del terminal.
  */
 void init_terminal()
 {
-    /* No es necesario malloc para username */
-    username = getenv("USER");
+    build_prompt();
+    fputs(CLEAR_SCREEN, stdout);
+    print_header();
+}
 
-    /* hostname ya está preasignado */
-    gethostname(hostname, sizeof(hostname));
+/**
+ * @brief Copia la primera línea pendiente, de longitud @p length, al buffer que devuelve get_command().
+ *
+ * @return Longitud de la línea, o -1 si no hay memoria.
+ */
+static ssize_t take_pending_line(size_t length)
+{
+    if (input.capacity < length + 1)
+    {
+        char* data = realloc(input.data, length + 1);
+        if (data == NULL)
+            return -1;
+        input.data = data;
+        input.capacity = length + 1;
+    }
+    memcpy(input.data, pending.data + pending_start, length);
+    input.data[length] = '\0';
+    pending_start += length;
+    return (ssize_t)length;
+}
 
-    /* No es necesario malloc para current_working_directory */
-    current_working_directory = getenv("PWD");
+/**
+ * @brief Lee una línea de la entrada estándar con read(2), esperando en el bucle de eventos solo si hace falta.
+ *
+ * Los bytes que llegan después del '\n' quedan pendientes para la siguiente llamada, de modo que una escritura con
+ * varias líneas se atiende completa sin volver a esperar al descriptor.
+ *
+ * @return Longitud de la línea (incluido el '\n' final, si lo hay), o -1 al final de la entrada o ante un error.
+ */
+static ssize_t read_input_line()
+{
+    bool eof = false;
+    while (1)
+    {
+        size_t available = pending_end - pending_start;
+        char* newline = available > 0 ? memchr(pending.data + pending_start, '\n', available) : NULL;
+        if (newline != NULL)
+            return take_pending_line((size_t)(newline - (pending.data + pending_start)) + 1);
+        if (eof)
+            return available > 0 ? take_pending_line(available) : -1;
 
-    print_header();
+        // Sin una línea completa: se compacta el buffer y se agranda si está lleno
+        memmove(pending.data, pending.data + pending_start, available);
+        pending_start = 0;
+        pending_end = available;
+        if (pending_end == pending.capacity)
+        {
+            size_t capacity = pending.capacity > 0 ? pending.capacity * 2 : BUFSIZ;
+            char* data = realloc(pending.data, capacity);
+            if (data == NULL)
+                return -1;
+            pending.data = data;
+            pending.capacity = capacity;
+        }
+
+        event_loop_wait_readable(STDIN_FILENO);
+        ssize_t count = read(STDIN_FILENO, pending.data + pending_end, pending.capacity - pending_end);
+        if (count == -1)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            return -1;
+        }
+        if (count == 0)
+            eof = true;
+        pending_end += (size_t)count;
+    }
 }
 
 /**
  * @brief Obtiene el comando ingresado por el usuario.
  *
  * Esta función imprime la línea del comando y espera a que el usuario ingrese
- * un comando. El comando se lee y se devuelve como una cadena.
+ * un comando. Con el bucle de eventos activo, la entrada estándar se lee con
+ * read(2) y solo se espera al descriptor cuando no queda una línea completa
+ * pendiente; mientras tanto se siguen atendiendo señales y la finalización de
+ * trabajos. Sin el bucle, la línea se lee desde stdin. En ambos casos el
+ * comando se lee, sin límite de longitud, en un buffer que se reutiliza entre
+ * llamadas.
  *
- * @return char* La cadena que contiene el comando ingresado por el usuario.
+ * @return char* La cadena que contiene el comando ingresado por el usuario,
+ *         válida hasta la próxima llamada. No debe liberarse.
  */
 char* get_command()
 {
     print_line();
 
-    char* command = (char*)malloc(sizeof(char) * COMMAND_BUFFER_SIZE_2);
-    if (fgets(command, COMMAND_BUFFER_SIZE_2, stdin) == NULL)
+    ssize_t length = event_loop_active() ? read_input_line() : line_buffer_read(&input, stdin);
+    if (length == -1)
         exit(EXIT_FAILURE);
 
-    return command;
+    return input.data;
 }
@@ -0,0 +1,703 @@
+#include "jobs.h"
+#include "event_loop.h"
+#include "job_metrics.h"
+#include "shell_stats.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define INITIAL_JOBS 16      // Capacidad inicial de la tabla de trabajos
+#define INITIAL_PID_SLOTS 64 // Capacidad inicial del índice de PIDs (siempre potencia de dos)
+
+/**
+ * @struct pid_slot
+ * @brief Entrada del índice que asocia cada PID vivo con su trabajo.
+ */
+typedef struct
+{
+    pid_t pid;  /**< PID del proceso, o 0 si la entrada está libre. */
+    job* owner; /**< Trabajo al que pertenece el proceso. */
+} pid_slot;
+
+static job** table = NULL;         // Trabajos activos, ordenados por identificador
+static int num_jobs = 0;           // Cantidad de trabajos activos
+static int table_capacity = 0;     // Capacidad de la tabla
+static pid_slot* pid_slots = NULL; // Índice PID -> trabajo con direccionamiento abierto
+static size_t pid_capacity = 0;    // Capacidad del índice
+static size_t pid_count = 0;       // Cantidad de PIDs en el índice
+
+static bool initialized = false;                   // Se instaló el manejador de SIGCHLD
+static bool terminal_control = false;              // La shell controla la terminal y puede cederla
+static pid_t shell_pgid = 0;                       // Grupo de procesos de la propia shell
+static volatile sig_atomic_t foreground_pgid = -1; // Grupo del trabajo en primer plano
+static sigset_t saved_mask;                        // Máscara previa a bloquear SIGCHLD
+static int metrics_fd = -1;                        // Socket para enviar los recursos de los trabajos al monitor
+
+/**
+ * @brief Bloquea SIGCHLD mientras se modifica la tabla desde el flujo principal.
+ */
+static void block_sigchld(void)
+{
+    sigset_t block;
+    sigemptyset(&block);
+    sigaddset(&block, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &block, &saved_mask);
+}
+
+/**
+ * @brief Restaura la máscara de señales guardada por block_sigchld().
+ */
+static void unblock_sigchld(void)
+{
+    sigprocmask(SIG_SETMASK, &saved_mask, NULL);
+}
+
+/**
+ * @brief Manejador de SIGCHLD: recolecta todos los hijos pendientes.
+ */
+static void sigchld_handler(int sig)
+{
+    (void)sig;
+    jobs_reap();
+}
+
+/**
+ * @brief Instala el manejador de SIGCHLD y detecta si la shell controla la terminal.
+ *
+ * Con el bucle de eventos activo, SIGCHLD se atiende de forma síncrona desde el bucle; sin él (por ejemplo, en las
+ * pruebas) se instala un manejador asíncrono.
+ */
+void jobs_init(void)
+{
+    if (initialized)
+        return;
+
+    if (event_loop_active())
+    {
+        event_loop_handle_signal(SIGCHLD, sigchld_handler);
+    }
+    else
+    {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = sigchld_handler;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = SA_RESTART;
+        sigaction(SIGCHLD, &sa, NULL);
+    }
+
+    shell_pgid = getpgrp();
+    terminal_control = isatty(STDIN_FILENO) && tcgetpgrp(STDIN_FILENO) == shell_pgid;
+    if (terminal_control)
+        signal(SIGTTOU, SIG_IGN); // Permite recuperar la terminal cuando un trabajo la libera
+
+    initialized = true;
+}
+
+/**
+ * @brief Informa la terminal detectada por jobs_init().
+ */
+int jobs_terminal_fd(void)
+{
+    jobs_init();
+    return terminal_control ? STDIN_FILENO : -1;
+}
+
+/**
+ * @brief Posición inicial de un PID en el índice.
+ */
+static size_t pid_home(pid_t pid)
+{
+    return ((uint32_t)pid * 2654435761u) & (pid_capacity - 1);
+}
+
+/**
+ * @brief Inserta un PID en el índice sin verificar la capacidad.
+ */
+static void pid_insert(pid_t pid, job* owner)
+{
+    size_t i = pid_home(pid);
+    while (pid_slots[i].pid != 0)
+        i = (i + 1) & (pid_capacity - 1);
+    pid_slots[i].pid = pid;
+    pid_slots[i].owner = owner;
+    pid_count++;
+}
+
+/**
+ * @brief Agranda el índice de PIDs, de una sola vez, para que entren otros `count` PIDs sin superar la mitad de su
+ * capacidad.
+ *
+ * @return 0 si el índice tiene lugar para los PIDs, -1 si no hay memoria (el índice queda como estaba).
+ */
+static int pid_reserve(size_t count)
+{
+    size_t old_capacity = pid_capacity;
+    pid_slot* old_slots = pid_slots;
+    size_t new_capacity = old_capacity ? old_capacity : INITIAL_PID_SLOTS;
+    while ((pid_count + count) * 2 > new_capacity)
+        new_capacity *= 2;
+    if (new_capacity == old_capacity)
+        return 0;
+
+    pid_slot* new_slots = calloc(new_capacity, sizeof(pid_slot));
+    if (new_slots == NULL)
+        return -1;
+
+    pid_slots = new_slots;
+    pid_capacity = new_capacity;
+    pid_count = 0;
+    for (size_t i = 0; i < old_capacity; i++)
+    {
+        if (old_slots[i].pid != 0)
+            pid_insert(old_slots[i].pid, old_slots[i].owner);
+    }
+    free(old_slots);
+    return 0;
+}
+
+/**
+ * @brief Busca la posición de un PID en el índice.
+ *
+ * @return Posición del PID, o -1 si no está.
+ */
+static long pid_find(pid_t pid)
+{
+    if (pid_capacity == 0)
+        return -1;
+
+    size_t i = pid_home(pid);
+    while (pid_slots[i].pid != 0)
+    {
+        if (pid_slots[i].pid == pid)
+            return (long)i;
+        i = (i + 1) & (pid_capacity - 1);
+    }
+    return -1;
+}
+
+/**
+ * @brief Elimina un PID del índice desplazando hacia atrás las entradas de la misma secuencia de sondeo.
+ */
+static void pid_remove(size_t i)
+{
+    pid_slots[i].pid = 0;
+    pid_count--;
+
+    size_t j = i;
+    while (true)
+    {
+        j = (j + 1) & (pid_capacity - 1);
+        if (pid_slots[j].pid == 0)
+            return;
+
+        // La entrada en j puede ocupar el hueco en i si su posición inicial no está entre i (exclusive) y j
+        size_t home = pid_home(pid_slots[j].pid);
+        bool movable = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+        if (movable)
+        {
+            pid_slots[i] = pid_slots[j];
+            pid_slots[j].pid = 0;
+            i = j;
+        }
+    }
+}
+
+/**
+ * @brief Traduce el estado de waitpid al código de salida de la shell.
+ */
+int jobs_exit_code(int status)
+{
+    if (WIFEXITED(status))
+        return WEXITSTATUS(status);
+    if (WIFSIGNALED(status))
+        return SIGNAL_EXIT_BASE + WTERMSIG(status);
+    return EXIT_FAILURE;
+}
+
+/**
+ * @brief Elimina un trabajo de la tabla y libera su memoria.
+ */
+static void remove_job(job* j)
+{
+    if (j->finished != 0)
+        stats_observe(STATS_CHILD_WALL, j->finished - j->started);
+
+    for (int i = 0; i < j->num_pids; i++)
+    {
+        long slot = pid_find(j->pids[i]);
+        if (slot >= 0 && pid_slots[slot].owner == j)
+            pid_remove((size_t)slot);
+    }
+
+    for (int i = 0; i < num_jobs; i++)
+    {
+        if (table[i] == j)
+        {
+            memmove(&table[i], &table[i + 1], (size_t)(num_jobs - i - 1) * sizeof(job*));
+            num_jobs--;
+            break;
+        }
+    }
+
+    free(j->pids);
+    free(j->command);
+    free(j);
+}
+
+/**
+ * @brief Agrega un trabajo a la tabla con el identificador siguiente al del último trabajo activo.
+ *
+ * @return El trabajo registrado, o NULL si no hay memoria.
+ */
+job* jobs_add(const pid_t* pids, int num_pids, pid_t pgid, const char* command, bool background)
+{
+    jobs_init();
+
+    job* j = calloc(1, sizeof(job));
+    if (j == NULL)
+        return NULL;
+    j->pids = malloc((size_t)num_pids * sizeof(pid_t));
+    j->command = strdup(command);
+    if (j->pids == NULL || j->command == NULL)
+    {
+        free(j->pids);
+        free(j->command);
+        free(j);
+        return NULL;
+    }
+    memcpy(j->pids, pids, (size_t)num_pids * sizeof(pid_t));
+    j->num_pids = num_pids;
+    j->num_alive = num_pids;
+    j->pgid = pgid;
+    j->state = JOB_RUNNING;
+    j->background = background;
+    j->started = stats_now();
+
+    block_sigchld();
+
+    // El índice se agranda antes de publicar el trabajo: un PID sin indexar nunca se recolectaría
+    if (pid_reserve((size_t)num_pids) == -1)
+    {
+        unblock_sigchld();
+        free(j->pids);
+        free(j->command);
+        free(j);
+        return NULL;
+    }
+
+    if (num_jobs == table_capacity)
+    {
+        int new_capacity = table_capacity ? table_capacity * 2 : INITIAL_JOBS;
+        job** new_table = realloc(table, (size_t)new_capacity * sizeof(job*));
+        if (new_table == NULL)
+        {
+            unblock_sigchld();
+            free(j->pids);
+            free(j->command);
+            free(j);
+            return NULL;
+        }
+        table = new_table;
+        table_capacity = new_capacity;
+    }
+
+    // Los identificadores se reutilizan: el nuevo trabajo toma el siguiente al último activo
+    j->id = num_jobs > 0 ? table[num_jobs - 1]->id + 1 : 1;
+    table[num_jobs++] = j;
+
+    for (int i = 0; i < num_pids; i++)
+        pid_insert(pids[i], j);
+
+    // Algún proceso pudo terminar antes de quedar indexado
+    jobs_reap();
+    unblock_sigchld();
+    return j;
+}
+
+/**
+ * @brief Suma los recursos de un proceso o trabajo a un total.
+ */
+void jobs_add_usage(struct rusage* total, const struct rusage* usage)
+{
+    timeradd(&total->ru_utime, &usage->ru_utime, &total->ru_utime);
+    timeradd(&total->ru_stime, &usage->ru_stime, &total->ru_stime);
+    if (usage->ru_maxrss > total->ru_maxrss)
+        total->ru_maxrss = usage->ru_maxrss;
+    total->ru_minflt += usage->ru_minflt;
+    total->ru_majflt += usage->ru_majflt;
+    total->ru_inblock += usage->ru_inblock;
+    total->ru_oublock += usage->ru_oublock;
+    total->ru_nvcsw += usage->ru_nvcsw;
+    total->ru_nivcsw += usage->ru_nivcsw;
+}
+
+/**
+ * @brief Envía al monitor un datagrama con los recursos de un trabajo terminado.
+ *
+ * Se llama desde jobs_reap(), posiblemente dentro del manejador de SIGCHLD, por lo que solo usa llamadas seguras
+ * en ese contexto. El envío no bloquea: si el monitor no está escuchando, el datagrama se descarta.
+ */
+static void report_job(const job* j)
+{
+    if (metrics_fd == -1)
+        metrics_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (metrics_fd == -1)
+        return;
+
+    job_metrics_datagram datagram;
+    memset(&datagram, 0, sizeof(datagram));
+    datagram.version = JOB_METRICS_VERSION;
+    datagram.exit_status = j->status;
+    datagram.user_usec = (uint64_t)j->usage.ru_utime.tv_sec * 1000000 + (uint64_t)j->usage.ru_utime.tv_usec;
+    datagram.system_usec = (uint64_t)j->usage.ru_stime.tv_sec * 1000000 + (uint64_t)j->usage.ru_stime.tv_usec;
+    datagram.max_rss_kib = (uint64_t)j->usage.ru_maxrss;
+    datagram.input_blocks = (uint64_t)j->usage.ru_inblock;
+    datagram.output_blocks = (uint64_t)j->usage.ru_oublock;
+    datagram.voluntary_switches = (uint64_t)j->usage.ru_nvcsw;
+    datagram.involuntary_switches = (uint64_t)j->usage.ru_nivcsw;
+
+    // La etiqueta es el nombre del primer programa, sin su directorio
+    const char* name = j->command;
+    size_t length = strcspn(name, " ");
+    for (size_t i = length; i > 0; i--)
+    {
+        if (name[i - 1] == '/')
+        {
+            name += i;
+            length -= i;
+            break;
+        }
+    }
+    if (length >= JOB_COMMAND_LENGTH)
+        length = JOB_COMMAND_LENGTH - 1;
+    memcpy(datagram.command, name, length);
+
+    const char* path = job_metrics_socket_path();
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return;
+    strcpy(addr.sun_path, path);
+    sendto(metrics_fd, &datagram, sizeof(datagram), MSG_DONTWAIT, (struct sockaddr*)&addr, sizeof(addr));
+}
+
+/**
+ * @brief Recolecta con wait4(-1, WNOHANG) a todos los hijos que cambiaron de estado.
+ */
+void jobs_reap(void)
+{
+    int saved_errno = errno;
+    int status;
+    pid_t pid;
+    struct rusage usage;
+
+    while ((pid = wait4(-1, &status, WNOHANG | WUNTRACED | WCONTINUED, &usage)) > 0)
+    {
+        long slot = pid_find(pid);
+        if (slot < 0)
+            continue; // Hijo que no pertenece a ningún trabajo (por ejemplo, el monitor)
+
+        job* j = pid_slots[slot].owner;
+        if (WIFSTOPPED(status))
+        {
+            j->state = JOB_STOPPED;
+            continue;
+        }
+        if (WIFCONTINUED(status))
+        {
+            j->state = JOB_RUNNING;
+            continue;
+        }
+
+        pid_remove((size_t)slot);
+        jobs_add_usage(&j->usage, &usage);
+        if (pid == j->pids[j->num_pids - 1])
+            j->status = jobs_exit_code(status);
+        if (--j->num_alive == 0)
+        {
+            j->state = JOB_DONE;
+            j->finished = stats_now();
+            report_job(j);
+        }
+    }
+
+    errno = saved_errno;
+}
+
+/**
+ * @brief Espera a que llegue al menos una señal: a través del bucle de eventos si está activo, o con sigsuspend.
+ *
+ * Debe llamarse con SIGCHLD bloqueada.
+ */
+static void wait_for_signal(void)
+{
+    if (event_loop_active())
+    {
+        event_loop_dispatch(-1);
+        return;
+    }
+
+    // Se espera con SIGCHLD habilitada aunque el llamador la tuviera bloqueada
+    sigset_t wait_mask = saved_mask;
+    sigdelset(&wait_mask, SIGCHLD);
+    sigsuspend(&wait_mask);
+}
+
+/**
+ * @brief Espera a que el trabajo deje de ejecutarse; si termina lo elimina y si se detiene lo pasa a segundo plano.
+ *
+ * @return Código de salida del trabajo.
+ */
+int jobs_wait(job* j, bool foreground)
+{
+    return jobs_wait_usage(j, foreground, NULL);
+}
+
+/**
+ * @brief Igual que jobs_wait(), copiando los recursos del trabajo antes de eliminarlo.
+ */
+int jobs_wait_usage(job* j, bool foreground, struct rusage* usage)
+{
+    block_sigchld();
+
+    // Un trabajo recién lanzado ya recibió la terminal en launch_pipeline(); uno continuado con `fg`, no
+    bool give_terminal = foreground && terminal_control;
+    if (give_terminal)
+        tcsetpgrp(STDIN_FILENO, j->pgid);
+    if (foreground)
+        foreground_pgid = j->pgid;
+
+    jobs_reap();
+    while (j->state == JOB_RUNNING)
+        wait_for_signal();
+
+    if (foreground)
+        foreground_pgid = -1;
+    if (give_terminal)
+        tcsetpgrp(STDIN_FILENO, shell_pgid);
+
+    int status = j->status;
+    if (usage != NULL)
+        *usage = j->usage;
+    if (j->state == JOB_DONE)
+    {
+        remove_job(j);
+    }
+    else
+    {
+        j->background = true;
+        status = SIGNAL_EXIT_BASE + SIGTSTP;
+        printf("\n[%d]+ Stopped\t%s\n", j->id, j->command);
+    }
+
+    unblock_sigchld();
+    return status;
+}
+
+/**
+ * @brief Espera hasta que ningún trabajo siga en ejecución e informa los que terminaron.
+ *
+ * @return Código de salida del último trabajo de la tabla.
+ */
+int jobs_wait_all(void)
+{
+    block_sigchld();
+    jobs_reap();
+
+    bool running = true;
+    while (running)
+    {
+        running = false;
+        for (int i = 0; i < num_jobs && !running; i++)
+            running = table[i]->state == JOB_RUNNING;
+        if (running)
+            wait_for_signal();
+    }
+
+    int status = num_jobs > 0 ? table[num_jobs - 1]->status : 0;
+    unblock_sigchld();
+    jobs_notify();
+    return status;
+}
+
+/**
+ * @brief Envía SIGCONT al grupo del trabajo y lo deja en primer o segundo plano.
+ *
+ * @return Código de salida si se esperó el trabajo, 0 en otro caso.
+ */
+int jobs_continue(job* j, bool foreground)
+{
+    if (kill(-j->pgid, SIGCONT) == -1)
+    {
+        perror("kill (SIGCONT)");
+        return 1;
+    }
+
+    block_sigchld();
+    if (j->state == JOB_STOPPED)
+        j->state = JOB_RUNNING;
+    j->background = !foreground;
+    unblock_sigchld();
+
+    if (!foreground)
+    {
+        printf("[%d]+ %s &\n", j->id, j->command);
+        return 0;
+    }
+
+    printf("%s\n", j->command);
+    return jobs_wait(j, true);
+}
+
+/**
+ * @brief Busca un trabajo por `%n`, `n`, PID, `%+`/`%%` (actual) o `%-` (anterior).
+ *
+ * @return El trabajo, o NULL si no existe.
+ */
+job* jobs_find(const char* spec)
+{
+    if (num_jobs == 0)
+        return NULL;
+
+    if (spec == NULL || strcmp(spec, "%+") == 0 || strcmp(spec, "%%") == 0)
+        return table[num_jobs - 1];
+    if (strcmp(spec, "%-") == 0)
+        return num_jobs > 1 ? table[num_jobs - 2] : NULL;
+
+    bool by_id = spec[0] == '%';
+    char* end;
+    long value = strtol(by_id ? spec + 1 : spec, &end, 10);
+    if (*end != '\0' || value <= 0)
+        return NULL;
+
+    for (int i = 0; i < num_jobs; i++)
+    {
+        if (table[i]->id == value)
+            return table[i];
+    }
+    if (by_id)
+        return NULL;
+
+    // Sin '%', un número que no es identificador de trabajo se interpreta como PID
+    for (int i = 0; i < num_jobs; i++)
+    {
+        for (int k = 0; k < table[i]->num_pids; k++)
+        {
+            if (table[i]->pids[k] == (pid_t)value)
+                return table[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Devuelve la marca de `jobs` para un trabajo: '+' el actual, '-' el anterior.
+ */
+static char job_marker(int index)
+{
+    if (index == num_jobs - 1)
+        return '+';
+    if (index == num_jobs - 2)
+        return '-';
+    return ' ';
+}
+
+/**
+ * @brief Imprime los recursos consumidos por los procesos de un trabajo que ya terminaron.
+ */
+static void print_usage(FILE* stream, const struct rusage* usage)
+{
+    fprintf(stream, "usuario %ld.%03lds, sistema %ld.%03lds, RSS máx %ld KiB, E/S %ld/%ld bloques, contexto %ld/%ld",
+            (long)usage->ru_utime.tv_sec, (long)usage->ru_utime.tv_usec / 1000, (long)usage->ru_stime.tv_sec,
+            (long)usage->ru_stime.tv_usec / 1000, usage->ru_maxrss, usage->ru_inblock, usage->ru_oublock,
+            usage->ru_nvcsw, usage->ru_nivcsw);
+}
+
+/**
+ * @brief Imprime una línea de estado para un trabajo terminado, con el resumen de sus recursos.
+ */
+static void print_done(FILE* stream, const job* j, char marker)
+{
+    if (j->status == 0)
+        fprintf(stream, "[%d]%c Done\t%s\t(", j->id, marker, j->command);
+    else
+        fprintf(stream, "[%d]%c Exit %d\t%s\t(", j->id, marker, j->status, j->command);
+    print_usage(stream, &j->usage);
+    fprintf(stream, ")\n");
+}
+
+/**
+ * @brief Imprime los trabajos activos; los que ya terminaron se informan y se eliminan.
+ */
+void jobs_print(FILE* stream, bool long_format)
+{
+    block_sigchld();
+    for (int i = 0; i < num_jobs; i++)
+    {
+        job* j = table[i];
+        if (j->state == JOB_DONE)
+        {
+            print_done(stream, j, job_marker(i));
+            remove_job(j);
+            i--;
+            continue;
+        }
+        const char* state = j->state == JOB_RUNNING ? "Running" : "Stopped";
+        if (!long_format)
+        {
+            fprintf(stream, "[%d]%c %s\t%s\n", j->id, job_marker(i), state, j->command);
+            continue;
+        }
+
+        fprintf(stream, "[%d]%c", j->id, job_marker(i));
+        for (int k = 0; k < j->num_pids; k++)
+            fprintf(stream, "%c%d", k == 0 ? ' ' : ',', j->pids[k]);
+        fprintf(stream, " %s\t%s\n\t", state, j->command);
+        print_usage(stream, &j->usage);
+        fprintf(stream, " (%d de %d procesos terminados)\n", j->num_pids - j->num_alive, j->num_pids);
+    }
+    unblock_sigchld();
+}
+
+/**
+ * @brief Informa los trabajos en segundo plano que terminaron y los elimina.
+ */
+void jobs_notify(void)
+{
+    if (num_jobs == 0)
+        return;
+
+    block_sigchld();
+    for (int i = 0; i < num_jobs; i++)
+    {
+        job* j = table[i];
+        if (j->background && j->state == JOB_DONE)
+        {
+            print_done(stdout, j, job_marker(i));
+            remove_job(j);
+            i--;
+        }
+    }
+    unblock_sigchld();
+}
+
+/**
+ * @brief Devuelve el grupo del trabajo en primer plano, o -1 si no hay ninguno.
+ */
+pid_t jobs_foreground_pgid(void)
+{
+    return foreground_pgid;
+}
@@ -0,0 +1,161 @@
+#include "line_reader.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Lee una línea con getline, que agranda el buffer solo cuando la línea no entra.
+ *
+ * @return Longitud de la línea leída, o -1 al final del flujo.
+ */
+ssize_t line_buffer_read(line_buffer* buffer, FILE* stream)
+{
+    return getline(&buffer->data, &buffer->capacity, stream);
+}
+
+/**
+ * @brief Libera el buffer y lo deja vacío.
+ */
+void line_buffer_free(line_buffer* buffer)
+{
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->capacity = 0;
+}
+
+/**
+ * @brief Inicializa el lector para leer desde un flujo con un buffer reutilizable.
+ */
+void line_reader_from_stream(line_reader* reader, FILE* stream)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->stream = stream;
+}
+
+/**
+ * @brief Proyecta el archivo con MAP_PRIVATE y permisos de escritura.
+ *
+ * Las escrituras (el '\0' que reemplaza cada '\n' y las que hace el propio intérprete sobre la línea) quedan en la
+ * copia privada del proceso y nunca llegan al archivo. Si el archivo no es regular se lee como flujo.
+ *
+ * @return 0 si el archivo se abrió, -1 en caso de error.
+ */
+int line_reader_open(line_reader* reader, const char* path)
+{
+    memset(reader, 0, sizeof(*reader));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+    {
+        int saved_errno = errno;
+        close(fd);
+        errno = saved_errno;
+        return -1;
+    }
+
+    if (!S_ISREG(st.st_mode))
+    {
+        reader->stream = fdopen(fd, "r");
+        if (reader->stream == NULL)
+        {
+            close(fd);
+            return -1;
+        }
+        reader->owns_stream = true;
+        return 0;
+    }
+
+    reader->size = (size_t)st.st_size;
+    if (reader->size > 0)
+    {
+        reader->map = mmap(NULL, reader->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (reader->map == MAP_FAILED)
+        {
+            int saved_errno = errno;
+            reader->map = NULL;
+            close(fd);
+            errno = saved_errno;
+            return -1;
+        }
+        madvise(reader->map, reader->size, MADV_SEQUENTIAL);
+    }
+    close(fd); // La proyección se mantiene después de cerrar el descriptor
+    return 0;
+}
+
+/**
+ * @brief Busca el siguiente '\n' con memchr y lo reemplaza por '\0'.
+ *
+ * Si la última línea no termina en '\n', el byte siguiente al final del archivo pertenece a la última página
+ * proyectada y vale cero, salvo que el archivo ocupe páginas completas: solo en ese caso la línea se copia.
+ *
+ * @return La línea, o NULL al llegar al final.
+ */
+char* line_reader_next(line_reader* reader, size_t* length)
+{
+    if (reader->stream != NULL)
+    {
+        ssize_t len = line_buffer_read(&reader->buffer, reader->stream);
+        if (len == -1)
+            return NULL;
+        if (len > 0 && reader->buffer.data[len - 1] == '\n')
+            reader->buffer.data[--len] = '\0';
+        if (length != NULL)
+            *length = (size_t)len;
+        return reader->buffer.data;
+    }
+
+    if (reader->map == NULL || reader->offset >= reader->size)
+        return NULL;
+
+    char* line = reader->map + reader->offset;
+    size_t remaining = reader->size - reader->offset;
+    char* newline = memchr(line, '\n', remaining);
+    size_t len;
+
+    if (newline != NULL)
+    {
+        len = (size_t)(newline - line);
+        *newline = '\0';
+        reader->offset += len + 1;
+    }
+    else
+    {
+        len = remaining;
+        reader->offset = reader->size;
+        if (reader->size % (size_t)sysconf(_SC_PAGESIZE) == 0)
+        {
+            free(reader->tail);
+            reader->tail = strndup(line, len);
+            if (reader->tail == NULL)
+                return NULL;
+            line = reader->tail;
+        }
+    }
+
+    if (length != NULL)
+        *length = len;
+    return line;
+}
+
+/**
+ * @brief Libera los recursos del lector.
+ */
+void line_reader_close(line_reader* reader)
+{
+    if (reader->map != NULL)
+        munmap(reader->map, reader->size);
+    if (reader->owns_stream)
+        fclose(reader->stream);
+    free(reader->tail);
+    line_buffer_free(&reader->buffer);
+    memset(reader, 0, sizeof(*reader));
+}
@@ -55,6 +55,16 @@ const char* status_to_string(status s)
     }
 }
 
+/**
+ * @brief Desbloquea en el hijo las señales que la shell recibe a través de su bucle de eventos.
+ */
+static void reset_child_signals(void)
+{
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, NULL);
+}
+
 /**
  * @brief Inicia el proceso de monitorización.
  *
@@ -76,6 +86,7 @@ void comando_start_monitoring()
         monitor_pid = fork();
         if (monitor_pid == 0)
         {
+            reset_child_signals();
             setsid();                                           // Hacer que el proceso hijo se ejecute en segundo plano
             execl("./bin/monitoring_project", "monitor", NULL); // Reemplaza con la ruta a tu binario monitor
             perror("Error al ejecutar monitor");
@@ -86,6 +97,7 @@ void comando_start_monitoring()
         wrapper_pid = fork();
         if (wrapper_pid == 0)
         {
+            reset_child_signals();
             setsid(); // Hacer que el proceso hijo se ejecute en segundo plano
             if (chdir("jsonconfig") != 0)
             {
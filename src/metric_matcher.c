@@ -0,0 +1,263 @@
+#include "metric_matcher.h"
+#include "hash.h"
+#include <fnmatch.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NAME_BUFFER_SIZE 256 // Nombres que se copian en la pila para fnmatch(); los más largos se copian al heap
+
+/**
+ * @brief Indica si hay comodines glob en [start, start + length).
+ */
+static bool has_wildcards(const char* start, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        if (start[i] == '*' || start[i] == '?' || start[i] == '[')
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Clase de un patrón según dónde tiene los comodines.
+ */
+typedef enum
+{
+    PATTERN_EXACT,  /**< Sin comodines. */
+    PATTERN_PREFIX, /**< `prefijo*`. */
+    PATTERN_SUFFIX, /**< `*sufijo`. */
+    PATTERN_GLOB    /**< Cualquier otro patrón. */
+} pattern_kind;
+
+/**
+ * @brief Clasifica un patrón.
+ */
+static pattern_kind classify(const char* pattern, size_t length)
+{
+    if (!has_wildcards(pattern, length))
+        return PATTERN_EXACT;
+    if (pattern[length - 1] == '*' && !has_wildcards(pattern, length - 1))
+        return PATTERN_PREFIX;
+    if (pattern[0] == '*' && !has_wildcards(pattern + 1, length - 1))
+        return PATTERN_SUFFIX;
+    return PATTERN_GLOB;
+}
+
+/**
+ * @brief Busca el hijo de un nodo que corresponde a un carácter.
+ *
+ * @return El índice del hijo, o 0 si no existe.
+ */
+static uint32_t find_child(const matcher_node* nodes, uint32_t node, char symbol)
+{
+    for (uint32_t child = nodes[node].child; child != 0; child = nodes[child].sibling)
+    {
+        if (nodes[child].symbol == symbol)
+            return child;
+    }
+    return 0;
+}
+
+/**
+ * @brief Agrega un prefijo (o un sufijo, leído al revés) a un trie con lugar suficiente para todos sus nodos.
+ */
+static void trie_insert(matcher_node* nodes, size_t* used, const char* text, size_t length, bool reversed)
+{
+    uint32_t node = 0;
+    for (size_t i = 0; i < length && !nodes[node].terminal; i++)
+    {
+        char symbol = reversed ? text[length - 1 - i] : text[i];
+        uint32_t child = find_child(nodes, node, symbol);
+        if (child == 0)
+        {
+            child = (uint32_t)(*used)++;
+            nodes[child].symbol = symbol;
+            nodes[child].sibling = nodes[node].child;
+            nodes[node].child = child;
+        }
+        node = child;
+    }
+    nodes[node].terminal = true; // Un prefijo más corto ya incluye a los más largos
+}
+
+/**
+ * @brief Recorre un trie con un nombre (al revés para los sufijos).
+ *
+ * @return true si el recorrido pasa por el final de algún patrón.
+ */
+static bool trie_match(const matcher_node* nodes, const char* name, size_t length, bool reversed)
+{
+    uint32_t node = 0;
+    for (size_t i = 0; !nodes[node].terminal; i++)
+    {
+        if (i == length)
+            return false;
+        node = find_child(nodes, node, reversed ? name[length - 1 - i] : name[i]);
+        if (node == 0)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Busca un nombre en el conjunto hash.
+ */
+static bool set_contains(const metric_matcher* matcher, const char* name, size_t length, uint32_t hash)
+{
+    size_t mask = matcher->entries_size - 1;
+    for (size_t i = hash & mask; matcher->entries[i].name != NULL; i = (i + 1) & mask)
+    {
+        const matcher_entry* entry = &matcher->entries[i];
+        if (entry->hash == hash && entry->length == length && memcmp(entry->name, name, length) == 0)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Compila una lista de nombres y patrones glob.
+ */
+int metric_matcher_compile(metric_matcher* matcher, const char* const* patterns, size_t count)
+{
+    memset(matcher, 0, sizeof(*matcher));
+
+    // Primera pasada: tamaños de cada estructura
+    size_t exact_bytes = 0;
+    size_t prefix_chars = 0;
+    size_t suffix_chars = 0;
+    size_t exact = 0;
+    size_t globs = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t length = strlen(patterns[i]);
+        if (length == 0)
+            continue;
+        switch (classify(patterns[i], length))
+        {
+        case PATTERN_EXACT:
+            exact++;
+            exact_bytes += length + 1;
+            break;
+        case PATTERN_PREFIX:
+            prefix_chars += length - 1;
+            break;
+        case PATTERN_SUFFIX:
+            suffix_chars += length - 1;
+            break;
+        case PATTERN_GLOB:
+            globs++;
+            break;
+        }
+    }
+
+    size_t entries_size = 16;
+    while (entries_size < exact * 2)
+        entries_size *= 2;
+    matcher->entries = calloc(entries_size, sizeof(matcher_entry));
+    matcher->entries_size = entries_size;
+    matcher->strings = malloc(exact_bytes + 1);
+    matcher->prefixes = calloc(prefix_chars + 1, sizeof(matcher_node));
+    matcher->suffixes = calloc(suffix_chars + 1, sizeof(matcher_node));
+    matcher->globs = calloc(globs + 1, sizeof(char*));
+    if (matcher->entries == NULL || matcher->strings == NULL || matcher->prefixes == NULL ||
+        matcher->suffixes == NULL || matcher->globs == NULL)
+    {
+        metric_matcher_free(matcher);
+        return -1;
+    }
+    matcher->prefix_nodes = 1;
+    matcher->suffix_nodes = 1;
+
+    // Segunda pasada: cada patrón a su estructura
+    size_t strings_used = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const char* pattern = patterns[i];
+        size_t length = strlen(pattern);
+        if (length == 0)
+            continue;
+        switch (classify(pattern, length))
+        {
+        case PATTERN_EXACT: {
+            uint32_t hash = fnv1a32(pattern, length);
+            if (set_contains(matcher, pattern, length, hash))
+                break;
+            size_t slot = hash & (entries_size - 1);
+            while (matcher->entries[slot].name != NULL)
+                slot = (slot + 1) & (entries_size - 1);
+            char* copy = matcher->strings + strings_used;
+            memcpy(copy, pattern, length + 1);
+            strings_used += length + 1;
+            matcher->entries[slot] = (matcher_entry){copy, (uint32_t)length, hash};
+            matcher->exact_count++;
+            break;
+        }
+        case PATTERN_PREFIX:
+            trie_insert(matcher->prefixes, &matcher->prefix_nodes, pattern, length - 1, false);
+            matcher->prefix_count++;
+            break;
+        case PATTERN_SUFFIX:
+            trie_insert(matcher->suffixes, &matcher->suffix_nodes, pattern + 1, length - 1, true);
+            matcher->suffix_count++;
+            break;
+        case PATTERN_GLOB:
+            matcher->globs[matcher->glob_count] = strdup(pattern);
+            if (matcher->globs[matcher->glob_count] == NULL)
+            {
+                metric_matcher_free(matcher);
+                return -1;
+            }
+            matcher->glob_count++;
+            break;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Indica si el nombre de una métrica coincide con algún patrón.
+ */
+bool metric_matcher_match(const metric_matcher* matcher, const char* name, size_t length)
+{
+    if (matcher->exact_count > 0 && set_contains(matcher, name, length, fnv1a32(name, length)))
+        return true;
+    if (matcher->prefix_count > 0 && trie_match(matcher->prefixes, name, length, false))
+        return true;
+    if (matcher->suffix_count > 0 && trie_match(matcher->suffixes, name, length, true))
+        return true;
+    if (matcher->glob_count == 0)
+        return false;
+
+    // fnmatch() necesita el nombre terminado en '\0'
+    char buffer[NAME_BUFFER_SIZE];
+    char* copy = length < sizeof(buffer) ? buffer : malloc(length + 1);
+    if (copy == NULL)
+        return false;
+    memcpy(copy, name, length);
+    copy[length] = '\0';
+    bool matched = false;
+    for (size_t i = 0; i < matcher->glob_count && !matched; i++)
+        matched = fnmatch(matcher->globs[i], copy, 0) == 0;
+    if (copy != buffer)
+        free(copy);
+    return matched;
+}
+
+/**
+ * @brief Libera la memoria del filtro.
+ */
+void metric_matcher_free(metric_matcher* matcher)
+{
+    if (matcher->globs != NULL)
+    {
+        for (size_t i = 0; i < matcher->glob_count; i++)
+            free(matcher->globs[i]);
+    }
+    free(matcher->globs);
+    free(matcher->entries);
+    free(matcher->strings);
+    free(matcher->prefixes);
+    free(matcher->suffixes);
+    memset(matcher, 0, sizeof(*matcher));
+}
@@ -0,0 +1,505 @@
+#include "metrics_shm.h"
+#include "exposition_parser.h"
+#include "hash.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define INITIAL_INTERNED 1024 // Posiciones iniciales de la tabla de cadenas del escritor (potencia de dos)
+#define INITIAL_STRINGS 4096  // Bytes iniciales de la tabla de cadenas de la trama en curso
+#define READ_RETRIES 1000     // Intentos de copia antes de rendirse ante un escritor colgado
+
+_Static_assert(sizeof(metrics_region) <= METRICS_SHM_HEADER_SIZE, "metrics_region no entra en el encabezado");
+
+/**
+ * @brief Devuelve la hora actual en milisegundos desde la época.
+ */
+static int64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Devuelve la posición `index` del anillo de una región proyectada.
+ */
+static metrics_slot* slot_at(metrics_region* region, uint64_t slot_size, uint64_t index)
+{
+    return (metrics_slot*)((char*)region + METRICS_SHM_HEADER_SIZE + index * slot_size);
+}
+
+/**
+ * @brief Devuelve los bytes que ocupa la región con posiciones de `slot_size` bytes.
+ */
+static size_t region_size(uint64_t slot_size)
+{
+    return METRICS_SHM_HEADER_SIZE + METRICS_SHM_SLOTS * slot_size;
+}
+
+/**
+ * @brief Prepara una región nueva, de otro formato o con un tamaño inconsistente para empezar sin tramas.
+ */
+static void reset_region(metrics_region* region, size_t size)
+{
+    uint64_t slot_size = ((size - METRICS_SHM_HEADER_SIZE) / METRICS_SHM_SLOTS) & ~(uint64_t)7;
+    atomic_store(&region->latest, 0);
+    atomic_store(&region->layout, 0);
+    region->slot_size = slot_size;
+    for (uint64_t i = 0; i < METRICS_SHM_SLOTS; i++)
+    {
+        atomic_store(&slot_at(region, slot_size, i)->sequence, 0);
+        slot_at(region, slot_size, i)->generation = 0;
+    }
+    region->version = METRICS_SHM_VERSION;
+    region->magic = METRICS_SHM_MAGIC;
+}
+
+/**
+ * @brief Indica si la región tiene el formato esperado y entra en los `size` bytes del archivo.
+ */
+static bool region_valid(const metrics_region* region, size_t size)
+{
+    return region->magic == METRICS_SHM_MAGIC && region->version == METRICS_SHM_VERSION &&
+           region->slot_size % 8 == 0 && region->slot_size >= sizeof(metrics_slot) + sizeof(metrics_frame) &&
+           region->slot_size <= (size - METRICS_SHM_HEADER_SIZE) / METRICS_SHM_SLOTS;
+}
+
+/**
+ * @brief Crea (o reutiliza) una región y la proyecta para publicar.
+ */
+int metrics_shm_create(metrics_shm* shm, const char* name)
+{
+    memset(shm, 0, sizeof(*shm));
+    shm->fd = shm_open(name, O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+    if (shm->fd == -1)
+        return -1;
+
+    // Nunca se achica: un lector podría tener proyectada la parte que se quitara
+    struct stat st;
+    size_t size = region_size(METRICS_SHM_INITIAL_SLOT);
+    if (fstat(shm->fd, &st) == -1 || ((size_t)st.st_size < size && ftruncate(shm->fd, size) == -1))
+    {
+        close(shm->fd);
+        return -1;
+    }
+    if ((size_t)st.st_size > size)
+        size = st.st_size;
+
+    void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+    shm->strings = malloc(INITIAL_STRINGS);
+    shm->interned = calloc(INITIAL_INTERNED, sizeof(uint32_t));
+    if (map == MAP_FAILED || shm->strings == NULL || shm->interned == NULL)
+    {
+        if (map != MAP_FAILED)
+            munmap(map, size);
+        free(shm->strings);
+        free(shm->interned);
+        close(shm->fd);
+        return -1;
+    }
+    shm->region = map;
+    shm->mapped_size = size;
+    shm->writer = true;
+    shm->strings_capacity = INITIAL_STRINGS;
+    shm->interned_size = INITIAL_INTERNED;
+
+    metrics_region* region = shm->region;
+    if (!region_valid(region, size))
+    {
+        reset_region(region, size);
+        return 0;
+    }
+
+    // Un escritor anterior pudo terminar a mitad de una publicación o de un cambio de tamaño: se dejan los
+    // contadores pares. Una posición a medio escribir no se lee porque su generación nunca se publicó
+    uint64_t layout = atomic_load(&region->layout);
+    if (layout & 1)
+        atomic_store(&region->layout, layout + 1);
+    for (uint64_t i = 0; i < METRICS_SHM_SLOTS; i++)
+    {
+        metrics_slot* slot = slot_at(region, region->slot_size, i);
+        uint64_t sequence = atomic_load(&slot->sequence);
+        if (sequence & 1)
+            atomic_store(&slot->sequence, sequence + 1);
+    }
+    return 0;
+}
+
+/**
+ * @brief Proyecta una región existente solo para lectura.
+ */
+int metrics_shm_open(metrics_shm* shm, const char* name)
+{
+    memset(shm, 0, sizeof(*shm));
+    shm->fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+    if (shm->fd == -1)
+        return -1;
+    struct stat st;
+    if (fstat(shm->fd, &st) == -1 || (size_t)st.st_size < region_size(0))
+    {
+        close(shm->fd);
+        errno = EPROTO;
+        return -1;
+    }
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, shm->fd, 0);
+    if (map == MAP_FAILED)
+    {
+        close(shm->fd);
+        return -1;
+    }
+
+    metrics_region* region = map;
+    if (region->magic != METRICS_SHM_MAGIC || region->version != METRICS_SHM_VERSION)
+    {
+        munmap(map, st.st_size);
+        close(shm->fd);
+        errno = EPROTO;
+        return -1;
+    }
+    shm->region = region;
+    shm->mapped_size = st.st_size;
+    return 0;
+}
+
+/**
+ * @brief Libera la proyección de la región.
+ */
+void metrics_shm_close(metrics_shm* shm)
+{
+    if (shm->region != NULL)
+    {
+        munmap(shm->region, shm->mapped_size);
+        close(shm->fd);
+    }
+    free(shm->samples);
+    free(shm->strings);
+    free(shm->interned);
+    memset(shm, 0, sizeof(*shm));
+}
+
+/**
+ * @brief Empieza una nueva trama.
+ */
+void metrics_shm_begin(metrics_shm* shm)
+{
+    shm->timestamp_ms = now_ms();
+    shm->truncated = false;
+    shm->num_samples = 0;
+    shm->strings[0] = '\0';
+    shm->strings_size = 1;
+    memset(shm->interned, 0, shm->interned_size * sizeof(uint32_t));
+    shm->interned_count = 0;
+}
+
+/**
+ * @brief Duplica la tabla hash de cadenas del escritor y vuelve a ubicar las que ya tenía.
+ *
+ * @return 0 si creció, -1 si no hay memoria.
+ */
+static int grow_interned(metrics_shm* shm)
+{
+    size_t size = shm->interned_size * 2;
+    uint32_t* table = calloc(size, sizeof(uint32_t));
+    if (table == NULL)
+        return -1;
+    for (size_t i = 0; i < shm->interned_size; i++)
+    {
+        uint32_t id = shm->interned[i];
+        if (id == 0)
+            continue;
+        const char* text = shm->strings + id;
+        size_t j = fnv1a32(text, strlen(text)) & (size - 1);
+        while (table[j] != 0)
+            j = (j + 1) & (size - 1);
+        table[j] = id;
+    }
+    free(shm->interned);
+    shm->interned = table;
+    shm->interned_size = size;
+    return 0;
+}
+
+/**
+ * @brief Guarda una cadena en la tabla de la trama, o reutiliza la copia que ya tenga.
+ *
+ * @return El identificador (desplazamiento) de la cadena, o UINT32_MAX si no hay memoria.
+ */
+static uint32_t intern_string(metrics_shm* shm, const char* text, size_t length)
+{
+    if (length == 0)
+        return 0;
+    if ((shm->interned_count + 1) * 2 > shm->interned_size && grow_interned(shm) == -1)
+        return UINT32_MAX;
+
+    size_t i = fnv1a32(text, length) & (shm->interned_size - 1);
+    while (shm->interned[i] != 0)
+    {
+        const char* stored = shm->strings + shm->interned[i];
+        if (strncmp(stored, text, length) == 0 && stored[length] == '\0')
+            return shm->interned[i];
+        i = (i + 1) & (shm->interned_size - 1);
+    }
+
+    size_t needed = shm->strings_size + length + 1;
+    if (needed >= UINT32_MAX)
+        return UINT32_MAX;
+    if (needed > shm->strings_capacity)
+    {
+        size_t capacity = shm->strings_capacity;
+        while (capacity < needed)
+            capacity *= 2;
+        char* grown = realloc(shm->strings, capacity);
+        if (grown == NULL)
+            return UINT32_MAX;
+        shm->strings = grown;
+        shm->strings_capacity = capacity;
+    }
+
+    uint32_t id = (uint32_t)shm->strings_size;
+    memcpy(shm->strings + id, text, length);
+    shm->strings[id + length] = '\0';
+    shm->strings_size = needed;
+    shm->interned[i] = id;
+    shm->interned_count++;
+    return id;
+}
+
+/**
+ * @brief Agrega una muestra a la trama en curso.
+ */
+int metrics_shm_add(metrics_shm* shm, const char* name, size_t name_length, const char* labels,
+                    size_t labels_length, double value, int64_t timestamp_ms)
+{
+    if (shm->num_samples == shm->samples_capacity)
+    {
+        size_t capacity = shm->samples_capacity ? shm->samples_capacity * 2 : 256;
+        metric_sample* grown = capacity < UINT32_MAX ? realloc(shm->samples, capacity * sizeof(metric_sample)) : NULL;
+        if (grown == NULL)
+        {
+            shm->truncated = true;
+            return -1;
+        }
+        shm->samples = grown;
+        shm->samples_capacity = capacity;
+    }
+
+    uint32_t name_id = intern_string(shm, name, name_length);
+    uint32_t labels_id = labels != NULL ? intern_string(shm, labels, labels_length) : 0;
+    if (name_id == UINT32_MAX || labels_id == UINT32_MAX)
+    {
+        shm->truncated = true;
+        return -1;
+    }
+
+    metric_sample* sample = &shm->samples[shm->num_samples++];
+    sample->name_id = name_id;
+    sample->labels_id = labels_id;
+    sample->value = value;
+    sample->timestamp_ms = timestamp_ms != 0 ? timestamp_ms : shm->timestamp_ms;
+    return 0;
+}
+
+/**
+ * @brief Analiza una línea del formato de exposición y agrega su muestra a la trama en curso.
+ */
+int metrics_shm_add_line(metrics_shm* shm, const char* line, size_t length)
+{
+    exposition_sample sample;
+    if (!exposition_parse_line(line, length, &sample))
+        return 0;
+    int status = metrics_shm_add(shm, sample.name, sample.name_length, sample.labels, sample.labels_length,
+                                 sample.value, sample.timestamp_ms);
+    return status == 0 ? 1 : -1;
+}
+
+/**
+ * @brief Agranda las posiciones del anillo para que entren `needed` bytes en cada una.
+ *
+ * Proyecta el archivo agrandado, mueve las posiciones a su nuevo lugar con el seqlock `layout` impar y recién
+ * entonces libera la proyección anterior.
+ *
+ * @return 0 si creció, -1 en caso de error (la región queda como estaba).
+ */
+static int grow_region(metrics_shm* shm, uint64_t needed)
+{
+    uint64_t old_slot = shm->region->slot_size;
+    uint64_t new_slot = old_slot;
+    while (new_slot < needed)
+        new_slot *= 2;
+    size_t size = region_size(new_slot);
+    if (ftruncate(shm->fd, size) == -1)
+        return -1;
+    metrics_region* region = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+    if (region == MAP_FAILED)
+        return -1;
+
+    uint64_t layout = atomic_load_explicit(&region->layout, memory_order_relaxed);
+    atomic_store_explicit(&region->layout, layout + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    // De la última a la primera: cada posición se mueve hacia adelante sin pisar las que faltan mover
+    for (uint64_t i = METRICS_SHM_SLOTS; i-- > 0;)
+        memmove(slot_at(region, new_slot, i), slot_at(region, old_slot, i), old_slot);
+    region->slot_size = new_slot;
+    atomic_store_explicit(&region->layout, layout + 2, memory_order_release);
+
+    munmap(shm->region, shm->mapped_size);
+    shm->region = region;
+    shm->mapped_size = size;
+    return 0;
+}
+
+/**
+ * @brief Publica la trama en curso.
+ */
+int metrics_shm_commit(metrics_shm* shm)
+{
+    size_t samples_bytes = shm->num_samples * sizeof(metric_sample);
+    uint64_t frame_bytes = (sizeof(metrics_frame) + samples_bytes + shm->strings_size + 7) & ~(uint64_t)7;
+    if (sizeof(metrics_slot) + frame_bytes > shm->region->slot_size &&
+        grow_region(shm, sizeof(metrics_slot) + frame_bytes) == -1)
+        return -1;
+
+    metrics_region* region = shm->region;
+    uint64_t generation = atomic_load_explicit(&region->latest, memory_order_relaxed) + 1;
+    metrics_slot* slot = slot_at(region, region->slot_size, generation % METRICS_SHM_SLOTS);
+
+    // Secuencia impar: los lectores que estén copiando esta posición descartan la copia
+    uint64_t sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+    atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->generation = generation;
+    metrics_frame* frame = (metrics_frame*)(slot + 1);
+    frame->bytes = frame_bytes;
+    frame->timestamp_ms = shm->timestamp_ms;
+    frame->num_samples = (uint32_t)shm->num_samples;
+    frame->truncated = shm->truncated;
+    frame->strings_size = shm->strings_size;
+    memcpy(frame + 1, shm->samples, samples_bytes);
+    memcpy((char*)(frame + 1) + samples_bytes, shm->strings, shm->strings_size);
+
+    atomic_store_explicit(&slot->sequence, sequence + 2, memory_order_release);
+    atomic_store_explicit(&region->latest, generation, memory_order_release);
+    return 0;
+}
+
+/**
+ * @brief Devuelve la generación publicada más reciente.
+ */
+uint64_t metrics_shm_latest(const metrics_shm* shm)
+{
+    return atomic_load_explicit(&shm->region->latest, memory_order_acquire);
+}
+
+/**
+ * @brief Vuelve a proyectar la región de un lector que el escritor agrandó.
+ *
+ * @return 0 si la proyección cubre `size` bytes, -1 si el archivo todavía no los tiene o no se pudo proyectar.
+ */
+static int remap_reader(metrics_shm* shm, size_t size)
+{
+    struct stat st;
+    if (fstat(shm->fd, &st) == -1 || (size_t)st.st_size < size)
+        return -1;
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, shm->fd, 0);
+    if (map == MAP_FAILED)
+        return -1;
+    munmap(shm->region, shm->mapped_size);
+    shm->region = map;
+    shm->mapped_size = st.st_size;
+    return 0;
+}
+
+/**
+ * @brief Copia la trama más reciente sin bloquear al escritor ni a otros lectores.
+ */
+int metrics_shm_read(metrics_shm* shm, metrics_snapshot* snapshot)
+{
+    for (int attempt = 0; attempt < READ_RETRIES; attempt++)
+    {
+        if (attempt > 0)
+            sched_yield(); // Deja terminar al escritor, que puede estar a mitad de una copia
+
+        const metrics_region* region = shm->region;
+        uint64_t layout = atomic_load_explicit(&region->layout, memory_order_acquire);
+        if (layout & 1)
+            continue;
+        uint64_t slot_size = region->slot_size;
+        if (region_size(slot_size) > shm->mapped_size)
+        {
+            if (remap_reader(shm, region_size(slot_size)) == -1)
+                continue;
+            region = shm->region;
+        }
+
+        uint64_t generation = atomic_load_explicit(&region->latest, memory_order_acquire);
+        if (generation == 0)
+            return -1;
+        const metrics_slot* slot = slot_at((metrics_region*)region, slot_size, generation % METRICS_SHM_SLOTS);
+        uint64_t before = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if ((before & 1) || slot->generation != generation)
+            continue; // El escritor ya la está reemplazando: se vuelve a leer la más reciente
+
+        // La longitud puede ser basura si la copia no resulta consistente; se acota para no salirse de la posición
+        const metrics_frame* frame = (const metrics_frame*)(slot + 1);
+        uint64_t bytes = frame->bytes;
+        if (bytes < sizeof(metrics_frame) || bytes > slot_size - sizeof(metrics_slot))
+            continue;
+        if (bytes > snapshot->capacity)
+        {
+            void* grown = realloc(snapshot->buffer, bytes);
+            if (grown == NULL)
+                return -1;
+            snapshot->buffer = grown;
+            snapshot->capacity = bytes;
+        }
+        memcpy(snapshot->buffer, frame, bytes);
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->sequence, memory_order_relaxed) != before ||
+            atomic_load_explicit(&region->layout, memory_order_relaxed) != layout)
+            continue;
+
+        metrics_frame* copy = snapshot->buffer;
+        size_t samples_bytes = (size_t)copy->num_samples * sizeof(metric_sample);
+        if (copy->strings_size == 0 || sizeof(metrics_frame) + samples_bytes + copy->strings_size > bytes)
+            continue;
+        char* strings = (char*)(copy + 1) + samples_bytes;
+        strings[copy->strings_size - 1] = '\0';
+        snapshot->generation = generation;
+        snapshot->timestamp_ms = copy->timestamp_ms;
+        snapshot->truncated = copy->truncated != 0;
+        snapshot->num_samples = copy->num_samples;
+        snapshot->samples = (const metric_sample*)(copy + 1);
+        snapshot->strings = strings;
+        snapshot->strings_size = copy->strings_size;
+        return 0;
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+/**
+ * @brief Devuelve una cadena de la copia a partir de su identificador.
+ */
+const char* metrics_snapshot_string(const metrics_snapshot* snapshot, uint32_t id)
+{
+    return id < snapshot->strings_size ? snapshot->strings + id : "";
+}
+
+/**
+ * @brief Libera el buffer de una copia.
+ */
+void metrics_snapshot_free(metrics_snapshot* snapshot)
+{
+    free(snapshot->buffer);
+    memset(snapshot, 0, sizeof(*snapshot));
+}
@@ -0,0 +1,752 @@
+#include "parser.h"
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern char** environ;
+
+/**
+ * @enum token_type
+ * @brief Tipos de tokens producidos por el analizador léxico.
+ */
+typedef enum
+{
+    TOKEN_WORD,   /**< Palabra, ya sin comillas ni escapes. */
+    TOKEN_PIPE,   /**< Operador `|`. */
+    TOKEN_IN,     /**< Operador `<`. */
+    TOKEN_OUT,    /**< Operador `>`. */
+    TOKEN_APPEND, /**< Operador `>>`. */
+    TOKEN_ERR,    /**< Operador `2>`. */
+    TOKEN_AMP,    /**< Operador `&`. */
+    TOKEN_SEMI,   /**< Operador `;`. */
+    TOKEN_END     /**< Fin de la línea (o comienzo de un comentario). */
+} token_type;
+
+/**
+ * @struct lexer
+ * @brief Estado del analizador léxico sobre una línea.
+ */
+typedef struct
+{
+    const char* cursor; /**< Próximo carácter a consumir. */
+    char* word;         /**< Campos de la palabra en construcción, cada uno terminado en '\0'. */
+    size_t word_len;    /**< Bytes usados del buffer de la palabra. */
+    size_t word_cap;    /**< Capacidad del buffer de la palabra. */
+    size_t field_start; /**< Comienzo del campo en construcción dentro del buffer. */
+    int num_fields;     /**< Campos completos de la última palabra. */
+    bool field_quoted;  /**< El campo en construcción tiene comillas: se conserva aunque quede vacío. */
+    bool assignment;    /**< La última palabra tiene la forma NOMBRE=valor. */
+    bool expanded;      /**< Se expandió alguna variable en la línea. */
+    bool failed;        /**< Faltó memoria para la palabra: la palabra quedó incompleta. */
+} lexer;
+
+/**
+ * @brief Informa que no hubo memoria para analizar la línea.
+ *
+ * @return PARSE_SYNTAX_ERROR, para que la línea no se ejecute.
+ */
+static parse_status out_of_memory(void)
+{
+    fprintf(stderr, "Error: sin memoria para analizar la línea\n");
+    return PARSE_SYNTAX_ERROR;
+}
+
+/**
+ * @brief Agrega un carácter a la palabra en construcción.
+ *
+ * Si no hay memoria para agrandar el buffer, el carácter se descarta y se marca `failed`.
+ */
+static void push_char(lexer* lx, char c)
+{
+    if (lx->failed)
+        return;
+    if (lx->word_len + 1 >= lx->word_cap)
+    {
+        size_t new_cap = lx->word_cap ? lx->word_cap * 2 : 64;
+        char* new_word = realloc(lx->word, new_cap);
+        if (new_word == NULL)
+        {
+            lx->failed = true;
+            return;
+        }
+        lx->word = new_word;
+        lx->word_cap = new_cap;
+    }
+    lx->word[lx->word_len++] = c;
+    lx->word[lx->word_len] = '\0';
+}
+
+/**
+ * @brief Cierra el campo en construcción; un campo vacío sin comillas (por ejemplo, `$VACIA`) se descarta.
+ */
+static void finish_field(lexer* lx)
+{
+    if (lx->word_len > lx->field_start || lx->field_quoted)
+    {
+        push_char(lx, '\0');
+        lx->num_fields++;
+    }
+    lx->field_start = lx->word_len;
+    lx->field_quoted = false;
+}
+
+/**
+ * @brief Busca una variable en el entorno de la shell sin copiar su nombre.
+ *
+ * @return El valor de la variable, o NULL si no está definida.
+ */
+static const char* lookup_variable(const char* name, size_t len)
+{
+    for (char** env = environ; *env != NULL; env++)
+    {
+        if (strncmp(*env, name, len) == 0 && (*env)[len] == '=')
+            return *env + len + 1;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Agrega el valor de una expansión a la palabra.
+ *
+ * Fuera de comillas, los espacios del valor separan campos y los comodines (que no se expanden) hacen que la línea
+ * se delegue en /bin/sh.
+ */
+static parse_status push_value(lexer* lx, const char* value, size_t len, bool quoted)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        char c = value[i];
+        if (quoted)
+            push_char(lx, c);
+        else if (c == ' ' || c == '\t' || c == '\n')
+            finish_field(lx);
+        else if (c == '*' || c == '?' || c == '[')
+            return PARSE_UNSUPPORTED;
+        else
+            push_char(lx, c);
+    }
+    return PARSE_OK;
+}
+
+/**
+ * @brief Indica si un carácter puede comenzar un nombre de variable.
+ */
+static bool is_name_start(char c)
+{
+    return isalpha((unsigned char)c) || c == '_';
+}
+
+/**
+ * @brief Indica si un carácter puede formar parte de un nombre de variable.
+ */
+static bool is_name_char(char c)
+{
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+/**
+ * @brief Expande `$NOMBRE`, `${NOMBRE}`, `${NOMBRE:-valor}` o `${NOMBRE-valor}` con el entorno de la shell.
+ *
+ * `*cursor` apunta al '$' y se avanza hasta después de la expansión. Con `:-` el valor por omisión se usa si la
+ * variable no existe o está vacía; con `-`, solo si no existe. El valor por omisión puede contener a su vez
+ * variables. Un '$' que no inicia una expansión se conserva literal; los parámetros especiales (`$?`, `$1`, ...),
+ * la sustitución de comandos y los demás operadores de `${}` se delegan en /bin/sh.
+ *
+ * @return PARSE_OK si la expansión se resolvió, o PARSE_UNSUPPORTED.
+ */
+static parse_status expand_variable(lexer* lx, const char** cursor, bool quoted)
+{
+    const char* p = *cursor + 1;
+
+    if (is_name_start(*p))
+    {
+        const char* name = p;
+        while (is_name_char(*p))
+            p++;
+        const char* value = lookup_variable(name, (size_t)(p - name));
+        *cursor = p;
+        lx->expanded = true;
+        return value != NULL ? push_value(lx, value, strlen(value), quoted) : PARSE_OK;
+    }
+
+    if (*p != '{')
+    {
+        if (*p != '\0' && (isdigit((unsigned char)*p) || strchr("?$!#@*-(", *p) != NULL))
+            return PARSE_UNSUPPORTED;
+        push_char(lx, '$');
+        *cursor = p;
+        return PARSE_OK;
+    }
+
+    const char* name = ++p;
+    if (!is_name_start(*p))
+        return PARSE_UNSUPPORTED;
+    while (is_name_char(*p))
+        p++;
+    const char* value = lookup_variable(name, (size_t)(p - name));
+    lx->expanded = true;
+
+    if (*p == '}')
+    {
+        *cursor = p + 1;
+        return value != NULL ? push_value(lx, value, strlen(value), quoted) : PARSE_OK;
+    }
+
+    bool use_default;
+    if (p[0] == ':' && p[1] == '-')
+    {
+        use_default = value == NULL || *value == '\0';
+        p += 2;
+    }
+    else if (p[0] == '-')
+    {
+        use_default = value == NULL;
+        p++;
+    }
+    else
+    {
+        return PARSE_UNSUPPORTED;
+    }
+
+    if (!use_default)
+    {
+        parse_status status = push_value(lx, value, strlen(value), quoted);
+        if (status != PARSE_OK)
+            return status;
+    }
+    while (*p != '}')
+    {
+        if (*p == '\0' || *p == '\'' || *p == '"' || *p == '\\' || *p == '`' || *p == '{')
+            return PARSE_UNSUPPORTED;
+        if (*p == '$')
+        {
+            if (!use_default)
+            {
+                const char* skip = p;
+                lexer scratch = {0}; // Se recorre la expansión anidada solo para saber dónde termina
+                parse_status status = expand_variable(&scratch, &skip, quoted);
+                free(scratch.word);
+                if (status != PARSE_OK)
+                    return status;
+                p = skip;
+                continue;
+            }
+            parse_status status = expand_variable(lx, &p, quoted);
+            if (status != PARSE_OK)
+                return status;
+            continue;
+        }
+        if (use_default)
+        {
+            parse_status status = push_value(lx, p, 1, quoted);
+            if (status != PARSE_OK)
+                return status;
+        }
+        p++;
+    }
+    *cursor = p + 1;
+    return PARSE_OK;
+}
+
+/**
+ * @brief Lee una palabra resolviendo comillas, escapes y expansiones de variables.
+ *
+ * Una palabra puede producir varios campos (una variable sin comillas cuyo valor tiene espacios) o ninguno (una
+ * variable vacía sin comillas).
+ *
+ * @return PARSE_OK si la palabra se leyó, o el estado que corresponda si contiene construcciones no soportadas o
+ * comillas sin cerrar.
+ */
+static parse_status read_word(lexer* lx)
+{
+    const char* p = lx->cursor;
+    bool quoted = false;
+
+    // Se reserva el buffer aunque la palabra quede vacía (por ejemplo, '')
+    lx->word_len = 0;
+    push_char(lx, '\0');
+    lx->word_len = 0;
+    lx->field_start = 0;
+    lx->num_fields = 0;
+    lx->field_quoted = false;
+    lx->assignment = false;
+
+    // `~` al comienzo de una palabra requiere expansión
+    if (*p == '~')
+        return PARSE_UNSUPPORTED;
+
+    while (!parser_is_word_end(*p))
+    {
+        char c = *p;
+        if (c == '\'')
+        {
+            // Comillas simples: todo es literal hasta la comilla de cierre
+            quoted = true;
+            lx->field_quoted = true;
+            p++;
+            while (*p != '\'' && *p != '\0')
+                push_char(lx, *p++);
+            if (*p == '\0')
+            {
+                fprintf(stderr, "Error de sintaxis: comillas simples sin cerrar\n");
+                return PARSE_SYNTAX_ERROR;
+            }
+            p++;
+        }
+        else if (c == '"')
+        {
+            // Comillas dobles: solo \", \\, \$ y \` son escapes; las variables se expanden sin separar campos
+            quoted = true;
+            lx->field_quoted = true;
+            p++;
+            while (*p != '"' && *p != '\0')
+            {
+                if (*p == '`')
+                    return PARSE_UNSUPPORTED;
+                if (*p == '$')
+                {
+                    parse_status status = expand_variable(lx, &p, true);
+                    if (status != PARSE_OK)
+                        return status;
+                    continue;
+                }
+                if (*p == '\\' && (p[1] == '"' || p[1] == '\\' || p[1] == '$' || p[1] == '`'))
+                    p++;
+                push_char(lx, *p++);
+            }
+            if (*p == '\0')
+            {
+                fprintf(stderr, "Error de sintaxis: comillas dobles sin cerrar\n");
+                return PARSE_SYNTAX_ERROR;
+            }
+            p++;
+        }
+        else if (c == '\\')
+        {
+            p++;
+            if (*p == '\0')
+            {
+                fprintf(stderr, "Error de sintaxis: '\\' al final de la línea\n");
+                return PARSE_SYNTAX_ERROR;
+            }
+            quoted = true;
+            lx->field_quoted = true;
+            push_char(lx, *p++);
+        }
+        else if (c == '$')
+        {
+            parse_status status = expand_variable(lx, &p, false);
+            if (status != PARSE_OK)
+                return status;
+        }
+        else if (c == '`' || c == '*' || c == '?' || c == '[' || c == '(' || c == ')' || c == '{' ||
+                 c == '}')
+        {
+            // Expansiones, comodines y agrupaciones: se delegan en /bin/sh
+            return PARSE_UNSUPPORTED;
+        }
+        else
+        {
+            if (c == '=' && !quoted && lx->word_len > 0)
+                lx->assignment = true;
+            push_char(lx, *p++);
+        }
+    }
+
+    finish_field(lx);
+    lx->cursor = p;
+    return lx->failed ? out_of_memory() : PARSE_OK;
+}
+
+/**
+ * @brief Obtiene el siguiente token de la línea.
+ *
+ * @return PARSE_OK si se obtuvo un token válido; en otro caso, el estado que corresponda.
+ */
+static parse_status next_token(lexer* lx, token_type* type)
+{
+    const char* p = lx->cursor;
+    while (*p == ' ' || *p == '\t' || *p == '\n')
+        p++;
+    lx->cursor = p;
+
+    switch (*p)
+    {
+    case '\0':
+    case '#':
+        *type = TOKEN_END;
+        return PARSE_OK;
+    case '|':
+        if (p[1] == '|')
+            return PARSE_UNSUPPORTED; // `||`
+        *type = TOKEN_PIPE;
+        lx->cursor = p + 1;
+        return PARSE_OK;
+    case '&':
+        if (p[1] == '&' || p[1] == '>')
+            return PARSE_UNSUPPORTED; // `&&` y `&>`
+        *type = TOKEN_AMP;
+        lx->cursor = p + 1;
+        return PARSE_OK;
+    case ';':
+        if (p[1] == ';')
+            return PARSE_UNSUPPORTED;
+        *type = TOKEN_SEMI;
+        lx->cursor = p + 1;
+        return PARSE_OK;
+    case '<':
+        if (p[1] == '<' || p[1] == '>' || p[1] == '&' || p[1] == '(')
+            return PARSE_UNSUPPORTED; // here-documents, `<>`, `<&` y sustitución de procesos
+        *type = TOKEN_IN;
+        lx->cursor = p + 1;
+        return PARSE_OK;
+    case '>':
+        if (p[1] == '>')
+        {
+            if (p[2] == '&' || p[2] == '>')
+                return PARSE_UNSUPPORTED;
+            *type = TOKEN_APPEND;
+            lx->cursor = p + 2;
+            return PARSE_OK;
+        }
+        if (p[1] == '&' || p[1] == '|' || p[1] == '(')
+            return PARSE_UNSUPPORTED; // `>&`, `>|` y sustitución de procesos
+        *type = TOKEN_OUT;
+        lx->cursor = p + 1;
+        return PARSE_OK;
+    default:
+        break;
+    }
+
+    // `2>` solo es un operador cuando el 2 no forma parte de una palabra más larga
+    if (p[0] == '2' && p[1] == '>')
+    {
+        if (p[2] == '&' || p[2] == '>')
+            return PARSE_UNSUPPORTED; // `2>&1` y `2>>`
+        *type = TOKEN_ERR;
+        lx->cursor = p + 2;
+        return PARSE_OK;
+    }
+
+    *type = TOKEN_WORD;
+    return read_word(lx);
+}
+
+/**
+ * @brief Agrega un argumento al comando simple.
+ *
+ * @return true si se agregó, false si no hay memoria (el comando queda como estaba).
+ */
+static bool add_argument(simple_command* cmd, const char* word)
+{
+    char** argv = realloc(cmd->argv, (cmd->argc + 2) * sizeof(char*));
+    if (argv == NULL)
+        return false;
+    cmd->argv = argv;
+    argv[cmd->argc] = strdup(word);
+    if (argv[cmd->argc] == NULL)
+        return false;
+    argv[++cmd->argc] = NULL;
+    return true;
+}
+
+/**
+ * @brief Agrega una redirección al comando simple.
+ *
+ * @return true si se agregó, false si no hay memoria (el comando queda como estaba).
+ */
+static bool add_redirection(simple_command* cmd, redirection_type type, const char* path)
+{
+    redirection* redirections = realloc(cmd->redirections, (cmd->num_redirections + 1) * sizeof(redirection));
+    if (redirections == NULL)
+        return false;
+    cmd->redirections = redirections;
+    redirections[cmd->num_redirections].type = type;
+    redirections[cmd->num_redirections].path = strdup(path);
+    if (redirections[cmd->num_redirections].path == NULL)
+        return false;
+    cmd->num_redirections++;
+    return true;
+}
+
+/**
+ * @brief Agrega una etapa vacía a la tubería y devuelve un puntero a ella.
+ *
+ * @return La etapa nueva, o NULL si no hay memoria.
+ */
+static simple_command* add_stage(pipeline* pl)
+{
+    simple_command* commands = realloc(pl->commands, (pl->num_commands + 1) * sizeof(simple_command));
+    if (commands == NULL)
+        return NULL;
+    pl->commands = commands;
+    simple_command* cmd = &commands[pl->num_commands++];
+    memset(cmd, 0, sizeof(*cmd));
+    return cmd;
+}
+
+/**
+ * @brief Agrega una tubería vacía a la lista y devuelve un puntero a ella.
+ *
+ * @return La tubería nueva, o NULL si no hay memoria.
+ */
+static pipeline* add_pipeline(command_list* list)
+{
+    pipeline* pipelines = realloc(list->pipelines, (list->num_pipelines + 1) * sizeof(pipeline));
+    if (pipelines == NULL)
+        return NULL;
+    list->pipelines = pipelines;
+    pipeline* pl = &pipelines[list->num_pipelines++];
+    memset(pl, 0, sizeof(*pl));
+    return pl;
+}
+
+/**
+ * @brief Convierte un token de redirección en su tipo correspondiente.
+ */
+static redirection_type to_redirection(token_type type)
+{
+    switch (type)
+    {
+    case TOKEN_IN:
+        return REDIR_IN;
+    case TOKEN_APPEND:
+        return REDIR_APPEND;
+    case TOKEN_ERR:
+        return REDIR_ERR;
+    case TOKEN_OUT:
+    default:
+        return REDIR_OUT;
+    }
+}
+
+/**
+ * @brief Devuelve la representación textual de un operador para los mensajes de error.
+ */
+static const char* token_text(token_type type)
+{
+    switch (type)
+    {
+    case TOKEN_PIPE:
+        return "|";
+    case TOKEN_AMP:
+        return "&";
+    case TOKEN_SEMI:
+        return ";";
+    case TOKEN_IN:
+        return "<";
+    case TOKEN_OUT:
+        return ">";
+    case TOKEN_APPEND:
+        return ">>";
+    case TOKEN_ERR:
+        return "2>";
+    default:
+        return "fin de línea";
+    }
+}
+
+/**
+ * @brief Analiza la línea completa con una gramática de la forma:
+ *
+ *     lista    := tuberia ((';' | '&') tuberia)* [';' | '&']
+ *     tuberia  := comando ('|' comando)*
+ *     comando  := (PALABRA | redireccion)+
+ *     redireccion := ('<' | '>' | '>>' | '2>') PALABRA
+ *
+ * @return Estado del análisis.
+ */
+parse_status parse_command_line(const char* line, command_list* list)
+{
+    lexer lx = {.cursor = line};
+    list->pipelines = NULL;
+    list->num_pipelines = 0;
+    list->expanded = false;
+
+    pipeline* pl = NULL;
+    simple_command* cmd = NULL;
+    parse_status status = PARSE_OK;
+    token_type type;
+
+    while ((status = next_token(&lx, &type)) == PARSE_OK)
+    {
+        if (type == TOKEN_END)
+            break;
+
+        if (type == TOKEN_WORD)
+        {
+            if (lx.num_fields == 0)
+                continue; // Una variable vacía sin comillas no aporta argumentos
+            if (pl == NULL)
+                pl = add_pipeline(list);
+            if (cmd == NULL && pl != NULL)
+                cmd = add_stage(pl);
+            if (cmd == NULL)
+            {
+                status = out_of_memory();
+                break;
+            }
+            // `NOMBRE=valor comando` asigna variables: se delega en /bin/sh
+            if (cmd->argc == 0 && lx.assignment)
+            {
+                status = PARSE_UNSUPPORTED;
+                break;
+            }
+            const char* field = lx.word;
+            bool added = true;
+            for (int i = 0; added && i < lx.num_fields; i++, field += strlen(field) + 1)
+                added = add_argument(cmd, field);
+            if (!added)
+            {
+                status = out_of_memory();
+                break;
+            }
+            continue;
+        }
+
+        if (type == TOKEN_IN || type == TOKEN_OUT || type == TOKEN_APPEND || type == TOKEN_ERR)
+        {
+            token_type target;
+            status = next_token(&lx, &target);
+            if (status != PARSE_OK)
+                break;
+            if (target != TOKEN_WORD)
+            {
+                fprintf(stderr, "Error de sintaxis cerca de '%s'\n", token_text(target));
+                status = PARSE_SYNTAX_ERROR;
+                break;
+            }
+            if (lx.num_fields != 1)
+            {
+                fprintf(stderr, "Error: redirección ambigua cerca de '%s'\n", token_text(type));
+                status = PARSE_SYNTAX_ERROR;
+                break;
+            }
+            if (pl == NULL)
+                pl = add_pipeline(list);
+            if (cmd == NULL && pl != NULL)
+                cmd = add_stage(pl);
+            if (cmd == NULL || !add_redirection(cmd, to_redirection(type), lx.word))
+            {
+                status = out_of_memory();
+                break;
+            }
+            continue;
+        }
+
+        // Operadores de control: deben cerrar un comando con al menos un argumento
+        if (cmd == NULL || cmd->argc == 0)
+        {
+            fprintf(stderr, "Error de sintaxis cerca de '%s'\n", token_text(type));
+            status = PARSE_SYNTAX_ERROR;
+            break;
+        }
+
+        if (type == TOKEN_PIPE)
+        {
+            cmd = NULL; // La próxima palabra abre una nueva etapa
+        }
+        else
+        {
+            pl->background = (type == TOKEN_AMP);
+            pl = NULL;
+            cmd = NULL;
+        }
+    }
+
+    // Una tubería no puede terminar en `|` ni tener etapas sin programa
+    if (status == PARSE_OK && pl != NULL && (cmd == NULL || cmd->argc == 0))
+    {
+        fprintf(stderr, "Error de sintaxis cerca de '%s'\n", cmd == NULL ? "|" : "fin de línea");
+        status = PARSE_SYNTAX_ERROR;
+    }
+
+    free(lx.word);
+    list->expanded = lx.expanded;
+    if (status != PARSE_OK)
+        free_command_list(list);
+    return status;
+}
+
+/**
+ * @brief Copia una cadena en el buffer de salida y devuelve la posición siguiente.
+ */
+static char* append_text(char* out, const char* text)
+{
+    size_t len = strlen(text);
+    memcpy(out, text, len);
+    return out + len;
+}
+
+/**
+ * @brief Reconstruye el texto de una tubería uniendo argumentos, redirecciones y etapas con espacios.
+ *
+ * @return Cadena reservada con malloc, o NULL si no hay memoria.
+ */
+char* pipeline_to_string(const pipeline* pl)
+{
+    size_t size = 1;
+    for (int i = 0; i < pl->num_commands; i++)
+    {
+        const simple_command* cmd = &pl->commands[i];
+        size += 3; // " | "
+        for (int j = 0; j < cmd->argc; j++)
+            size += strlen(cmd->argv[j]) + 1;
+        for (int j = 0; j < cmd->num_redirections; j++)
+            size += strlen(cmd->redirections[j].path) + 4; // " 2> "
+    }
+
+    char* text = malloc(size);
+    if (text == NULL)
+        return NULL;
+
+    char* out = text;
+    for (int i = 0; i < pl->num_commands; i++)
+    {
+        const simple_command* cmd = &pl->commands[i];
+        if (i > 0)
+            out = append_text(out, " | ");
+        for (int j = 0; j < cmd->argc; j++)
+        {
+            if (j > 0)
+                *out++ = ' ';
+            out = append_text(out, cmd->argv[j]);
+        }
+        for (int j = 0; j < cmd->num_redirections; j++)
+        {
+            static const char* const operators[] = {
+                [REDIR_IN] = " < ", [REDIR_OUT] = " > ", [REDIR_APPEND] = " >> ", [REDIR_ERR] = " 2> "};
+            out = append_text(out, operators[cmd->redirections[j].type]);
+            out = append_text(out, cmd->redirections[j].path);
+        }
+    }
+    *out = '\0';
+    return text;
+}
+
+/**
+ * @brief Libera cada tubería, comando, argumento y redirección de la lista.
+ */
+void free_command_list(command_list* list)
+{
+    for (int i = 0; i < list->num_pipelines; i++)
+    {
+        pipeline* pl = &list->pipelines[i];
+        for (int j = 0; j < pl->num_commands; j++)
+        {
+            simple_command* cmd = &pl->commands[j];
+            for (int k = 0; k < cmd->argc; k++)
+                free(cmd->argv[k]);
+            for (int k = 0; k < cmd->num_redirections; k++)
+                free(cmd->redirections[k].path);
+            free(cmd->argv);
+            free(cmd->redirections);
+        }
+        free(pl->commands);
+    }
+    free(list->pipelines);
+    list->pipelines = NULL;
+    list->num_pipelines = 0;
+}
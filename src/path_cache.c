@@ -0,0 +1,229 @@
+#include "path_cache.h"
+#include "executor.h"
+#include "hash.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_BUCKETS 64 // Cantidad inicial de cubetas (siempre potencia de dos)
+
+/**
+ * @struct path_entry
+ * @brief Entrada de la tabla: nombre del comando y su ruta resuelta.
+ */
+typedef struct path_entry
+{
+    char* name;              /**< Nombre del comando tal como se escribió. */
+    char* path;              /**< Ruta absoluta resuelta en $PATH. */
+    unsigned int hits;       /**< Cantidad de veces que se usó la entrada. */
+    uint32_t hash;           /**< Hash del nombre, para redistribuir sin recalcular. */
+    struct path_entry* next; /**< Siguiente entrada en la misma cubeta. */
+} path_entry;
+
+static path_entry** buckets = NULL;
+static size_t num_buckets = 0;
+static size_t num_entries = 0;
+static char* cached_path_env = NULL; // Valor de $PATH con el que se llenó la tabla
+
+/**
+ * @brief Duplica la cantidad de cubetas cuando la tabla supera un elemento por cubeta.
+ */
+static void grow_table(void)
+{
+    size_t new_size = num_buckets ? num_buckets * 2 : INITIAL_BUCKETS;
+    path_entry** new_buckets = calloc(new_size, sizeof(path_entry*));
+    if (new_buckets == NULL)
+        return; // Se sigue usando la tabla actual, solo que más cargada
+
+    for (size_t i = 0; i < num_buckets; i++)
+    {
+        path_entry* entry = buckets[i];
+        while (entry != NULL)
+        {
+            path_entry* next = entry->next;
+            size_t index = entry->hash & (new_size - 1);
+            entry->next = new_buckets[index];
+            new_buckets[index] = entry;
+            entry = next;
+        }
+    }
+    free(buckets);
+    buckets = new_buckets;
+    num_buckets = new_size;
+}
+
+/**
+ * @brief Vacía la tabla si $PATH cambió desde que se llenó.
+ */
+static void check_path_env(void)
+{
+    const char* path_env = getenv("PATH");
+    if (path_env == NULL)
+        path_env = "";
+
+    if (cached_path_env != NULL && strcmp(cached_path_env, path_env) == 0)
+        return;
+
+    path_cache_clear();
+    cached_path_env = strdup(path_env);
+}
+
+/**
+ * @brief Busca una entrada por nombre.
+ *
+ * @return La entrada, o NULL si el nombre no está en la tabla.
+ */
+static path_entry* find_entry(const char* name, uint32_t hash)
+{
+    if (num_buckets == 0)
+        return NULL;
+
+    for (path_entry* entry = buckets[hash & (num_buckets - 1)]; entry != NULL; entry = entry->next)
+    {
+        if (entry->hash == hash && strcmp(entry->name, name) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Resuelve un nombre en $PATH y lo inserta en la tabla.
+ *
+ * @return La nueva entrada, o NULL si el comando no se encontró o no hay memoria para almacenarlo.
+ */
+static path_entry* insert_entry(const char* name, uint32_t hash)
+{
+    char resolved[PATH_BUFFER_SIZE];
+    if (resolve_command_path(name, resolved, sizeof(resolved)) == NULL)
+        return NULL;
+
+    if (num_entries >= num_buckets)
+        grow_table();
+    if (num_buckets == 0)
+        return NULL;
+
+    path_entry* entry = malloc(sizeof(path_entry));
+    if (entry == NULL)
+        return NULL;
+    entry->name = strdup(name);
+    entry->path = strdup(resolved);
+    if (entry->name == NULL || entry->path == NULL)
+    {
+        free(entry->name);
+        free(entry->path);
+        free(entry);
+        return NULL;
+    }
+    entry->hits = 0;
+    entry->hash = hash;
+
+    size_t index = hash & (num_buckets - 1);
+    entry->next = buckets[index];
+    buckets[index] = entry;
+    num_entries++;
+    return entry;
+}
+
+/**
+ * @brief Devuelve la ruta almacenada del comando o la resuelve y la almacena.
+ *
+ * @return Ruta del ejecutable, o NULL si no se encontró.
+ */
+const char* path_cache_lookup(const char* name)
+{
+    check_path_env();
+
+    uint32_t hash = fnv1a32(name, strlen(name));
+    path_entry* entry = find_entry(name, hash);
+    if (entry == NULL)
+        entry = insert_entry(name, hash);
+    if (entry == NULL)
+        return NULL;
+
+    entry->hits++;
+    return entry->path;
+}
+
+/**
+ * @brief Agrega un comando a la tabla sin contarlo como uso.
+ *
+ * @return 0 si el comando se encontró, -1 en caso contrario.
+ */
+int path_cache_seed(const char* name)
+{
+    check_path_env();
+
+    uint32_t hash = fnv1a32(name, strlen(name));
+    if (find_entry(name, hash) != NULL)
+        return 0;
+    return insert_entry(name, hash) != NULL ? 0 : -1;
+}
+
+/**
+ * @brief Elimina un comando de la tabla, si estaba.
+ */
+void path_cache_forget(const char* name)
+{
+    if (num_buckets == 0)
+        return;
+
+    uint32_t hash = fnv1a32(name, strlen(name));
+    path_entry** link = &buckets[hash & (num_buckets - 1)];
+    while (*link != NULL)
+    {
+        path_entry* entry = *link;
+        if (entry->hash == hash && strcmp(entry->name, name) == 0)
+        {
+            *link = entry->next;
+            free(entry->name);
+            free(entry->path);
+            free(entry);
+            num_entries--;
+            return;
+        }
+        link = &entry->next;
+    }
+}
+
+/**
+ * @brief Libera todas las entradas de la tabla.
+ */
+void path_cache_clear(void)
+{
+    for (size_t i = 0; i < num_buckets; i++)
+    {
+        path_entry* entry = buckets[i];
+        while (entry != NULL)
+        {
+            path_entry* next = entry->next;
+            free(entry->name);
+            free(entry->path);
+            free(entry);
+            entry = next;
+        }
+        buckets[i] = NULL;
+    }
+    num_entries = 0;
+    free(cached_path_env);
+    cached_path_env = NULL;
+}
+
+/**
+ * @brief Imprime cada entrada con el formato `usos<TAB>ruta`.
+ */
+void path_cache_print(FILE* stream)
+{
+    if (num_entries == 0)
+    {
+        fprintf(stream, "hash: tabla vacía\n");
+        return;
+    }
+
+    fprintf(stream, "usos\tcomando\n");
+    for (size_t i = 0; i < num_buckets; i++)
+    {
+        for (path_entry* entry = buckets[i]; entry != NULL; entry = entry->next)
+            fprintf(stream, "%4u\t%s\n", entry->hits, entry->path);
+    }
+}
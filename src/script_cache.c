@@ -0,0 +1,553 @@
+#include "script_cache.h"
+#include "builtins.h"
+#include "file_util.h"
+#include "hash.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define CACHE_MAGIC "SHC6"                 // Identifica el formato; cambia si cambia la estructura de los registros
+#define CACHE_DIR_NAME "shell"             // Subdirectorio dentro del directorio de caché del usuario
+#define CACHE_DIR_MODE 0700                // Permisos de los directorios de caché
+#define SHELL_BINARY_PATH "/proc/self/exe" // Ejecutable de la shell, cuya identidad se guarda en la caché
+
+/**
+ * @struct cache_header
+ * @brief Encabezado del archivo de caché, seguido de la ruta del script (terminada en '\0') y de los registros.
+ *
+ * Cada registro es: tipo (u8), estado del análisis (u8), si debe volver a analizarse (u8) y longitud y texto de la
+ * línea (u32 + bytes + '\0').
+ *
+ * Solo llevan la lista de comandos las líneas de tipos que se ejecutan como tuberías (is_pipeline_command(): externo,
+ * echo, jobs, hash y stats) analizadas con PARSE_OK y sin marca de volver a analizarse: la cantidad de tuberías (u32)
+ * y cada tubería: segundo plano (u8), cantidad de comandos (u32) y cada comando: argc (u32), cantidad de
+ * redirecciones (u32), los argumentos y las redirecciones (tipo u8 + ruta).
+ *
+ * Los enteros se guardan en el orden de bytes de la máquina: la caché no se comparte entre equipos. La caché solo
+ * vale para el ejecutable que la construyó y para su tabla de comandos internos: otro binario puede numerar
+ * distinto los tipos de comando o separar distinto las líneas.
+ */
+typedef struct
+{
+    char magic[4];             /**< CACHE_MAGIC. */
+    uint32_t path_length;      /**< Longitud de la ruta del script. */
+    uint64_t script_size;      /**< Tamaño del script al construir la caché. */
+    int64_t mtime_sec;         /**< Fecha de modificación del script (segundos). */
+    int64_t mtime_nsec;        /**< Fecha de modificación del script (nanosegundos). */
+    uint64_t shell_size;       /**< Tamaño del ejecutable de la shell que construyó la caché. */
+    int64_t shell_mtime_sec;   /**< Fecha de modificación del ejecutable (segundos). */
+    int64_t shell_mtime_nsec;  /**< Fecha de modificación del ejecutable (nanosegundos). */
+    uint64_t builtins_id;      /**< builtin_table_identity() de la shell que construyó la caché. */
+    uint32_t num_lines;        /**< Cantidad de registros. */
+    uint32_t num_pipelines;    /**< Total de tuberías. */
+    uint32_t num_commands;     /**< Total de comandos simples. */
+    uint32_t num_args;         /**< Total de argumentos. */
+    uint32_t num_redirections; /**< Total de redirecciones. */
+    uint32_t reserved;         /**< Relleno, siempre cero. */
+} cache_header;
+
+/**
+ * @brief Devuelve el directorio de caché de la shell: `$XDG_CACHE_HOME/shell` o `~/.cache/shell`.
+ */
+char* cache_directory(bool create_dirs)
+{
+    char base[PATH_MAX];
+    const char* xdg = getenv("XDG_CACHE_HOME");
+    const char* home = getenv("HOME");
+    int len;
+
+    if (xdg != NULL && *xdg == '/')
+        len = snprintf(base, sizeof(base), "%s", xdg);
+    else if (home != NULL && *home != '\0')
+        len = snprintf(base, sizeof(base), "%s/.cache", home);
+    else
+        return NULL;
+    if (len < 0 || (size_t)len >= sizeof(base))
+        return NULL;
+
+    if (create_dirs && mkdir(base, CACHE_DIR_MODE) == -1 && errno != EEXIST)
+        return NULL;
+    if (strlen(base) + sizeof("/" CACHE_DIR_NAME) > sizeof(base))
+        return NULL;
+    strcat(base, "/" CACHE_DIR_NAME);
+    if (create_dirs && mkdir(base, CACHE_DIR_MODE) == -1 && errno != EEXIST)
+        return NULL;
+    return strdup(base);
+}
+
+/**
+ * @brief Arma la ruta del archivo de caché de un script y, si se pide, crea los directorios que faltan.
+ *
+ * @return Ruta reservada con malloc, o NULL si no hay directorio de caché disponible.
+ */
+static char* cache_file_path(const char* script_path, bool create_dirs)
+{
+    char* base = cache_directory(create_dirs);
+    if (base == NULL)
+        return NULL;
+    char* path = malloc(strlen(base) + 32);
+    if (path != NULL)
+        sprintf(path, "%s/%016llx.cache", base, (unsigned long long)fnv1a64(script_path, strlen(script_path)));
+    free(base);
+    return path;
+}
+
+/**
+ * @brief Completa en el encabezado la identidad de la shell actual: su ejecutable y su tabla de comandos internos.
+ *
+ * @return true si se pudo identificar el ejecutable.
+ */
+static bool fill_shell_identity(cache_header* header)
+{
+    struct stat st;
+    if (stat(SHELL_BINARY_PATH, &st) == -1)
+        return false;
+    header->shell_size = (uint64_t)st.st_size;
+    header->shell_mtime_sec = (int64_t)st.st_mtim.tv_sec;
+    header->shell_mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+    header->builtins_id = builtin_table_identity();
+    return true;
+}
+
+/**
+ * @brief Indica si el encabezado corresponde al script en su estado actual y a la shell que lo ejecuta.
+ */
+static bool header_matches(const cache_header* header, const struct stat* st)
+{
+    cache_header shell;
+    return memcmp(header->magic, CACHE_MAGIC, sizeof(header->magic)) == 0 &&
+           header->script_size == (uint64_t)st->st_size && header->mtime_sec == (int64_t)st->st_mtim.tv_sec &&
+           header->mtime_nsec == (int64_t)st->st_mtim.tv_nsec && fill_shell_identity(&shell) &&
+           header->shell_size == shell.shell_size && header->shell_mtime_sec == shell.shell_mtime_sec &&
+           header->shell_mtime_nsec == shell.shell_mtime_nsec && header->builtins_id == shell.builtins_id;
+}
+
+/**
+ * @struct cursor
+ * @brief Posición de lectura dentro de la proyección, con el límite que no debe superarse.
+ */
+typedef struct
+{
+    char* pos; /**< Próximo byte a leer. */
+    char* end; /**< Fin de la proyección. */
+} cursor;
+
+/**
+ * @brief Lee un byte.
+ */
+static bool read_u8(cursor* c, uint8_t* value)
+{
+    if (c->pos >= c->end)
+        return false;
+    *value = (uint8_t)*c->pos++;
+    return true;
+}
+
+/**
+ * @brief Lee un entero de 32 bits, que puede no estar alineado.
+ */
+static bool read_u32(cursor* c, uint32_t* value)
+{
+    if ((size_t)(c->end - c->pos) < sizeof(*value))
+        return false;
+    memcpy(value, c->pos, sizeof(*value));
+    c->pos += sizeof(*value);
+    return true;
+}
+
+/**
+ * @brief Lee una cadena guardada con su longitud y su '\0'; la cadena queda dentro de la proyección.
+ */
+static bool read_string(cursor* c, char** value)
+{
+    uint32_t len;
+    if (!read_u32(c, &len) || (size_t)(c->end - c->pos) <= len || c->pos[len] != '\0')
+        return false;
+    *value = c->pos;
+    c->pos += len + 1;
+    return true;
+}
+
+/**
+ * @struct cache_counts
+ * @brief Estructuras ya usadas de cada arreglo de la caché, para no superar los totales del encabezado.
+ */
+typedef struct
+{
+    uint32_t pipelines;    /**< Tuberías usadas. */
+    uint32_t commands;     /**< Comandos simples usados. */
+    uint32_t args;         /**< Punteros de argv usados (incluidos los NULL finales). */
+    uint32_t redirections; /**< Redirecciones usadas. */
+} cache_counts;
+
+/**
+ * @brief Reconstruye un comando simple desde el registro.
+ */
+static bool read_simple_command(cursor* c, script_cache* cache, const cache_header* header, cache_counts* used,
+                                simple_command* cmd)
+{
+    uint32_t argc, num_redirections;
+    if (!read_u32(c, &argc) || !read_u32(c, &num_redirections) || argc == 0 ||
+        (uint64_t)used->args + argc + 1 > (uint64_t)header->num_args + header->num_commands ||
+        num_redirections > header->num_redirections - used->redirections)
+        return false;
+
+    cmd->argv = &cache->args[used->args];
+    cmd->argc = (int)argc;
+    used->args += argc + 1;
+    for (uint32_t i = 0; i < argc; i++)
+    {
+        if (!read_string(c, &cmd->argv[i]))
+            return false;
+    }
+    cmd->argv[argc] = NULL;
+
+    cmd->redirections = num_redirections > 0 ? &cache->redirections[used->redirections] : NULL;
+    cmd->num_redirections = (int)num_redirections;
+    used->redirections += num_redirections;
+    for (uint32_t i = 0; i < num_redirections; i++)
+    {
+        uint8_t type;
+        if (!read_u8(c, &type) || type > REDIR_ERR || !read_string(c, &cmd->redirections[i].path))
+            return false;
+        cmd->redirections[i].type = (redirection_type)type;
+    }
+    return true;
+}
+
+/**
+ * @brief Reconstruye la lista de tuberías de un comando externo desde el registro.
+ */
+static bool read_command_list(cursor* c, script_cache* cache, const cache_header* header, cache_counts* used,
+                              command_list* list)
+{
+    uint32_t num_pipelines;
+    if (!read_u32(c, &num_pipelines) || num_pipelines > header->num_pipelines - used->pipelines)
+        return false;
+
+    list->pipelines = num_pipelines > 0 ? &cache->pipelines[used->pipelines] : NULL;
+    list->num_pipelines = (int)num_pipelines;
+    used->pipelines += num_pipelines;
+    for (uint32_t i = 0; i < num_pipelines; i++)
+    {
+        pipeline* pl = &list->pipelines[i];
+        uint8_t background;
+        uint32_t num_commands;
+        if (!read_u8(c, &background) || !read_u32(c, &num_commands) || num_commands == 0 ||
+            num_commands > header->num_commands - used->commands)
+            return false;
+
+        pl->background = background != 0;
+        pl->commands = &cache->commands[used->commands];
+        pl->num_commands = (int)num_commands;
+        used->commands += num_commands;
+        for (uint32_t j = 0; j < num_commands; j++)
+        {
+            if (!read_simple_command(c, cache, header, used, &pl->commands[j]))
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Reconstruye todas las líneas a partir de los registros que siguen al encabezado.
+ */
+static bool read_lines(cursor* c, script_cache* cache, const cache_header* header)
+{
+    cache_counts used = {0, 0, 0, 0};
+
+    for (uint32_t i = 0; i < header->num_lines; i++)
+    {
+        cached_line* line = &cache->lines[i];
+        uint8_t type, status, reparse;
+        if (!read_u8(c, &type) || !read_u8(c, &status) || !read_u8(c, &reparse) || type > CMD_LAST ||
+            status > PARSE_SYNTAX_ERROR || !read_string(c, &line->text))
+            return false;
+
+        line->prepared.type = (command_type)type;
+        line->prepared.status = (parse_status)status;
+        line->prepared.list.pipelines = NULL;
+        line->prepared.list.num_pipelines = 0;
+        line->prepared.list.expanded = false;
+        line->reparse = reparse != 0;
+        if (is_pipeline_command(line->prepared.type) && status == PARSE_OK && !line->reparse &&
+            !read_command_list(c, cache, header, &used, &line->prepared.list))
+            return false;
+    }
+    return c->pos == c->end;
+}
+
+/**
+ * @brief Proyecta el archivo de caché y reconstruye las líneas sin volver a analizarlas.
+ *
+ * La proyección es privada y escribible: los comandos internos pueden modificar el texto de la línea sin afectar
+ * al archivo.
+ */
+int script_cache_load(script_cache* cache, const char* script_path)
+{
+    memset(cache, 0, sizeof(*cache));
+
+    char resolved[PATH_MAX];
+    struct stat script_stat;
+    if (realpath(script_path, resolved) == NULL || stat(resolved, &script_stat) == -1 ||
+        !S_ISREG(script_stat.st_mode))
+        return -1;
+
+    char* path = cache_file_path(resolved, false);
+    if (path == NULL)
+        return -1;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    free(path);
+    if (fd == -1)
+        return -1;
+
+    struct stat cache_stat;
+    if (fstat(fd, &cache_stat) == -1 || (size_t)cache_stat.st_size < sizeof(cache_header))
+    {
+        close(fd);
+        return -1;
+    }
+    cache->map_size = (size_t)cache_stat.st_size;
+    cache->map = mmap(NULL, cache->map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (cache->map == MAP_FAILED)
+    {
+        cache->map = NULL;
+        return -1;
+    }
+
+    cache_header header;
+    memcpy(&header, cache->map, sizeof(header));
+    cursor c = {cache->map + sizeof(header), cache->map + cache->map_size};
+    size_t path_length = strlen(resolved);
+    if (!header_matches(&header, &script_stat) || header.path_length != path_length ||
+        (size_t)(c.end - c.pos) <= path_length || memcmp(c.pos, resolved, path_length + 1) != 0 ||
+        header.num_lines > INT_MAX)
+    {
+        script_cache_close(cache);
+        return -1;
+    }
+    c.pos += path_length + 1;
+
+    cache->lines = malloc(((size_t)header.num_lines + 1) * sizeof(cached_line));
+    cache->pipelines = malloc(((size_t)header.num_pipelines + 1) * sizeof(pipeline));
+    cache->commands = malloc(((size_t)header.num_commands + 1) * sizeof(simple_command));
+    cache->args = malloc(((size_t)header.num_args + header.num_commands + 1) * sizeof(char*));
+    cache->redirections = malloc(((size_t)header.num_redirections + 1) * sizeof(redirection));
+    if (cache->lines == NULL || cache->pipelines == NULL || cache->commands == NULL || cache->args == NULL ||
+        cache->redirections == NULL || !read_lines(&c, cache, &header))
+    {
+        script_cache_close(cache);
+        return -1;
+    }
+    cache->num_lines = (int)header.num_lines;
+    return 0;
+}
+
+/**
+ * @brief Libera la proyección y los arreglos de la caché.
+ */
+void script_cache_close(script_cache* cache)
+{
+    if (cache->map != NULL)
+        munmap(cache->map, cache->map_size);
+    free(cache->lines);
+    free(cache->pipelines);
+    free(cache->commands);
+    free(cache->args);
+    free(cache->redirections);
+    memset(cache, 0, sizeof(*cache));
+}
+
+/**
+ * @brief Resuelve la ruta del script y la del archivo de caché, creando el directorio si hace falta.
+ */
+int script_cache_builder_init(script_cache_builder* builder, const char* script_path)
+{
+    memset(builder, 0, sizeof(*builder));
+
+    char resolved[PATH_MAX];
+    if (realpath(script_path, resolved) == NULL || stat(resolved, &builder->script_stat) == -1 ||
+        !S_ISREG(builder->script_stat.st_mode))
+        return -1;
+
+    builder->script_path = strdup(resolved);
+    builder->cache_path = cache_file_path(resolved, true);
+    if (builder->script_path == NULL || builder->cache_path == NULL)
+    {
+        script_cache_builder_free(builder);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Agrega bytes al final de los registros, agrandando el buffer al doble cuando no entran.
+ */
+static void append(script_cache_builder* builder, const void* data, size_t size)
+{
+    if (builder->failed)
+        return;
+
+    if (builder->size + size > builder->capacity)
+    {
+        size_t new_capacity = builder->capacity ? builder->capacity : 4096;
+        while (builder->size + size > new_capacity)
+            new_capacity *= 2;
+        unsigned char* new_data = realloc(builder->data, new_capacity);
+        if (new_data == NULL)
+        {
+            builder->failed = true;
+            return;
+        }
+        builder->data = new_data;
+        builder->capacity = new_capacity;
+    }
+    memcpy(builder->data + builder->size, data, size);
+    builder->size += size;
+}
+
+/**
+ * @brief Agrega un byte.
+ */
+static void append_u8(script_cache_builder* builder, uint8_t value)
+{
+    append(builder, &value, sizeof(value));
+}
+
+/**
+ * @brief Agrega un entero de 32 bits.
+ */
+static void append_u32(script_cache_builder* builder, uint32_t value)
+{
+    append(builder, &value, sizeof(value));
+}
+
+/**
+ * @brief Agrega una cadena con su longitud y su '\0', para poder usarla en el lugar al cargar la caché.
+ */
+static void append_string(script_cache_builder* builder, const char* value)
+{
+    size_t len = strlen(value);
+    if (len > UINT32_MAX - 1)
+    {
+        builder->failed = true;
+        return;
+    }
+    append_u32(builder, (uint32_t)len);
+    append(builder, value, len + 1);
+}
+
+/**
+ * @brief Serializa la lista de tuberías de un comando externo.
+ */
+static void append_command_list(script_cache_builder* builder, const command_list* list)
+{
+    append_u32(builder, (uint32_t)list->num_pipelines);
+    builder->num_pipelines += (unsigned int)list->num_pipelines;
+    for (int i = 0; i < list->num_pipelines; i++)
+    {
+        const pipeline* pl = &list->pipelines[i];
+        append_u8(builder, pl->background);
+        append_u32(builder, (uint32_t)pl->num_commands);
+        builder->num_commands += (unsigned int)pl->num_commands;
+        for (int j = 0; j < pl->num_commands; j++)
+        {
+            const simple_command* cmd = &pl->commands[j];
+            append_u32(builder, (uint32_t)cmd->argc);
+            append_u32(builder, (uint32_t)cmd->num_redirections);
+            builder->num_args += (unsigned int)cmd->argc;
+            builder->num_redirections += (unsigned int)cmd->num_redirections;
+            for (int k = 0; k < cmd->argc; k++)
+                append_string(builder, cmd->argv[k]);
+            for (int k = 0; k < cmd->num_redirections; k++)
+            {
+                append_u8(builder, (uint8_t)cmd->redirections[k].type);
+                append_string(builder, cmd->redirections[k].path);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Serializa una línea: tipo, estado, texto y, si corresponde, sus tuberías.
+ *
+ * Las líneas con errores de sintaxis o con variables se guardan sin tuberías: se vuelven a analizar en cada
+ * ejecución, para informar el error o expandir las variables con el entorno de ese momento.
+ */
+void script_cache_record(script_cache_builder* builder, const char* text, const prepared_command* prepared)
+{
+    bool parsed = is_pipeline_command(prepared->type) && prepared->status == PARSE_OK;
+    bool reparse = prepared->status == PARSE_SYNTAX_ERROR || (parsed && prepared->list.expanded);
+    append_u8(builder, (uint8_t)prepared->type);
+    append_u8(builder, (uint8_t)prepared->status);
+    append_u8(builder, reparse);
+    append_string(builder, text);
+    if (parsed && !reparse)
+        append_command_list(builder, &prepared->list);
+    builder->num_lines++;
+}
+
+/**
+ * @brief Guarda la caché de forma atómica: otra ejecución simultánea ve la caché anterior o la nueva completa.
+ */
+int script_cache_commit(script_cache_builder* builder)
+{
+    struct stat st;
+    if (builder->failed || stat(builder->script_path, &st) == -1 ||
+        st.st_size != builder->script_stat.st_size || st.st_mtim.tv_sec != builder->script_stat.st_mtim.tv_sec ||
+        st.st_mtim.tv_nsec != builder->script_stat.st_mtim.tv_nsec)
+        return -1;
+
+    cache_header header;
+    memset(&header, 0, sizeof(header));
+    if (!fill_shell_identity(&header))
+        return -1;
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.path_length = (uint32_t)strlen(builder->script_path);
+    header.script_size = (uint64_t)st.st_size;
+    header.mtime_sec = (int64_t)st.st_mtim.tv_sec;
+    header.mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+    header.num_lines = builder->num_lines;
+    header.num_pipelines = builder->num_pipelines;
+    header.num_commands = builder->num_commands;
+    header.num_args = builder->num_args;
+    header.num_redirections = builder->num_redirections;
+
+    size_t tmp_len = strlen(builder->cache_path) + sizeof(".XXXXXX");
+    char tmp_path[tmp_len];
+    snprintf(tmp_path, tmp_len, "%s.XXXXXX", builder->cache_path);
+    int fd = mkstemp(tmp_path);
+    if (fd == -1)
+        return -1;
+
+    bool ok = write_all(fd, &header, sizeof(header)) &&
+              write_all(fd, builder->script_path, header.path_length + 1) &&
+              write_all(fd, builder->data, builder->size);
+    if (close(fd) == -1)
+        ok = false;
+    if (!ok || rename(tmp_path, builder->cache_path) == -1)
+    {
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Libera las rutas y los registros acumulados.
+ */
+void script_cache_builder_free(script_cache_builder* builder)
+{
+    free(builder->cache_path);
+    free(builder->script_path);
+    free(builder->data);
+    memset(builder, 0, sizeof(*builder));
+}
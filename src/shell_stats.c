@@ -0,0 +1,472 @@
+#define _GNU_SOURCE // Para accept4()
+#include "shell_stats.h"
+#include "file_util.h"
+#include "hash.h"
+#include <errno.h>
+#include <poll.h>
+#include <prom.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define STATS_TABLE_SIZE 256      // Posiciones de la tabla de contadores (siempre potencia de dos)
+#define STATS_MAX_NAMES 128       // Nombres distintos antes de agrupar los nuevos en "(otros)"
+#define STATS_OTHERS "(otros)"    // Nombre con el que se cuentan los comandos que no entran en la tabla
+#define STATS_REQUEST_SIZE 1024   // Bytes de la petición HTTP que se leen (y se descartan)
+#define STATS_REQUEST_WAIT_MS 100 // Espera máxima por la petición antes de responder igual
+
+/**
+ * @struct latency_histogram
+ * @brief Histograma con cubetas de potencias de dos en microsegundos.
+ */
+typedef struct
+{
+    uint64_t buckets[STATS_BUCKETS + 1]; /**< Mediciones de cada cubeta; la última no tiene cota superior. */
+    uint64_t count;                      /**< Cantidad de mediciones. */
+    uint64_t sum;                        /**< Suma de las mediciones (ns). */
+    uint64_t max;                        /**< Mayor medición (ns). */
+} latency_histogram;
+
+/**
+ * @struct command_counter
+ * @brief Entrada de la tabla de contadores por comando.
+ */
+typedef struct
+{
+    char* name;              /**< Nombre del comando, o NULL si la entrada está libre. */
+    stats_command_kind kind; /**< Clase del comando. */
+    uint64_t count;          /**< Ejecuciones contadas. */
+} command_counter;
+
+static latency_histogram histograms[STATS_HISTOGRAMS];
+static command_counter counters[STATS_TABLE_SIZE]; // Tabla con direccionamiento abierto
+static size_t num_names = 0;                       // Nombres distintos en la tabla
+
+static const char* const histogram_titles[STATS_HISTOGRAMS] = {"despacho", "comando interno", "fork + exec",
+                                                                "trabajo (real)"};
+static const char* const histogram_names[STATS_HISTOGRAMS] = {"shell_dispatch_seconds", "shell_builtin_seconds",
+                                                               "shell_spawn_seconds", "shell_child_wall_seconds"};
+static const char* const histogram_help[STATS_HISTOGRAMS] = {
+    "Tiempo desde que se lee una línea hasta despacharla", "Tiempo de ejecución de los comandos internos",
+    "Tiempo desde que se crea un proceso hasta que ejecuta su programa", "Tiempo real de los trabajos"};
+static const char* const kind_names[] = {"interno", "externo"};
+static const char* command_label_keys[] = {"tipo", "comando"};
+
+static prom_collector_registry_t* registry = NULL; // Métricas exportadas; NULL hasta stats_serve()
+static prom_histogram_t* prom_histograms[STATS_HISTOGRAMS];
+static prom_counter_t* prom_commands = NULL;
+static volatile bool exporting = false; // Las mediciones también se registran en las métricas de Prometheus
+static int server_fd = -1;
+static pid_t server_pid = 0;     // Proceso que creó el socket, el único que lo elimina al salir
+static char* server_path = NULL; // Ruta del socket
+static bool handlers_registered = false;
+
+/**
+ * @brief Devuelve el instante actual del reloj monotónico en nanosegundos.
+ */
+uint64_t stats_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Cota superior de una cubeta en nanosegundos.
+ */
+static uint64_t bucket_bound(int bucket)
+{
+    return (uint64_t)1000 << bucket;
+}
+
+/**
+ * @brief Cubeta que corresponde a una duración: la primera cuya cota es mayor o igual.
+ */
+static int bucket_index(uint64_t nanoseconds)
+{
+    uint64_t micros = (nanoseconds + 999) / 1000;
+    if (micros <= 1)
+        return 0;
+    int bucket = 64 - __builtin_clzll(micros - 1); // Redondeo hacia arriba de log2
+    return bucket < STATS_BUCKETS ? bucket : STATS_BUCKETS;
+}
+
+/**
+ * @brief Registra una duración en un histograma.
+ */
+void stats_observe(stats_histogram histogram, uint64_t nanoseconds)
+{
+    latency_histogram* h = &histograms[histogram];
+    h->buckets[bucket_index(nanoseconds)]++;
+    h->count++;
+    h->sum += nanoseconds;
+    if (nanoseconds > h->max)
+        h->max = nanoseconds;
+
+    if (exporting)
+        prom_histogram_observe(prom_histograms[histogram], (double)nanoseconds / 1e9, NULL);
+}
+
+/**
+ * @brief Registra en un histograma el tiempo transcurrido desde `start`.
+ */
+void stats_observe_since(stats_histogram histogram, uint64_t start)
+{
+    stats_observe(histogram, stats_now() - start);
+}
+
+/**
+ * @brief Busca la entrada de un comando en la tabla de contadores.
+ *
+ * @return La entrada, o la posición libre donde debería ir si no está.
+ */
+static command_counter* find_counter(stats_command_kind kind, const char* name)
+{
+    size_t i = fnv1a32_from(FNV1A32_OFFSET ^ (uint32_t)kind, name, strlen(name)) & (STATS_TABLE_SIZE - 1);
+    while (counters[i].name != NULL && (counters[i].kind != kind || strcmp(counters[i].name, name) != 0))
+        i = (i + 1) & (STATS_TABLE_SIZE - 1);
+    return &counters[i];
+}
+
+/**
+ * @brief Suma una ejecución al contador de un comando.
+ */
+void stats_count_command(stats_command_kind kind, const char* name)
+{
+    if (kind == STATS_EXTERNAL)
+    {
+        const char* slash = strrchr(name, '/');
+        if (slash != NULL && slash[1] != '\0')
+            name = slash + 1;
+    }
+
+    command_counter* counter = find_counter(kind, name);
+    if (counter->name == NULL && num_names >= STATS_MAX_NAMES)
+    {
+        name = STATS_OTHERS; // La tabla nunca se llena: siempre queda lugar para los dos "(otros)"
+        counter = find_counter(kind, name);
+    }
+    if (counter->name == NULL)
+    {
+        counter->name = strdup(name);
+        if (counter->name == NULL)
+            return;
+        counter->kind = kind;
+        num_names++;
+    }
+    counter->count++;
+
+    if (exporting)
+    {
+        const char* labels[] = {kind_names[kind], name};
+        prom_counter_inc(prom_commands, labels);
+    }
+}
+
+/**
+ * @brief Devuelve la cantidad de mediciones de un histograma.
+ */
+uint64_t stats_histogram_count(stats_histogram histogram)
+{
+    return histograms[histogram].count;
+}
+
+/**
+ * @brief Estima un cuantil de un histograma interpolando dentro de su cubeta.
+ */
+uint64_t stats_histogram_quantile(stats_histogram histogram, double quantile)
+{
+    const latency_histogram* h = &histograms[histogram];
+    if (h->count == 0)
+        return 0;
+
+    double rank = quantile * (double)h->count;
+    uint64_t below = 0;
+    for (int i = 0; i <= STATS_BUCKETS; i++)
+    {
+        if (h->buckets[i] == 0 || (double)(below + h->buckets[i]) < rank)
+        {
+            below += h->buckets[i];
+            continue;
+        }
+
+        // La última cubeta no tiene cota: se usa el máximo observado
+        uint64_t lower = i > 0 ? bucket_bound(i - 1) : 0;
+        uint64_t upper = i < STATS_BUCKETS ? bucket_bound(i) : h->max;
+        double fraction = (rank - (double)below) / (double)h->buckets[i];
+        uint64_t estimate = lower + (uint64_t)((double)(upper - lower) * fraction);
+        return estimate < h->max ? estimate : h->max;
+    }
+    return h->max;
+}
+
+/**
+ * @brief Devuelve la cantidad de ejecuciones contadas para un comando.
+ */
+uint64_t stats_command_count(stats_command_kind kind, const char* name)
+{
+    const command_counter* counter = find_counter(kind, name);
+    return counter->name != NULL ? counter->count : 0;
+}
+
+/**
+ * @brief Vacía los histogramas y los contadores.
+ */
+void stats_reset(void)
+{
+    memset(histograms, 0, sizeof(histograms));
+    for (size_t i = 0; i < STATS_TABLE_SIZE; i++)
+        free(counters[i].name);
+    memset(counters, 0, sizeof(counters));
+    num_names = 0;
+}
+
+/**
+ * @brief Ordena los contadores por clase, de mayor a menor cantidad y luego por nombre.
+ */
+static int compare_counters(const void* a, const void* b)
+{
+    const command_counter* x = *(const command_counter* const*)a;
+    const command_counter* y = *(const command_counter* const*)b;
+    if (x->kind != y->kind)
+        return (int)x->kind - (int)y->kind;
+    if (x->count != y->count)
+        return x->count > y->count ? -1 : 1;
+    return strcmp(x->name, y->name);
+}
+
+/**
+ * @brief Imprime los histogramas y los contadores de comandos.
+ */
+void stats_print(FILE* stream)
+{
+    fprintf(stream, "%-18s %10s %10s %10s %10s %10s %10s\n", "Latencia (ms)", "cantidad", "media", "p50", "p95",
+            "p99", "max");
+    for (int i = 0; i < STATS_HISTOGRAMS; i++)
+    {
+        const latency_histogram* h = &histograms[i];
+        double mean = h->count > 0 ? (double)h->sum / (double)h->count : 0;
+        fprintf(stream, "%-18s %10llu %10.3f %10.3f %10.3f %10.3f %10.3f\n", histogram_titles[i],
+                (unsigned long long)h->count, mean / 1e6, (double)stats_histogram_quantile(i, 0.5) / 1e6,
+                (double)stats_histogram_quantile(i, 0.95) / 1e6, (double)stats_histogram_quantile(i, 0.99) / 1e6,
+                (double)h->max / 1e6);
+    }
+
+    const command_counter* sorted[STATS_TABLE_SIZE];
+    size_t count = 0;
+    for (size_t i = 0; i < STATS_TABLE_SIZE; i++)
+    {
+        if (counters[i].name != NULL)
+            sorted[count++] = &counters[i];
+    }
+    if (count == 0)
+        return;
+    qsort(sorted, count, sizeof(sorted[0]), compare_counters);
+
+    fprintf(stream, "\n%-8s %-30s %10s\n", "Tipo", "Comando", "cantidad");
+    for (size_t i = 0; i < count; i++)
+        fprintf(stream, "%-8s %-30s %10llu\n", kind_names[sorted[i]->kind], sorted[i]->name,
+                (unsigned long long)sorted[i]->count);
+}
+
+/**
+ * @brief En los hijos creados con fork() deja de registrar las mediciones en las métricas de Prometheus.
+ *
+ * El hilo del socket no existe en el hijo y podría haber quedado con un bloqueo de las métricas tomado.
+ */
+static void stop_exporting_in_child(void)
+{
+    exporting = false;
+    server_pid = 0;
+}
+
+/**
+ * @brief Elimina `path` solo si es un socket, para no borrar un archivo que el usuario nombró por error.
+ *
+ * @return 0 si se eliminó o no existía, -1 si hay otro tipo de archivo (errno = EEXIST) o no se pudo eliminar.
+ */
+static int unlink_socket(const char* path)
+{
+    struct stat st;
+    if (lstat(path, &st) == -1)
+        return errno == ENOENT ? 0 : -1;
+    if (!S_ISSOCK(st.st_mode))
+    {
+        errno = EEXIST;
+        return -1;
+    }
+    return unlink(path);
+}
+
+/**
+ * @brief Elimina el socket al terminar la shell.
+ */
+static void remove_socket(void)
+{
+    if (server_pid == getpid() && server_path != NULL)
+        unlink_socket(server_path);
+}
+
+/**
+ * @brief Responde a una conexión con la exposición de las métricas.
+ *
+ * La petición se lee para no cerrar la conexión con datos pendientes, pero su contenido no importa: cualquier
+ * ruta devuelve las métricas. Si el cliente no envía nada, se responde igual.
+ */
+static void serve_client(int client)
+{
+    char request[STATS_REQUEST_SIZE];
+    struct pollfd pfd = {.fd = client, .events = POLLIN};
+    if (poll(&pfd, 1, STATS_REQUEST_WAIT_MS) > 0)
+    {
+        ssize_t unused = read(client, request, sizeof(request));
+        (void)unused;
+    }
+
+    const char* body = prom_collector_registry_bridge(registry);
+    if (body == NULL)
+        return;
+    char header[128];
+    int length = snprintf(header, sizeof(header),
+                          "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\n\r\n",
+                          strlen(body));
+    if (write_all(client, header, (size_t)length))
+        write_all(client, body, strlen(body)); // Si el cliente se fue, no hay a quién informarle el error
+    free((char*)body);
+}
+
+/**
+ * @brief Cuerpo del hilo del socket: atiende una conexión por vez.
+ */
+static void* serve_metrics(void* arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        int client = accept4(server_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (client == -1)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            perror("stats: accept");
+            return NULL;
+        }
+        serve_client(client);
+        close(client);
+    }
+}
+
+/**
+ * @brief Crea las métricas de Prometheus que reflejan los histogramas y los contadores.
+ *
+ * @return 0 si se crearon, -1 si no.
+ */
+static int create_metrics(void)
+{
+    prom_collector_registry_t* new_registry = prom_collector_registry_new("shell");
+    prom_collector_t* collector = prom_collector_new("shell");
+    if (new_registry == NULL || collector == NULL ||
+        prom_collector_registry_register_collector(new_registry, collector) != 0)
+        return -1;
+    prom_collector_registry_enable_process_metrics(new_registry); // CPU, memoria y descriptores de la propia shell
+
+    // Las mismas cotas que los histogramas internos, en segundos
+    prom_histogram_buckets_t* buckets = prom_histogram_buckets_exponential(1e-6, 2, STATS_BUCKETS);
+    if (buckets == NULL)
+        return -1;
+    for (int i = 0; i < STATS_HISTOGRAMS; i++)
+    {
+        prom_histograms[i] = prom_histogram_new(histogram_names[i], histogram_help[i], buckets, 0, NULL);
+        if (prom_histograms[i] == NULL || prom_collector_add_metric(collector, prom_histograms[i]) != 0)
+            return -1;
+    }
+    prom_commands = prom_counter_new("shell_commands_total", "Comandos ejecutados por la shell", 2, command_label_keys);
+    if (prom_commands == NULL || prom_collector_add_metric(collector, prom_commands) != 0)
+        return -1;
+
+    registry = new_registry;
+    return 0;
+}
+
+/**
+ * @brief Exporta las estadísticas en formato Prometheus por un socket Unix.
+ */
+int stats_serve(const char* path)
+{
+    if (server_fd != -1)
+    {
+        fprintf(stderr, "stats: las métricas ya se exportan en %s\n", server_path);
+        return -1;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "stats: ruta de socket demasiado larga: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    // Solo se reemplaza el socket de una shell anterior, nunca otro tipo de archivo
+    if (unlink_socket(path) == -1)
+    {
+        if (errno == EEXIST)
+            fprintf(stderr, "stats: %s ya existe y no es un socket\n", path);
+        else
+            perror("stats: socket");
+        return -1;
+    }
+
+    if (registry == NULL && create_metrics() == -1)
+    {
+        fprintf(stderr, "stats: no se pudieron crear las métricas de Prometheus\n");
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1 || listen(fd, SOMAXCONN) == -1)
+    {
+        perror("stats: socket");
+        if (fd != -1)
+            close(fd);
+        return -1;
+    }
+    server_fd = fd;
+    server_path = strdup(path);
+    server_pid = getpid();
+
+    if (!handlers_registered)
+    {
+        pthread_atfork(NULL, NULL, stop_exporting_in_child);
+        atexit(remove_socket);
+        handlers_registered = true;
+    }
+
+    // El hilo bloquea todas las señales, para que las de la shell sigan llegando al hilo principal
+    sigset_t all_signals, old_mask;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_BLOCK, &all_signals, &old_mask);
+    pthread_t thread;
+    int error = pthread_create(&thread, NULL, serve_metrics, NULL);
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    if (error != 0)
+    {
+        fprintf(stderr, "stats: %s\n", strerror(error));
+        close(server_fd);
+        unlink_socket(path);
+        server_fd = -1;
+        return -1;
+    }
+    pthread_detach(thread);
+    exporting = true;
+    return 0;
+}
@@ -1,48 +1,59 @@
 #include "wrapper.h"
 #include <cjson/cJSON.h>
 #include <curl/curl.h>
-#include <fcntl.h> // Para open y O_TRUNC
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/stat.h>
-#include <sys/types.h> // Para mkfifo
-#include <unistd.h>    // Para access y sleep
+#include <sys/stat.h> // Para stat
+#include <unistd.h>   // Para sleep
 
 /**
- * @brief Callback para escribir datos en un buffer.
+ * @brief Callback de cURL: analiza cada trozo de la respuesta a medida que llega.
  *
- * Esta función se llama para manejar los datos recibidos de cURL y
- * almacenarlos en un buffer dinámico.
+ * Las muestras completas pasan por el filtro y se agregan a la trama en curso sin guardar la respuesta entera.
  *
- * @return Tamaño real de los datos escritos.
+ * @return Tamaño de los datos consumidos, o 0 para cancelar la transferencia si no hay memoria.
  */
-static size_t write_memory_callback(void* contents, size_t size, size_t nmemb, void* userp)
+static size_t write_stream_callback(void* contents, size_t size, size_t nmemb, void* userp)
 {
     size_t realsize = size * nmemb;
-    struct memory_struct* mem = (struct memory_struct*)userp;
+    struct metrics_client* client = (struct metrics_client*)userp;
 
-    char* ptr = realloc(mem->memory, mem->size + realsize + 1);
-    if (ptr == NULL)
+    if (exposition_parser_feed(&client->parser, contents, realsize) == -1)
         return 0; // Sin memoria
 
-    mem->memory = ptr;
-    memcpy(&(mem->memory[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->memory[mem->size] = 0;
-
     return realsize;
 }
 
+/**
+ * @brief Filtro del analizador: acepta las métricas que incluye la configuración.
+ */
+static bool filtrar_muestra(const char* name, size_t name_length, void* data)
+{
+    struct metrics_client* client = data;
+    return metric_matcher_match(&client->matcher, name, name_length);
+}
+
+/**
+ * @brief Recibe cada muestra que pasó el filtro y la agrega a la trama en curso.
+ */
+static void publicar_muestra(const exposition_sample* sample, void* data)
+{
+    struct metrics_client* client = data;
+    metrics_shm_add(client->shm, sample->name, sample->name_length, sample->labels, sample->labels_length,
+                    sample->value, sample->timestamp_ms);
+}
+
 /**
  * @brief Lee el archivo de configuración.
  *
  * Esta función carga y analiza el archivo de configuración JSON para
- * obtener el intervalo de muestreo.
+ * obtener el intervalo de muestreo y el tiempo máximo de cada consulta.
  *
  * @return Puntero a un objeto cJSON que representa la configuración leída, o NULL en caso de error.
  */
-cJSON* leer_configuracion(int* intervalo_muestreo)
+cJSON* leer_configuracion(int* intervalo_muestreo, long* timeout_ms)
 {
     FILE* file = fopen(CONFIG_PATH, "r");
     if (!file)
@@ -54,9 +65,14 @@ cJSON* leer_configuracion(int* intervalo_muestreo)
     fseek(file, 0, SEEK_END);
     long length = ftell(file);
     fseek(file, 0, SEEK_SET);
-    char* data = malloc(length + 1);
+    char* data = length >= 0 ? malloc(length + 1) : NULL;
+    if (data == NULL)
+    {
+        fclose(file);
+        return NULL;
+    }
     size_t read_count = fread(data, 1, length, file);
-    (void)read_count;
+    data[read_count] = '\0';
     fclose(file);
 
     cJSON* json = cJSON_Parse(data);
@@ -74,144 +90,226 @@ cJSON* leer_configuracion(int* intervalo_muestreo)
     {
         *intervalo_muestreo = DEFAULT_INTERVAL; // Valor predeterminado si no está definido en el JSON
     }
+
+    // Leer el tiempo máximo de cada consulta
+    cJSON* timeout = cJSON_GetObjectItem(json, "timeout_ms");
+    *timeout_ms = cJSON_IsNumber(timeout) && timeout->valueint > 0 ? timeout->valueint : DEFAULT_TIMEOUT_MS;
     return json;
 }
 
 /**
- * @brief Filtra métricas según el archivo de configuración.
+ * @brief Compila el filtro de métricas de la configuración.
  *
- * Esta función verifica si las métricas proporcionadas están incluidas en
- * el conjunto de métricas especificadas en la configuración.
+ * Esta función toma los nombres y patrones de la lista "metricas" y los
+ * compila en un metric_matcher, que se usa hasta que cambie el archivo.
  *
- * @return 1 si hay métricas filtradas, 0 de lo contrario.
+ * @return 0 si se compiló, -1 si no hay memoria.
  */
-int metricas_filtradas(const char* metricas, cJSON* config)
+int compilar_filtro(metric_matcher* matcher, cJSON* config)
 {
     cJSON* metricas_array = cJSON_GetObjectItem(config, "metricas");
-    if (!metricas_array)
-        return 0;
+    int cantidad = cJSON_IsArray(metricas_array) ? cJSON_GetArraySize(metricas_array) : 0;
+    const char** patrones = malloc((cantidad > 0 ? cantidad : 1) * sizeof(char*));
+    if (!patrones)
+        return -1;
 
+    size_t usados = 0;
     cJSON* metrica;
-    cJSON_ArrayForEach(metrica, metricas_array)
+    if (cantidad > 0)
     {
-        const char* nombre_metrica = cJSON_GetStringValue(metrica);
-        if (strstr(metricas, nombre_metrica))
-            return 1;
+        cJSON_ArrayForEach(metrica, metricas_array)
+        {
+            const char* nombre_metrica = cJSON_GetStringValue(metrica);
+            if (nombre_metrica)
+                patrones[usados++] = nombre_metrica;
+        }
     }
+    int status = metric_matcher_compile(matcher, patrones, usados);
+    free(patrones);
+    return status;
+}
+
+/**
+ * @brief Prepara el cliente HTTP que se reutiliza en todas las consultas.
+ *
+ * El mismo handle de cURL mantiene abierta la conexión con el monitor (keep-alive), así que las consultas
+ * siguientes no vuelven a conectarse.
+ *
+ * @return 0 si el cliente quedó listo, -1 en caso de error.
+ */
+int iniciar_cliente(struct metrics_client* client)
+{
+    memset(client, 0, sizeof(*client));
+    exposition_parser_init(&client->parser, filtrar_muestra, publicar_muestra, client);
+    client->curl = curl_easy_init();
+    if (!client->curl)
+        return -1;
+
+    curl_easy_setopt(client->curl, CURLOPT_URL, METRICS_URL);
+    curl_easy_setopt(client->curl, CURLOPT_WRITEFUNCTION, write_stream_callback);
+    curl_easy_setopt(client->curl, CURLOPT_WRITEDATA, (void*)client);
+    curl_easy_setopt(client->curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(client->curl, CURLOPT_NOSIGNAL, 1L); // Los tiempos máximos no usan SIGALRM
     return 0;
 }
 
 /**
- * @brief Función principal para obtener, filtrar y escribir métricas.
+ * @brief Libera el cliente HTTP y su analizador.
+ */
+void cerrar_cliente(struct metrics_client* client)
+{
+    if (client->curl)
+        curl_easy_cleanup(client->curl);
+    exposition_parser_free(&client->parser);
+    metric_matcher_free(&client->matcher);
+    memset(client, 0, sizeof(*client));
+}
+
+/**
+ * @brief Función principal para obtener, filtrar y publicar métricas.
  *
- * Esta función realiza una solicitud HTTP para obtener métricas,
- * las filtra según la configuración y las escribe en una pipe nombrada.
+ * Esta función realiza una solicitud HTTP para obtener métricas, las filtra según la configuración y publica las
+ * muestras como una nueva trama de la memoria compartida.
  */
-void procesar_metricas()
+void procesar_metricas(struct metrics_client* client, long timeout_ms, metrics_shm* shm)
 {
-    CURL* curl;
-    CURLcode res;
-    struct memory_struct chunk = {0};
-
-    // Inicializar cURL
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (!curl)
-        return;
-
-    // Configurar URL del programa de monitoreo
-    curl_easy_setopt(curl, CURLOPT_URL, "http://localhost:8000/metrics");
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_memory_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void*)&chunk);
-
-    res = curl_easy_perform(curl);
+    client->shm = shm;
+    exposition_parser_reset(&client->parser);
+    curl_easy_setopt(client->curl, CURLOPT_TIMEOUT_MS, timeout_ms);
+
+    // Las muestras se filtran y se agregan a la trama mientras llega la respuesta; los lectores ven la trama
+    // anterior hasta el commit
+    metrics_shm_begin(shm);
+    CURLcode res = curl_easy_perform(client->curl);
     if (res != CURLE_OK)
     {
         fprintf(stderr, "Error de cURL: %s\n", curl_easy_strerror(res));
-        curl_easy_cleanup(curl);
-        return;
+        return; // La trama a medio armar se descarta en el próximo metrics_shm_begin()
     }
+    exposition_parser_finish(&client->parser);
 
-    // Leer configuración
-    int intervalo_muestreo = DEFAULT_INTERVAL;
-    cJSON* config = leer_configuracion(&intervalo_muestreo);
-    if (!config)
-    {
-        fprintf(stderr, "Error al cargar la configuración\n");
-        return;
-    }
+    if (shm->truncated)
+        fprintf(stderr, "Sin memoria para las métricas; se publican incompletas\n");
+    if (metrics_shm_commit(shm) == -1)
+        perror("Error al publicar las métricas");
+}
 
-    // Abrir pipe para escribir (usar open en lugar de fopen)
-    int pipe_fd = open(PIPE_PATH, O_WRONLY | O_TRUNC);
-    if (pipe_fd == -1)
+/**
+ * @brief Indica si el archivo de configuración cambió desde la última carga.
+ *
+ * Si el archivo falta o no se puede consultar, informa el cambio solo la primera vez (o si el error es otro), para
+ * que el intento de recarga avise una sola vez; después se espera a que stat vuelva a funcionar.
+ *
+ * @param actual Donde se guarda el estado actual del archivo; no se modifica si stat falla.
+ * @param ultima Estado del archivo en la última carga.
+ * @param error_stat Error de stat de la consulta anterior (0 si funcionó); se actualiza con el de esta.
+ * @return true si cambió, o si stat empezó a fallar.
+ */
+static bool configuracion_cambio(struct stat* actual, const struct stat* ultima, int* error_stat)
+{
+    struct stat st;
+    if (stat(CONFIG_PATH, &st) == -1)
     {
-        perror("Error al abrir la pipe");
-        return;
+        bool nuevo = errno != *error_stat;
+        *error_stat = errno;
+        return nuevo;
     }
+    *error_stat = 0;
+    *actual = st;
+    return actual->st_ino != ultima->st_ino || actual->st_size != ultima->st_size ||
+           actual->st_mtim.tv_sec != ultima->st_mtim.tv_sec || actual->st_mtim.tv_nsec != ultima->st_mtim.tv_nsec;
+}
 
-    // Filtrar y escribir métricas
-    char* linea = strtok(chunk.memory, "\n");
-    while (linea != NULL)
+/**
+ * @brief Lee la configuración y reemplaza el filtro del cliente.
+ *
+ * Si falla, el cliente conserva el filtro anterior.
+ *
+ * @return 0 si se cargó, -1 en caso de error (informado en stderr).
+ */
+static int cargar_configuracion(struct metrics_client* client, int* intervalo_muestreo, long* timeout_ms)
+{
+    cJSON* config = leer_configuracion(intervalo_muestreo, timeout_ms);
+    if (!config)
     {
-        if (metricas_filtradas(linea, config))
-        {
-            ssize_t bytes_written = write(pipe_fd, linea, strlen(linea));
-            if (bytes_written == -1)
-            {
-                perror("Error al escribir en el pipe");
-                continue;
-            }
-            bytes_written = write(pipe_fd, "\n", 1); // Agregar nueva línea
-            (void)bytes_written;
-        }
-        linea = strtok(NULL, "\n");
+        fprintf(stderr, "Error al cargar la configuración\n");
+        return -1;
     }
-
-    // Escribir el delimitador al final de todas las métricas
-    size_t unus = write(pipe_fd, DELIMITADOR, strlen(DELIMITADOR));
-    (void)unus;
-
-    close(pipe_fd); // Cerrar el descriptor de archivo
+    metric_matcher matcher;
+    int status = compilar_filtro(&matcher, config);
     cJSON_Delete(config);
-    curl_easy_cleanup(curl);
-    free(chunk.memory);
+    if (status == -1)
+    {
+        fprintf(stderr, "Sin memoria para compilar el filtro de métricas\n");
+        return -1;
+    }
+    metric_matcher_free(&client->matcher);
+    client->matcher = matcher;
+    return 0;
 }
 
 /**
  * @brief Función principal del programa.
  *
- * Esta función crea una pipe nombrada si no existe y ejecuta el
- * procesamiento de métricas en un bucle continuo, usando el intervalo
- * de muestreo definido en el archivo de configuración.
+ * Esta función crea la memoria compartida de métricas y ejecuta el procesamiento de métricas en un bucle continuo,
+ * usando el intervalo de muestreo definido en el archivo de configuración.
  *
  * @return 0 si el programa se ejecuta con éxito.
  */
 int main()
 {
-    // Crear la pipe nombrada si no existe
-    if (access(PIPE_PATH, F_OK) == -1)
+    if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK)
     {
-        if (mkfifo(PIPE_PATH, 0666) != 0)
-        {
-            perror("Error al crear la pipe");
-            return 1;
-        }
+        fprintf(stderr, "Error al inicializar cURL\n");
+        return 1;
+    }
+
+    metrics_shm shm;
+    if (metrics_shm_create(&shm, METRICS_SHM_NAME) == -1)
+    {
+        perror("Error al crear la memoria compartida de métricas");
+        curl_global_cleanup();
+        return 1;
+    }
+
+    struct metrics_client client;
+    if (iniciar_cliente(&client) == -1)
+    {
+        fprintf(stderr, "Error al crear el cliente de cURL\n");
+        metrics_shm_close(&shm);
+        curl_global_cleanup();
+        return 1;
     }
 
     // Ejecutar el wrapper continuamente
+    int status = 0;
+    int intervalo_muestreo = DEFAULT_INTERVAL;
+    long timeout_ms = DEFAULT_TIMEOUT_MS;
+    struct stat ultima = {0};
+    int error_stat = 0;
+    bool cargada = false;
     while (1)
     {
-        int intervalo_muestreo = DEFAULT_INTERVAL;
-        cJSON* config = leer_configuracion(&intervalo_muestreo);
-        if (!config)
+        // La configuración y su filtro compilado se reutilizan hasta que cambie el archivo
+        struct stat actual = ultima;
+        if (configuracion_cambio(&actual, &ultima, &error_stat) || !cargada)
         {
-            fprintf(stderr, "Error al cargar la configuración\n");
-            return 1;
+            // Si falla, se sigue con el filtro anterior hasta que el archivo vuelva a cambiar
+            bool error = cargar_configuracion(&client, &intervalo_muestreo, &timeout_ms) == -1;
+            ultima = actual; // Si stat falló, queda la identidad de la última carga
+            if (error && !cargada)
+            {
+                status = 1;
+                break;
+            }
+            cargada = true;
         }
-        procesar_metricas();
-        cJSON_Delete(config);
+        procesar_metricas(&client, timeout_ms, &shm);
         sleep(intervalo_muestreo); // Usar el intervalo de muestreo definido en el JSON
     }
 
-    return 0;
+    cerrar_cliente(&client);
+    metrics_shm_close(&shm);
+    curl_global_cleanup();
+    return status;
 }
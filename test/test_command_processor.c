@@ -1,9 +1,32 @@
 #include "JSON_handler.h"
+#include "batch.h"
+#include "builtins.h"
+#include "command_bench.h"
 #include "command_processor.h"
+#include "config_filter.h"
+#include "config_index.h"
+#include "config_scan.h"
+#include "event_loop.h"
+#include "exposition_parser.h"
 #include "input_interface.h"
+#include "job_metrics.h"
+#include "jobs.h"
+#include "line_reader.h"
 #include "metric_handler.h"
+#include "metric_matcher.h"
+#include "metrics_shm.h"
+#include "parser.h"
+#include "path_cache.h"
+#include "script_cache.h"
+#include "shell_stats.h"
+#include <fcntl.h>
+#include <signal.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
 #include <unistd.h>
 #include <unity/unity.h>
 
@@ -13,6 +36,39 @@
 static char output_buffer[OUTPUT_BUFFER_SIZE]; // Buffer donde almacenamos la salida
 static FILE* output_stream;
 
+static sigset_t test_child_mask; // Máscara previa a fork_test_child()
+
+/**
+ * @brief Crea un proceso hijo para la prueba con SIGCHLD bloqueada en el padre.
+ *
+ * Así el manejador de SIGCHLD de la tabla de trabajos no recolecta al hijo antes que wait_test_child().
+ */
+static pid_t fork_test_child(void)
+{
+    sigset_t block;
+    sigemptyset(&block);
+    sigaddset(&block, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &block, &test_child_mask);
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid <= 0)
+        sigprocmask(SIG_SETMASK, &test_child_mask, NULL);
+    return pid;
+}
+
+/**
+ * @brief Espera al hijo creado con fork_test_child() y restaura la máscara de señales.
+ *
+ * @return Estado del hijo según waitpid(), o -1 si no pudo esperarse.
+ */
+static int wait_test_child(pid_t pid)
+{
+    int status;
+    pid_t waited = waitpid(pid, &status, 0);
+    sigprocmask(SIG_SETMASK, &test_child_mask, NULL);
+    return waited == pid ? status : -1;
+}
+
 void setUp(void)
 {
     // Inicialización antes de cada prueba, si es necesario
@@ -52,6 +108,56 @@ void test_cd_to_previous_directory()
     free(command);
 }
 
+void test_builtin_arguments_expanded()
+{
+    char dir[] = "/tmp/test_builtin_args_XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+    char cwd[1024];
+    TEST_ASSERT_NOT_NULL(getcwd(cwd, sizeof(cwd)));
+    char command[256];
+    snprintf(command, sizeof(command), "mkdir '%s/con espacio' && echo aguja > '%s/con espacio/app.json'", dir, dir);
+    TEST_ASSERT_EQUAL_INT(0, system(command));
+
+    // `cd` recibe la variable expandida como una sola palabra entre comillas
+    char target[128];
+    snprintf(target, sizeof(target), "%s/con espacio", dir);
+    setenv("TEST_CD_DIR", target, 1);
+    strcpy(command, "cd \"$TEST_CD_DIR\"");
+    execute_command(command);
+    TEST_ASSERT_EQUAL_INT(0, get_last_exit_status());
+    TEST_ASSERT_EQUAL_STRING(target, getenv("PWD"));
+
+    // Sin DIR, `scan` recorre "."; con DIR, ese directorio
+    unsetenv("DIR");
+    strcpy(command, "scan --grep aguja ${DIR:-.}");
+    execute_command(command);
+    TEST_ASSERT_EQUAL_INT(0, get_last_exit_status());
+    setenv("DIR", dir, 1);
+    strcpy(command, "cd $DIR");
+    execute_command(command);
+    strcpy(command, "scan --grep pajar ${DIR:-.}");
+    execute_command(command);
+    TEST_ASSERT_EQUAL_INT(1, get_last_exit_status());
+
+    // Los comandos internos que no forman tuberías no aceptan redirecciones
+    strcpy(command, "cd /tmp > salida");
+    execute_command(command);
+    TEST_ASSERT_EQUAL_INT(2, get_last_exit_status());
+    TEST_ASSERT_EQUAL_STRING(dir, getenv("PWD"));
+
+    // Un subcomando de `config` que deja de ser válido al expandirse falla en lugar de no hacer nada
+    unsetenv("TEST_INTERVAL");
+    strcpy(command, "config set intervalo_muestreo $TEST_INTERVAL");
+    execute_command(command);
+    TEST_ASSERT_EQUAL_INT(1, get_last_exit_status());
+
+    TEST_ASSERT_EQUAL_INT(0, chdir(cwd));
+    unsetenv("DIR");
+    unsetenv("TEST_CD_DIR");
+    snprintf(command, sizeof(command), "rm -rf %s", dir);
+    TEST_ASSERT_EQUAL_INT(0, system(command));
+}
+
 void test_output_redirection()
 {
     char* command = strdup("echo test > output.txt");
@@ -70,6 +176,706 @@ void test_output_redirection()
     free(command);
 }
 
+void test_builtin_in_pipeline()
+{
+    char command[] = "echo hola  \"a b\" | tr a-z A-Z > builtin_pipe.txt";
+    execute_command(command);
+    TEST_ASSERT_EQUAL_INT(0, get_last_exit_status());
+
+    FILE* file = fopen("builtin_pipe.txt", "r");
+    TEST_ASSERT_NOT_NULL(file);
+    char output[32] = "";
+    fgets(output, sizeof(output), file);
+    fclose(file);
+    TEST_ASSERT_EQUAL_STRING("HOLA A B\n", output);
+    remove("builtin_pipe.txt");
+
+    // La última etapa se ejecuta dentro de la shell y su código es el de la tubería
+    char tail[] = "false | echo -n";
+    execute_command(tail);
+    TEST_ASSERT_EQUAL_INT(0, get_last_exit_status());
+}
+
+void test_builtin_middle_stage_gets_epipe()
+{
+    // 256 KiB no entran en la tubería: `echo` solo termina si recibe EPIPE cuando `head` deja de leer
+    size_t size = 256 * 1024;
+    char* big = malloc(size + 1);
+    TEST_ASSERT_NOT_NULL(big);
+    memset(big, 'x', size);
+    big[size] = '\0';
+    setenv("TEST_BIG", big, 1);
+    free(big);
+
+    pid_t pid = fork_test_child();
+    TEST_ASSERT_TRUE(pid >= 0);
+    if (pid == 0)
+    {
+        alarm(5); // Si el hijo de `echo` se bloquea, la tubería no termina y el proceso muere por SIGALRM
+        char command[] = "true | echo $TEST_BIG | head -c 1 > /dev/null";
+        execute_command(command);
+        _exit(0);
+    }
+
+    int status = wait_test_child(pid);
+    unsetenv("TEST_BIG");
+    TEST_ASSERT_TRUE(WIFEXITED(status));
+    TEST_ASSERT_EQUAL_INT(0, WEXITSTATUS(status));
+}
+
+void test_parse_pipeline_with_redirections()
+{
+    command_list list;
+    TEST_ASSERT_EQUAL(PARSE_OK, parse_command_line("grep 'a b' < in.txt | sort -r >> out.txt 2> err.txt &", &list));
+
+    TEST_ASSERT_EQUAL(1, list.num_pipelines);
+    TEST_ASSERT_TRUE(list.pipelines[0].background);
+    TEST_ASSERT_EQUAL(2, list.pipelines[0].num_commands);
+
+    simple_command* first = &list.pipelines[0].commands[0];
+    TEST_ASSERT_EQUAL(2, first->argc);
+    TEST_ASSERT_EQUAL_STRING("a b", first->argv[1]);
+    TEST_ASSERT_EQUAL(REDIR_IN, first->redirections[0].type);
+    TEST_ASSERT_EQUAL_STRING("in.txt", first->redirections[0].path);
+
+    simple_command* second = &list.pipelines[0].commands[1];
+    TEST_ASSERT_EQUAL(2, second->num_redirections);
+    TEST_ASSERT_EQUAL(REDIR_APPEND, second->redirections[0].type);
+    TEST_ASSERT_EQUAL(REDIR_ERR, second->redirections[1].type);
+
+    free_command_list(&list);
+
+    TEST_ASSERT_EQUAL(PARSE_UNSUPPORTED, parse_command_line("ls *.c && echo ok", &list));
+    TEST_ASSERT_EQUAL(PARSE_SYNTAX_ERROR, parse_command_line("ls | | wc", &list));
+}
+
+void test_parse_variable_expansion()
+{
+    setenv("TEST_VAR", "uno dos", 1);
+    unsetenv("TEST_UNSET");
+
+    command_list list;
+    TEST_ASSERT_EQUAL_INT(PARSE_OK,
+                          parse_command_line("cmd \"$TEST_VAR\" $TEST_VAR ${TEST_UNSET:-x/$TEST_UNSET} '$TEST_VAR' "
+                                             "$TEST_UNSET a${TEST_VAR}b",
+                                             &list));
+    TEST_ASSERT_TRUE(list.expanded);
+    const simple_command* cmd = &list.pipelines[0].commands[0];
+    const char* expected[] = {"cmd", "uno dos", "uno", "dos", "x/", "$TEST_VAR", "auno", "dosb"};
+    TEST_ASSERT_EQUAL_INT(8, cmd->argc);
+    for (int i = 0; i < cmd->argc; i++)
+        TEST_ASSERT_EQUAL_STRING(expected[i], cmd->argv[i]);
+    free_command_list(&list);
+
+    // Los parámetros especiales se siguen delegando en /bin/sh
+    TEST_ASSERT_EQUAL_INT(PARSE_UNSUPPORTED, parse_command_line("echo $?", &list));
+    unsetenv("TEST_VAR");
+}
+
+void test_external_pipeline_three_stages()
+{
+    char* command = strdup("printf 'c\\nb\\na\\n' | sort | head -n 1 > pipeline_output.txt");
+    execute_command(command);
+
+    FILE* file = fopen("pipeline_output.txt", "r");
+    TEST_ASSERT_NOT_NULL(file);
+
+    char output[10] = "";
+    fgets(output, sizeof(output), file);
+    fclose(file);
+
+    TEST_ASSERT_EQUAL_STRING("a\n", output);
+
+    remove("pipeline_output.txt");
+    free(command);
+}
+
+void test_path_cache_invalidated_on_path_change()
+{
+    char* original_path = strdup(getenv("PATH"));
+
+    setenv("PATH", "/bin", 1);
+    const char* resolved = path_cache_lookup("sh");
+    TEST_ASSERT_NOT_NULL(resolved);
+    TEST_ASSERT_EQUAL_STRING("/bin/sh", resolved);
+
+    // Con un $PATH distinto la entrada anterior no debe reutilizarse
+    setenv("PATH", "/nonexistent", 1);
+    TEST_ASSERT_NULL(path_cache_lookup("sh"));
+
+    setenv("PATH", original_path, 1);
+    path_cache_clear();
+    free(original_path);
+}
+
+void test_background_jobs_beyond_four()
+{
+    char command[64];
+
+    // Antes solo se registraban cuatro trabajos en segundo plano
+    for (int i = 0; i < 8; i++)
+    {
+        strcpy(command, "sleep 0.1 &");
+        execute_command(command);
+    }
+    TEST_ASSERT_NOT_NULL(jobs_find("%8"));
+
+    strcpy(command, "wait");
+    execute_command(command);
+    TEST_ASSERT_NULL(jobs_find(NULL));
+}
+
+void test_job_usage_reported_to_monitor()
+{
+    struct rusage total = {0};
+    struct rusage usage = {0};
+    usage.ru_utime.tv_usec = 600000;
+    usage.ru_maxrss = 300;
+    usage.ru_inblock = 2;
+    jobs_add_usage(&total, &usage);
+    usage.ru_maxrss = 100;
+    jobs_add_usage(&total, &usage);
+    TEST_ASSERT_EQUAL_INT(1, (int)total.ru_utime.tv_sec);
+    TEST_ASSERT_EQUAL_INT(200000, (int)total.ru_utime.tv_usec);
+    TEST_ASSERT_EQUAL_INT(300, (int)total.ru_maxrss);
+    TEST_ASSERT_EQUAL_INT(4, (int)total.ru_inblock);
+
+    // Hace de monitor en un socket propio, sin tocar el de un monitor que esté en ejecución
+    char dir[] = "/tmp/test_job_metrics_XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s/jobs.sock", dir);
+    setenv(JOB_METRICS_SOCKET_ENV, addr.sun_path, 1);
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    TEST_ASSERT_NOT_EQUAL(-1, fd);
+    TEST_ASSERT_EQUAL_INT(0, bind(fd, (struct sockaddr*)&addr, sizeof(addr)));
+
+    char command[64];
+    strcpy(command, "/bin/sh -c 'exit 3'");
+    execute_command(command);
+
+    job_metrics_datagram datagram;
+    TEST_ASSERT_EQUAL_INT(sizeof(datagram), recv(fd, &datagram, sizeof(datagram), MSG_DONTWAIT));
+    TEST_ASSERT_EQUAL_INT(JOB_METRICS_VERSION, datagram.version);
+    TEST_ASSERT_EQUAL_INT(3, datagram.exit_status);
+    TEST_ASSERT_EQUAL_STRING("sh", datagram.command);
+    close(fd);
+    unsetenv(JOB_METRICS_SOCKET_ENV);
+    unlink(addr.sun_path);
+    rmdir(dir);
+}
+
+void test_batch_parallel_keeps_output_order()
+{
+    FILE* script_file = tmpfile();
+    FILE* output = tmpfile();
+    TEST_ASSERT_NOT_NULL(script_file);
+    TEST_ASSERT_NOT_NULL(output);
+
+    // La primera línea termina última, pero su salida debe aparecer primero
+    fputs("sh -c 'sleep 0.3; echo uno'\nsh -c 'echo dos'\nwait\nsh -c 'echo tres; exit 3'\n", script_file);
+    rewind(script_file);
+
+    line_reader script;
+    line_reader_from_stream(&script, script_file);
+    int status = batch_run_parallel(&script, 4, fileno(output));
+    TEST_ASSERT_EQUAL_INT(3, status);
+
+    // stderr también se almacena (p. ej. avisos de configuración): solo se verifica el orden
+    char content[OUTPUT_BUFFER_SIZE];
+    rewind(output);
+    size_t len = fread(content, 1, sizeof(content) - 1, output);
+    content[len] = '\0';
+    char* uno = strstr(content, "uno\n");
+    char* dos = strstr(content, "dos\n");
+    char* tres = strstr(content, "tres\n");
+    TEST_ASSERT_NOT_NULL(uno);
+    TEST_ASSERT_NOT_NULL(dos);
+    TEST_ASSERT_NOT_NULL(tres);
+    TEST_ASSERT_TRUE(uno < dos && dos < tres);
+
+    line_reader_close(&script);
+    fclose(script_file);
+    fclose(output);
+}
+
+void test_line_reader_long_and_unterminated_lines()
+{
+    char path[] = "/tmp/test_line_reader_XXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT_NOT_EQUAL(-1, fd);
+
+    // Una línea más larga que el antiguo buffer de 1024 bytes y una última línea sin '\n'
+    char long_line[3000];
+    memset(long_line, 'x', sizeof(long_line));
+    TEST_ASSERT_EQUAL_INT(sizeof(long_line), write(fd, long_line, sizeof(long_line)));
+    TEST_ASSERT_EQUAL_INT(8, write(fd, "\nultima", 8));
+    close(fd);
+
+    line_reader reader;
+    TEST_ASSERT_EQUAL_INT(0, line_reader_open(&reader, path));
+    size_t length;
+    char* line = line_reader_next(&reader, &length);
+    TEST_ASSERT_NOT_NULL(line);
+    TEST_ASSERT_EQUAL_UINT(sizeof(long_line), length);
+    TEST_ASSERT_EQUAL_UINT(sizeof(long_line), strlen(line));
+    TEST_ASSERT_EQUAL_STRING("ultima", line_reader_next(&reader, NULL));
+    TEST_ASSERT_NULL(line_reader_next(&reader, NULL));
+
+    line_reader_close(&reader);
+    unlink(path);
+}
+
+void test_builtin_lookup()
+{
+    TEST_ASSERT_EQUAL_INT(CMD_CD, lookup_builtin("  cd /tmp"));
+    // La primera palabra termina donde la termina el parser: en un tabulador o en un operador
+    TEST_ASSERT_EQUAL_INT(CMD_CD, lookup_builtin("\tcd\t/tmp"));
+    TEST_ASSERT_EQUAL_INT(CMD_ECHO, lookup_builtin("echo\tx"));
+    TEST_ASSERT_EQUAL_INT(CMD_ECHO, lookup_builtin("echo|tr a-z A-Z"));
+    TEST_ASSERT_EQUAL_INT(CMD_QUIT, lookup_builtin("quit"));
+    TEST_ASSERT_EQUAL_INT(CMD_CONFIG, lookup_builtin("config print"));
+    TEST_ASSERT_EQUAL_INT(CMD_MONITOR, lookup_builtin("expose metrics realtime"));
+    // La primera palabra coincide pero los argumentos no son válidos para el comando interno
+    TEST_ASSERT_EQUAL_INT(CMD_EXTERNAL, lookup_builtin("config imprimir"));
+    TEST_ASSERT_EQUAL_INT(CMD_EXTERNAL, lookup_builtin("metrics"));
+    TEST_ASSERT_EQUAL_INT(CMD_EXTERNAL, lookup_builtin("echoes hola"));
+    TEST_ASSERT_EQUAL_INT(CMD_EXTERNAL, lookup_builtin("ls -l"));
+    TEST_ASSERT_EQUAL_INT(CMD_EXTERNAL, lookup_builtin(""));
+    TEST_ASSERT_NOT_NULL(find_builtin("status_monitor", 14));
+    TEST_ASSERT_NULL(find_builtin("status", 6));
+}
+
+void test_script_cache_round_trip()
+{
+    char dir[] = "/tmp/test_script_cache_XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+    char* old_cache_home = getenv("XDG_CACHE_HOME") ? strdup(getenv("XDG_CACHE_HOME")) : NULL;
+    setenv("XDG_CACHE_HOME", dir, 1);
+
+    char script[64];
+    snprintf(script, sizeof(script), "%s/script.sh", dir);
+    FILE* file = fopen(script, "w");
+    TEST_ASSERT_NOT_NULL(file);
+    fputs("jobs\nsort -r < in.txt | head -n 1 > out.txt &\n", file);
+    fclose(file);
+
+    script_cache cache;
+    TEST_ASSERT_EQUAL_INT(-1, script_cache_load(&cache, script));
+
+    script_cache_builder builder;
+    TEST_ASSERT_EQUAL_INT(0, script_cache_builder_init(&builder, script));
+    line_reader reader;
+    TEST_ASSERT_EQUAL_INT(0, line_reader_open(&reader, script));
+    char* line;
+    while ((line = line_reader_next(&reader, NULL)) != NULL)
+    {
+        prepared_command prepared;
+        prepare_command(line, &prepared);
+        script_cache_record(&builder, line, &prepared);
+        free_prepared_command(&prepared);
+    }
+    line_reader_close(&reader);
+    TEST_ASSERT_EQUAL_INT(0, script_cache_commit(&builder));
+    script_cache_builder_free(&builder);
+
+    TEST_ASSERT_EQUAL_INT(0, script_cache_load(&cache, script));
+    TEST_ASSERT_EQUAL_INT(2, cache.num_lines);
+    TEST_ASSERT_EQUAL_INT(CMD_JOBS, cache.lines[0].prepared.type);
+    TEST_ASSERT_EQUAL_INT(CMD_EXTERNAL, cache.lines[1].prepared.type);
+    const command_list* list = &cache.lines[1].prepared.list;
+    TEST_ASSERT_EQUAL_INT(1, list->num_pipelines);
+    TEST_ASSERT_TRUE(list->pipelines[0].background);
+    TEST_ASSERT_EQUAL_INT(2, list->pipelines[0].num_commands);
+    const simple_command* sort = &list->pipelines[0].commands[0];
+    TEST_ASSERT_EQUAL_INT(2, sort->argc);
+    TEST_ASSERT_EQUAL_STRING("-r", sort->argv[1]);
+    TEST_ASSERT_NULL(sort->argv[2]);
+    TEST_ASSERT_EQUAL_INT(REDIR_IN, sort->redirections[0].type);
+    TEST_ASSERT_EQUAL_STRING("out.txt", list->pipelines[0].commands[1].redirections[0].path);
+    script_cache_close(&cache);
+
+    // Un cambio en el script invalida la caché
+    file = fopen(script, "a");
+    fputs("pwd\n", file);
+    fclose(file);
+    TEST_ASSERT_EQUAL_INT(-1, script_cache_load(&cache, script));
+
+    // Un script que termina con `quit` también queda en la caché, aunque `quit` termine el proceso
+    char quit_script[64];
+    snprintf(quit_script, sizeof(quit_script), "%s/quit.sh", dir);
+    file = fopen(quit_script, "w");
+    TEST_ASSERT_NOT_NULL(file);
+    fputs("echo uno\nquit\n", file);
+    fclose(file);
+    pid_t pid = fork_test_child();
+    TEST_ASSERT_TRUE(pid >= 0);
+    if (pid == 0)
+    {
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        close(null_fd);
+        if (line_reader_open(&reader, quit_script) == 0)
+            batch_run_file(&reader, quit_script, true);
+        _exit(EXIT_FAILURE); // `quit` debió terminar el proceso con EXIT_SUCCESS
+    }
+    int status = wait_test_child(pid);
+    TEST_ASSERT_TRUE(WIFEXITED(status));
+    TEST_ASSERT_EQUAL_INT(EXIT_SUCCESS, WEXITSTATUS(status));
+    TEST_ASSERT_EQUAL_INT(0, script_cache_load(&cache, quit_script));
+    TEST_ASSERT_EQUAL_INT(2, cache.num_lines);
+    TEST_ASSERT_EQUAL_INT(CMD_QUIT, cache.lines[1].prepared.type);
+    script_cache_close(&cache);
+
+    if (old_cache_home != NULL)
+        setenv("XDG_CACHE_HOME", old_cache_home, 1);
+    else
+        unsetenv("XDG_CACHE_HOME");
+    free(old_cache_home);
+    char command[64];
+    snprintf(command, sizeof(command), "rm -rf %s", dir);
+    TEST_ASSERT_EQUAL_INT(0, system(command));
+}
+
+void test_scan_config_files_follows_links_once()
+{
+    char dir[] = "/tmp/test_scan_XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+    char command[256];
+    snprintf(command, sizeof(command),
+             "cd %s && mkdir -p a/b d && touch top.json a/app.config a/b/c.json a/b/no.txt && ln -s .. a/b/loop && "
+             "ln -s ../a d/link && ln -s missing d/broken.json",
+             dir);
+    TEST_ASSERT_EQUAL_INT(0, system(command));
+
+    char cwd[1024];
+    TEST_ASSERT_NOT_NULL(getcwd(cwd, sizeof(cwd)));
+    scan_result result;
+    TEST_ASSERT_EQUAL_INT(0, scan_config_files(dir, 4, &result));
+
+    // El directorio enlazado se muestra por su ruta real y el ciclo a/b/loop no se recorre
+    TEST_ASSERT_EQUAL_UINT(3, result.count);
+    char expected[64];
+    snprintf(expected, sizeof(expected), "%s/a/app.config", dir);
+    TEST_ASSERT_EQUAL_STRING(expected, result.paths[0]);
+    snprintf(expected, sizeof(expected), "%s/a/b/c.json", dir);
+    TEST_ASSERT_EQUAL_STRING(expected, result.paths[1]);
+    snprintf(expected, sizeof(expected), "%s/top.json", dir);
+    TEST_ASSERT_EQUAL_STRING(expected, result.paths[2]);
+    scan_result_free(&result);
+
+    char after[1024];
+    TEST_ASSERT_NOT_NULL(getcwd(after, sizeof(after)));
+    TEST_ASSERT_EQUAL_STRING(cwd, after);
+
+    snprintf(command, sizeof(command), "rm -rf %s", dir);
+    TEST_ASSERT_EQUAL_INT(0, system(command));
+}
+
+void test_filter_config_files()
+{
+    char dir[] = "/tmp/test_filter_XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+    char command[256];
+    snprintf(command, sizeof(command),
+             "cd %s && printf '{\"a\": [1, 2]}\\n' > ok.json && printf '{\"a\": 1} x' > trailing.json && "
+             ": > empty.json && echo 'modo: error grave' > app.config",
+             dir);
+    TEST_ASSERT_EQUAL_INT(0, system(command));
+
+    scan_result result;
+    TEST_ASSERT_EQUAL_INT(0, scan_config_files(dir, 2, &result));
+    TEST_ASSERT_EQUAL_UINT(4, result.count);
+    TEST_ASSERT_EQUAL_INT(0, filter_config_files(&result, FILTER_GREP, "error grave", 2));
+    TEST_ASSERT_EQUAL_UINT(1, result.count);
+    char expected[64];
+    snprintf(expected, sizeof(expected), "%s/app.config", dir);
+    TEST_ASSERT_EQUAL_STRING(expected, result.paths[0]);
+    scan_result_free(&result);
+
+    // Solo quedan los ".json" que cJSON rechaza, en orden
+    TEST_ASSERT_EQUAL_INT(0, scan_config_files(dir, 2, &result));
+    TEST_ASSERT_EQUAL_INT(0, filter_config_files(&result, FILTER_INVALID, NULL, 2));
+    TEST_ASSERT_EQUAL_UINT(2, result.count);
+    snprintf(expected, sizeof(expected), "%s/empty.json", dir);
+    TEST_ASSERT_EQUAL_STRING(expected, result.paths[0]);
+    snprintf(expected, sizeof(expected), "%s/trailing.json", dir);
+    TEST_ASSERT_EQUAL_STRING(expected, result.paths[1]);
+    scan_result_free(&result);
+
+    snprintf(command, sizeof(command), "rm -rf %s", dir);
+    TEST_ASSERT_EQUAL_INT(0, system(command));
+}
+
+void test_config_index_tracks_changes()
+{
+    char dir[] = "/tmp/test_index_XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+    char* old_cache_home = getenv("XDG_CACHE_HOME") ? strdup(getenv("XDG_CACHE_HOME")) : NULL;
+    setenv("XDG_CACHE_HOME", dir, 1);
+    char command[256];
+    snprintf(command, sizeof(command), "mkdir -p %s/tree/a && touch %s/tree/a/app.json", dir, dir);
+    TEST_ASSERT_EQUAL_INT(0, system(command));
+
+    char root[64];
+    snprintf(root, sizeof(root), "%s/tree", dir);
+    scan_result result;
+    TEST_ASSERT_EQUAL_INT(-1, config_index_scan(root, &result));
+    TEST_ASSERT_EQUAL_INT(0, config_index_register(root));
+    TEST_ASSERT_EQUAL_INT(0, config_index_scan(root, &result));
+    TEST_ASSERT_EQUAL_UINT(1, result.count);
+    scan_result_free(&result);
+
+    // Un directorio nuevo y un archivo borrado se reflejan sin reconstruir el índice
+    snprintf(command, sizeof(command), "mkdir -p %s/tree/b/c && touch %s/tree/b/c/new.config && rm %s/tree/a/app.json",
+             dir, dir, dir);
+    TEST_ASSERT_EQUAL_INT(0, system(command));
+    TEST_ASSERT_EQUAL_INT(0, config_index_scan(root, &result));
+    TEST_ASSERT_EQUAL_UINT(1, result.count);
+    char expected[96];
+    snprintf(expected, sizeof(expected), "%s/b/c/new.config", root);
+    TEST_ASSERT_EQUAL_STRING(expected, result.paths[0]);
+    scan_result_free(&result);
+
+    // Desde un subdirectorio solo se devuelven sus archivos
+    snprintf(expected, sizeof(expected), "%s/a", root);
+    TEST_ASSERT_EQUAL_INT(0, config_index_scan(expected, &result));
+    TEST_ASSERT_EQUAL_UINT(0, result.count);
+    scan_result_free(&result);
+
+    TEST_ASSERT_EQUAL_INT(0, config_index_unregister(root));
+    TEST_ASSERT_EQUAL_INT(-1, config_index_scan(root, &result));
+
+    if (old_cache_home != NULL)
+        setenv("XDG_CACHE_HOME", old_cache_home, 1);
+    else
+        unsetenv("XDG_CACHE_HOME");
+    free(old_cache_home);
+    snprintf(command, sizeof(command), "rm -rf %s", dir);
+    TEST_ASSERT_EQUAL_INT(0, system(command));
+}
+
+void test_bench_options_and_percentiles()
+{
+    bench_options options;
+    TEST_ASSERT_EQUAL_INT(0, bench_parse_options("-n 50 -w 3 --json -- ls -l | wc -l", &options));
+    TEST_ASSERT_EQUAL_INT(50, options.runs);
+    TEST_ASSERT_EQUAL_INT(3, options.warmup);
+    TEST_ASSERT_TRUE(options.json);
+    TEST_ASSERT_EQUAL_STRING("ls -l | wc -l", options.command);
+
+    // Sin `--`, el comando empieza en la primera palabra que no es una opción
+    TEST_ASSERT_EQUAL_INT(0, bench_parse_options("sleep 0", &options));
+    TEST_ASSERT_EQUAL_INT(BENCH_DEFAULT_RUNS, options.runs);
+    TEST_ASSERT_EQUAL_STRING("sleep 0", options.command);
+
+    TEST_ASSERT_EQUAL_INT(-1, bench_parse_options("-n 0 -- true", &options));
+    TEST_ASSERT_EQUAL_INT(-1, bench_parse_options("-x -- true", &options));
+    TEST_ASSERT_EQUAL_INT(-1, bench_parse_options("-n 5 --", &options));
+
+    // Las opciones se expanden como cualquier otra palabra
+    setenv("TEST_BENCH_RUNS", "7", 1);
+    TEST_ASSERT_EQUAL_INT(0, bench_parse_options("-n $TEST_BENCH_RUNS -- echo $HOME", &options));
+    TEST_ASSERT_EQUAL_INT(7, options.runs);
+    TEST_ASSERT_EQUAL_STRING("echo $HOME", options.command);
+    unsetenv("TEST_BENCH_RUNS");
+    TEST_ASSERT_EQUAL_INT(-1, bench_parse_options(NULL, &options));
+
+    double sorted[100];
+    for (int i = 0; i < 100; i++)
+        sorted[i] = i + 1;
+    TEST_ASSERT_EQUAL_INT(50, (int)bench_percentile(sorted, 100, 50));
+    TEST_ASSERT_EQUAL_INT(95, (int)bench_percentile(sorted, 100, 95));
+    TEST_ASSERT_EQUAL_INT(99, (int)bench_percentile(sorted, 100, 99));
+    TEST_ASSERT_EQUAL_INT(10, (int)bench_percentile(sorted, 10, 95));
+    TEST_ASSERT_EQUAL_INT(1, (int)bench_percentile(sorted, 1, 99));
+}
+
+void test_shell_stats()
+{
+    stats_reset();
+    for (int i = 1; i <= 100; i++)
+        stats_observe(STATS_DISPATCH, (uint64_t)i * 1000); // 1 µs ... 100 µs
+    TEST_ASSERT_EQUAL_INT(100, (int)stats_histogram_count(STATS_DISPATCH));
+    // Con cubetas de potencias de dos, el cuantil queda dentro de la cubeta que lo contiene
+    uint64_t median = stats_histogram_quantile(STATS_DISPATCH, 0.5);
+    TEST_ASSERT_TRUE(median > 32000 && median <= 64000);
+    TEST_ASSERT_EQUAL_INT(100000, (int)stats_histogram_quantile(STATS_DISPATCH, 1.0));
+    TEST_ASSERT_EQUAL_INT(0, (int)stats_histogram_quantile(STATS_SPAWN, 0.5));
+
+    char command[64];
+    strcpy(command, "/bin/true | true");
+    execute_command(command);
+    strcpy(command, "cd .");
+    execute_command(command);
+    TEST_ASSERT_EQUAL_INT(2, (int)stats_command_count(STATS_EXTERNAL, "true"));
+    TEST_ASSERT_EQUAL_INT(1, (int)stats_command_count(STATS_INTERNAL, "cd"));
+    TEST_ASSERT_EQUAL_INT(2, (int)stats_histogram_count(STATS_SPAWN));
+    TEST_ASSERT_EQUAL_INT(1, (int)stats_histogram_count(STATS_CHILD_WALL));
+    TEST_ASSERT_EQUAL_INT(1, (int)stats_histogram_count(STATS_BUILTIN));
+
+    stats_reset();
+    TEST_ASSERT_EQUAL_INT(0, (int)stats_command_count(STATS_INTERNAL, "cd"));
+
+    // stats --serve nunca reemplaza un archivo que no sea un socket
+    char dir[] = "/tmp/shell_stats_testXXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+    char path[64];
+    snprintf(path, sizeof(path), "%s/notes.txt", dir);
+    FILE* notes = fopen(path, "w");
+    TEST_ASSERT_NOT_NULL(notes);
+    fclose(notes);
+    TEST_ASSERT_EQUAL_INT(-1, stats_serve(path));
+    TEST_ASSERT_EQUAL_INT(0, access(path, F_OK));
+    unlink(path);
+    rmdir(dir);
+}
+
+void test_metrics_shm_publish_and_read()
+{
+    const char* name = "/shell_metrics_test";
+    metrics_shm writer;
+    metrics_shm reader;
+    TEST_ASSERT_EQUAL_INT(0, metrics_shm_create(&writer, name));
+    TEST_ASSERT_EQUAL_INT(0, metrics_shm_open(&reader, name));
+    uint64_t previous = metrics_shm_latest(&reader);
+
+    const char* lines[] = {"# TYPE cpu_usage gauge", "cpu_usage 12.5", "memory_used{kind=\"a}b\"} 3 1700000000000",
+                           "mal formada", "cpu_usage{core=\"1\"} 7"};
+    metrics_shm_begin(&writer);
+    int added = 0;
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++)
+        added += metrics_shm_add_line(&writer, lines[i], strlen(lines[i]));
+    TEST_ASSERT_EQUAL_INT(3, added);
+    TEST_ASSERT_EQUAL_INT(0, metrics_shm_commit(&writer));
+    TEST_ASSERT_EQUAL_INT((int)previous + 1, (int)metrics_shm_latest(&reader));
+
+    metrics_snapshot snapshot = {0};
+    TEST_ASSERT_EQUAL_INT(0, metrics_shm_read(&reader, &snapshot));
+    TEST_ASSERT_EQUAL_INT(3, (int)snapshot.num_samples);
+    TEST_ASSERT_FALSE(snapshot.truncated);
+    TEST_ASSERT_EQUAL_STRING("cpu_usage", metrics_snapshot_string(&snapshot, snapshot.samples[0].name_id));
+    TEST_ASSERT_EQUAL_STRING("", metrics_snapshot_string(&snapshot, snapshot.samples[0].labels_id));
+    TEST_ASSERT_EQUAL_INT(125, (int)(snapshot.samples[0].value * 10));
+    TEST_ASSERT_EQUAL_STRING("kind=\"a}b\"", metrics_snapshot_string(&snapshot, snapshot.samples[1].labels_id));
+    TEST_ASSERT_TRUE(snapshot.samples[1].timestamp_ms == 1700000000000);
+    // El nombre repetido se guarda una sola vez
+    TEST_ASSERT_EQUAL_INT((int)snapshot.samples[0].name_id, (int)snapshot.samples[2].name_id);
+
+    // Mientras se arma la siguiente trama, los lectores siguen viendo la publicada
+    metrics_shm_begin(&writer);
+    char labels[32];
+    for (int i = 0; i < 10000; i++)
+    {
+        int length = snprintf(labels, sizeof(labels), "id=\"%d\"", i);
+        metrics_shm_add(&writer, "series", 6, labels, (size_t)length, i, 0);
+    }
+    TEST_ASSERT_EQUAL_INT(0, metrics_shm_read(&reader, &snapshot));
+    TEST_ASSERT_EQUAL_INT(3, (int)snapshot.num_samples);
+
+    // La trama no entra en la región inicial: el escritor la agranda y el lector vuelve a proyectarla
+    TEST_ASSERT_EQUAL_INT(0, metrics_shm_commit(&writer));
+    TEST_ASSERT_EQUAL_INT(0, metrics_shm_read(&reader, &snapshot));
+    TEST_ASSERT_EQUAL_INT(10000, (int)snapshot.num_samples);
+    TEST_ASSERT_EQUAL_STRING("id=\"9999\"", metrics_snapshot_string(&snapshot, snapshot.samples[9999].labels_id));
+    TEST_ASSERT_EQUAL_INT(9999, (int)snapshot.samples[9999].value);
+
+    metrics_snapshot_free(&snapshot);
+    metrics_shm_close(&reader);
+    metrics_shm_close(&writer);
+    shm_unlink(name);
+}
+
+/**
+ * @brief Acumula lo que entrega el analizador de exposición: cantidad de muestras, suma de valores y último nombre.
+ */
+typedef struct
+{
+    int count;
+    double sum;
+    char last[64];
+} exposition_totals;
+
+static void collect_sample(const exposition_sample* sample, void* data)
+{
+    exposition_totals* totals = data;
+    totals->count++;
+    totals->sum += sample->value;
+    snprintf(totals->last, sizeof(totals->last), "%.*s{%.*s}", (int)sample->name_length, sample->name,
+             (int)sample->labels_length, sample->labels ? sample->labels : "");
+}
+
+void test_exposition_parser_split_chunks()
+{
+    const char* text = "# HELP cpu_usage Uso de CPU\n"
+                       "# TYPE cpu_usage gauge\n"
+                       "cpu_usage 12.5\n"
+                       "\n"
+                       "memory_used{kind=\"rss\",path=\"a b}\"} 3 1700000000000\r\n"
+                       "http_requests_total{code=\"200\"} 1027\n"
+                       "disk_usage 4.5";
+    size_t length = strlen(text);
+
+    // El resultado no depende de cómo curl corte la respuesta
+    exposition_parser parser;
+    for (size_t chunk = 1; chunk <= length; chunk++)
+    {
+        exposition_totals totals = {0};
+        exposition_parser_init(&parser, NULL, collect_sample, &totals);
+        for (size_t offset = 0; offset < length; offset += chunk)
+            TEST_ASSERT_EQUAL_INT(0, exposition_parser_feed(&parser, text + offset,
+                                                            offset + chunk <= length ? chunk : length - offset));
+        TEST_ASSERT_EQUAL_INT(3, totals.count); // La última línea llega sin '\n'
+        exposition_parser_finish(&parser);
+        TEST_ASSERT_EQUAL_INT(4, totals.count);
+        TEST_ASSERT_EQUAL_INT(1047, (int)totals.sum);
+        TEST_ASSERT_EQUAL_STRING("disk_usage{}", totals.last);
+        exposition_parser_free(&parser);
+    }
+
+    exposition_sample sample;
+    const char* line = "memory_used{kind=\"rss\",path=\"a b}\"} 3 1700000000000\r";
+    TEST_ASSERT_EQUAL_INT(1, exposition_parse_line(line, strlen(line), &sample));
+    TEST_ASSERT_EQUAL_INT(11, (int)sample.name_length);
+    TEST_ASSERT_EQUAL_INT(22, (int)sample.labels_length);
+    TEST_ASSERT_TRUE(sample.timestamp_ms == 1700000000000);
+    TEST_ASSERT_EQUAL_INT(0, exposition_parse_line("cpu_usage", 9, &sample));
+    TEST_ASSERT_EQUAL_INT(0, exposition_parse_line("cpu_usage abc", 13, &sample));
+}
+
+void test_metric_matcher()
+{
+    const char* patterns[] = {"minor_page", "disk_usage_percentage", "memory_*", "*_total", "node_*_bytes", "",
+                              "disk_usage_percentage"};
+    metric_matcher matcher;
+    TEST_ASSERT_EQUAL_INT(0, metric_matcher_compile(&matcher, patterns, sizeof(patterns) / sizeof(patterns[0])));
+    TEST_ASSERT_EQUAL_INT(2, (int)matcher.exact_count); // Los repetidos se guardan una vez
+
+    // Los nombres sin comodines se comparan enteros, no como subcadenas
+    TEST_ASSERT_TRUE(metric_matcher_match(&matcher, "minor_page", 10));
+    TEST_ASSERT_FALSE(metric_matcher_match(&matcher, "minor_page_faults", 17));
+    TEST_ASSERT_FALSE(metric_matcher_match(&matcher, "disk_usage", 10));
+    TEST_ASSERT_TRUE(metric_matcher_match(&matcher, "disk_usage_percentage{mount=\"/\"}", 21));
+
+    TEST_ASSERT_TRUE(metric_matcher_match(&matcher, "memory_total", 12));
+    TEST_ASSERT_TRUE(metric_matcher_match(&matcher, "memory_", 7));
+    TEST_ASSERT_FALSE(metric_matcher_match(&matcher, "memor", 5));
+    TEST_ASSERT_TRUE(metric_matcher_match(&matcher, "http_requests_total", 19));
+    TEST_ASSERT_FALSE(metric_matcher_match(&matcher, "total_processes", 15));
+    TEST_ASSERT_TRUE(metric_matcher_match(&matcher, "node_memory_free_bytes", 22));
+    TEST_ASSERT_FALSE(metric_matcher_match(&matcher, "node_memory_free_bytes_x", 24));
+    metric_matcher_free(&matcher);
+
+    // `*` acepta todo y una lista vacía no acepta nada
+    const char* all[] = {"*"};
+    TEST_ASSERT_EQUAL_INT(0, metric_matcher_compile(&matcher, all, 1));
+    TEST_ASSERT_TRUE(metric_matcher_match(&matcher, "cpu_usage_percentage", 20));
+    metric_matcher_free(&matcher);
+    TEST_ASSERT_EQUAL_INT(0, metric_matcher_compile(&matcher, NULL, 0));
+    TEST_ASSERT_FALSE(metric_matcher_match(&matcher, "cpu_usage_percentage", 20));
+    metric_matcher_free(&matcher);
+}
+
 void test_get_command()
 {
     const char* input = "test_command\n";
@@ -84,13 +890,86 @@ void test_get_command()
     TEST_ASSERT_NOT_NULL(result);
     TEST_ASSERT_EQUAL_STRING("test_command\n", result);
 
-    free(result);
-
     // Restaurar stdin a su estado original y liberar temp_input
     stdin = stdin_backup;
     fclose(temp_input);
 }
 
+void test_get_command_with_event_loop_returns_buffered_lines()
+{
+    int pipefd[2];
+    TEST_ASSERT_EQUAL_INT(0, pipe(pipefd));
+
+    // El bucle de eventos queda activo solo en el hijo, sin afectar al resto de las pruebas
+    pid_t pid = fork_test_child();
+    TEST_ASSERT_TRUE(pid >= 0);
+    if (pid == 0)
+    {
+        alarm(5); // Si la segunda línea espera más datos del descriptor, el hijo termina por SIGALRM
+        close(pipefd[1]);
+        dup2(pipefd[0], STDIN_FILENO);
+        close(pipefd[0]);
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        close(null_fd);
+        if (event_loop_init() == -1)
+            _exit(2);
+        if (strcmp(get_command(), "echo uno\n") != 0)
+            _exit(3);
+        if (strcmp(get_command(), "echo dos\n") != 0)
+            _exit(4);
+        _exit(0);
+    }
+
+    // Ambas líneas llegan en una sola escritura y el extremo de escritura sigue abierto
+    close(pipefd[0]);
+    const char* lines = "echo uno\necho dos\n";
+    TEST_ASSERT_EQUAL_INT((int)strlen(lines), (int)write(pipefd[1], lines, strlen(lines)));
+
+    int status = wait_test_child(pid);
+    close(pipefd[1]);
+    TEST_ASSERT_TRUE(WIFEXITED(status));
+    TEST_ASSERT_EQUAL_INT(0, WEXITSTATUS(status));
+}
+
+void test_prompt_written_once_and_refreshed_by_cd()
+{
+    char* saved_pwd = strdup(getenv("PWD"));
+    const char* input = "uno\n";
+    FILE* temp_input = fmemopen((void*)input, strlen(input), "r");
+    FILE* stdin_backup = stdin;
+    stdin = temp_input;
+
+    char command[64];
+    strcpy(command, "cd /tmp");
+    execute_command(command);
+
+    // El prompt completo llega en una sola escritura a stdout
+    int pipefd[2];
+    TEST_ASSERT_EQUAL_INT(0, pipe(pipefd));
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    dup2(pipefd[1], STDOUT_FILENO);
+    get_command();
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+    close(pipefd[1]);
+
+    char prompt[256] = "";
+    ssize_t n = read(pipefd[0], prompt, sizeof(prompt) - 1);
+    close(pipefd[0]);
+    TEST_ASSERT_TRUE(n > 0);
+    TEST_ASSERT_NOT_NULL(strstr(prompt, ":" RESET "/tmp\n"));
+    TEST_ASSERT_NOT_NULL(strstr(prompt, "$ "));
+
+    stdin = stdin_backup;
+    fclose(temp_input);
+    TEST_ASSERT_EQUAL_INT(0, chdir(saved_pwd));
+    setenv("PWD", saved_pwd, 1);
+    refresh_prompt();
+    free(saved_pwd);
+}
+
 void test_JSON_command_print()
 {
     Config config;
@@ -189,8 +1068,31 @@ int main(void)
     UNITY_BEGIN();
     RUN_TEST(test_cd_to_home);
     RUN_TEST(test_cd_to_previous_directory);
+    RUN_TEST(test_builtin_arguments_expanded);
     RUN_TEST(test_output_redirection);
+    RUN_TEST(test_builtin_in_pipeline);
+    RUN_TEST(test_builtin_middle_stage_gets_epipe);
+    RUN_TEST(test_parse_pipeline_with_redirections);
+    RUN_TEST(test_parse_variable_expansion);
+    RUN_TEST(test_external_pipeline_three_stages);
+    RUN_TEST(test_path_cache_invalidated_on_path_change);
+    RUN_TEST(test_background_jobs_beyond_four);
+    RUN_TEST(test_job_usage_reported_to_monitor);
+    RUN_TEST(test_batch_parallel_keeps_output_order);
+    RUN_TEST(test_line_reader_long_and_unterminated_lines);
+    RUN_TEST(test_builtin_lookup);
+    RUN_TEST(test_script_cache_round_trip);
+    RUN_TEST(test_scan_config_files_follows_links_once);
+    RUN_TEST(test_filter_config_files);
+    RUN_TEST(test_config_index_tracks_changes);
+    RUN_TEST(test_bench_options_and_percentiles);
+    RUN_TEST(test_shell_stats);
+    RUN_TEST(test_metrics_shm_publish_and_read);
+    RUN_TEST(test_exposition_parser_split_chunks);
+    RUN_TEST(test_metric_matcher);
     RUN_TEST(test_get_command);
+    RUN_TEST(test_get_command_with_event_loop_returns_buffered_lines);
+    RUN_TEST(test_prompt_written_once_and_refreshed_by_cd);
     RUN_TEST(test_JSON_command_print);
     RUN_TEST(test_config_help);
     RUN_TEST(test_status_monitor);